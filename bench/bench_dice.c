@@ -0,0 +1,336 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dice.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// =============================================================================
+// bench_dice - fixed-seed microbenchmarks for the library hot paths
+// =============================================================================
+//
+// Usage: bench_dice [--json FILE] [--filter TEXT] [--scale FACTOR]
+//
+// Every case reports nanoseconds, heap allocations and arena bytes per
+// operation. --json writes the same numbers in a stable machine-readable form
+// for diffing between builds.
+
+#define BENCH_SEED 42
+#define BENCH_RNG_BATCH 1000
+#define BENCH_ARENA_SIZE (1024 * 1024)
+
+// -----------------------------------------------------------------------------
+// Heap allocation counting (glibc only: the executable's malloc interposes the
+// library's calls and forwards to the real allocator)
+// -----------------------------------------------------------------------------
+
+#if defined(__GLIBC__)
+#define BENCH_COUNT_ALLOCS 1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static unsigned long long bench_alloc_count;
+
+void *malloc(size_t size) {
+    bench_alloc_count++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    bench_alloc_count++;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    bench_alloc_count++;
+    return __libc_realloc(ptr, size);
+}
+#endif
+
+static unsigned long long bench_allocs(void) {
+#ifdef BENCH_COUNT_ALLOCS
+    return bench_alloc_count;
+#else
+    return 0;
+#endif
+}
+
+static double bench_now_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart * 1e9 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Cases
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    dice_context_t *ctx;
+    dice_ast_node_t *ast;
+    const char *expression;
+    size_t mark;
+    dice_rng_vtable_t rng;
+    int buffer[BENCH_RNG_BATCH];
+    volatile int64_t sink;
+} bench_fixture_t;
+
+// Runs one timed operation and returns the arena bytes it used
+typedef size_t (*bench_op_t)(bench_fixture_t *f);
+
+typedef enum {
+    BENCH_ENGINE_NONE,
+    BENCH_ENGINE_SYSTEM,
+    BENCH_ENGINE_XOSHIRO,
+    BENCH_ENGINE_XOSHIRO_X4
+} bench_engine_t;
+
+typedef struct {
+    const char *name;
+    const char *expression;         // Expression parsed or evaluated (NULL for RNG cases)
+    bench_op_t op;
+    unsigned long long iterations;  // Calls to op at scale 1
+    unsigned ops_per_call;          // Operations each call performs
+    dice_trace_level_t trace_level;
+    bench_engine_t engine;          // Engine driven directly by RNG cases
+} bench_case_t;
+
+typedef struct {
+    const bench_case_t *bench;
+    unsigned long long ops;
+    double ns_per_op;
+    double allocs_per_op;
+    double arena_bytes_per_op;
+} bench_result_t;
+
+static size_t op_parse(bench_fixture_t *f) {
+    dice_ast_node_t *ast = dice_parse(f->ctx, f->expression);
+    size_t used = dice_arena_mark(f->ctx) - f->mark;
+    f->sink += ast != NULL;
+    dice_arena_rewind(f->ctx, f->mark);
+    return used;
+}
+
+static size_t op_evaluate(bench_fixture_t *f) {
+    dice_eval_result_t result = dice_evaluate(f->ctx, f->ast);
+    size_t used = dice_arena_mark(f->ctx) - f->mark;
+    f->sink += result.value;
+    dice_clear_trace(f->ctx);
+    dice_arena_rewind(f->ctx, f->mark);
+    return used;
+}
+
+// Same as op_evaluate; the fixture runs dice_optimize on the AST first
+static size_t op_evaluate_optimized(bench_fixture_t *f) {
+    return op_evaluate(f);
+}
+
+static size_t op_rng_roll(bench_fixture_t *f) {
+    int64_t sum = 0;
+    for (int i = 0; i < BENCH_RNG_BATCH; i++) {
+        sum += f->rng.roll(f->rng.state, 6);
+    }
+    f->sink += sum;
+    return 0;
+}
+
+static size_t op_rng_roll_n(bench_fixture_t *f) {
+    f->rng.roll_n(f->rng.state, 6, f->buffer, BENCH_RNG_BATCH);
+    f->sink += f->buffer[BENCH_RNG_BATCH - 1];
+    return 0;
+}
+
+static size_t op_simple_notation(bench_fixture_t *f) {
+    f->sink += dice_roll_notation(f->expression);
+    return 0;
+}
+
+static size_t op_simple_roll(bench_fixture_t *f) {
+    f->sink += dice_roll(20);
+    return 0;
+}
+
+// kh/kl spellings are not accepted by the parser; k is keep-highest
+static const bench_case_t BENCH_CASES[] = {
+    {"parse/short", "3d6+2", op_parse, 200000, 1, DICE_TRACE_FULL, BENCH_ENGINE_NONE},
+    {"parse/long", "4d6k3+2d20l1+3d8r<2+5d10s>7+(2d6+3)*2-1d4/1d2+4dF",
+     op_parse, 50000, 1, DICE_TRACE_FULL, BENCH_ENGINE_NONE},
+    {"evaluate/3d6+2", "3d6+2", op_evaluate, 200000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"evaluate/1000d6", "1000d6", op_evaluate, 5000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"evaluate/100d20k10", "100d20k10", op_evaluate, 20000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"evaluate/reroll", "10d6r<3", op_evaluate, 50000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"evaluate/500d6!", "500d6!", op_evaluate, 10000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"evaluate/pool1000", "1000d10>8", op_evaluate, 50000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"evaluate/select1000", "1000d10s>8", op_evaluate, 5000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"evaluate/custom_inline", "10d{1,1,2,3,5,8}", op_evaluate, 50000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"evaluate/custom_named", "10dF", op_evaluate, 50000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"evaluate/custom_weighted", "10d{0:\"miss\"*97, 1:\"hit\"*3}", op_evaluate, 50000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"evaluate/template", "(2+1)d(4*2)+1d6+1d6+1d6+0", op_evaluate, 50000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"optimize/template", "(2+1)d(4*2)+1d6+1d6+1d6+0", op_evaluate_optimized, 50000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"trace/off", "100d6", op_evaluate, 20000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"trace/summary", "100d6", op_evaluate, 20000, 1, DICE_TRACE_SUMMARY, BENCH_ENGINE_NONE},
+    {"trace/full", "100d6", op_evaluate, 20000, 1, DICE_TRACE_FULL, BENCH_ENGINE_NONE},
+    {"simple/dice_roll", NULL, op_simple_roll, 200000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"simple/dice_roll_notation", "4d6k3+2", op_simple_notation, 100000, 1, DICE_TRACE_OFF, BENCH_ENGINE_NONE},
+    {"rng/system/roll", NULL, op_rng_roll, 2000, BENCH_RNG_BATCH, DICE_TRACE_OFF, BENCH_ENGINE_SYSTEM},
+    {"rng/xoshiro/roll", NULL, op_rng_roll, 2000, BENCH_RNG_BATCH, DICE_TRACE_OFF, BENCH_ENGINE_XOSHIRO},
+    {"rng/xoshiro/roll_n", NULL, op_rng_roll_n, 2000, BENCH_RNG_BATCH, DICE_TRACE_OFF, BENCH_ENGINE_XOSHIRO},
+    {"rng/xoshiro_x4/roll", NULL, op_rng_roll, 2000, BENCH_RNG_BATCH, DICE_TRACE_OFF, BENCH_ENGINE_XOSHIRO_X4},
+    {"rng/xoshiro_x4/roll_n", NULL, op_rng_roll_n, 2000, BENCH_RNG_BATCH, DICE_TRACE_OFF, BENCH_ENGINE_XOSHIRO_X4},
+};
+
+static dice_rng_vtable_t bench_create_engine(bench_engine_t engine) {
+    switch (engine) {
+        case BENCH_ENGINE_SYSTEM: return dice_create_system_rng(BENCH_SEED);
+        case BENCH_ENGINE_XOSHIRO_X4: return dice_create_xoshiro_x4_rng(BENCH_SEED);
+        default: return dice_create_xoshiro_rng(BENCH_SEED);
+    }
+}
+
+static int bench_run(const bench_case_t *bench, double scale, bench_result_t *result) {
+    bench_fixture_t f;
+    memset(&f, 0, sizeof(f));
+    
+    f.ctx = dice_context_create(BENCH_ARENA_SIZE, DICE_FEATURE_ALL);
+    if (!f.ctx) return -1;
+    dice_rng_vtable_t ctx_rng = dice_create_xoshiro_rng(BENCH_SEED);
+    dice_context_set_rng(f.ctx, &ctx_rng);
+    dice_context_set_trace_level(f.ctx, bench->trace_level);
+    
+    f.expression = bench->expression;
+    if (bench->op == op_evaluate || bench->op == op_evaluate_optimized) {
+        f.ast = dice_parse(f.ctx, bench->expression);
+        if (f.ast && bench->op == op_evaluate_optimized && dice_optimize(f.ctx, f.ast) != 0) {
+            f.ast = NULL;
+        }
+        if (!f.ast) {
+            fprintf(stderr, "%s: %s\n", bench->name, dice_get_error(f.ctx));
+            dice_context_destroy(f.ctx);
+            return -1;
+        }
+    }
+    if (bench->engine != BENCH_ENGINE_NONE) {
+        f.rng = bench_create_engine(bench->engine);
+    }
+    f.mark = dice_arena_mark(f.ctx);
+    
+    unsigned long long iterations = (unsigned long long)(bench->iterations * scale);
+    if (iterations == 0) iterations = 1;
+    
+    // Warm caches and branch predictors before timing
+    for (unsigned long long i = 0; i < iterations / 10 + 1; i++) {
+        bench->op(&f);
+    }
+    
+    size_t arena_bytes = 0;
+    unsigned long long allocs_before = bench_allocs();
+    double start = bench_now_ns();
+    for (unsigned long long i = 0; i < iterations; i++) {
+        arena_bytes += bench->op(&f);
+    }
+    double elapsed = bench_now_ns() - start;
+    unsigned long long allocs = bench_allocs() - allocs_before;
+    
+    int status = dice_has_error(f.ctx) ? -1 : 0;
+    if (status != 0) fprintf(stderr, "%s: %s\n", bench->name, dice_get_error(f.ctx));
+    
+    unsigned long long ops = iterations * bench->ops_per_call;
+    result->bench = bench;
+    result->ops = ops;
+    result->ns_per_op = elapsed / (double)ops;
+    result->allocs_per_op = (double)allocs / (double)ops;
+    result->arena_bytes_per_op = (double)arena_bytes / (double)ops;
+    
+    if (f.rng.cleanup) f.rng.cleanup(f.rng.state);
+    dice_context_destroy(f.ctx);
+    return status;
+}
+
+static void bench_write_json(FILE *out, const bench_result_t *results, size_t count) {
+    fprintf(out, "{\n  \"suite\": \"bench_dice\",\n  \"version\": \"%s\",\n", dice_version());
+    fprintf(out, "  \"seed\": %d,\n  \"allocations_counted\": %s,\n  \"results\": [\n",
+            BENCH_SEED,
+#ifdef BENCH_COUNT_ALLOCS
+            "true"
+#else
+            "false"
+#endif
+            );
+    for (size_t i = 0; i < count; i++) {
+        const bench_result_t *r = &results[i];
+        fprintf(out, "    {\"name\": \"%s\", \"ops\": %llu, \"ns_per_op\": %.3f, "
+                "\"allocs_per_op\": %.4f, \"arena_bytes_per_op\": %.1f}%s\n",
+                r->bench->name, r->ops, r->ns_per_op, r->allocs_per_op,
+                r->arena_bytes_per_op, i + 1 < count ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *json_path = NULL;
+    const char *filter = NULL;
+    double scale = 1.0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+            scale = atof(argv[++i]);
+            if (scale <= 0) {
+                fprintf(stderr, "Error: --scale must be positive\n");
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Usage: %s [--json FILE] [--filter TEXT] [--scale FACTOR]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    size_t case_count = sizeof(BENCH_CASES) / sizeof(BENCH_CASES[0]);
+    bench_result_t results[sizeof(BENCH_CASES) / sizeof(BENCH_CASES[0])];
+    size_t result_count = 0;
+    int status = 0;
+    
+    printf("%-26s %14s %12s %12s %14s\n", "benchmark", "ops", "ns/op", "allocs/op", "arena B/op");
+    for (size_t i = 0; i < case_count; i++) {
+        const bench_case_t *bench = &BENCH_CASES[i];
+        if (filter && !strstr(bench->name, filter)) continue;
+        
+        bench_result_t *r = &results[result_count];
+        if (bench_run(bench, scale, r) != 0) {
+            status = 1;
+            continue;
+        }
+        result_count++;
+        printf("%-26s %14llu %12.2f %12.4f %14.1f\n", bench->name, r->ops, r->ns_per_op,
+               r->allocs_per_op, r->arena_bytes_per_op);
+    }
+#ifndef BENCH_COUNT_ALLOCS
+    printf("(allocation counts are only collected on glibc builds)\n");
+#endif
+    
+    if (json_path) {
+        FILE *out = strcmp(json_path, "-") == 0 ? stdout : fopen(json_path, "w");
+        if (!out) {
+            fprintf(stderr, "Error: cannot write %s\n", json_path);
+            return 1;
+        }
+        bench_write_json(out, results, result_count);
+        if (out != stdout) fclose(out);
+    }
+    return status;
+}
@@ -116,4 +116,71 @@ public class DiceTests
         Assert.Throws<DiceException>(() => Dice.RollNotation(""));
         Assert.Throws<DiceException>(() => Dice.RollNotation(null));
     }
+
+    [Fact]
+    public void TestContextRolls()
+    {
+        using var first = new DiceContext(42);
+        using var second = new DiceContext(42);
+
+        for (int i = 0; i < 100; i++)
+        {
+            var result = first.Roll("4d6k3+2");
+            Assert.InRange(result, 5, 20);
+            Assert.Equal(result, second.Roll("4d6k3+2"));
+        }
+
+        var error = Assert.Throws<DiceException>(() => first.Roll("3d"));
+        Assert.NotEmpty(error.Message);
+        Assert.InRange(first.Roll("1d6"), 1, 6);
+    }
+
+    [Fact]
+    public void TestContextCustomDice()
+    {
+        using var context = new DiceContext(7);
+        context.RegisterDie("COIN", new long[] { 0, 1 }, new uint[] { 1, 3 });
+
+        using var expression = context.Compile("100dCOIN");
+        var rolls = expression.Evaluate(context, 200);
+        Assert.All(rolls, value => Assert.InRange(value, 0, 100));
+        Assert.InRange(rolls.Average(), 65.0, 85.0);
+
+        Assert.Throws<DiceException>(() => context.RegisterDie("BAD", new long[] { 1, 2 }, new uint[] { 1 }));
+    }
+
+    [Fact]
+    public void TestCompiledExpression()
+    {
+        using var context = new DiceContext(3);
+        using var expression = context.Compile("2d6+1d4");
+        Assert.Throws<DiceException>(() => context.Compile("2d"));
+
+        Span<long> batch = new long[1000];
+        expression.Evaluate(context, batch);
+        foreach (var value in batch)
+            Assert.InRange(value, 3, 16);
+
+        // Batches draw the same values as successive single evaluations
+        using var replay = new DiceContext(3);
+        for (int i = 0; i < batch.Length; i++)
+            Assert.Equal(batch[i], expression.Evaluate(replay));
+
+        using var failing = context.Compile("1d6/(1d2-1)");
+        Assert.Throws<DiceException>(() => failing.Evaluate(context, 1000));
+        Assert.InRange(expression.Evaluate(context), 3, 16);
+    }
+
+    [Fact]
+    public void TestContextPerThread()
+    {
+        using var compiler = new DiceContext();
+        using var expression = compiler.Compile("3d6");
+
+        Parallel.For(0, 4, seed =>
+        {
+            using var context = new DiceContext((ulong)seed + 1);
+            Assert.All(expression.Evaluate(context, 10_000), value => Assert.InRange(value, 3, 18));
+        });
+    }
 }
\ No newline at end of file
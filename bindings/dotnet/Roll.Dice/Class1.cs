@@ -22,7 +22,7 @@ public static class Dice
 
     // P/Invoke declarations
     [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
-    private static extern void dice_init(uint seed);
+    private static extern void dice_thread_seed(ulong seed);
 
     [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
     private static extern int dice_roll(int sides);
@@ -36,16 +36,22 @@ public static class Dice
     [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
     private static extern int dice_roll_notation(byte[] dice_notation);
 
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int dice_roll_batch(int sides, nuint n, ref int results);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int dice_roll_notation_batch(byte[] dice_notation, nuint n, ref long results);
+
     [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
     private static extern IntPtr dice_version();
 
     /// <summary>
-    /// Initialize the dice library with a seed
+    /// Seed the calling thread's random number generator
     /// </summary>
     /// <param name="seed">Random seed (null for time-based seed)</param>
-    public static void Init(uint? seed = null)
+    public static void Init(ulong? seed = null)
     {
-        dice_init(seed ?? 0);
+        dice_thread_seed(seed ?? 0);
     }
 
     /// <summary>
@@ -139,4 +145,39 @@ public static class Dice
 
         return result;
     }
+
+    /// <summary>
+    /// Roll one die per element of a buffer in a single native call
+    /// </summary>
+    /// <param name="sides">Number of sides on each die</param>
+    /// <param name="results">Buffer filled with values between 1 and sides (inclusive)</param>
+    /// <exception cref="DiceException">Thrown when sides &lt;= 0</exception>
+    public static void RollBatch(int sides, Span<int> results)
+    {
+        if (sides <= 0)
+            throw new DiceException($"Invalid number of sides: {sides}");
+        if (results.IsEmpty)
+            return;
+
+        if (dice_roll_batch(sides, (nuint)results.Length, ref MemoryMarshal.GetReference(results)) != 0)
+            throw new DiceException($"Invalid number of sides: {sides}");
+    }
+
+    /// <summary>
+    /// Evaluate dice notation once per element of a buffer in a single native call
+    /// </summary>
+    /// <param name="notation">Dice notation like "3d6", "4d6k3+2"</param>
+    /// <param name="results">Buffer filled with one result per element</param>
+    /// <exception cref="DiceException">Thrown when notation is invalid</exception>
+    public static void RollNotationBatch(string notation, Span<long> results)
+    {
+        if (string.IsNullOrEmpty(notation))
+            throw new DiceException("Notation cannot be null or empty");
+        if (results.IsEmpty)
+            return;
+
+        byte[] notationBytes = Encoding.UTF8.GetBytes(notation + "\0");
+        if (dice_roll_notation_batch(notationBytes, (nuint)results.Length, ref MemoryMarshal.GetReference(results)) != 0)
+            throw new DiceException($"Invalid dice notation: {notation}");
+    }
 }
@@ -0,0 +1,358 @@
+using System;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace Roll.Dice;
+
+/// <summary>
+/// P/Invoke declarations for the context-based API
+/// </summary>
+internal static class NativeContext
+{
+    private const string LibName = "dice";
+
+    internal const int FeatureAll = 0xFF;
+    internal const int TraceOff = 0;
+
+    /// <summary>
+    /// Mirrors dice_eval_result_t
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct EvalResult
+    {
+        public long Value;
+        public byte Success;
+    }
+
+    /// <summary>
+    /// Mirrors dice_rng_vtable_t; the function pointers are only handed back to C
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct RngVtable
+    {
+        public IntPtr Init;
+        public IntPtr Roll;
+        public IntPtr Rand;
+        public IntPtr Cleanup;
+        public IntPtr State;
+        public IntPtr RollN;
+        public IntPtr RandN;
+    }
+
+    /// <summary>
+    /// Mirrors dice_custom_side_t
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct CustomSide
+    {
+        public long Value;
+        public IntPtr Label;
+        public uint Weight;
+    }
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern IntPtr dice_context_create(nuint arena_size, int features);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern void dice_context_destroy(IntPtr ctx);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern int dice_context_set_rng(ContextHandle ctx, ref RngVtable rng_vtable);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern int dice_context_set_arena_growth(ContextHandle ctx, nuint chunk_size);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern int dice_context_set_trace_level(ContextHandle ctx, int level);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern nuint dice_arena_mark(ContextHandle ctx);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern void dice_arena_rewind(ContextHandle ctx, nuint mark);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern RngVtable dice_create_xoshiro_rng(ulong seed);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern IntPtr dice_parse(ContextHandle ctx, byte[] expression_str);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern int dice_optimize(ContextHandle ctx, IntPtr node);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern EvalResult dice_roll_expression(ContextHandle ctx, byte[] expression_str);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern IntPtr dice_compile(ContextHandle ctx, IntPtr node);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern EvalResult dice_program_evaluate(ContextHandle ctx, ProgramHandle program);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern int dice_program_evaluate_batch(ContextHandle ctx, ProgramHandle program,
+                                                           nuint n, ref long results);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern void dice_program_destroy(IntPtr program);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern int dice_register_custom_die(ContextHandle ctx, byte[] name,
+                                                        CustomSide[] sides, nuint side_count);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern IntPtr dice_get_error(ContextHandle ctx);
+
+    [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+    internal static extern void dice_clear_error(ContextHandle ctx);
+
+    internal static byte[] ToUtf8(string value)
+    {
+        return Encoding.UTF8.GetBytes(value + "\0"); // Add null terminator
+    }
+}
+
+/// <summary>
+/// Owns a dice_context_t and destroys it when released
+/// </summary>
+internal sealed class ContextHandle : SafeHandle
+{
+    public ContextHandle(IntPtr ctx) : base(IntPtr.Zero, true)
+    {
+        SetHandle(ctx);
+    }
+
+    public override bool IsInvalid => handle == IntPtr.Zero;
+
+    protected override bool ReleaseHandle()
+    {
+        NativeContext.dice_context_destroy(handle);
+        return true;
+    }
+}
+
+/// <summary>
+/// Owns a compiled dice_program_t and destroys it when released
+/// </summary>
+internal sealed class ProgramHandle : SafeHandle
+{
+    public ProgramHandle(IntPtr program) : base(IntPtr.Zero, true)
+    {
+        SetHandle(program);
+    }
+
+    public override bool IsInvalid => handle == IntPtr.Zero;
+
+    protected override bool ReleaseHandle()
+    {
+        NativeContext.dice_program_destroy(handle);
+        return true;
+    }
+}
+
+/// <summary>
+/// A library context with its own RNG, custom dice and memory arena
+/// </summary>
+/// <remarks>
+/// A context is not thread-safe; give each worker thread its own.
+/// </remarks>
+public sealed class DiceContext : IDisposable
+{
+    private const int ArenaSize = 64 * 1024;
+
+    internal readonly ContextHandle Handle;
+
+    /// <summary>
+    /// Create a context with a xoshiro256++ RNG
+    /// </summary>
+    /// <param name="seed">Random seed (null for time-based seed)</param>
+    /// <exception cref="DiceException">Thrown when the context cannot be created</exception>
+    public DiceContext(ulong? seed = null)
+    {
+        Handle = new ContextHandle(NativeContext.dice_context_create(ArenaSize, NativeContext.FeatureAll));
+        if (Handle.IsInvalid)
+            throw new DiceException("Failed to create dice context");
+
+        NativeContext.dice_context_set_arena_growth(Handle, ArenaSize);
+        NativeContext.dice_context_set_trace_level(Handle, NativeContext.TraceOff);
+        Seed(seed);
+    }
+
+    /// <summary>
+    /// Replace the context's RNG with a freshly seeded xoshiro256++ engine
+    /// </summary>
+    /// <param name="seed">Random seed (null for time-based seed)</param>
+    /// <exception cref="DiceException">Thrown when the RNG cannot be created</exception>
+    public void Seed(ulong? seed = null)
+    {
+        var rng = NativeContext.dice_create_xoshiro_rng(seed ?? 0);
+        if (rng.State == IntPtr.Zero || NativeContext.dice_context_set_rng(Handle, ref rng) != 0)
+            throw new DiceException("Failed to create random number generator");
+    }
+
+    /// <summary>
+    /// Parse and evaluate an expression once
+    /// </summary>
+    /// <param name="expression">Dice notation like "4d6k3+2" or "3dF"</param>
+    /// <returns>Result of the roll</returns>
+    /// <exception cref="DiceException">Thrown when the expression is invalid or fails</exception>
+    public long Roll(string expression)
+    {
+        if (string.IsNullOrEmpty(expression))
+            throw new DiceException("Expression cannot be null or empty");
+
+        nuint mark = NativeContext.dice_arena_mark(Handle);
+        var result = NativeContext.dice_roll_expression(Handle, NativeContext.ToUtf8(expression));
+        NativeContext.dice_arena_rewind(Handle, mark);
+
+        if (result.Success == 0)
+            throw TakeError($"Invalid dice notation: {expression}");
+
+        return result.Value;
+    }
+
+    /// <summary>
+    /// Parse, optimize and compile an expression for repeated evaluation
+    /// </summary>
+    /// <param name="expression">Dice notation like "4d6k3+2" or "3dF"</param>
+    /// <returns>Compiled expression, usable with any context</returns>
+    /// <exception cref="DiceException">Thrown when the expression is invalid</exception>
+    public CompiledExpression Compile(string expression)
+    {
+        if (string.IsNullOrEmpty(expression))
+            throw new DiceException("Expression cannot be null or empty");
+
+        nuint mark = NativeContext.dice_arena_mark(Handle);
+        IntPtr ast = NativeContext.dice_parse(Handle, NativeContext.ToUtf8(expression));
+        IntPtr program = IntPtr.Zero;
+        if (ast != IntPtr.Zero && NativeContext.dice_optimize(Handle, ast) == 0)
+            program = NativeContext.dice_compile(Handle, ast);
+
+        // The program does not reference the AST, so the parse scratch is reclaimed
+        NativeContext.dice_arena_rewind(Handle, mark);
+
+        if (program == IntPtr.Zero)
+            throw TakeError($"Invalid dice notation: {expression}");
+
+        return new CompiledExpression(new ProgramHandle(program));
+    }
+
+    /// <summary>
+    /// Register a named custom die, replacing any die of the same name
+    /// </summary>
+    /// <param name="name">Die name used in notation (e.g. "DMG" for "2dDMG")</param>
+    /// <param name="values">Side values</param>
+    /// <param name="weights">Optional relative weight per side (0 is treated as 1)</param>
+    /// <exception cref="DiceException">Thrown when the die definition is invalid</exception>
+    public void RegisterDie(string name, ReadOnlySpan<long> values, ReadOnlySpan<uint> weights = default)
+    {
+        if (string.IsNullOrEmpty(name))
+            throw new DiceException("Die name cannot be null or empty");
+        if (!weights.IsEmpty && weights.Length != values.Length)
+            throw new DiceException("Weights must match the number of sides");
+
+        var sides = new NativeContext.CustomSide[values.Length];
+        for (int i = 0; i < values.Length; i++)
+        {
+            sides[i].Value = values[i];
+            sides[i].Weight = weights.IsEmpty ? 1 : weights[i];
+        }
+
+        if (NativeContext.dice_register_custom_die(Handle, NativeContext.ToUtf8(name), sides, (nuint)sides.Length) != 0)
+            throw TakeError($"Invalid custom die: {name}");
+    }
+
+    /// <summary>
+    /// Move the context's error message into an exception and clear it
+    /// </summary>
+    internal DiceException TakeError(string fallback)
+    {
+        string? message = Marshal.PtrToStringUTF8(NativeContext.dice_get_error(Handle));
+        NativeContext.dice_clear_error(Handle);
+        return new DiceException(string.IsNullOrEmpty(message) ? fallback : message);
+    }
+
+    /// <summary>
+    /// Destroy the native context
+    /// </summary>
+    public void Dispose()
+    {
+        Handle.Dispose();
+    }
+}
+
+/// <summary>
+/// An expression parsed and compiled once for repeated evaluation
+/// </summary>
+/// <remarks>
+/// The compiled program is immutable and independent of the context that compiled it,
+/// so one expression may be evaluated concurrently by threads that each own a context.
+/// </remarks>
+public sealed class CompiledExpression : IDisposable
+{
+    private readonly ProgramHandle _handle;
+
+    internal CompiledExpression(ProgramHandle handle)
+    {
+        _handle = handle;
+    }
+
+    /// <summary>
+    /// Evaluate the expression once with the context's RNG
+    /// </summary>
+    /// <param name="context">Context supplying the RNG and custom dice</param>
+    /// <returns>Result of the roll</returns>
+    /// <exception cref="DiceException">Thrown when evaluation fails</exception>
+    public long Evaluate(DiceContext context)
+    {
+        nuint mark = NativeContext.dice_arena_mark(context.Handle);
+        var result = NativeContext.dice_program_evaluate(context.Handle, _handle);
+        NativeContext.dice_arena_rewind(context.Handle, mark);
+
+        if (result.Success == 0)
+            throw context.TakeError("Evaluation failed");
+
+        return result.Value;
+    }
+
+    /// <summary>
+    /// Evaluate the expression once per element of a buffer in a single native call
+    /// </summary>
+    /// <param name="context">Context supplying the RNG and custom dice</param>
+    /// <param name="results">Buffer filled with one result per element</param>
+    /// <exception cref="DiceException">Thrown when a sample fails</exception>
+    public void Evaluate(DiceContext context, Span<long> results)
+    {
+        if (results.IsEmpty)
+            return;
+
+        if (NativeContext.dice_program_evaluate_batch(context.Handle, _handle, (nuint)results.Length,
+                                                      ref MemoryMarshal.GetReference(results)) != 0)
+            throw context.TakeError("Evaluation failed");
+    }
+
+    /// <summary>
+    /// Evaluate the expression a number of times into a new array
+    /// </summary>
+    /// <param name="context">Context supplying the RNG and custom dice</param>
+    /// <param name="count">Number of samples</param>
+    /// <returns>Array of results</returns>
+    /// <exception cref="DiceException">Thrown when count &lt; 0 or a sample fails</exception>
+    public long[] Evaluate(DiceContext context, int count)
+    {
+        if (count < 0)
+            throw new DiceException($"Invalid count: {count}");
+
+        var results = new long[count];
+        Evaluate(context, results);
+        return results;
+    }
+
+    /// <summary>
+    /// Free the compiled program
+    /// </summary>
+    public void Dispose()
+    {
+        _handle.Dispose();
+    }
+}
@@ -136,15 +136,11 @@ class Dice {
      * @returns {{sum: number, individual: number[]}} Object with sum and individual results
      */
     rollIndividual(count, sides) {
-        // For individual results, we need to roll them one by one
-        const individual = [];
-        let sum = 0;
-        
-        for (let i = 0; i < count; i++) {
-            const result = this.roll(sides);
-            individual.push(result);
-            sum += result;
-        }
+        // One CLI invocation rolls every die; a process per die would also
+        // repeat the same value whenever a seed is set
+        const rolls = this.rollNotation(`1d${sides}`, count);
+        const individual = Array.isArray(rolls) ? rolls : [rolls];
+        const sum = individual.reduce((total, result) => total + result, 0);
         
         return { sum, individual };
     }
@@ -2,11 +2,17 @@
 Python bindings for the Roll dice library using ctypes.
 """
 
+import array
 import ctypes
 import os
 from pathlib import Path
 from typing import List, Optional
 
+try:
+    import numpy as _np
+except ImportError:  # NumPy is optional; array.array is used without it
+    _np = None
+
 # Find the shared library
 def _find_library():
     """Find the dice shared library"""
@@ -33,8 +39,8 @@ _lib_path = _find_library()
 _lib = ctypes.CDLL(_lib_path)
 
 # Define function signatures
-_lib.dice_init.argtypes = [ctypes.c_uint32]
-_lib.dice_init.restype = None
+_lib.dice_thread_seed.argtypes = [ctypes.c_uint64]
+_lib.dice_thread_seed.restype = None
 
 _lib.dice_roll.argtypes = [ctypes.c_int]
 _lib.dice_roll.restype = ctypes.c_int
@@ -48,6 +54,12 @@ _lib.dice_roll_individual.restype = ctypes.c_int
 _lib.dice_roll_notation.argtypes = [ctypes.c_char_p]
 _lib.dice_roll_notation.restype = ctypes.c_int
 
+_lib.dice_roll_batch.argtypes = [ctypes.c_int, ctypes.c_size_t, ctypes.c_void_p]
+_lib.dice_roll_batch.restype = ctypes.c_int
+
+_lib.dice_roll_notation_batch.argtypes = [ctypes.c_char_p, ctypes.c_size_t, ctypes.c_void_p]
+_lib.dice_roll_notation_batch.restype = ctypes.c_int
+
 _lib.dice_version.argtypes = []
 _lib.dice_version.restype = ctypes.c_char_p
 
@@ -55,6 +67,27 @@ class DiceError(Exception):
     """Exception raised for dice library errors"""
     pass
 
+def _new_buffer(count: int, typecode: str, dtype: str):
+    """Allocate a result buffer: a NumPy array when available, else array.array"""
+    if _np is not None:
+        return _np.empty(count, dtype=dtype)
+    return array.array(typecode, bytes(count * array.array(typecode).itemsize))
+
+def _buffer_address(out, count: int, itemsize: int):
+    """Address of a writable, C-contiguous buffer holding at least count items
+    
+    Any object implementing the buffer protocol works (NumPy arrays,
+    array.array, bytearray, memoryview); nothing is copied.
+    """
+    view = memoryview(out)
+    if view.readonly or not view.c_contiguous:
+        raise DiceError("Output buffer must be writable and C-contiguous")
+    if view.itemsize != itemsize or view.nbytes < count * itemsize:
+        raise DiceError(f"Output buffer must hold {count} items of {itemsize} bytes")
+    if count == 0:
+        return None
+    return ctypes.addressof(ctypes.c_char.from_buffer(view.cast('B')))
+
 class Dice:
     """Python interface to the Roll dice library"""
     
@@ -66,7 +99,7 @@ class Dice:
         """
         if seed is None:
             seed = 0
-        _lib.dice_init(ctypes.c_uint32(seed))
+        _lib.dice_thread_seed(ctypes.c_uint64(seed))
     
     @staticmethod
     def version() -> str:
@@ -163,6 +196,56 @@ class Dice:
             raise DiceError(f"Invalid dice notation: {notation}")
         return result
 
+    @staticmethod
+    def roll_batch(sides: int, count: int, out=None):
+        """Roll count individual dice into a buffer with a single library call
+        
+        Args:
+            sides: Number of sides on each die
+            count: Number of dice to roll
+            out: Optional writable int32 buffer (NumPy array, array.array('i'), ...)
+            
+        Returns:
+            The filled buffer (a new NumPy int32 array or array.array if out is None)
+            
+        Raises:
+            DiceError: If sides <= 0 or the buffer is unsuitable
+        """
+        if sides <= 0 or count < 0:
+            raise DiceError(f"Invalid parameters: count={count}, sides={sides}")
+        if out is None:
+            out = _new_buffer(count, 'i', 'int32')
+        
+        address = _buffer_address(out, count, ctypes.sizeof(ctypes.c_int))
+        if _lib.dice_roll_batch(ctypes.c_int(sides), ctypes.c_size_t(count), address) != 0:
+            raise DiceError(f"Invalid parameters: count={count}, sides={sides}")
+        return out
+    
+    @staticmethod
+    def roll_notation_batch(notation: str, count: int, out=None):
+        """Evaluate dice notation count times into a buffer with a single library call
+        
+        Args:
+            notation: Dice notation like "3d6", "4d6k3+2"
+            count: Number of results to produce
+            out: Optional writable int64 buffer (NumPy array, array.array('q'), ...)
+            
+        Returns:
+            The filled buffer (a new NumPy int64 array or array.array if out is None)
+            
+        Raises:
+            DiceError: If notation is invalid or the buffer is unsuitable
+        """
+        if count < 0:
+            raise DiceError(f"Invalid count: {count}")
+        if out is None:
+            out = _new_buffer(count, 'q', 'int64')
+        
+        address = _buffer_address(out, count, ctypes.sizeof(ctypes.c_int64))
+        if _lib.dice_roll_notation_batch(notation.encode('utf-8'), ctypes.c_size_t(count), address) != 0:
+            raise DiceError(f"Invalid dice notation: {notation}")
+        return out
+
 # Convenience functions
 def init(seed: Optional[int] = None):
     """Initialize the dice library"""
@@ -186,4 +269,12 @@ def roll_individual(count: int, sides: int) -> tuple[int, List[int]]:
 
 def roll_notation(notation: str) -> int:
     """Roll dice using RPG notation"""
-    return Dice.roll_notation(notation)
\ No newline at end of file
+    return Dice.roll_notation(notation)
+
+def roll_batch(sides: int, count: int, out=None):
+    """Roll count individual dice into a buffer"""
+    return Dice.roll_batch(sides, count, out)
+
+def roll_notation_batch(notation: str, count: int, out=None):
+    """Evaluate dice notation count times into a buffer"""
+    return Dice.roll_notation_batch(notation, count, out)
\ No newline at end of file
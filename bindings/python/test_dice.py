@@ -132,6 +132,38 @@ def test_class_interface():
     result = d.roll_notation("2d6+3")
     assert 5 <= result <= 15
 
+def test_batch_rolls():
+    """Test bulk rolls into caller-owned buffers"""
+    import array
+    
+    dice.init(12345)
+    values = dice.roll_batch(6, 100000)
+    assert len(values) == 100000
+    assert all(1 <= v <= 6 for v in values)
+    
+    # Caller-owned buffers are filled in place
+    out = array.array('q', bytes(8 * 1000))
+    assert dice.roll_notation_batch("4d6k3+2", 1000, out) is out
+    assert all(5 <= v <= 20 for v in out)
+    
+    # Reseeding repeats the stream
+    dice.init(99)
+    first = list(dice.roll_notation_batch("3d6", 500))
+    dice.init(99)
+    assert list(dice.roll_notation_batch("3d6", 500)) == first
+    
+    try:
+        dice.roll_notation_batch("3d", 10)
+        assert False, "Expected DiceError"
+    except dice.DiceError:
+        pass
+    
+    try:
+        dice.roll_notation_batch("1d6", 10, array.array('i', bytes(40)))
+        assert False, "Expected DiceError for a 32-bit buffer"
+    except dice.DiceError:
+        pass
+
 if __name__ == "__main__":
     print("Running Python dice library tests...")
     
@@ -142,5 +174,6 @@ if __name__ == "__main__":
     test_individual_rolls()
     test_notation_rolls()
     test_class_interface()
+    test_batch_rolls()
     
     print("All Python tests passed!")
\ No newline at end of file
@@ -2,20 +2,91 @@
 //! 
 //! This library provides safe Rust bindings for the universal dice rolling library.
 
-use libc::{c_char, c_int, c_uint};
+use libc::{c_char, c_int, c_void, size_t};
 use std::ffi::{CStr, CString};
 use std::fmt;
+use std::ptr::{self, NonNull};
 
 // External C functions
 extern "C" {
-    fn dice_init(seed: c_uint);
+    fn dice_thread_seed(seed: u64);
     fn dice_roll(sides: c_int) -> c_int;
     fn dice_roll_multiple(count: c_int, sides: c_int) -> c_int;
     fn dice_roll_individual(count: c_int, sides: c_int, results: *mut c_int) -> c_int;
     fn dice_roll_notation(dice_notation: *const c_char) -> c_int;
+    fn dice_roll_batch(sides: c_int, n: size_t, out: *mut c_int) -> c_int;
+    fn dice_roll_notation_batch(dice_notation: *const c_char, n: size_t, out: *mut i64) -> c_int;
     fn dice_version() -> *const c_char;
 }
 
+// Context API types; only pointers to the opaque ones cross the boundary
+#[repr(C)]
+struct RawContext {
+    _private: [u8; 0],
+}
+
+#[repr(C)]
+struct RawAstNode {
+    _private: [u8; 0],
+}
+
+#[repr(C)]
+struct RawProgram {
+    _private: [u8; 0],
+}
+
+// Mirrors dice_rng_vtable_t; the function pointers are only handed back to C
+#[repr(C)]
+struct RawRng {
+    init: *const c_void,
+    roll: *const c_void,
+    rand: *const c_void,
+    cleanup: *const c_void,
+    state: *mut c_void,
+    roll_n: *const c_void,
+    rand_n: *const c_void,
+}
+
+#[repr(C)]
+struct RawEvalResult {
+    value: i64,
+    success: bool,
+}
+
+#[repr(C)]
+struct RawCustomSide {
+    value: i64,
+    label: *const c_char,
+    weight: u32,
+}
+
+const DICE_FEATURE_ALL: c_int = 0xFF;
+const DICE_TRACE_OFF: c_int = 0;
+const CONTEXT_ARENA_SIZE: size_t = 64 * 1024;
+
+extern "C" {
+    fn dice_context_create(arena_size: size_t, features: c_int) -> *mut RawContext;
+    fn dice_context_destroy(ctx: *mut RawContext);
+    fn dice_context_set_rng(ctx: *mut RawContext, rng_vtable: *const RawRng) -> c_int;
+    fn dice_context_set_arena_growth(ctx: *mut RawContext, chunk_size: size_t) -> c_int;
+    fn dice_context_set_trace_level(ctx: *mut RawContext, level: c_int) -> c_int;
+    fn dice_arena_mark(ctx: *const RawContext) -> size_t;
+    fn dice_arena_rewind(ctx: *mut RawContext, mark: size_t);
+    fn dice_create_xoshiro_rng(seed: u64) -> RawRng;
+    fn dice_parse(ctx: *mut RawContext, expression_str: *const c_char) -> *mut RawAstNode;
+    fn dice_optimize(ctx: *mut RawContext, node: *mut RawAstNode) -> c_int;
+    fn dice_roll_expression(ctx: *mut RawContext, expression_str: *const c_char) -> RawEvalResult;
+    fn dice_compile(ctx: *mut RawContext, node: *const RawAstNode) -> *mut RawProgram;
+    fn dice_program_evaluate(ctx: *mut RawContext, program: *const RawProgram) -> RawEvalResult;
+    fn dice_program_evaluate_batch(ctx: *mut RawContext, program: *const RawProgram,
+                                   n: size_t, out: *mut i64) -> c_int;
+    fn dice_program_destroy(program: *mut RawProgram);
+    fn dice_register_custom_die(ctx: *mut RawContext, name: *const c_char,
+                                sides: *const RawCustomSide, side_count: size_t) -> c_int;
+    fn dice_get_error(ctx: *const RawContext) -> *const c_char;
+    fn dice_clear_error(ctx: *mut RawContext);
+}
+
 /// Error type for dice operations
 #[derive(Debug, Clone, PartialEq)]
 pub enum DiceError {
@@ -23,6 +94,7 @@ pub enum DiceError {
     InvalidCount(i32),
     InvalidNotation(String),
     NullPointer,
+    Library(String),
 }
 
 impl fmt::Display for DiceError {
@@ -32,6 +104,7 @@ impl fmt::Display for DiceError {
             DiceError::InvalidCount(count) => write!(f, "Invalid count: {}", count),
             DiceError::InvalidNotation(notation) => write!(f, "Invalid dice notation: {}", notation),
             DiceError::NullPointer => write!(f, "Null pointer error"),
+            DiceError::Library(message) => write!(f, "{}", message),
         }
     }
 }
@@ -50,9 +123,9 @@ impl Dice {
     /// # Arguments
     /// 
     /// * `seed` - Random seed (None for time-based seed)
-    pub fn init(seed: Option<u32>) {
+    pub fn init(seed: Option<u64>) {
         unsafe {
-            dice_init(seed.unwrap_or(0));
+            dice_thread_seed(seed.unwrap_or(0));
         }
     }
     
@@ -181,10 +254,247 @@ impl Dice {
             }
         }
     }
+    
+    /// Roll one die per element of `out` in a single library call
+    /// 
+    /// # Arguments
+    /// 
+    /// * `sides` - Number of sides on each die
+    /// * `out` - Buffer filled with values between 1 and sides (inclusive)
+    pub fn roll_into(sides: i32, out: &mut [i32]) -> DiceResult<()> {
+        if sides <= 0 {
+            return Err(DiceError::InvalidSides(sides));
+        }
+        
+        unsafe {
+            if dice_roll_batch(sides, out.len(), out.as_mut_ptr()) != 0 {
+                return Err(DiceError::InvalidSides(sides));
+            }
+        }
+        Ok(())
+    }
+    
+    /// Evaluate dice notation once per element of `out` in a single library call
+    /// 
+    /// # Arguments
+    /// 
+    /// * `notation` - Dice notation like "3d6", "4d6k3+2"
+    /// * `out` - Buffer filled with one result per element
+    pub fn roll_notation_into(notation: &str, out: &mut [i64]) -> DiceResult<()> {
+        let c_notation = CString::new(notation)
+            .map_err(|_| DiceError::InvalidNotation(notation.to_string()))?;
+        
+        unsafe {
+            if dice_roll_notation_batch(c_notation.as_ptr(), out.len(), out.as_mut_ptr()) != 0 {
+                return Err(DiceError::InvalidNotation(notation.to_string()));
+            }
+        }
+        Ok(())
+    }
+}
+
+/// A library context with its own RNG, custom dice and memory arena
+/// 
+/// Each context is used by one thread at a time; move one into every worker
+/// thread rather than sharing it.
+pub struct Context {
+    raw: NonNull<RawContext>,
+}
+
+// The context owns all of its state and the C library keeps no reference to
+// it, so it may move between threads; it is not Sync because every call mutates it
+unsafe impl Send for Context {}
+
+impl Context {
+    /// Create a context with a time-seeded xoshiro256++ RNG
+    pub fn new() -> DiceResult<Self> {
+        Self::with_seed(0)
+    }
+    
+    /// Create a context whose RNG is seeded for reproducible results
+    /// 
+    /// # Arguments
+    /// 
+    /// * `seed` - Random seed (0 for time-based seed)
+    pub fn with_seed(seed: u64) -> DiceResult<Self> {
+        let raw = unsafe { dice_context_create(CONTEXT_ARENA_SIZE, DICE_FEATURE_ALL) };
+        let mut context = Context {
+            raw: NonNull::new(raw).ok_or(DiceError::NullPointer)?,
+        };
+        
+        unsafe {
+            dice_context_set_arena_growth(context.raw.as_ptr(), CONTEXT_ARENA_SIZE);
+            dice_context_set_trace_level(context.raw.as_ptr(), DICE_TRACE_OFF);
+        }
+        context.seed(seed)?;
+        Ok(context)
+    }
+    
+    /// Replace the context's RNG with a freshly seeded xoshiro256++ engine
+    /// 
+    /// # Arguments
+    /// 
+    /// * `seed` - Random seed (0 for time-based seed)
+    pub fn seed(&mut self, seed: u64) -> DiceResult<()> {
+        unsafe {
+            let rng = dice_create_xoshiro_rng(seed);
+            if rng.state.is_null() || dice_context_set_rng(self.raw.as_ptr(), &rng) != 0 {
+                return Err(DiceError::NullPointer);
+            }
+        }
+        Ok(())
+    }
+    
+    /// Parse and evaluate an expression once
+    /// 
+    /// # Arguments
+    /// 
+    /// * `expression` - Dice notation like "4d6k3+2" or "3dF"
+    pub fn roll(&mut self, expression: &str) -> DiceResult<i64> {
+        let c_expression = CString::new(expression)
+            .map_err(|_| DiceError::InvalidNotation(expression.to_string()))?;
+        
+        unsafe {
+            let mark = dice_arena_mark(self.raw.as_ptr());
+            let result = dice_roll_expression(self.raw.as_ptr(), c_expression.as_ptr());
+            dice_arena_rewind(self.raw.as_ptr(), mark);
+            if result.success {
+                Ok(result.value)
+            } else {
+                Err(self.take_error(expression))
+            }
+        }
+    }
+    
+    /// Parse, optimize and compile an expression for repeated evaluation
+    /// 
+    /// # Arguments
+    /// 
+    /// * `expression` - Dice notation like "4d6k3+2" or "3dF"
+    pub fn compile(&mut self, expression: &str) -> DiceResult<CompiledExpression> {
+        let c_expression = CString::new(expression)
+            .map_err(|_| DiceError::InvalidNotation(expression.to_string()))?;
+        
+        unsafe {
+            let ctx = self.raw.as_ptr();
+            let mark = dice_arena_mark(ctx);
+            let ast = dice_parse(ctx, c_expression.as_ptr());
+            let program = if !ast.is_null() && dice_optimize(ctx, ast) == 0 {
+                dice_compile(ctx, ast)
+            } else {
+                ptr::null_mut()
+            };
+            // The program does not reference the AST, so the parse scratch is reclaimed
+            dice_arena_rewind(ctx, mark);
+            
+            match NonNull::new(program) {
+                Some(raw) => Ok(CompiledExpression { raw }),
+                None => Err(self.take_error(expression)),
+            }
+        }
+    }
+    
+    /// Register a named custom die, replacing any die of the same name
+    /// 
+    /// # Arguments
+    /// 
+    /// * `name` - Die name used in notation (e.g. "DMG" for "2dDMG")
+    /// * `sides` - `(value, weight)` per side; a weight of 0 is treated as 1
+    pub fn register_die(&mut self, name: &str, sides: &[(i64, u32)]) -> DiceResult<()> {
+        let c_name = CString::new(name)
+            .map_err(|_| DiceError::InvalidNotation(name.to_string()))?;
+        let raw_sides: Vec<RawCustomSide> = sides
+            .iter()
+            .map(|&(value, weight)| RawCustomSide { value, label: ptr::null(), weight })
+            .collect();
+        
+        unsafe {
+            if dice_register_custom_die(self.raw.as_ptr(), c_name.as_ptr(),
+                                        raw_sides.as_ptr(), raw_sides.len()) != 0 {
+                return Err(self.take_error(name));
+            }
+        }
+        Ok(())
+    }
+    
+    // Move the context's error message into a DiceError and clear it
+    unsafe fn take_error(&mut self, what: &str) -> DiceError {
+        let message = dice_get_error(self.raw.as_ptr());
+        let error = if message.is_null() || *message == 0 {
+            DiceError::InvalidNotation(what.to_string())
+        } else {
+            DiceError::Library(CStr::from_ptr(message).to_string_lossy().into_owned())
+        };
+        dice_clear_error(self.raw.as_ptr());
+        error
+    }
+}
+
+impl Drop for Context {
+    fn drop(&mut self) {
+        unsafe {
+            dice_context_destroy(self.raw.as_ptr());
+        }
+    }
+}
+
+/// An expression parsed and compiled once for repeated evaluation
+/// 
+/// The compiled program is immutable and independent of the context that
+/// compiled it, so one expression can be shared by threads that each
+/// evaluate it with their own `Context`.
+pub struct CompiledExpression {
+    raw: NonNull<RawProgram>,
+}
+
+unsafe impl Send for CompiledExpression {}
+unsafe impl Sync for CompiledExpression {}
+
+impl CompiledExpression {
+    /// Evaluate the expression once with the context's RNG
+    pub fn evaluate(&self, context: &mut Context) -> DiceResult<i64> {
+        unsafe {
+            let ctx = context.raw.as_ptr();
+            let mark = dice_arena_mark(ctx);
+            let result = dice_program_evaluate(ctx, self.raw.as_ptr());
+            dice_arena_rewind(ctx, mark);
+            if result.success {
+                Ok(result.value)
+            } else {
+                Err(context.take_error("compiled expression"))
+            }
+        }
+    }
+    
+    /// Evaluate the expression once per element of `out` in a single library call
+    pub fn evaluate_into(&self, context: &mut Context, out: &mut [i64]) -> DiceResult<()> {
+        unsafe {
+            if dice_program_evaluate_batch(context.raw.as_ptr(), self.raw.as_ptr(),
+                                           out.len(), out.as_mut_ptr()) != 0 {
+                return Err(context.take_error("compiled expression"));
+            }
+        }
+        Ok(())
+    }
+    
+    /// Evaluate the expression `n` times into a new vector
+    pub fn evaluate_n(&self, context: &mut Context, n: usize) -> DiceResult<Vec<i64>> {
+        let mut results = vec![0i64; n];
+        self.evaluate_into(context, &mut results)?;
+        Ok(results)
+    }
+}
+
+impl Drop for CompiledExpression {
+    fn drop(&mut self) {
+        unsafe {
+            dice_program_destroy(self.raw.as_ptr());
+        }
+    }
 }
 
 /// Convenience functions
-pub fn init(seed: Option<u32>) {
+pub fn init(seed: Option<u64>) {
     Dice::init(seed);
 }
 
@@ -208,6 +518,14 @@ pub fn roll_notation(notation: &str) -> DiceResult<i32> {
     Dice::roll_notation(notation)
 }
 
+pub fn roll_into(sides: i32, out: &mut [i32]) -> DiceResult<()> {
+    Dice::roll_into(sides, out)
+}
+
+pub fn roll_notation_into(notation: &str, out: &mut [i64]) -> DiceResult<()> {
+    Dice::roll_notation_into(notation, out)
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -300,4 +618,90 @@ mod tests {
         // Test invalid notation
         assert!(Dice::roll_notation("invalid").is_err());
     }
+
+    #[test]
+    fn test_batch_rolls() {
+        let mut dice = vec![0i32; 100_000];
+        Dice::roll_into(6, &mut dice).unwrap();
+        assert!(dice.iter().all(|&roll| roll >= 1 && roll <= 6));
+        assert!(Dice::roll_into(0, &mut dice).is_err());
+        
+        // The engine is per thread, so seeding and rolling share this test's thread
+        let mut first = vec![0i64; 1000];
+        let mut second = vec![0i64; 1000];
+        Dice::init(Some(99));
+        Dice::roll_notation_into("4d6k3+2", &mut first).unwrap();
+        Dice::init(Some(99));
+        Dice::roll_notation_into("4d6k3+2", &mut second).unwrap();
+        assert_eq!(first, second);
+        assert!(first.iter().all(|&value| value >= 5 && value <= 20));
+        
+        assert!(Dice::roll_notation_into("3d", &mut first).is_err());
+        Dice::roll_notation_into("1d6", &mut []).unwrap();
+    }
+
+    #[test]
+    fn test_context_rolls() {
+        let mut first = Context::with_seed(42).unwrap();
+        let mut second = Context::with_seed(42).unwrap();
+        for _ in 0..100 {
+            let value = first.roll("4d6k3+2").unwrap();
+            assert!(value >= 5 && value <= 20);
+            assert_eq!(value, second.roll("4d6k3+2").unwrap());
+        }
+        
+        match first.roll("3d") {
+            Err(DiceError::Library(message)) => assert!(!message.is_empty()),
+            other => panic!("expected a library error, got {:?}", other),
+        }
+        assert!(first.roll("1d6").is_ok());
+    }
+    
+    #[test]
+    fn test_context_custom_dice() {
+        let mut context = Context::with_seed(7).unwrap();
+        context.register_die("COIN", &[(0, 1), (1, 3)]).unwrap();
+        
+        let rolls = context.compile("100dCOIN").unwrap().evaluate_n(&mut context, 200).unwrap();
+        assert!(rolls.iter().all(|&value| value >= 0 && value <= 100));
+        let mean = rolls.iter().sum::<i64>() as f64 / rolls.len() as f64;
+        assert!(mean > 65.0 && mean < 85.0);
+    }
+    
+    #[test]
+    fn test_compiled_expression() {
+        let mut context = Context::with_seed(3).unwrap();
+        let expression = context.compile("2d6+1d4").unwrap();
+        assert!(context.compile("2d").is_err());
+        
+        let mut batch = vec![0i64; 1000];
+        expression.evaluate_into(&mut context, &mut batch).unwrap();
+        assert!(batch.iter().all(|&value| value >= 3 && value <= 16));
+        
+        // Batches draw the same values as successive single evaluations
+        let mut replay = Context::with_seed(3).unwrap();
+        let single: Vec<i64> = (0..1000).map(|_| expression.evaluate(&mut replay).unwrap()).collect();
+        assert_eq!(batch, single);
+        
+        let failing = context.compile("1d6/(1d2-1)").unwrap();
+        assert!(failing.evaluate_n(&mut context, 1000).is_err());
+        assert!(expression.evaluate(&mut context).is_ok());
+    }
+    
+    #[test]
+    fn test_context_per_thread() {
+        let expression = std::sync::Arc::new(Context::new().unwrap().compile("3d6").unwrap());
+        let workers: Vec<_> = (0..4u64)
+            .map(|seed| {
+                let expression = expression.clone();
+                let mut context = Context::with_seed(seed + 1).unwrap();
+                std::thread::spawn(move || expression.evaluate_n(&mut context, 10_000).unwrap())
+            })
+            .collect();
+        
+        for worker in workers {
+            let rolls = worker.join().unwrap();
+            assert!(rolls.iter().all(|&value| value >= 3 && value <= 18));
+        }
+    }
 }
\ No newline at end of file
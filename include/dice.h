@@ -18,6 +18,12 @@ typedef struct dice_policy dice_policy_t;
 typedef struct dice_trace dice_trace_t;
 typedef struct dice_error_buffer dice_error_buffer_t;
 typedef struct dice_ast_visitor dice_ast_visitor_t;
+typedef struct dice_program dice_program_t;
+typedef struct dice_program_set dice_program_set_t;
+typedef struct dice_parse_cache dice_parse_cache_t;
+typedef struct dice_arena_chunk dice_arena_chunk_t;
+typedef struct dice_stats dice_stats_t;
+typedef struct dice_context_template dice_context_template_t;
 
 // =============================================================================
 // Core Types
@@ -80,8 +86,21 @@ typedef enum {
 typedef struct dice_custom_side {
     int64_t value;          // Numeric value for calculations
     const char *label;      // String label (optional, can be NULL)
+    uint32_t weight;        // Relative likelihood (0 is treated as 1)
 } dice_custom_side_t;
 
+/**
+ * @brief Alias-method table entry for a weighted custom die
+ *
+ * A roll draws a column i in [0, side_count) and a threshold t in
+ * [0, total_weight); side i is kept when t < keep, otherwise its alias is taken.
+ */
+typedef struct dice_alias_entry {
+    uint64_t keep;          // Threshold in [0, total_weight]
+    uint32_t alias;         // Side index taken above the threshold
+    uint32_t reserved;
+} dice_alias_entry_t;
+
 /**
  * @brief Custom die definition
  */
@@ -89,6 +108,8 @@ typedef struct dice_custom_die {
     const char *name;              // Die name (for named dice like "F", "HQ", etc.)
     dice_custom_side_t *sides;     // Array of side definitions
     size_t side_count;             // Number of sides
+    uint64_t total_weight;         // Sum of side weights; 0 when all sides are equally likely
+    dice_alias_entry_t *alias;     // One entry per side when weighted, otherwise NULL
 } dice_custom_die_t;
 
 /**
@@ -98,6 +119,9 @@ typedef struct dice_custom_die_registry {
     dice_custom_die_t *dice;    // Array of custom dice definitions
     size_t count;               // Number of registered dice
     size_t capacity;            // Maximum capacity
+    uint32_t *index;            // Open-addressed name hash index (die index + 1, 0 = empty)
+    size_t index_capacity;      // Number of index slots (power of two)
+    uint64_t generation;        // Changes on every registration or clear; never reused
 } dice_custom_die_registry_t;
 
 /**
@@ -137,11 +161,16 @@ struct dice_ast_node {
             dice_ast_node_t *count;      // number of dice (can be expression)
             dice_ast_node_t *sides;      // sides per die (can be expression, or NULL for custom)
             dice_ast_node_t *modifier;   // keep/drop count, explosion threshold, etc.
+            bool compounding;            // NdS!! adds each die's explosions into one value
             // Dice selection support (unified keep/drop)
             dice_selection_t *selection; // Selection parameters (NULL for non-select operations)
             // Custom dice support
             const char *custom_name;     // Name for named custom dice (e.g., "F", "HQ")
             dice_custom_die_t *custom_die; // Inline custom die definition
+            // Registry binding of custom_name, valid while the registry
+            // generation still equals bound_generation
+            const dice_custom_die_t *bound_die;
+            uint64_t bound_generation;
         } dice_op;
         
         struct {
@@ -197,6 +226,14 @@ struct dice_rng_vtable {
     
     // RNG state data
     void *state;
+    
+    // Optional bulk variants (NULL falls back to looping over roll/rand).
+    // Must produce the same values as n successive single calls.
+    // Fill out[0..n-1] with values in [1, sides]; 0 on success, -1 on error
+    int (*roll_n)(void *state, int sides, int *out, size_t n);
+    
+    // Fill out[0..n-1] with values in [0, max-1]; 0 on success, -1 on error
+    int (*rand_n)(void *state, uint64_t max, uint64_t *out, size_t n);
 };
 
 /**
@@ -239,6 +276,24 @@ typedef struct dice_trace_entry {
     struct dice_trace_entry *next;
 } dice_trace_entry_t;
 
+/**
+ * @brief How much a context records about each roll
+ */
+typedef enum {
+    DICE_TRACE_OFF,      // Record nothing
+    DICE_TRACE_SUMMARY,  // Aggregate counters only
+    DICE_TRACE_FULL      // Counters plus one entry per die (default)
+} dice_trace_level_t;
+
+/**
+ * @brief Aggregate roll counters, kept at DICE_TRACE_SUMMARY and above
+ */
+typedef struct {
+    uint64_t dice_rolled;  // Dice rolled, including rerolls
+    uint64_t rerolls;      // Dice rolled again by reroll operations
+    uint64_t dropped;      // Dice rolled but not counted by keep/drop/success filters
+} dice_trace_summary_t;
+
 /**
  * @brief Structured trace log
  */
@@ -246,8 +301,57 @@ struct dice_trace {
     dice_trace_entry_t *first;
     dice_trace_entry_t *last;
     size_t count;
+    dice_trace_summary_t summary;
 };
 
+/**
+ * @brief One die decoded from a packed trace (see dice_trace_decode)
+ */
+typedef struct {
+    int sides;
+    int result;
+    bool selected;
+} dice_trace_roll_t;
+
+/**
+ * @brief Receiver for packed trace bytes (see dice_context_set_trace_sink)
+ * @param user_data Pointer given to dice_context_set_trace_sink
+ * @param data Whole packed records, in rolling order
+ * @param length Number of bytes in data
+ * @return 0 on success; nonzero keeps the bytes pending and fails the
+ *         evaluation in progress
+ */
+typedef int (*dice_trace_sink_fn)(void *user_data, const uint8_t *data, size_t length);
+
+/**
+ * @brief One dice operation recorded by dice_evaluate_ex()
+ */
+typedef struct {
+    int sides;          // Sides per die (custom dice: number of sides)
+    size_t first;       // Index of the operation's first die in the die arrays
+    size_t count;       // Dice recorded for the operation, explosion dice included
+} dice_results_op_t;
+
+/**
+ * @brief Caller-provided struct-of-arrays buffer for dice_evaluate_ex()
+ *
+ * The caller owns every array and sets the capacities; evaluation writes the
+ * dice in rolling order and fills in the counts.
+ */
+typedef struct {
+    int64_t *values;            // Final face of each die (custom dice: side value)
+    uint8_t *kept;              // Bit i % 8 of kept[i / 8] is set when die i counts toward the total
+    uint32_t *rerolls;          // Times each die was rerolled before its final face (may be NULL)
+    size_t die_capacity;        // Dice the arrays can hold; kept needs (die_capacity + 7) / 8 bytes
+    size_t die_count;           // Dice written
+    
+    dice_results_op_t *ops;     // One entry per dice operation, in rolling order
+    size_t op_capacity;
+    size_t op_count;            // Operations written
+    
+    bool truncated;             // Dice or operations past a capacity were not recorded
+} dice_results_t;
+
 /**
  * @brief Policy/configuration for evaluation
  */
@@ -255,6 +359,8 @@ struct dice_policy {
     int max_dice_count;      // Maximum dice in single roll
     int max_sides;           // Maximum sides per die
     int max_explosion_depth; // Maximum explosion iterations
+    int max_depth;           // Maximum sub-expression nesting (0 = unlimited)
+    int max_nodes;           // Maximum AST nodes per expression (0 = unlimited)
     bool allow_negative_dice;// Allow negative die counts
     bool strict_mode;        // Strict parsing/evaluation
 };
@@ -268,14 +374,40 @@ struct dice_error_buffer {
     bool has_error;
 };
 
+/**
+ * @brief Cumulative performance counters (see dice_counters_get)
+ *
+ * Kept only in builds configured with DICE_ENABLE_COUNTERS; otherwise the
+ * library does no counting at all. The context has room for them either way,
+ * so its layout does not depend on the build option.
+ */
+typedef struct {
+    uint64_t dice_rolled;        // Dice rolled, including rerolls and explosions
+    uint64_t rng_calls;          // Values drawn from the RNG
+    uint64_t rng_rejections;     // Draws discarded by range reduction (built-in xoshiro256++ only)
+    uint64_t rerolls;            // Dice rolled again by reroll operations
+    uint64_t explosions;         // Extra dice rolled by exploding dice
+    uint64_t reroll_limit_hits;  // Dice that exceeded the reroll limit
+    uint64_t trace_entries;      // Trace entries recorded
+    uint64_t arena_used;         // Arena bytes in use when the counters were read
+    uint64_t arena_high_water;   // Largest arena offset reached since the last reset
+    uint64_t parse_calls;        // dice_parse()/dice_parse_n() calls
+    uint64_t parse_ns;           // Monotonic nanoseconds spent parsing
+    uint64_t evaluate_calls;     // dice_evaluate() and dice_program_evaluate() calls
+    uint64_t evaluate_ns;        // Monotonic nanoseconds spent in those calls
+} dice_counters_t;
+
 /**
  * @brief Main context handle - contains all state
  */
 struct dice_context {
     // Arena allocator for AST nodes
-    void *arena;
-    size_t arena_size;
-    size_t arena_used;
+    void *arena;                        // Fixed first block
+    size_t arena_size;                  // Size of the first block
+    size_t arena_used;                  // Logical offset of the next allocation (a valid mark)
+    size_t arena_chunk_size;            // Growth chunk size; 0 keeps the arena fixed-size
+    dice_arena_chunk_t *arena_chunks;   // Growth chunks, in offset order
+    dice_arena_chunk_t *arena_current;  // Chunk last allocated from
     
     // Error reporting
     dice_error_buffer_t error;
@@ -288,12 +420,39 @@ struct dice_context {
     
     // Trace log
     dice_trace_t trace;
+    dice_trace_level_t trace_level;
+    
+    // Packed trace (heap buffer; see dice_context_set_trace_packed)
+    bool trace_packing;                 // Dice are encoded into trace_packed, not listed in the arena
+    uint8_t *trace_packed;              // Records not yet handed to the sink
+    size_t trace_packed_length;
+    size_t trace_packed_capacity;
+    dice_trace_sink_fn trace_sink;      // Optional receiver of full batches
+    void *trace_sink_data;
+    size_t trace_batch_bytes;           // Pending bytes that trigger a flush
+    
+    // Per-die results requested by dice_evaluate_ex (not owned), or NULL
+    dice_results_t *results;
+    bool results_op_open;               // Dice are still going into results->ops[op_count - 1]
     
     // RNG vtable
     dice_rng_vtable_t rng;
     
     // Custom dice registry
     dice_custom_die_registry_t custom_dice;
+    
+    // Optional expression cache consulted by dice_roll_expression (not owned)
+    dice_parse_cache_t *parse_cache;
+    
+    // Template this context was cloned from (a counted reference), or NULL
+    dice_context_template_t *origin;
+    bool registry_shared;               // custom_dice is the template's frozen registry
+    bool external_context;              // Context storage belongs to the caller
+    bool external_arena;                // First arena block is not freed with the context
+    uint64_t rng_inline[5];             // Engine state for cloned contexts (no heap RNG)
+
+    // Performance counters, left at zero unless built with DICE_ENABLE_COUNTERS
+    dice_counters_t counters;
 };
 
 /**
@@ -340,14 +499,55 @@ int dice_roll_individual(int count, int sides, int *results);
 int dice_roll_notation(const char *dice_notation);
 
 /**
- * @brief Instant dice rolling helper - creates context, evaluates expression, and cleans up
+ * @brief Instant dice rolling helper - evaluates an expression on the thread's context
  * @param dice_notation String representing dice notation
  * @param seed Random seed (use 0 for time-based randomness)
  * @return Result of the dice roll, or -1 on error
- * @note This is a convenience function that handles all context management internally
+ * @note This is a convenience function that handles all context management
+ *       internally. A non-zero seed always gives the same result for the same
+ *       expression and does not disturb the thread's unseeded stream.
  */
 int dice_roll_quick(const char *dice_notation, uint32_t seed);
 
+/**
+ * @brief Roll n individual dice into a caller-owned buffer
+ * @param sides Number of sides on each die (must be > 0)
+ * @param n Number of dice to roll
+ * @param out Buffer of at least n elements; receives values in [1, sides]
+ * @return 0 on success, -1 on error
+ * @note Meant for language bindings: one call fills the whole buffer (e.g. a
+ *       NumPy int32 array or a Rust &mut [i32]) with no per-value crossing
+ */
+int dice_roll_batch(int sides, size_t n, int *out);
+
+/**
+ * @brief Evaluate an expression n times into a caller-owned buffer
+ * @param dice_notation String representing dice notation
+ * @param n Number of results to produce
+ * @param out Buffer of at least n elements
+ * @return 0 on success, -1 on error (out may be partly written)
+ * @note The expression is parsed, optimized and compiled once per call and
+ *       then run n times on the thread's context, without tracing
+ */
+int dice_roll_notation_batch(const char *dice_notation, size_t n, int64_t *out);
+
+/**
+ * @brief Reseed the calling thread's simple-API engine
+ * @param seed Seed for the thread's xoshiro256++ stream (0 = time-based)
+ * @note Later dice_roll(), dice_roll_notation(), *_batch() and similar calls
+ *       on this thread continue from the new stream
+ */
+void dice_thread_seed(uint64_t seed);
+
+/**
+ * @brief Release the calling thread's simple-API context
+ * @note The simple functions above share one lazily created context and
+ *       xoshiro256++ engine per thread, so calls allocate nothing after the
+ *       first. Call this before a thread exits to free it; the next simple
+ *       call on the thread creates a new one.
+ */
+void dice_thread_cleanup(void);
+
 /**
  * @brief Get the version of the dice library
  * @return Version string
@@ -375,6 +575,8 @@ void dice_context_destroy(dice_context_t *ctx);
 /**
  * @brief Reset context arena and clear trace (reuse context)
  * @param ctx Context to reset
+ * @note Custom dice are cleared; a cloned context returns to its template's
+ *       custom dice instead.
  */
 void dice_context_reset(dice_context_t *ctx);
 
@@ -394,6 +596,87 @@ int dice_context_set_rng(dice_context_t *ctx, const dice_rng_vtable_t *rng_vtabl
  */
 int dice_context_set_policy(dice_context_t *ctx, const dice_policy_t *policy);
 
+/**
+ * @brief Let the arena grow in chunks instead of failing when full
+ * @param ctx Context handle
+ * @param chunk_size Minimum size of each growth chunk in bytes (larger
+ *        requests get a chunk of their own size); 0 restores a fixed arena
+ * @return 0 on success, -1 on error
+ */
+int dice_context_set_arena_growth(dice_context_t *ctx, size_t chunk_size);
+
+/**
+ * @brief Record the current arena position
+ * @param ctx Context handle
+ * @return Mark to pass to dice_arena_rewind()
+ */
+size_t dice_arena_mark(const dice_context_t *ctx);
+
+/**
+ * @brief Free every arena allocation made after a mark
+ * @param ctx Context handle
+ * @param mark Value returned by dice_arena_mark() (later marks are ignored)
+ * @note Anything allocated after the mark, including AST nodes and trace
+ *       entries, becomes invalid; growth chunks are kept for reuse
+ */
+void dice_arena_rewind(dice_context_t *ctx, size_t mark);
+
+// =============================================================================
+// Context Template API
+// =============================================================================
+
+/**
+ * @brief Freeze a context's configuration into a shareable template
+ * @param source Context whose custom dice, policy, features, trace level and
+ *        arena settings are copied
+ * @param seed Base seed for the engines of cloned contexts (0 = time-based)
+ * @return Template with one reference, or NULL on failure
+ * @note The template is never modified after creation, so any number of
+ *       threads may clone from it at once without locking. Later changes to
+ *       source do not affect it.
+ */
+dice_context_template_t* dice_context_template_create(const dice_context_t *source, uint64_t seed);
+
+/**
+ * @brief Take another reference to a template
+ * @param tmpl Template handle
+ * @return tmpl
+ */
+dice_context_template_t* dice_context_template_retain(dice_context_template_t *tmpl);
+
+/**
+ * @brief Drop a reference; the template is freed with its last reference
+ * @param tmpl Template handle (NULL is ignored)
+ * @note Every cloned context holds a reference until it is destroyed, so a
+ *       template may be released while clones are still in use.
+ */
+void dice_context_template_release(dice_context_template_t *tmpl);
+
+/**
+ * @brief Initialize a context from a template in caller-provided storage
+ * @param tmpl Template handle
+ * @param ctx Storage for the context; any previous contents are overwritten
+ * @param arena First arena block (8-byte aligned), e.g. from the caller's pool
+ * @param arena_size Size of arena in bytes (0 with arena NULL for none)
+ * @return 0 on success, -1 on error
+ * @note Makes no heap allocation. The clone reads the template's custom dice
+ *       in place and copies them only when it registers or clears dice of its
+ *       own; its engine is a xoshiro256++ stream seeded from the template's
+ *       seed and the clone's sequence number. dice_context_destroy() releases
+ *       what the context acquired but frees neither ctx nor arena.
+ */
+int dice_context_clone_into(dice_context_template_t *tmpl, dice_context_t *ctx,
+                            void *arena, size_t arena_size);
+
+/**
+ * @brief Create a context from a template
+ * @param tmpl Template handle
+ * @return New context with the template's arena size, or NULL on failure
+ * @note The context and its arena take one allocation; otherwise this is
+ *       dice_context_clone_into(). Free it with dice_context_destroy().
+ */
+dice_context_t* dice_context_clone(dice_context_template_t *tmpl);
+
 // =============================================================================
 // Parsing API
 // =============================================================================
@@ -406,6 +689,19 @@ int dice_context_set_policy(dice_context_t *ctx, const dice_policy_t *policy);
  */
 dice_ast_node_t* dice_parse(dice_context_t *ctx, const char *expression_str);
 
+/**
+ * @brief Parse a length-delimited dice expression into AST
+ * @param ctx Context handle
+ * @param text Expression text; need not be NUL-terminated
+ * @param length Number of bytes of text to parse
+ * @return AST root node or NULL on error
+ * @note Only the first length bytes are read, so an expression can be parsed
+ *       straight out of a larger buffer. The AST copies what it keeps (die
+ *       names and side labels), so text may be released once this returns.
+ *       A NUL byte within length is an error like any other stray character.
+ */
+dice_ast_node_t* dice_parse_n(dice_context_t *ctx, const char *text, size_t length);
+
 // =============================================================================
 // AST Visitor API
 // =============================================================================
@@ -415,7 +711,8 @@ dice_ast_node_t* dice_parse(dice_context_t *ctx, const char *expression_str);
  * @param node AST root node to traverse
  * @param visitor Visitor interface with callback functions
  * @note Traverses the tree in depth-first order, calling enter_node, 
- *       specific visitor, then exit_node for each node
+ *       specific visitor, then exit_node for each node. Iterative, so deep
+ *       trees need no C stack; stops early if its stack cannot be allocated
  */
 void dice_ast_traverse(const dice_ast_node_t *node, const dice_ast_visitor_t *visitor);
 
@@ -428,6 +725,21 @@ void dice_ast_traverse(const dice_ast_node_t *node, const dice_ast_visitor_t *vi
  */
 dice_ast_visitor_t dice_create_trace_visitor(FILE *output, const char *indent_str);
 
+/**
+ * @brief Simplify an AST in place without changing what it evaluates to
+ * @param ctx Context supplying the policy and arena; receives any error
+ * @param node AST root (e.g. from dice_parse)
+ * @return 0 on success, -1 on error
+ * @note Folds literal arithmetic (including constant dice counts and sides),
+ *       drops identity operations such as x+0 and x*1, gathers the constants
+ *       of a sum at its end and merges consecutive plain dice terms with the
+ *       same sides (1d6+1d6+1d6 becomes 3d6). Dice keep their rolling order,
+ *       so a seeded RNG yields the same results and traces before and after.
+ *       Selections, custom dice and anything evaluation would reject (division
+ *       by zero, overflow, counts beyond the policy limit) are left as is.
+ */
+int dice_optimize(dice_context_t *ctx, dice_ast_node_t *node);
+
 // =============================================================================
 // Evaluation API
 // =============================================================================
@@ -437,17 +749,529 @@ dice_ast_visitor_t dice_create_trace_visitor(FILE *output, const char *indent_st
  * @param ctx Context handle (for RNG, tracing, policy)
  * @param node AST node to evaluate
  * @return Evaluation result
+ * @note Iterative over an explicit stack, so C stack use does not grow with
+ *       the tree; fails once policy.max_depth or policy.max_nodes is exceeded
  */
 dice_eval_result_t dice_evaluate(dice_context_t *ctx, const dice_ast_node_t *node);
 
+/**
+ * @brief Evaluate one parsed AST many times into a caller buffer
+ * @param ctx Context handle (for RNG and policy)
+ * @param node AST node to evaluate (e.g. from dice_parse)
+ * @param n Number of samples to evaluate
+ * @param out Output buffer with room for at least n values
+ * @return 0 on success, -1 on error (details in ctx error buffer)
+ * @note Tracing is skipped and per-sample scratch memory is reclaimed after each
+ *       sample, so the arena does not grow with n. Stops at the first failing sample.
+ */
+int dice_evaluate_batch(dice_context_t *ctx, const dice_ast_node_t *node, size_t n, int64_t *out);
+
+/**
+ * @brief Evaluate an AST and record every die into a struct-of-arrays buffer
+ * @param ctx Context handle (for RNG, tracing, policy)
+ * @param node AST node to evaluate
+ * @param results Caller buffer; its counts are reset first (NULL behaves like dice_evaluate)
+ * @return Evaluation result, identical to dice_evaluate()
+ * @note Dice are copied from the evaluator's own roll buffers with no
+ *       allocation, whatever the trace level. Rerolled dice appear once with
+ *       their final face and reroll count; each explosion die is its own entry
+ *       (compounding NdS!! keeps one summed die). Success pools and
+ *       conditional selections roll every die instead of sampling their
+ *       counts, so their RNG stream is that of a fully traced roll.
+ */
+dice_eval_result_t dice_evaluate_ex(dice_context_t *ctx, const dice_ast_node_t *node,
+                                    dice_results_t *results);
+
 /**
  * @brief Parse and evaluate expression in one call
  * @param ctx Context handle
  * @param expression_str Expression to parse and evaluate
  * @return Evaluation result
+ * @note When a parse cache is attached, repeat expressions skip parsing and
+ *       run the cached compiled program
  */
 dice_eval_result_t dice_roll_expression(dice_context_t *ctx, const char *expression_str);
 
+// =============================================================================
+// Compiled Program API
+// =============================================================================
+
+/**
+ * @brief Compile an AST into a flat, position-independent instruction program
+ * @param ctx Context handle (registry used to bind named dice, policy, errors)
+ * @param node AST root node to compile
+ * @return Heap-allocated program (free with dice_program_destroy) or NULL on error
+ * @note Constant counts/sides are folded and checked against the context policy
+ *       once here; inline custom dice are copied, so the program does not
+ *       reference the AST or the arena after compilation
+ */
+dice_program_t* dice_compile(dice_context_t *ctx, const dice_ast_node_t *node);
+
+/**
+ * @brief Evaluate a compiled program
+ * @param ctx Context handle (for RNG, tracing, custom dice registry)
+ * @param program Program returned by dice_compile()
+ * @return Evaluation result, identical to dice_evaluate() on the source AST
+ *         for the same RNG state
+ */
+dice_eval_result_t dice_program_evaluate(dice_context_t *ctx, const dice_program_t *program);
+
+/**
+ * @brief Evaluate a compiled program and record every die (see dice_evaluate_ex)
+ * @param ctx Context handle (for RNG, tracing, custom dice registry)
+ * @param program Program returned by dice_compile()
+ * @param results Caller buffer; its counts are reset first (may be NULL)
+ * @return Evaluation result, identical to dice_program_evaluate()
+ */
+dice_eval_result_t dice_program_evaluate_ex(dice_context_t *ctx, const dice_program_t *program,
+                                            dice_results_t *results);
+
+/**
+ * @brief Evaluate a compiled program many times into a caller buffer
+ * @param ctx Context handle (for RNG, policy, custom dice registry)
+ * @param program Program returned by dice_compile()
+ * @param n Number of samples to evaluate
+ * @param out Output buffer with room for at least n values
+ * @return 0 on success, -1 on error (details in ctx error buffer)
+ * @note Like dice_evaluate_batch(): tracing is skipped, per-sample scratch is
+ *       reclaimed and the first failing sample stops the batch
+ */
+int dice_program_evaluate_batch(dice_context_t *ctx, const dice_program_t *program,
+                                size_t n, int64_t *out);
+
+/**
+ * @brief Evaluate a compiled program many times straight into a statistics accumulator
+ * @param ctx Context handle (for RNG, policy, custom dice registry)
+ * @param program Program returned by dice_compile()
+ * @param n Number of samples to evaluate
+ * @param stats Accumulator that receives every sample (see dice_stats_init())
+ * @return 0 on success, -1 on error (details in ctx error buffer)
+ * @note Same sampling as dice_program_evaluate_batch(), but no sample is stored,
+ *       so memory use does not depend on n. Samples before a failure stay accumulated.
+ */
+int dice_program_evaluate_stats(dice_context_t *ctx, const dice_program_t *program,
+                                size_t n, dice_stats_t *stats);
+
+/**
+ * @brief Free a compiled program
+ * @param program Program to free (NULL is ignored)
+ */
+void dice_program_destroy(dice_program_t *program);
+
+// =============================================================================
+// Performance Counters API
+// =============================================================================
+
+/**
+ * @brief Whether the library was built with DICE_ENABLE_COUNTERS
+ * @return true if contexts keep performance counters
+ */
+bool dice_counters_enabled(void);
+
+/**
+ * @brief Read a context's performance counters
+ * @param ctx Context handle
+ * @param out Receives the counters (zeroed when counters are compiled out)
+ * @return 0 on success, -1 if ctx/out is NULL or counters are compiled out
+ * @note Counters accumulate until dice_counters_reset(). Each public parse or
+ *       evaluate call reads the monotonic clock twice; subexpressions are not
+ *       timed separately.
+ */
+int dice_counters_get(const dice_context_t *ctx, dice_counters_t *out);
+
+/**
+ * @brief Zero a context's counters; the arena high-water mark restarts at the current offset
+ * @param ctx Context handle
+ */
+void dice_counters_reset(dice_context_t *ctx);
+
+// =============================================================================
+// Program Set API (serialized compiled programs)
+// =============================================================================
+
+/**
+ * @brief Bytes needed to encode programs as a program set
+ * @param programs Compiled programs
+ * @param keys Unique lookup key per program, e.g. its expression text
+ * @param count Number of programs
+ * @return Encoded size, or 0 if an argument is invalid
+ */
+size_t dice_program_set_encoded_size(const dice_program_t *const *programs,
+                                     const char *const *keys, size_t count);
+
+/**
+ * @brief Encode programs into a versioned, position-independent program set
+ * @param ctx Context for error reporting
+ * @param programs Compiled programs
+ * @param keys Unique lookup key per program (duplicates are rejected)
+ * @param count Number of programs
+ * @param buffer Destination, 8-byte aligned
+ * @param size Bytes available (at least dice_program_set_encoded_size())
+ * @return 0 on success, -1 on error (details in ctx error buffer)
+ * @note Programs are stored in native byte order, sorted by key. Inline custom
+ *       dice are embedded; named dice keep only their names and are resolved
+ *       against the evaluating context's registry.
+ */
+int dice_program_set_encode(dice_context_t *ctx, const dice_program_t *const *programs,
+                            const char *const *keys, size_t count, void *buffer, size_t size);
+
+/**
+ * @brief Encode programs into a file
+ * @param ctx Context for error reporting
+ * @param path Output file path (replaced if it exists)
+ * @param programs Compiled programs
+ * @param keys Unique lookup key per program
+ * @param count Number of programs
+ * @return 0 on success, -1 on error (details in ctx error buffer)
+ */
+int dice_program_set_save(dice_context_t *ctx, const char *path, const dice_program_t *const *programs,
+                          const char *const *keys, size_t count);
+
+/**
+ * @brief Use an encoded program set in place, without copying
+ * @param ctx Context whose policy the programs are checked against; receives errors
+ * @param data Encoded set, 8-byte aligned; must outlive the returned handle
+ * @param size Bytes at data
+ * @return Set handle (free with dice_program_set_close) or NULL if the data is invalid
+ * @note Every offset, index and stack effect is validated once here, so
+ *       untrusted data cannot make evaluation read out of bounds
+ */
+dice_program_set_t* dice_program_set_view(dice_context_t *ctx, const void *data, size_t size);
+
+/**
+ * @brief Map a program set file read-only
+ * @param ctx Context whose policy the programs are checked against; receives errors
+ * @param path File written by dice_program_set_save()
+ * @return Set handle (free with dice_program_set_close) or NULL on error
+ * @note Uses mmap on POSIX systems, so processes opening the same file share
+ *       its pages; other platforms read the file into memory
+ */
+dice_program_set_t* dice_program_set_open(dice_context_t *ctx, const char *path);
+
+/**
+ * @brief Release a program set (unmapping its file, if any)
+ * @param set Set to close (NULL is ignored); its programs become invalid
+ */
+void dice_program_set_close(dice_program_set_t *set);
+
+/**
+ * @brief Number of programs in a set
+ */
+size_t dice_program_set_count(const dice_program_set_t *set);
+
+/**
+ * @brief Key of the program at index (keys are sorted), or NULL if out of range
+ */
+const char* dice_program_set_key(const dice_program_set_t *set, size_t index);
+
+/**
+ * @brief Program at index, or NULL if out of range
+ * @note The program can be passed to any dice_program_evaluate*() or
+ *       dice_simulate*() call; it must not be passed to dice_program_destroy()
+ */
+const dice_program_t* dice_program_set_get(const dice_program_set_t *set, size_t index);
+
+/**
+ * @brief Program stored under key (binary search), or NULL if absent
+ */
+const dice_program_t* dice_program_set_find(const dice_program_set_t *set, const char *key);
+
+// =============================================================================
+// Statistics API
+// =============================================================================
+
+#define DICE_STATS_MAX_QUANTILES 8
+
+/**
+ * @brief P-square (Jain & Chlamtac) estimator of one quantile
+ * @note Until five samples arrive, height[] holds the raw samples in arrival order
+ */
+typedef struct {
+    double p;               // Target quantile in (0, 1)
+    double height[5];       // Marker heights
+    double position[5];     // Actual marker positions (1-based)
+    double desired[5];      // Desired marker positions
+} dice_stats_quantile_t;
+
+/**
+ * @brief Constant-memory accumulator of integer samples
+ * @note Initialize with dice_stats_init(), then optionally attach a histogram
+ *       and quantile estimators before adding samples. Fields are read-only.
+ */
+struct dice_stats {
+    uint64_t count;         // Samples accumulated
+    double mean;            // Running mean (Welford)
+    double m2;              // Sum of squared deviations from the mean
+    int64_t min;            // Smallest sample (INT64_MAX while empty)
+    int64_t max;            // Largest sample (INT64_MIN while empty)
+    
+    // Optional fixed-bucket histogram over caller-owned counters:
+    // bucket i counts samples in [histogram_min + i*width, histogram_min + (i+1)*width)
+    uint64_t *buckets;
+    size_t bucket_count;
+    int64_t histogram_min;
+    int64_t bucket_width;
+    uint64_t underflow;     // Samples below histogram_min
+    uint64_t overflow;      // Samples past the last bucket
+    
+    size_t quantile_count;
+    dice_stats_quantile_t quantiles[DICE_STATS_MAX_QUANTILES];
+};
+
+/**
+ * @brief Initialize an empty accumulator with no histogram or quantiles
+ * @param stats Accumulator to initialize
+ */
+void dice_stats_init(dice_stats_t *stats);
+
+/**
+ * @brief Attach a fixed-bucket histogram
+ * @param stats Accumulator (must be empty)
+ * @param min Lower bound of the first bucket
+ * @param bucket_width Width of each bucket (> 0); 1 gives one bucket per value
+ * @param buckets Caller-owned counters, zeroed here and owned by the caller
+ * @param bucket_count Number of counters
+ * @return 0 on success, -1 on invalid arguments or a non-empty accumulator
+ */
+int dice_stats_set_histogram(dice_stats_t *stats, int64_t min, int64_t bucket_width,
+                             uint64_t *buckets, size_t bucket_count);
+
+/**
+ * @brief Track an estimate of the p-quantile
+ * @param stats Accumulator (must be empty)
+ * @param p Quantile in (0, 1), e.g. 0.5 for the median
+ * @return 0 on success, -1 on invalid p, a full quantile table or a non-empty accumulator
+ * @note Each estimator is five markers, whatever the sample count
+ */
+int dice_stats_add_quantile(dice_stats_t *stats, double p);
+
+/**
+ * @brief Discard all samples, keeping the histogram and quantile configuration
+ * @param stats Accumulator to reset
+ */
+void dice_stats_reset(dice_stats_t *stats);
+
+/**
+ * @brief Accumulate one sample
+ * @param stats Accumulator
+ * @param value Sample
+ */
+void dice_stats_add(dice_stats_t *stats, int64_t value);
+
+/**
+ * @brief Accumulate n samples from a buffer
+ * @param stats Accumulator
+ * @param values Samples
+ * @param n Number of samples
+ */
+void dice_stats_add_n(dice_stats_t *stats, const int64_t *values, size_t n);
+
+/**
+ * @brief Fold one accumulator into another, e.g. per-thread results
+ * @param into Accumulator that receives the samples of from
+ * @param from Accumulator to merge (unchanged)
+ * @return 0 on success, -1 if the histogram layouts or quantile lists differ
+ * @note Count, mean, variance, min, max and histogram merge exactly (the
+ *       moments up to rounding). Quantile estimators merge approximately by
+ *       count-weighting their markers.
+ */
+int dice_stats_merge(dice_stats_t *into, const dice_stats_t *from);
+
+/**
+ * @brief Population variance of the samples (0 while empty)
+ */
+double dice_stats_variance(const dice_stats_t *stats);
+
+/**
+ * @brief Population standard deviation of the samples (0 while empty)
+ */
+double dice_stats_stddev(const dice_stats_t *stats);
+
+/**
+ * @brief Estimate of a tracked quantile
+ * @param stats Accumulator
+ * @param p Quantile previously passed to dice_stats_add_quantile()
+ * @param out Receives the estimate
+ * @return 0 on success, -1 if p is not tracked or no samples were added
+ * @note Exact (nearest rank) for fewer than five samples, P-square estimate after
+ */
+int dice_stats_quantile(const dice_stats_t *stats, double p, double *out);
+
+// =============================================================================
+// Simulation API
+// =============================================================================
+
+/**
+ * @brief Aggregate statistics of a simulation run
+ */
+typedef struct {
+    uint64_t samples;   // Samples evaluated
+    double mean;        // Sample mean
+    double variance;    // Population variance of the samples
+    int64_t min;        // Smallest sample
+    int64_t max;        // Largest sample
+} dice_simulation_summary_t;
+
+/**
+ * @brief Evaluate a compiled program many times across worker threads
+ * @param ctx Context supplying policy and custom dice; receives any error
+ * @param program Program to sample (compile ASTs with dice_compile() first)
+ * @param samples Number of samples
+ * @param threads Worker threads including the caller (0 is treated as 1)
+ * @param seed xoshiro256++ seed for the run
+ * @param out Optional buffer with room for samples values (sample i in out[i])
+ * @param summary Optional statistics accumulator
+ * @return 0 on success, -1 on error (details in ctx error buffer)
+ * @note Samples are taken in chunks of 8192, each from its own jump-ahead
+ *       xoshiro256++ stream, so the same seed always gives the same samples
+ *       and summary for any thread count. Workers use private contexts with
+ *       tracing off; ctx's RNG and arena are untouched. The custom dice
+ *       registry is read concurrently, so do not modify it during the call.
+ */
+int dice_simulate(dice_context_t *ctx, const dice_program_t *program, size_t samples,
+                  unsigned threads, uint64_t seed, int64_t *out,
+                  dice_simulation_summary_t *summary);
+
+/**
+ * @brief Run dice_simulate() sampling straight into a statistics accumulator
+ * @param ctx Context supplying policy and custom dice; receives any error
+ * @param program Program to sample
+ * @param samples Number of samples
+ * @param threads Worker threads including the caller (0 is treated as 1)
+ * @param seed xoshiro256++ seed for the run
+ * @param stats Configured accumulator; the run's samples are merged into it
+ * @return 0 on success, -1 on error (details in ctx error buffer; stats unchanged)
+ * @note Samples are identical to dice_simulate() for the same seed. Each worker
+ *       accumulates a chunk locally and chunks are merged in chunk order, so the
+ *       result does not depend on the thread count and memory stays constant.
+ */
+int dice_simulate_stats(dice_context_t *ctx, const dice_program_t *program, size_t samples,
+                        unsigned threads, uint64_t seed, dice_stats_t *stats);
+
+// =============================================================================
+// Parse Cache API
+// =============================================================================
+
+/**
+ * @brief Parse cache counters
+ */
+typedef struct {
+    uint64_t hits;       // Lookups answered from the cache
+    uint64_t misses;     // Lookups that parsed and compiled
+    uint64_t evictions;  // Entries dropped to stay within capacity
+    size_t entries;      // Entries currently cached
+    size_t capacity;     // Maximum number of entries
+} dice_parse_cache_stats_t;
+
+/**
+ * @brief Create a cache mapping expression text to compiled programs
+ * @param capacity Maximum number of cached expressions (least recently used
+ *                 entries are evicted beyond this)
+ * @return Cache handle or NULL on failure (or if capacity is 0)
+ * @note A cache may be attached to several contexts, but is not thread-safe;
+ *       contexts sharing one should use the same policy and dice registry
+ */
+dice_parse_cache_t* dice_parse_cache_create(size_t capacity);
+
+/**
+ * @brief Destroy a cache and every program it holds
+ * @param cache Cache to destroy (NULL is ignored)
+ */
+void dice_parse_cache_destroy(dice_parse_cache_t *cache);
+
+/**
+ * @brief Remove every entry (counters are kept)
+ * @param cache Cache handle
+ */
+void dice_parse_cache_clear(dice_parse_cache_t *cache);
+
+/**
+ * @brief Look up an expression, parsing and compiling it on a miss
+ * @param cache Cache handle
+ * @param ctx Context used to parse/compile on a miss (errors are reported here)
+ * @param expression_str Expression text; surrounding spaces/tabs and
+ *        space/tab runs are normalized before lookup
+ * @return Cached program owned by the cache, or NULL on error. The pointer
+ *         stays valid until the entry is evicted by a later lookup or the
+ *         cache is cleared or destroyed.
+ */
+const dice_program_t* dice_parse_cache_get(dice_parse_cache_t *cache, dice_context_t *ctx,
+                                           const char *expression_str);
+
+/**
+ * @brief Get hit/miss/eviction counters
+ * @param cache Cache handle
+ * @return Counter snapshot (all zero for NULL)
+ */
+dice_parse_cache_stats_t dice_parse_cache_get_stats(const dice_parse_cache_t *cache);
+
+/**
+ * @brief Attach a cache to a context so dice_roll_expression() consults it
+ * @param ctx Context handle
+ * @param cache Cache to attach, or NULL to detach (the context never frees it)
+ * @return 0 on success, -1 on error
+ */
+int dice_context_set_parse_cache(dice_context_t *ctx, dice_parse_cache_t *cache);
+
+// =============================================================================
+// Distribution Analysis API
+// =============================================================================
+
+/**
+ * @brief Exact probability mass function over a dense integer support
+ */
+typedef struct dice_distribution {
+    int64_t min_value;  // Value of pmf[0]
+    size_t size;        // Number of entries in pmf
+    double *pmf;        // pmf[i] = P(X == min_value + i)
+} dice_distribution_t;
+
+/**
+ * @brief Compute the exact outcome distribution of an expression
+ * @param ctx Context handle (custom dice registry, policy, errors)
+ * @param node AST root node to analyze
+ * @return Heap-allocated distribution (free with dice_distribution_destroy)
+ *         or NULL on error
+ * @note No dice are rolled. Sums of dice are built by convolution (FFT for
+ *       large supports), keep/drop by a dynamic program over face values.
+ *       Rerolled dice are treated as uniform over the non-matching faces.
+ */
+dice_distribution_t* dice_analyze(dice_context_t *ctx, const dice_ast_node_t *node);
+
+/**
+ * @brief Free a distribution
+ * @param dist Distribution to free (NULL is ignored)
+ */
+void dice_distribution_destroy(dice_distribution_t *dist);
+
+/**
+ * @brief Probability of an exact outcome, P(X == value)
+ */
+double dice_distribution_probability(const dice_distribution_t *dist, int64_t value);
+
+/**
+ * @brief Cumulative probability, P(X <= value)
+ */
+double dice_distribution_cdf(const dice_distribution_t *dist, int64_t value);
+
+/**
+ * @brief Expected value of the distribution
+ */
+double dice_distribution_mean(const dice_distribution_t *dist);
+
+/**
+ * @brief Variance of the distribution
+ */
+double dice_distribution_variance(const dice_distribution_t *dist);
+
+/**
+ * @brief Smallest outcome whose cumulative probability reaches p
+ * @param dist Distribution
+ * @param p Probability in [0, 1] (0.5 gives the median)
+ * @return Quantile value
+ */
+int64_t dice_distribution_quantile(const dice_distribution_t *dist, double p);
+
 // =============================================================================
 // Tracing API
 // =============================================================================
@@ -465,6 +1289,16 @@ const dice_trace_t* dice_get_trace(const dice_context_t *ctx);
  */
 void dice_clear_trace(dice_context_t *ctx);
 
+/**
+ * @brief Choose how much evaluation records in the trace
+ * @param ctx Context handle
+ * @param level DICE_TRACE_OFF, DICE_TRACE_SUMMARY or DICE_TRACE_FULL
+ * @return 0 on success, -1 on error
+ * @note Below DICE_TRACE_FULL no per-die entries are allocated, so rolls use
+ *       no arena memory for tracing
+ */
+int dice_context_set_trace_level(dice_context_t *ctx, dice_trace_level_t level);
+
 /**
  * @brief Format trace output to a string
  * @param ctx Context handle
@@ -482,6 +1316,65 @@ int dice_format_trace_string(const dice_context_t *ctx, char *buffer, size_t buf
  */
 int dice_format_trace_stream(const dice_context_t *ctx, FILE *stream);
 
+/**
+ * @brief Record dice as a packed byte stream instead of arena entries
+ * @param ctx Context handle
+ * @param packed true to encode each traced die into a growable heap buffer,
+ *        false to go back to the linked list of entries
+ * @return 0 on success, -1 on error or if pending bytes could not be flushed
+ * @note Each die is two LEB128 varints: zigzag(sides) << 1 | selected, then
+ *       zigzag(result); a d6 takes 2 bytes rather than a full
+ *       dice_trace_entry_t. trace->count and the summary are kept as before,
+ *       but trace->first stays NULL. Turning packing off flushes to the sink,
+ *       detaches it and frees the buffer.
+ */
+int dice_context_set_trace_packed(dice_context_t *ctx, bool packed);
+
+/**
+ * @brief Stream packed trace records to a callback in batches
+ * @param ctx Context handle
+ * @param sink Receiver, or NULL to detach the current one
+ * @param user_data Passed to every sink call
+ * @param batch_bytes Pending bytes that trigger a flush during evaluation
+ *        (0 selects 4096)
+ * @return 0 on success, -1 on error or if the previous sink failed its flush
+ * @note Enables packing. Bytes pending for the previous sink are flushed to it
+ *       first. A sink failure sets the context error, so the evaluation that
+ *       filled the batch fails; the bytes stay pending for the next flush.
+ */
+int dice_context_set_trace_sink(dice_context_t *ctx, dice_trace_sink_fn sink,
+                                void *user_data, size_t batch_bytes);
+
+/**
+ * @brief Hand all pending packed records to the sink
+ * @param ctx Context handle
+ * @return 0 on success or when there is nothing to flush, -1 if the sink failed
+ * @note Call after an evaluation to deliver its tail; dice_clear_trace and
+ *       dice_context_destroy also flush. Without a sink the bytes stay
+ *       readable through dice_trace_packed().
+ */
+int dice_trace_flush(dice_context_t *ctx);
+
+/**
+ * @brief Get the packed records not yet handed to a sink
+ * @param ctx Context handle
+ * @param length Receives the number of bytes (may be NULL)
+ * @return Pointer to the records, or NULL when there are none; valid until
+ *         the next evaluation, flush or clear
+ */
+const uint8_t* dice_trace_packed(const dice_context_t *ctx, size_t *length);
+
+/**
+ * @brief Decode the next die from a packed trace
+ * @param data Packed records (from dice_trace_packed or a sink)
+ * @param length Number of bytes in data
+ * @param offset Read position; advanced past the decoded record
+ * @param roll Receives the decoded die
+ * @return 1 when a die was decoded, 0 at the end of data, -1 on malformed
+ *         or truncated input
+ */
+int dice_trace_decode(const uint8_t *data, size_t length, size_t *offset, dice_trace_roll_t *roll);
+
 // =============================================================================
 // Error Handling API
 // =============================================================================
@@ -524,6 +1417,35 @@ dice_rng_vtable_t dice_create_system_rng(uint64_t seed);
  */
 dice_rng_vtable_t dice_create_xoshiro_rng(uint64_t seed);
 
+/**
+ * @brief Advance a xoshiro256++ RNG by 2^128 steps
+ * @param rng RNG vtable created by dice_create_xoshiro_rng()
+ * @return 0 on success, -1 if rng is not a xoshiro256++ engine
+ * @note Engines created from the same seed and jumped a different number of
+ *       times produce non-overlapping streams (e.g. one per worker thread)
+ */
+int dice_xoshiro_jump(dice_rng_vtable_t *rng);
+
+/**
+ * @brief Advance a xoshiro256++ RNG by 2^192 steps
+ * @param rng RNG vtable created by dice_create_xoshiro_rng()
+ * @return 0 on success, -1 if rng is not a xoshiro256++ engine
+ * @note Use to partition streams at a coarser level than dice_xoshiro_jump(),
+ *       e.g. one long jump per process and one jump per thread
+ */
+int dice_xoshiro_long_jump(dice_rng_vtable_t *rng);
+
+/**
+ * @brief Create a four-lane xoshiro256++ RNG vtable for large bulk rolls
+ * @param seed Random seed
+ * @return RNG vtable
+ * @note Runs four jump-separated xoshiro256++ lanes in lockstep; roll_n uses
+ *       AVX2, SSE2 or NEON when available (chosen at runtime) and produces the
+ *       same values as the scalar path for the same seed. Its stream differs
+ *       from dice_create_xoshiro_rng() with the same seed.
+ */
+dice_rng_vtable_t dice_create_xoshiro_x4_rng(uint64_t seed);
+
 // =============================================================================
 // Utility Functions
 // =============================================================================
@@ -545,6 +1467,9 @@ dice_policy_t dice_default_policy(void);
  * @param sides Array of side definitions
  * @param side_count Number of sides
  * @return 0 on success, -1 on error
+ * @note Registering an existing name replaces that die. Sides with unequal
+ *       weights get an alias table built here, so each roll costs two RNG
+ *       draws and one comparison regardless of side count or skew.
  */
 int dice_register_custom_die(dice_context_t *ctx, const char *name, 
                              const dice_custom_side_t *sides, size_t side_count);
@@ -557,6 +1482,17 @@ int dice_register_custom_die(dice_context_t *ctx, const char *name,
  */
 dice_custom_side_t dice_custom_side(int64_t value, const char *label);
 
+/**
+ * @brief Create a weighted custom side
+ * @param value Numeric value for calculations
+ * @param label String label (can be NULL)
+ * @param weight Relative likelihood of the side (0 is treated as 1)
+ * @return Custom side structure
+ * @note A side of weight 97 is as likely as 97 copies of a weight 1 side,
+ *       without the extra side or label storage
+ */
+dice_custom_side_t dice_custom_weighted_side(int64_t value, const char *label, uint32_t weight);
+
 /**
  * @brief Look up a named custom die
  * @param ctx Context handle
@@ -565,6 +1501,17 @@ dice_custom_side_t dice_custom_side(int64_t value, const char *label);
  */
 const dice_custom_die_t* dice_lookup_custom_die(const dice_context_t *ctx, const char *name);
 
+/**
+ * @brief Bind the named custom dice in an AST to the context's registry
+ * @param ctx Context whose registry is used
+ * @param node AST root (e.g. from dice_parse)
+ * @return Number of names not found in the registry (0 = fully bound), or -1 on error
+ * @note dice_parse() already binds names registered at parse time. Any later
+ *       registration or clear invalidates bindings; evaluation then falls back
+ *       to a hash lookup until the AST is bound again.
+ */
+int dice_bind_custom_dice(const dice_context_t *ctx, dice_ast_node_t *node);
+
 /**
  * @brief Clear all custom dice from registry
  * @param ctx Context handle
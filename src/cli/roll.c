@@ -2,6 +2,18 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#endif
 #include "dice.h"
 
 // Helper function to parse custom die definition from --die flag
@@ -61,8 +73,547 @@ int parse_die_definition(dice_context_t *ctx, const char *definition) {
     return result;
 }
 
+// Read one line of any length into *buffer, growing it as needed.
+// Returns the line length without the newline, or -1 at end of input.
+long read_line(FILE *input, char **buffer, size_t *capacity) {
+    size_t length = 0;
+    
+    for (;;) {
+        if (*capacity - length < 2) {
+            size_t new_capacity = *capacity ? *capacity * 2 : 256;
+            char *grown = realloc(*buffer, new_capacity);
+            if (!grown) return -1;
+            *buffer = grown;
+            *capacity = new_capacity;
+        }
+        
+        if (!fgets(*buffer + length, (int)(*capacity - length), input)) {
+            if (length == 0) return -1;
+            break;
+        }
+        length += strlen(*buffer + length);
+        if (length > 0 && (*buffer)[length - 1] == '\n') {
+            (*buffer)[--length] = '\0';
+            break;
+        }
+    }
+    
+    if (length > 0 && (*buffer)[length - 1] == '\r') (*buffer)[--length] = '\0';
+    return (long)length;
+}
+
+// Write a JSON string literal
+void write_json_string(FILE *out, const char *text) {
+    fputc('"', out);
+    for (const unsigned char *c = (const unsigned char*)text; *c; c++) {
+        switch (*c) {
+            case '"':  fputs("\\\"", out); break;
+            case '\\': fputs("\\\\", out); break;
+            case '\n': fputs("\\n", out); break;
+            case '\r': fputs("\\r", out); break;
+            case '\t': fputs("\\t", out); break;
+            default:
+                if (*c < 0x20) {
+                    fprintf(out, "\\u%04x", *c);
+                } else {
+                    fputc(*c, out);
+                }
+        }
+    }
+    fputc('"', out);
+}
+
+static const double stats_quantiles[] = {0.5, 0.9, 0.99};
+static const char *stats_quantile_names[] = {"p50", "p90", "p99"};
+
+void init_stats(dice_stats_t *stats) {
+    dice_stats_init(stats);
+    for (size_t i = 0; i < sizeof(stats_quantiles) / sizeof(stats_quantiles[0]); i++) {
+        dice_stats_add_quantile(stats, stats_quantiles[i]);
+    }
+}
+
+// Accumulate count samples of an AST without storing any of them
+int accumulate_stats(dice_context_t *ctx, const dice_ast_node_t *ast, int count, dice_stats_t *stats) {
+    dice_program_t *program = dice_compile(ctx, ast);
+    if (!program) return -1;
+    
+    dice_stats_reset(stats);
+    int status = dice_program_evaluate_stats(ctx, program, (size_t)count, stats);
+    dice_program_destroy(program);
+    return status;
+}
+
+// Print a summary as key=value pairs, or as the members of a JSON object
+void write_stats(FILE *out, const dice_stats_t *stats, int json) {
+    const char *format = json ? "\"samples\":%llu,\"mean\":%.4f,\"stddev\":%.4f,\"min\":%lld,\"max\":%lld"
+                              : "samples=%llu mean=%.4f stddev=%.4f min=%lld max=%lld";
+    fprintf(out, format, (unsigned long long)stats->count, stats->mean, dice_stats_stddev(stats),
+            (long long)stats->min, (long long)stats->max);
+    
+    for (size_t i = 0; i < sizeof(stats_quantiles) / sizeof(stats_quantiles[0]); i++) {
+        double q;
+        if (dice_stats_quantile(stats, stats_quantiles[i], &q) != 0) continue;
+        fprintf(out, json ? ",\"%s\":%.2f" : " %s=%.2f", stats_quantile_names[i], q);
+    }
+}
+
+// Settings and scratch shared by every line of a stream or connection
+typedef struct {
+    int count;
+    int ndjson;
+    int show_stats;
+    int64_t *values;             // count samples (NULL with show_stats)
+    dice_stats_t stats;
+    dice_parse_cache_t *cache;   // Optional; compiled programs are reused across lines
+    FILE *out;                   // Results, and errors in NDJSON mode
+    FILE *errors;                // Plain-text errors
+} line_runner_t;
+
+int line_runner_init(line_runner_t *runner, int count, int ndjson, int show_stats) {
+    memset(runner, 0, sizeof(*runner));
+    runner->count = count;
+    runner->ndjson = ndjson;
+    runner->show_stats = show_stats;
+    runner->out = stdout;
+    runner->errors = stderr;
+    init_stats(&runner->stats);
+    
+    // Summaries need no per-sample storage
+    if (show_stats) return 0;
+    runner->values = malloc((size_t)count * sizeof(int64_t));
+    if (!runner->values) {
+        fprintf(stderr, "Error: failed to allocate memory for %d results\n", count);
+        return -1;
+    }
+    return 0;
+}
+
+// Strip surrounding whitespace in place; NULL for blank lines and '#' comments
+char* trim_expression(char *line, size_t length) {
+    while (length > 0 && isspace((unsigned char)line[length - 1])) line[--length] = '\0';
+    while (isspace((unsigned char)*line)) line++;
+    return (*line == '\0' || *line == '#') ? NULL : line;
+}
+
+// Roll one expression count times and write its result line.
+// Returns 0 on success, -1 if the line failed (the error is written too).
+int run_line(dice_context_t *ctx, line_runner_t *runner, const char *expression, long line_number) {
+    FILE *out = runner->out;
+    int count = runner->count;
+    int status = -1;
+    
+    if (runner->cache) {
+        const dice_program_t *program = dice_parse_cache_get(runner->cache, ctx, expression);
+        if (program) {
+            dice_stats_reset(&runner->stats);
+            status = runner->show_stats ?
+                dice_program_evaluate_stats(ctx, program, (size_t)count, &runner->stats) :
+                dice_program_evaluate_batch(ctx, program, (size_t)count, runner->values);
+        }
+    } else {
+        dice_ast_node_t *ast = dice_parse(ctx, expression);
+        if (ast && dice_optimize(ctx, ast) == 0) {
+            status = runner->show_stats ? accumulate_stats(ctx, ast, count, &runner->stats)
+                                        : dice_evaluate_batch(ctx, ast, (size_t)count, runner->values);
+        }
+    }
+    
+    if (status != 0) {
+        if (runner->ndjson) {
+            fprintf(out, "{\"line\":%ld,\"expression\":", line_number);
+            write_json_string(out, expression);
+            fputs(",\"error\":", out);
+            write_json_string(out, dice_get_error(ctx));
+            fputs("}\n", out);
+        } else {
+            fprintf(runner->errors, "Error: line %ld: %s\n", line_number, dice_get_error(ctx));
+        }
+        dice_clear_error(ctx);
+        return -1;
+    }
+    
+    if (runner->show_stats) {
+        if (runner->ndjson) {
+            fprintf(out, "{\"line\":%ld,\"expression\":", line_number);
+            write_json_string(out, expression);
+            fputs(",\"stats\":{", out);
+            write_stats(out, &runner->stats, 1);
+            fputs("}}\n", out);
+        } else {
+            write_stats(out, &runner->stats, 0);
+            fputc('\n', out);
+        }
+        return 0;
+    }
+    
+    if (runner->ndjson) {
+        fprintf(out, "{\"line\":%ld,\"expression\":", line_number);
+        write_json_string(out, expression);
+        fputs(",\"results\":[", out);
+    }
+    for (int i = 0; i < count; i++) {
+        fprintf(out, i > 0 ? (runner->ndjson ? ",%lld" : " %lld") : "%lld", (long long)runner->values[i]);
+    }
+    fputs(runner->ndjson ? "]}\n" : "\n", out);
+    return 0;
+}
+
+// Evaluate newline-delimited expressions with one long-lived context.
+// Blank lines and lines starting with '#' are skipped. Returns the number of
+// lines that failed, or -1 if the stream could not be processed at all.
+long run_stream(dice_context_t *ctx, FILE *input, int count, int ndjson, int show_stats) {
+    line_runner_t runner;
+    if (line_runner_init(&runner, count, ndjson, show_stats) != 0) return -1;
+    
+    // Batch output is what this mode is for, so write it in large blocks
+    setvbuf(stdout, NULL, _IOFBF, 64 * 1024);
+    
+    char *line = NULL;
+    size_t capacity = 0;
+    long line_number = 0;
+    long failures = 0;
+    size_t base_mark = dice_arena_mark(ctx);
+    
+    long length;
+    while ((length = read_line(input, &line, &capacity)) >= 0) {
+        line_number++;
+        
+        const char *expression = trim_expression(line, (size_t)length);
+        if (!expression) continue;
+        
+        // Everything the previous line parsed or evaluated is scratch now
+        dice_arena_rewind(ctx, base_mark);
+        
+        if (run_line(ctx, &runner, expression, line_number) != 0) failures++;
+    }
+    
+    dice_arena_rewind(ctx, base_mark);
+    free(line);
+    free(runner.values);
+    fflush(stdout);
+    return failures;
+}
+
+#ifndef _WIN32
+// =============================================================================
+// Server Mode (--serve)
+// =============================================================================
+
+// Longest request line a connection may send
+#define SERVE_LINE_MAX (1024 * 1024)
+
+// Connections one worker multiplexes; it stops accepting while full
+#define SERVE_CONNECTIONS_MAX 256
+
+// A client that stops reading its replies for this long is dropped, so it
+// cannot stall the other connections of its worker
+#define SERVE_WRITE_TIMEOUT 10
+
+typedef struct roll_server roll_server_t;
+
+// A client connection and its partial request line
+typedef struct {
+    int fd;
+    FILE *out;                  // Buffered replies, on a dup of fd
+    char *buffer;
+    size_t capacity;
+    size_t used;
+    long line_number;
+} serve_connection_t;
+
+// One thread with its own context, cache and scratch, polling the listener
+// and every connection it has accepted
+typedef struct {
+    roll_server_t *server;
+    pthread_t thread;
+    dice_context_t *ctx;        // Cloned from the server's template
+    line_runner_t runner;       // Cache and result buffer reused across requests
+    serve_connection_t connections[SERVE_CONNECTIONS_MAX];
+    int connection_count;
+} serve_worker_t;
+
+struct roll_server {
+    int listener;               // Non-blocking; every worker polls it
+    int wake[2];                // Written once on shutdown to stop the workers
+    serve_worker_t *workers;
+    int worker_count;
+};
+
+// Listen on "unix:PATH" or "[HOST:]PORT" (HOST defaults to 127.0.0.1)
+int open_listener(const char *address) {
+    int fd;
+    
+    if (strncmp(address, "unix:", 5) == 0) {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (strlen(address + 5) >= sizeof(addr.sun_path)) {
+            fprintf(stderr, "Error: socket path too long '%s'\n", address + 5);
+            return -1;
+        }
+        strcpy(addr.sun_path, address + 5);
+        
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(addr.sun_path);  // A socket left behind by an earlier server
+        if (fd < 0 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+            fprintf(stderr, "Error: cannot bind '%s': %s\n", address + 5, strerror(errno));
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+    } else {
+        char host[256] = "127.0.0.1";
+        const char *port = address;
+        const char *colon = strrchr(address, ':');
+        if (colon) {
+            size_t host_len = (size_t)(colon - address);
+            if (host_len >= sizeof(host)) host_len = sizeof(host) - 1;
+            if (host_len > 0) {
+                memcpy(host, address, host_len);
+                host[host_len] = '\0';
+            }
+            port = colon + 1;
+        }
+        
+        struct addrinfo hints, *info;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        int status = getaddrinfo(host, port, &hints, &info);
+        if (status != 0) {
+            fprintf(stderr, "Error: cannot resolve '%s': %s\n", address, gai_strerror(status));
+            return -1;
+        }
+        
+        fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        int reuse = 1;
+        if (fd >= 0) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (fd < 0 || bind(fd, info->ai_addr, info->ai_addrlen) != 0) {
+            fprintf(stderr, "Error: cannot bind '%s': %s\n", address, strerror(errno));
+            if (fd >= 0) close(fd);
+            freeaddrinfo(info);
+            return -1;
+        }
+        freeaddrinfo(info);
+    }
+    
+    if (listen(fd, 128) != 0) {
+        fprintf(stderr, "Error: cannot listen on '%s': %s\n", address, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Take a connection the listener has ready, if another worker has not
+void serve_accept(serve_worker_t *worker) {
+    int fd = accept(worker->server->listener, NULL, NULL);
+    if (fd < 0) return;
+    
+    // Replies are written blocking, but not forever
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    struct timeval timeout = { SERVE_WRITE_TIMEOUT, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    
+    int out_fd = dup(fd);
+    FILE *out = out_fd >= 0 ? fdopen(out_fd, "w") : NULL;
+    if (!out) {
+        if (out_fd >= 0) close(out_fd);
+        close(fd);
+        return;
+    }
+    setvbuf(out, NULL, _IOFBF, 64 * 1024);
+    
+    serve_connection_t *connection = &worker->connections[worker->connection_count++];
+    memset(connection, 0, sizeof(*connection));
+    connection->fd = fd;
+    connection->out = out;
+}
+
+void serve_close(serve_connection_t *connection) {
+    fclose(connection->out);
+    close(connection->fd);
+    free(connection->buffer);
+}
+
+// Answer pipelined requests, one expression per line. Every complete line a
+// read delivers is evaluated before the replies are written in one batch.
+// Returns -1 once the connection should be closed.
+int serve_readable(serve_worker_t *worker, serve_connection_t *connection) {
+    FILE *out = connection->out;
+    if (connection->capacity - connection->used < 4096) {
+        size_t new_capacity = connection->capacity ? connection->capacity * 2 : 16 * 1024;
+        char *grown = new_capacity <= SERVE_LINE_MAX ? realloc(connection->buffer, new_capacity + 1) : NULL;
+        if (!grown) {
+            fprintf(out, "Error: line %ld: request line too long\n", connection->line_number + 1);
+            fflush(out);
+            return -1;
+        }
+        connection->buffer = grown;
+        connection->capacity = new_capacity;
+    }
+    
+    char *buffer = connection->buffer;
+    ssize_t n = read(connection->fd, buffer + connection->used, connection->capacity - connection->used);
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) return 0;
+    int at_end = n <= 0;
+    if (!at_end) connection->used += (size_t)n;
+    
+    // A final line without a newline still counts at end of input
+    size_t used = connection->used;
+    if (at_end && used > 0) buffer[used++] = '\n';
+    
+    worker->runner.out = out;
+    worker->runner.errors = out;
+    dice_context_t *ctx = worker->ctx;
+    size_t base_mark = dice_arena_mark(ctx);
+    size_t start = 0;
+    char *newline;
+    while ((newline = memchr(buffer + start, '\n', used - start)) != NULL) {
+        *newline = '\0';
+        connection->line_number++;
+        
+        char *expression = trim_expression(buffer + start, (size_t)(newline - buffer) - start);
+        start = (size_t)(newline - buffer) + 1;
+        if (!expression) continue;
+        
+        dice_arena_rewind(ctx, base_mark);
+        run_line(ctx, &worker->runner, expression, connection->line_number);
+    }
+    dice_arena_rewind(ctx, base_mark);
+    memmove(buffer, buffer + start, used - start);
+    connection->used = used - start;
+    
+    // Nothing more has arrived yet: send the whole batch of replies
+    return fflush(out) != 0 || at_end ? -1 : 0;
+}
+
+// Poll the wake pipe, the listener and this worker's connections, so idle
+// clients hold a slot in the poll set rather than a thread
+void* serve_worker(void *arg) {
+    serve_worker_t *worker = arg;
+    roll_server_t *server = worker->server;
+    struct pollfd polls[SERVE_CONNECTIONS_MAX + 2];
+    
+    for (;;) {
+        polls[0].fd = server->wake[0];
+        polls[0].events = POLLIN;
+        polls[1].fd = worker->connection_count < SERVE_CONNECTIONS_MAX ? server->listener : -1;
+        polls[1].events = POLLIN;
+        for (int i = 0; i < worker->connection_count; i++) {
+            polls[i + 2].fd = worker->connections[i].fd;
+            polls[i + 2].events = POLLIN;
+        }
+        
+        if (poll(polls, (nfds_t)worker->connection_count + 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (polls[0].revents) break;
+        
+        // Backwards, so a closed connection can be replaced by the last one
+        for (int i = worker->connection_count - 1; i >= 0; i--) {
+            if (!polls[i + 2].revents) continue;
+            if (serve_readable(worker, &worker->connections[i]) != 0) {
+                serve_close(&worker->connections[i]);
+                worker->connections[i] = worker->connections[--worker->connection_count];
+            }
+        }
+        if (polls[1].revents & POLLIN) serve_accept(worker);
+    }
+    
+    for (int i = 0; i < worker->connection_count; i++) {
+        serve_close(&worker->connections[i]);
+    }
+    worker->connection_count = 0;
+    return NULL;
+}
+
+// Serve until SIGINT or SIGTERM. Each worker rolls from its own clone of the
+// configured context, so the dice registry is shared read-only and every
+// worker draws from its own xoshiro256++ stream.
+int run_server(dice_context_t *ctx, const char *address, int workers, uint32_t seed,
+               int count, int ndjson, int show_stats) {
+    roll_server_t server;
+    memset(&server, 0, sizeof(server));
+    
+    // Replies go to the clients; a client that hangs up only ends its connection
+    signal(SIGPIPE, SIG_IGN);
+    
+    // Signals are taken by sigwait below, never by the workers
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    
+    dice_context_set_trace_level(ctx, DICE_TRACE_OFF);
+    dice_context_template_t *tmpl = dice_context_template_create(ctx, seed);
+    server.workers = calloc((size_t)workers, sizeof(serve_worker_t));
+    int ready = tmpl && server.workers && pipe(server.wake) == 0;
+    server.listener = ready ? open_listener(address) : -1;
+    if (server.listener < 0) {
+        if (!ready) fprintf(stderr, "Error: failed to set up server\n");
+        if (ready) {
+            close(server.wake[0]);
+            close(server.wake[1]);
+        }
+        free(server.workers);
+        dice_context_template_release(tmpl);
+        return 1;
+    }
+    
+    // Workers race for each new connection; the losers must not block
+    fcntl(server.listener, F_SETFL, fcntl(server.listener, F_GETFL) | O_NONBLOCK);
+    
+    int status = 0;
+    for (int i = 0; i < workers; i++) {
+        serve_worker_t *worker = &server.workers[i];
+        worker->server = &server;
+        worker->ctx = dice_context_clone(tmpl);
+        if (!worker->ctx || line_runner_init(&worker->runner, count, ndjson, show_stats) != 0 ||
+            !(worker->runner.cache = dice_parse_cache_create(1024)) ||
+            pthread_create(&worker->thread, NULL, serve_worker, worker) != 0) {
+            fprintf(stderr, "Error: failed to start worker %d\n", i + 1);
+            status = 1;
+            break;
+        }
+        server.worker_count++;
+    }
+    
+    if (status == 0) {
+        fprintf(stderr, "Listening on %s with %d workers\n", address, workers);
+        int signal_number;
+        sigwait(&signals, &signal_number);
+    }
+    
+    // The pipe stays readable, so every worker wakes, closes its
+    // connections and exits
+    if (write(server.wake[1], "", 1) != 1) status = 1;
+    
+    for (int i = 0; i < workers; i++) {
+        serve_worker_t *worker = &server.workers[i];
+        if (i < server.worker_count) pthread_join(worker->thread, NULL);
+        dice_parse_cache_destroy(worker->runner.cache);
+        free(worker->runner.values);
+        dice_context_destroy(worker->ctx);
+    }
+    
+    close(server.listener);
+    close(server.wake[0]);
+    close(server.wake[1]);
+    if (strncmp(address, "unix:", 5) == 0) unlink(address + 5);
+    free(server.workers);
+    dice_context_template_release(tmpl);
+    return status;
+}
+#endif
+
 void print_usage(FILE *stream, const char *program_name) {
     fprintf(stream, "Usage: %s [options] <dice_notation>\n", program_name);
+    fprintf(stream, "       %s [options] --stdin | --file PATH\n", program_name);
+    fprintf(stream, "       %s [options] --serve unix:PATH | [HOST:]PORT\n", program_name);
     fprintf(stream, "  dice_notation: Standard RPG notation (e.g., '3d6', '1d20+5', '2d8-1')\n");
     fprintf(stream, "                 or custom dice notation (e.g., '1d{-1,0,1}', '1dF')\n");
     fprintf(stream, "  Options:\n");
@@ -74,6 +625,13 @@ void print_usage(FILE *stream, const char *program_name) {
     fprintf(stream, "    --ast             Show AST (Abstract Syntax Tree) structure\n");
     fprintf(stream, "    -p, --parse-only  Parse and display AST without evaluation\n");
     fprintf(stream, "    --die NAME=DEF    Define a named custom die\n");
+    fprintf(stream, "    --stdin           Evaluate one expression per line from standard input\n");
+    fprintf(stream, "    -f, --file PATH   Evaluate one expression per line from PATH\n");
+    fprintf(stream, "    --ndjson          With --stdin/--file/--serve, write one JSON object per line\n");
+    fprintf(stream, "    --serve ADDRESS   Answer one expression per line on a Unix or TCP socket\n");
+    fprintf(stream, "    --workers N       Threads (and contexts) serving connections (default 4)\n");
+    fprintf(stream, "    --stats           Print count, mean, stddev, min, max and p50/p90/p99\n");
+    fprintf(stream, "                      of the --count rolls instead of each roll\n");
     fprintf(stream, "\n");
     fprintf(stream, "  Standard Examples:\n");
     fprintf(stream, "    %s 3d6        # Roll 3 six-sided dice\n", program_name);
@@ -82,6 +640,10 @@ void print_usage(FILE *stream, const char *program_name) {
     fprintf(stream, "    %s -t 4d6     # Roll 4 six-sided dice, show individual results\n", program_name);
     fprintf(stream, "    %s --ast '2+3*4'  # Show AST structure for complex expression\n", program_name);
     fprintf(stream, "    %s -p '3d6+2'     # Parse and display AST without rolling\n", program_name);
+    fprintf(stream, "    %s --stdin < rolls.txt        # One result line per input line\n", program_name);
+    fprintf(stream, "    %s -c 3 --ndjson -f rolls.txt # Three results per line as NDJSON\n", program_name);
+    fprintf(stream, "    %s --stats -c 1000000 4d6k3   # Summary of a million rolls\n", program_name);
+    fprintf(stream, "    %s --serve unix:/tmp/roll.sock # Roll server on a Unix socket\n", program_name);
     fprintf(stream, "\n");
     fprintf(stream, "  Selection Examples:\n");
     fprintf(stream, "    %s '4d6k3'    # Keep highest 3 of 4d6 (ability scores)\n", program_name);
@@ -116,6 +678,12 @@ int main(int argc, char *argv[]) {
     int show_trace = 0;
     int show_ast = 0;
     int parse_only = 0;
+    int use_stdin = 0;
+    int ndjson = 0;
+    int show_stats = 0;
+    const char *input_path = NULL;
+    const char *serve_address = NULL;
+    int workers = 0;
     char *dice_notation = NULL;
     
     // Create dice context for custom die support
@@ -162,6 +730,41 @@ int main(int argc, char *argv[]) {
             show_ast = 1;
         } else if (strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--parse-only") == 0) {
             parse_only = 1;
+        } else if (strcmp(argv[i], "--stdin") == 0) {
+            use_stdin = 1;
+        } else if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--file") == 0) {
+            if (i + 1 < argc) {
+                input_path = argv[++i];
+            } else {
+                fprintf(stderr, "Error: -f/--file requires a path\n");
+                dice_context_destroy(ctx);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--ndjson") == 0) {
+            ndjson = 1;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            show_stats = 1;
+        } else if (strcmp(argv[i], "--serve") == 0) {
+            if (i + 1 < argc) {
+                serve_address = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --serve requires an address\n");
+                dice_context_destroy(ctx);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--workers") == 0) {
+            if (i + 1 < argc) {
+                workers = atoi(argv[++i]);
+                if (workers <= 0) {
+                    fprintf(stderr, "Error: workers must be positive\n");
+                    dice_context_destroy(ctx);
+                    return 1;
+                }
+            } else {
+                fprintf(stderr, "Error: --workers requires a number\n");
+                dice_context_destroy(ctx);
+                return 1;
+            }
         } else if (strncmp(argv[i], "--die", 5) == 0) {
             const char *definition = NULL;
             if (argv[i][5] == '=') {
@@ -196,6 +799,62 @@ int main(int argc, char *argv[]) {
         }
     }
     
+    if (serve_address) {
+        int status = 1;
+        if (use_stdin || input_path || dice_notation) {
+            fprintf(stderr, "Error: --serve cannot be combined with --stdin/--file or a dice notation\n");
+        } else if (show_trace || show_ast || parse_only) {
+            fprintf(stderr, "Error: --trace, --ast and --parse-only are not supported with --serve\n");
+        } else {
+#ifndef _WIN32
+            status = run_server(ctx, serve_address, workers ? workers : 4, seed, count, ndjson, show_stats);
+#else
+            fprintf(stderr, "Error: --serve is not supported on this platform\n");
+#endif
+        }
+        dice_context_destroy(ctx);
+        return status;
+    }
+    
+    if (workers) {
+        fprintf(stderr, "Error: --workers requires --serve\n");
+        dice_context_destroy(ctx);
+        return 1;
+    }
+    
+    if (use_stdin || input_path) {
+        if (use_stdin && input_path) {
+            fprintf(stderr, "Error: --stdin and --file cannot be combined\n");
+        } else if (dice_notation) {
+            fprintf(stderr, "Error: a dice notation cannot be combined with --stdin/--file\n");
+        } else if (show_trace || show_ast || parse_only) {
+            fprintf(stderr, "Error: --trace, --ast and --parse-only are not supported with --stdin/--file\n");
+        } else {
+            FILE *input = use_stdin ? stdin : fopen(input_path, "r");
+            if (!input) {
+                fprintf(stderr, "Error: cannot open '%s'\n", input_path);
+                dice_context_destroy(ctx);
+                return 1;
+            }
+            
+            dice_rng_vtable_t rng = dice_create_system_rng(seed);
+            dice_context_set_rng(ctx, &rng);
+            
+            long failures = run_stream(ctx, input, count, ndjson, show_stats);
+            if (input != stdin) fclose(input);
+            dice_context_destroy(ctx);
+            return failures == 0 ? 0 : 1;
+        }
+        dice_context_destroy(ctx);
+        return 1;
+    }
+    
+    if (ndjson) {
+        fprintf(stderr, "Error: --ndjson requires --stdin, --file or --serve\n");
+        dice_context_destroy(ctx);
+        return 1;
+    }
+    
     if (dice_notation == NULL) {
         fprintf(stderr, "Error: no dice notation specified\n");
         print_usage(stderr, argv[0]);
@@ -207,6 +866,28 @@ int main(int argc, char *argv[]) {
     dice_rng_vtable_t rng = dice_create_system_rng(seed);
     dice_context_set_rng(ctx, &rng);
     
+    if (show_stats) {
+        if (show_trace) {
+            fprintf(stderr, "Error: --trace cannot be combined with --stats\n");
+            dice_context_destroy(ctx);
+            return 1;
+        }
+        
+        dice_stats_t stats;
+        init_stats(&stats);
+        dice_ast_node_t *ast = dice_parse(ctx, dice_notation);
+        if (!ast || dice_optimize(ctx, ast) != 0 || accumulate_stats(ctx, ast, count, &stats) != 0) {
+            fprintf(stderr, "Error: %s\n", dice_get_error(ctx));
+            dice_context_destroy(ctx);
+            return 1;
+        }
+        
+        write_stats(stdout, &stats, 0);
+        printf("\n");
+        dice_context_destroy(ctx);
+        return 0;
+    }
+    
     // If AST display is requested, parse and show AST structure
     if (show_ast || parse_only) {
         dice_ast_node_t *ast = dice_parse(ctx, dice_notation);
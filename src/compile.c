@@ -0,0 +1,842 @@
+#include "dice.h"
+#include "internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =============================================================================
+// Program Compiler (AST -> flat instruction array)
+// =============================================================================
+
+// The compiler runs twice over the AST: once with program == NULL to size
+// every section, then again to write into a single allocation.
+typedef struct {
+    dice_context_t *ctx;
+    dice_program_t *program;
+    uint32_t instr_count;
+    uint32_t selection_count;
+    uint32_t die_count;
+    uint32_t side_count;
+    bool weighted;              // some inline die needs the alias section
+    uint32_t string_size;
+    uint32_t depth;
+    uint32_t max_depth;
+    size_t nodes;               // AST nodes compiled, checked against policy.max_nodes
+} program_builder_t;
+
+static uint32_t align8(uint32_t size) {
+    return (size + 7u) & ~7u;
+}
+
+static void builder_set_error(program_builder_t *b, const char *message, const char *detail) {
+    if (detail) {
+        snprintf(b->ctx->error.message, sizeof(b->ctx->error.message), "%s: %s", message, detail);
+    } else {
+        snprintf(b->ctx->error.message, sizeof(b->ctx->error.message), "%s", message);
+    }
+    b->ctx->error.has_error = true;
+}
+
+static void builder_adjust_depth(program_builder_t *b, int pops, int pushes) {
+    b->depth = b->depth - (uint32_t)pops + (uint32_t)pushes;
+    if (b->depth > b->max_depth) {
+        b->max_depth = b->depth;
+    }
+}
+
+static void emit_instr(program_builder_t *b, dice_opcode_t opcode, uint8_t flags,
+                       uint32_t aux, int64_t a, int64_t bval) {
+    // Past the final count is only ever a constant PUSH that is taken back
+    if (b->program && b->instr_count < b->program->instr_count) {
+        dice_instr_t *instr = (dice_instr_t*)((char*)b->program + b->program->instr_offset) + b->instr_count;
+        instr->opcode = (uint8_t)opcode;
+        instr->flags = flags;
+        instr->reserved = 0;
+        instr->aux = aux;
+        instr->a = a;
+        instr->b = bval;
+    }
+    b->instr_count++;
+}
+
+static uint32_t add_string(program_builder_t *b, const char *str) {
+    if (!str) return 0;
+    
+    uint32_t offset = b->string_size;
+    size_t len = strlen(str) + 1;
+    if (b->program) {
+        memcpy((char*)b->program + b->program->string_offset + offset, str, len);
+    }
+    b->string_size += (uint32_t)len;
+    return offset;
+}
+
+// Fold l op r at compile time; division by zero is left for evaluation
+static bool const_fold(dice_binary_op_t op, int64_t left, int64_t right, int64_t *out) {
+    switch (op) {
+        case DICE_OP_ADD: *out = left + right; return true;
+        case DICE_OP_SUB: *out = left - right; return true;
+        case DICE_OP_MUL: *out = left * right; return true;
+        case DICE_OP_DIV:
+            if (right == 0) return false;
+            *out = left / right;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Set when a subexpression compiled to a single PUSH, so its parent can fold
+// it without walking the subtree again
+typedef struct {
+    bool constant;
+    int64_t value;
+} compiled_t;
+
+// Take back the PUSH a constant operand just emitted; max_depth is the
+// builder's value from before the operand was compiled
+static void builder_unpush(program_builder_t *b, uint32_t max_depth) {
+    b->instr_count--;
+    b->depth--;
+    b->max_depth = max_depth;
+}
+
+static bool compile_node(program_builder_t *b, const dice_ast_node_t *node, int depth, compiled_t *out);
+
+// Hold the tree to the evaluator's limits: same node count, same nesting rule
+static bool builder_visit(program_builder_t *b, int depth) {
+    const dice_policy_t *policy = &b->ctx->policy;
+    if (policy->max_nodes > 0 && b->nodes >= (size_t)policy->max_nodes) {
+        snprintf(b->ctx->error.message, sizeof(b->ctx->error.message),
+                "Expression exceeds node limit of %d", policy->max_nodes);
+        b->ctx->error.has_error = true;
+        return false;
+    }
+    if (policy->max_depth > 0 && depth > policy->max_depth) {
+        snprintf(b->ctx->error.message, sizeof(b->ctx->error.message),
+                "Expression exceeds nesting depth limit of %d", policy->max_depth);
+        b->ctx->error.has_error = true;
+        return false;
+    }
+    b->nodes++;
+    return true;
+}
+
+static uint32_t add_selection(program_builder_t *b, const dice_selection_t *selection) {
+    uint32_t index = b->selection_count++;
+    uint32_t syntax = add_string(b, selection->original_syntax);
+    
+    if (b->program) {
+        dice_program_selection_t *sel = (dice_program_selection_t*)
+            ((char*)b->program + b->program->selection_offset) + index;
+        memset(sel, 0, sizeof(*sel));
+        sel->count = selection->count;
+        sel->comparison_value = selection->comparison_value;
+        sel->comparison_op = (uint32_t)selection->comparison_op;
+        sel->syntax = syntax;
+        sel->select_high = selection->select_high;
+        sel->is_drop_operation = selection->is_drop_operation;
+        sel->is_conditional = selection->is_conditional;
+        sel->is_reroll = selection->is_reroll;
+    }
+    return index;
+}
+
+static bool add_custom_die(program_builder_t *b, const dice_ast_node_t *node, uint32_t *index_out) {
+    dice_program_die_t die = {0, 0, 0, 0, 0, 0};
+    
+    if (node->data.dice_op.custom_die) {
+        // Inline die: copy its side table into the program
+        const dice_custom_die_t *custom_die = node->data.dice_op.custom_die;
+        if (custom_die->side_count == 0) {
+            builder_set_error(b, "Custom die has no sides", NULL);
+            return false;
+        }
+        
+        die.first_side = b->side_count;
+        die.side_count = (uint32_t)custom_die->side_count;
+        if (custom_die->alias) {
+            die.total_weight = custom_die->total_weight;
+            b->weighted = true;
+        }
+        for (size_t i = 0; i < custom_die->side_count; i++) {
+            uint32_t label = add_string(b, custom_die->sides[i].label);
+            if (b->program) {
+                dice_program_side_t *side = (dice_program_side_t*)
+                    ((char*)b->program + b->program->side_offset) + b->side_count;
+                side->value = custom_die->sides[i].value;
+                side->label = label;
+                side->reserved = 0;
+                if (custom_die->alias) {
+                    dice_alias_entry_t *alias = (dice_alias_entry_t*)
+                        ((char*)b->program + b->program->alias_offset) + b->side_count;
+                    *alias = custom_die->alias[i];
+                }
+            }
+            b->side_count++;
+        }
+    } else if (node->data.dice_op.custom_name) {
+        // Named die: bind to its registry slot now, re-validated at run time
+        const char *name = node->data.dice_op.custom_name;
+        const dice_custom_die_t *registered = dice_lookup_custom_die(b->ctx, name);
+        if (!registered) {
+            builder_set_error(b, "Unknown custom die", name);
+            return false;
+        }
+        if (registered->side_count == 0) {
+            builder_set_error(b, "Custom die has no sides", NULL);
+            return false;
+        }
+        
+        die.name = add_string(b, name);
+        die.registry_index = (uint32_t)(registered - b->ctx->custom_dice.dice);
+        die.registry_generation = b->ctx->custom_dice.generation;
+    } else {
+        builder_set_error(b, "Custom die has no definition or name", NULL);
+        return false;
+    }
+    
+    *index_out = b->die_count;
+    if (b->program) {
+        dice_program_die_t *dst = (dice_program_die_t*)
+            ((char*)b->program + b->program->die_offset) + b->die_count;
+        *dst = die;
+    }
+    b->die_count++;
+    return true;
+}
+
+static bool compile_dice_op(program_builder_t *b, const dice_ast_node_t *node, int depth) {
+    uint8_t flags = 0;
+    int64_t count = 1;
+    int64_t sides = 0;
+    
+    compiled_t operand;
+    uint32_t max_depth = b->max_depth;
+    
+    // Count: constant counts are validated once here instead of on every roll
+    if (node->data.dice_op.count) {
+        if (!compile_node(b, node->data.dice_op.count, depth + 1, &operand)) return false;
+        if (operand.constant) {
+            builder_unpush(b, max_depth);
+            count = operand.value;
+            if (!eval_check_dice_count(b->ctx, count)) return false;
+        } else {
+            flags |= DICE_INSTR_COUNT_DYNAMIC;
+        }
+    } else if (!eval_check_dice_count(b->ctx, count)) {
+        return false;
+    }
+    
+    int pops = (flags & DICE_INSTR_COUNT_DYNAMIC) ? 1 : 0;
+    
+    if (node->data.dice_op.dice_type == DICE_DICE_CUSTOM) {
+        uint32_t die_index = 0;
+        if (!add_custom_die(b, node, &die_index)) return false;
+        emit_instr(b, DICE_OPC_CUSTOM, flags, die_index, count, 0);
+        builder_adjust_depth(b, pops, 1);
+        return true;
+    }
+    
+    max_depth = b->max_depth;
+    if (!compile_node(b, node->data.dice_op.sides, depth + 1, &operand)) return false;
+    if (operand.constant) {
+        builder_unpush(b, max_depth);
+        sides = operand.value;
+        if (!eval_check_dice_sides(b->ctx, sides)) return false;
+    } else {
+        flags |= DICE_INSTR_SIDES_DYNAMIC;
+        pops++;
+    }
+    
+    if (node->data.dice_op.dice_type == DICE_DICE_FILTER || node->data.dice_op.dice_type == DICE_DICE_POOL) {
+        if (!node->data.dice_op.selection) {
+            builder_set_error(b, "Filter operation has no selection", NULL);
+            return false;
+        }
+        uint32_t selection_index = add_selection(b, node->data.dice_op.selection);
+        dice_opcode_t opcode = node->data.dice_op.dice_type == DICE_DICE_POOL ? DICE_OPC_POOL : DICE_OPC_FILTER;
+        emit_instr(b, opcode, flags, selection_index, count, sides);
+    } else if (node->data.dice_op.dice_type == DICE_DICE_EXPLODING) {
+        // Thresholds past any legal side count never explode, so clamping keeps them exact
+        const dice_ast_node_t *threshold = node->data.dice_op.modifier;
+        int64_t explode_at = threshold ? threshold->data.literal.value : 0;
+        if (explode_at > (int64_t)UINT32_MAX) explode_at = UINT32_MAX;
+        if (node->data.dice_op.compounding) flags |= DICE_INSTR_COMPOUNDING;
+        emit_instr(b, DICE_OPC_EXPLODE, flags, (uint32_t)explode_at, count, sides);
+    } else {
+        emit_instr(b, DICE_OPC_ROLL, flags, 0, count, sides);
+    }
+    builder_adjust_depth(b, pops, 1);
+    return true;
+}
+
+// One operator of a chain; acc holds the left operand's result
+static bool compile_binary_step(program_builder_t *b, const dice_ast_node_t *node, int depth,
+                                uint32_t max_depth, compiled_t *acc) {
+    compiled_t right;
+    if (!compile_node(b, node->data.binary_op.right, depth + 1, &right)) return false;
+    
+    // Both operands are single PUSHes: replace them with the result
+    int64_t value;
+    if (acc->constant && right.constant &&
+        const_fold(node->data.binary_op.op, acc->value, right.value, &value)) {
+        builder_unpush(b, max_depth);
+        builder_unpush(b, max_depth);
+        emit_instr(b, DICE_OPC_PUSH, 0, 0, value, 0);
+        builder_adjust_depth(b, 0, 1);
+        acc->value = value;
+        return true;
+    }
+    
+    dice_opcode_t opcode;
+    switch (node->data.binary_op.op) {
+        case DICE_OP_ADD: opcode = DICE_OPC_ADD; break;
+        case DICE_OP_SUB: opcode = DICE_OPC_SUB; break;
+        case DICE_OP_MUL: opcode = DICE_OPC_MUL; break;
+        case DICE_OP_DIV: opcode = DICE_OPC_DIV; break;
+        default:
+            builder_set_error(b, "Unknown binary operator", NULL);
+            return false;
+    }
+    emit_instr(b, opcode, 0, 0, 0, 0);
+    builder_adjust_depth(b, 2, 1);
+    acc->constant = false;
+    return true;
+}
+
+// Left operands continue the chain, so a chain like 1+2+...+N is compiled in a
+// loop from its innermost operator out instead of recursing once per term
+static bool compile_binary(program_builder_t *b, const dice_ast_node_t *node, int depth, compiled_t *out) {
+    ast_spine_t spine;
+    if (!ast_spine_init(&spine, node)) {
+        builder_set_error(b, "Failed to allocate memory for compilation", NULL);
+        return false;
+    }
+    
+    // A constant operand emitted only its PUSH, so folding restores this depth
+    uint32_t max_depth = b->max_depth;
+    bool ok = true;
+    for (size_t i = 1; ok && i < spine.length; i++) {
+        ok = builder_visit(b, depth);
+    }
+    ok = ok && compile_node(b, spine.nodes[spine.length - 1]->data.binary_op.left, depth, out);
+    for (size_t i = spine.length; ok && i > 0; i--) {
+        ok = compile_binary_step(b, spine.nodes[i - 1], depth, max_depth, out);
+    }
+    
+    ast_spine_release(&spine);
+    return ok;
+}
+
+static bool compile_node(program_builder_t *b, const dice_ast_node_t *node, int depth, compiled_t *out) {
+    out->constant = false;
+    if (!node) {
+        builder_set_error(b, "Cannot compile empty expression", NULL);
+        return false;
+    }
+    if (!builder_visit(b, depth)) return false;
+    
+    switch (node->type) {
+        case DICE_NODE_LITERAL:
+            emit_instr(b, DICE_OPC_PUSH, 0, 0, node->data.literal.value, 0);
+            builder_adjust_depth(b, 0, 1);
+            out->constant = true;
+            out->value = node->data.literal.value;
+            return true;
+        
+        case DICE_NODE_BINARY_OP:
+            return compile_binary(b, node, depth, out);
+        
+        case DICE_NODE_DICE_OP:
+            return compile_dice_op(b, node, depth);
+        
+        case DICE_NODE_ANNOTATION:
+            return compile_node(b, node->data.annotation.child, depth, out);
+        
+        case DICE_NODE_FUNCTION_CALL:
+            builder_set_error(b, "Function calls not yet supported", node->data.function_call.name);
+            return false;
+        
+        default:
+            builder_set_error(b, "Unknown AST node type", NULL);
+            return false;
+    }
+}
+
+static void builder_reset(program_builder_t *b, dice_context_t *ctx, dice_program_t *program) {
+    memset(b, 0, sizeof(*b));
+    b->ctx = ctx;
+    b->program = program;
+    b->string_size = 1; // offset 0 is the reserved empty string
+}
+
+dice_program_t* dice_compile(dice_context_t *ctx, const dice_ast_node_t *node) {
+    if (!ctx) return NULL;
+    
+    // Pass 1: size every section
+    program_builder_t b;
+    builder_reset(&b, ctx, NULL);
+    compiled_t root;
+    if (!compile_node(&b, node, 0, &root)) return NULL;
+    
+    uint32_t instr_offset = align8((uint32_t)sizeof(dice_program_t));
+    uint32_t selection_offset = instr_offset + align8(b.instr_count * (uint32_t)sizeof(dice_instr_t));
+    uint32_t die_offset = selection_offset +
+        align8(b.selection_count * (uint32_t)sizeof(dice_program_selection_t));
+    uint32_t side_offset = die_offset + align8(b.die_count * (uint32_t)sizeof(dice_program_die_t));
+    uint32_t alias_offset = side_offset + align8(b.side_count * (uint32_t)sizeof(dice_program_side_t));
+    uint32_t alias_count = b.weighted ? b.side_count : 0;
+    uint32_t string_offset = alias_offset + align8(alias_count * (uint32_t)sizeof(dice_alias_entry_t));
+    uint32_t total_size = string_offset + align8(b.string_size);
+    
+    dice_program_t *program = calloc(1, total_size);
+    if (!program) {
+        builder_set_error(&b, "Failed to allocate memory for compiled program", NULL);
+        return NULL;
+    }
+    
+    program->magic = DICE_PROGRAM_MAGIC;
+    program->version = DICE_PROGRAM_VERSION;
+    program->total_size = total_size;
+    program->max_stack = b.max_depth;
+    program->instr_offset = instr_offset;
+    program->instr_count = b.instr_count;
+    program->selection_offset = selection_offset;
+    program->selection_count = b.selection_count;
+    program->die_offset = die_offset;
+    program->die_count = b.die_count;
+    program->side_offset = side_offset;
+    program->side_count = b.side_count;
+    program->alias_offset = alias_offset;
+    program->alias_count = alias_count;
+    program->string_offset = string_offset;
+    program->string_size = b.string_size;
+    
+    // Pass 2: emit into the allocated program
+    builder_reset(&b, ctx, program);
+    if (!compile_node(&b, node, 0, &root)) {
+        free(program);
+        return NULL;
+    }
+    
+    return program;
+}
+
+void dice_program_destroy(dice_program_t *program) {
+    free(program);
+}
+
+// =============================================================================
+// Program Validation (untrusted encodings)
+// =============================================================================
+
+static bool validate_fail(dice_context_t *ctx, const char *detail) {
+    snprintf(ctx->error.message, sizeof(ctx->error.message), "Invalid compiled program: %s", detail);
+    ctx->error.has_error = true;
+    return false;
+}
+
+// A section of count elements fits inside the program and is 8-byte aligned
+static bool validate_section(const dice_program_t *program, uint32_t offset, uint32_t count, size_t elem) {
+    if (offset % 8 != 0 || offset < sizeof(dice_program_t)) return false;
+    return (uint64_t)offset + (uint64_t)count * elem <= program->total_size;
+}
+
+bool program_validate(dice_context_t *ctx, const dice_program_t *program, size_t size) {
+    if (size < sizeof(dice_program_t) || program->magic != DICE_PROGRAM_MAGIC) {
+        return validate_fail(ctx, "bad header");
+    }
+    if (program->version != DICE_PROGRAM_VERSION) return validate_fail(ctx, "unsupported version");
+    if (program->total_size > size || program->total_size < sizeof(dice_program_t) ||
+        program->instr_count == 0 || program->max_stack > program->instr_count) {
+        return validate_fail(ctx, "bad size");
+    }
+    
+    if (!validate_section(program, program->instr_offset, program->instr_count, sizeof(dice_instr_t)) ||
+        !validate_section(program, program->selection_offset, program->selection_count,
+                          sizeof(dice_program_selection_t)) ||
+        !validate_section(program, program->die_offset, program->die_count, sizeof(dice_program_die_t)) ||
+        !validate_section(program, program->side_offset, program->side_count, sizeof(dice_program_side_t)) ||
+        !validate_section(program, program->alias_offset, program->alias_count, sizeof(dice_alias_entry_t)) ||
+        !validate_section(program, program->string_offset, program->string_size, 1)) {
+        return validate_fail(ctx, "section out of bounds");
+    }
+    if (program->alias_count != 0 && program->alias_count != program->side_count) {
+        return validate_fail(ctx, "alias table does not match side table");
+    }
+    
+    // Every string offset below string_size must reach a terminator
+    const char *strings = DICE_PROGRAM_SECTION(program, program->string_offset, char);
+    if (program->string_size == 0 || strings[0] != '\0' || strings[program->string_size - 1] != '\0') {
+        return validate_fail(ctx, "bad string pool");
+    }
+    
+    const dice_program_selection_t *selections =
+        DICE_PROGRAM_SECTION(program, program->selection_offset, dice_program_selection_t);
+    for (uint32_t i = 0; i < program->selection_count; i++) {
+        if (selections[i].syntax >= program->string_size) return validate_fail(ctx, "bad selection");
+    }
+    
+    const dice_program_side_t *sides = DICE_PROGRAM_SECTION(program, program->side_offset, dice_program_side_t);
+    const dice_alias_entry_t *alias = DICE_PROGRAM_SECTION(program, program->alias_offset, dice_alias_entry_t);
+    for (uint32_t i = 0; i < program->side_count; i++) {
+        if (sides[i].label >= program->string_size) return validate_fail(ctx, "bad side label");
+    }
+    
+    const dice_program_die_t *dice = DICE_PROGRAM_SECTION(program, program->die_offset, dice_program_die_t);
+    for (uint32_t i = 0; i < program->die_count; i++) {
+        const dice_program_die_t *die = &dice[i];
+        if (die->name) {
+            if (die->name >= program->string_size) return validate_fail(ctx, "bad die name");
+            continue;
+        }
+        if (die->side_count == 0 || (uint64_t)die->first_side + die->side_count > program->side_count) {
+            return validate_fail(ctx, "bad inline die");
+        }
+        if (die->total_weight) {
+            if (program->alias_count == 0) return validate_fail(ctx, "weighted die without alias table");
+            // A draw spans side_count * total_weight values, which must not wrap to zero
+            if (die->total_weight > UINT64_MAX / die->side_count) {
+                return validate_fail(ctx, "weighted die too large");
+            }
+            for (uint32_t j = 0; j < die->side_count; j++) {
+                if (alias[die->first_side + j].alias >= die->side_count ||
+                    alias[die->first_side + j].keep > die->total_weight) {
+                    return validate_fail(ctx, "bad alias entry");
+                }
+            }
+        }
+    }
+    
+    // Replay the stack effect of every instruction, as dice_compile() computed it
+    const dice_instr_t *instrs = DICE_PROGRAM_SECTION(program, program->instr_offset, dice_instr_t);
+    uint64_t depth = 0;
+    for (uint32_t i = 0; i < program->instr_count; i++) {
+        const dice_instr_t *ip = &instrs[i];
+        uint32_t pops = 0;
+        
+        switch ((dice_opcode_t)ip->opcode) {
+            case DICE_OPC_PUSH:
+                break;
+            case DICE_OPC_ADD:
+            case DICE_OPC_SUB:
+            case DICE_OPC_MUL:
+            case DICE_OPC_DIV:
+                pops = 2;
+                break;
+            case DICE_OPC_ROLL:
+            case DICE_OPC_FILTER:
+            case DICE_OPC_CUSTOM:
+            case DICE_OPC_EXPLODE:
+            case DICE_OPC_POOL:
+                if ((ip->opcode == DICE_OPC_FILTER || ip->opcode == DICE_OPC_POOL) &&
+                    ip->aux >= program->selection_count) {
+                    return validate_fail(ctx, "bad selection index");
+                }
+                if (ip->opcode == DICE_OPC_CUSTOM && ip->aux >= program->die_count) {
+                    return validate_fail(ctx, "bad custom die index");
+                }
+                // Reject constant operands over the loading context's policy up front; the
+                // interpreter checks them again against whichever context runs the program
+                if (ip->flags & DICE_INSTR_COUNT_DYNAMIC) {
+                    pops++;
+                } else if (!eval_check_dice_count(ctx, ip->a)) {
+                    return false;
+                }
+                if (ip->flags & DICE_INSTR_SIDES_DYNAMIC) {
+                    pops++;
+                } else if (ip->opcode != DICE_OPC_CUSTOM && !eval_check_dice_sides(ctx, ip->b)) {
+                    return false;
+                }
+                break;
+            default:
+                return validate_fail(ctx, "unknown instruction");
+        }
+        
+        if (depth < pops) return validate_fail(ctx, "stack underflow");
+        depth = depth - pops + 1;
+        if (depth > program->max_stack) return validate_fail(ctx, "stack overflow");
+    }
+    if (depth != 1) return validate_fail(ctx, "unbalanced stack");
+    
+    return true;
+}
+
+// =============================================================================
+// Program Interpreter
+// =============================================================================
+
+#define PROGRAM_LOCAL_STACK 32
+
+static const dice_custom_die_t* program_bind_die(dice_context_t *ctx, const char *strings,
+                                                 const dice_program_die_t *die) {
+    const dice_custom_die_registry_t *registry = &ctx->custom_dice;
+    
+    // Fast path: the registry is unchanged since compilation, so the bound
+    // slot still holds the same die
+    if (die->registry_generation == registry->generation && die->registry_index < registry->count) {
+        return &registry->dice[die->registry_index];
+    }
+    return dice_lookup_custom_die(ctx, strings + die->name);
+}
+
+static bool program_roll_custom(dice_context_t *ctx, const dice_program_t *program,
+                                const dice_program_die_t *die, int64_t count, int64_t *sum) {
+    const char *strings = DICE_PROGRAM_SECTION(program, program->string_offset, char);
+    bool full_trace = ctx->trace_level == DICE_TRACE_FULL;
+    bool record = ctx->results != NULL;
+    uint64_t picks[EVAL_ROLL_BLOCK];
+    *sum = 0;
+    
+    if (die->name) {
+        const dice_custom_die_t *custom_die = program_bind_die(ctx, strings, die);
+        if (!custom_die) {
+            snprintf(ctx->error.message, sizeof(ctx->error.message),
+                    "Unknown custom die: %s", strings + die->name);
+            ctx->error.has_error = true;
+            return false;
+        }
+        
+        if (record) results_begin_op(ctx, (int)custom_die->side_count);
+        for (int64_t done = 0; done < count; ) {
+            size_t n = count - done < EVAL_ROLL_BLOCK ? (size_t)(count - done) : EVAL_ROLL_BLOCK;
+            if (!eval_pick_custom_sides(ctx, custom_die->side_count, custom_die->total_weight,
+                                        custom_die->alias, picks, n)) {
+                return false;
+            }
+            for (size_t i = 0; i < n; i++) {
+                int64_t roll_value = custom_die->sides[picks[i]].value;
+                if (full_trace) trace_atomic_roll(ctx, (int)custom_die->side_count, (int)roll_value);
+                if (record) results_add_value(ctx, roll_value, true);
+                *sum += roll_value;
+            }
+            done += (int64_t)n;
+        }
+        trace_summary_add(ctx, (uint64_t)count, 0, 0);
+        return true;
+    }
+    
+    const dice_program_side_t *sides =
+        DICE_PROGRAM_SECTION(program, program->side_offset, dice_program_side_t) + die->first_side;
+    const dice_alias_entry_t *alias = die->total_weight ?
+        DICE_PROGRAM_SECTION(program, program->alias_offset, dice_alias_entry_t) + die->first_side : NULL;
+    if (record) results_begin_op(ctx, (int)die->side_count);
+    for (int64_t done = 0; done < count; ) {
+        size_t n = count - done < EVAL_ROLL_BLOCK ? (size_t)(count - done) : EVAL_ROLL_BLOCK;
+        if (!eval_pick_custom_sides(ctx, die->side_count, die->total_weight, alias, picks, n)) return false;
+        for (size_t i = 0; i < n; i++) {
+            int64_t roll_value = sides[picks[i]].value;
+            if (full_trace) trace_atomic_roll(ctx, (int)die->side_count, (int)roll_value);
+            if (record) results_add_value(ctx, roll_value, true);
+            *sum += roll_value;
+        }
+        done += (int64_t)n;
+    }
+    trace_summary_add(ctx, (uint64_t)count, 0, 0);
+    return true;
+}
+
+static void program_unpack_selection(const dice_program_t *program, uint32_t index,
+                                     dice_selection_t *selection) {
+    const dice_program_selection_t *sel =
+        DICE_PROGRAM_SECTION(program, program->selection_offset, dice_program_selection_t) + index;
+    const char *strings = DICE_PROGRAM_SECTION(program, program->string_offset, char);
+    
+    selection->count = sel->count;
+    selection->select_high = sel->select_high;
+    selection->is_drop_operation = sel->is_drop_operation;
+    selection->original_syntax = sel->syntax ? strings + sel->syntax : NULL;
+    selection->is_conditional = sel->is_conditional;
+    selection->comparison_op = (dice_binary_op_t)sel->comparison_op;
+    selection->comparison_value = sel->comparison_value;
+    selection->is_reroll = sel->is_reroll;
+}
+
+static dice_eval_result_t program_run(dice_context_t *ctx, const dice_program_t *program) {
+    dice_eval_result_t result = {0, false};
+    
+    if (!ctx || !program) return result;
+    
+    if (program->magic != DICE_PROGRAM_MAGIC || program->version != DICE_PROGRAM_VERSION ||
+        program->instr_count == 0) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message), "Invalid compiled program");
+        ctx->error.has_error = true;
+        return result;
+    }
+    
+    // Programs compiled or loaded under a looser policy; a tree within the
+    // limits never needs more instructions than nodes or a deeper stack
+    if (ctx->policy.max_nodes > 0 && program->instr_count > (uint32_t)ctx->policy.max_nodes) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Expression exceeds node limit of %d", ctx->policy.max_nodes);
+        ctx->error.has_error = true;
+        return result;
+    }
+    if (ctx->policy.max_depth > 0 && program->max_stack > (uint32_t)ctx->policy.max_depth + 1) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Expression exceeds nesting depth limit of %d", ctx->policy.max_depth);
+        ctx->error.has_error = true;
+        return result;
+    }
+    
+    int64_t local_stack[PROGRAM_LOCAL_STACK];
+    int64_t *stack = local_stack;
+    if (program->max_stack > PROGRAM_LOCAL_STACK) {
+        stack = arena_alloc_scratch(ctx, program->max_stack * sizeof(int64_t));
+        if (!stack) return result;
+    }
+    
+    size_t sp = 0;
+    const dice_instr_t *ip = DICE_PROGRAM_SECTION(program, program->instr_offset, dice_instr_t);
+    const dice_instr_t *end = ip + program->instr_count;
+    
+    for (; ip < end; ip++) {
+        switch ((dice_opcode_t)ip->opcode) {
+            case DICE_OPC_PUSH:
+                stack[sp++] = ip->a;
+                break;
+            
+            case DICE_OPC_ADD:
+                sp--;
+                stack[sp - 1] = stack[sp - 1] + stack[sp];
+                break;
+            
+            case DICE_OPC_SUB:
+                sp--;
+                stack[sp - 1] = stack[sp - 1] - stack[sp];
+                break;
+            
+            case DICE_OPC_MUL:
+                sp--;
+                stack[sp - 1] = stack[sp - 1] * stack[sp];
+                break;
+            
+            case DICE_OPC_DIV:
+                sp--;
+                if (stack[sp] == 0) {
+                    snprintf(ctx->error.message, sizeof(ctx->error.message),
+                            "Division by zero");
+                    ctx->error.has_error = true;
+                    return result;
+                }
+                stack[sp - 1] = stack[sp - 1] / stack[sp];
+                break;
+            
+            case DICE_OPC_ROLL:
+            case DICE_OPC_FILTER:
+            case DICE_OPC_CUSTOM:
+            case DICE_OPC_EXPLODE:
+            case DICE_OPC_POOL: {
+                int64_t count = ip->a;
+                int64_t sides = ip->b;
+                
+                if (ip->flags & DICE_INSTR_SIDES_DYNAMIC) sides = stack[--sp];
+                if (ip->flags & DICE_INSTR_COUNT_DYNAMIC) count = stack[--sp];
+                
+                // Constant operands too: the program may predate this context's policy
+                if (!eval_check_dice_count(ctx, count)) return result;
+                if (ip->opcode != DICE_OPC_CUSTOM && !eval_check_dice_sides(ctx, sides)) {
+                    return result;
+                }
+                
+                int64_t sum = 0;
+                if (ip->opcode == DICE_OPC_ROLL) {
+                    sum = eval_roll_basic(ctx, count, (int)sides);
+                } else if (ip->opcode == DICE_OPC_FILTER || ip->opcode == DICE_OPC_POOL) {
+                    dice_selection_t selection;
+                    program_unpack_selection(program, ip->aux, &selection);
+                    sum = ip->opcode == DICE_OPC_POOL ?
+                        evaluate_dice_pool(ctx, count, (int)sides, &selection) :
+                        evaluate_dice_filter(ctx, count, (int)sides, &selection);
+                } else if (ip->opcode == DICE_OPC_EXPLODE) {
+                    sum = eval_roll_exploding(ctx, count, (int)sides, (int64_t)ip->aux,
+                                              (ip->flags & DICE_INSTR_COMPOUNDING) != 0);
+                } else {
+                    const dice_program_die_t *die =
+                        DICE_PROGRAM_SECTION(program, program->die_offset, dice_program_die_t) + ip->aux;
+                    program_roll_custom(ctx, program, die, count, &sum);
+                }
+                if (ctx->error.has_error) return result;
+                
+                stack[sp++] = sum;
+                break;
+            }
+            
+            default:
+                snprintf(ctx->error.message, sizeof(ctx->error.message),
+                        "Invalid instruction in compiled program");
+                ctx->error.has_error = true;
+                return result;
+        }
+    }
+    
+    result.value = stack[sp - 1];
+    result.success = true;
+    return result;
+}
+
+dice_eval_result_t dice_program_evaluate(dice_context_t *ctx, const dice_program_t *program) {
+#ifdef DICE_ENABLE_COUNTERS
+    if (!ctx) return program_run(ctx, program);
+    
+    uint64_t start = counters_now_ns();
+    dice_eval_result_t result = program_run(ctx, program);
+    DICE_COUNT(ctx, evaluate_calls, 1);
+    DICE_COUNT(ctx, evaluate_ns, counters_now_ns() - start);
+    return result;
+#else
+    return program_run(ctx, program);
+#endif
+}
+
+int dice_program_evaluate_batch(dice_context_t *ctx, const dice_program_t *program,
+                                size_t n, int64_t *out) {
+    if (!ctx || !program || (n > 0 && !out)) return -1;
+    
+    dice_trace_level_t saved_level = ctx->trace_level;
+    ctx->trace_level = DICE_TRACE_OFF;
+    
+    // The program does not live in the arena, so every sample's scratch is reclaimed
+    size_t arena_mark = dice_arena_mark(ctx);
+    int status = 0;
+    
+    for (size_t i = 0; i < n; i++) {
+        dice_eval_result_t result = dice_program_evaluate(ctx, program);
+        dice_arena_rewind(ctx, arena_mark);
+        
+        if (!result.success) {
+            status = -1;
+            break;
+        }
+        out[i] = result.value;
+    }
+    
+    ctx->trace_level = saved_level;
+    return status;
+}
+
+int dice_program_evaluate_stats(dice_context_t *ctx, const dice_program_t *program,
+                                size_t n, dice_stats_t *stats) {
+    if (!ctx || !program || !stats) return -1;
+    
+    dice_trace_level_t saved_level = ctx->trace_level;
+    ctx->trace_level = DICE_TRACE_OFF;
+    
+    size_t arena_mark = dice_arena_mark(ctx);
+    int status = 0;
+    
+    for (size_t i = 0; i < n; i++) {
+        dice_eval_result_t result = dice_program_evaluate(ctx, program);
+        dice_arena_rewind(ctx, arena_mark);
+        
+        if (!result.success) {
+            status = -1;
+            break;
+        }
+        dice_stats_add(stats, result.value);
+    }
+    
+    ctx->trace_level = saved_level;
+    return status;
+}
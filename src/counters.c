@@ -0,0 +1,65 @@
+#include "dice.h"
+#include "internal.h"
+#include <string.h>
+
+#ifdef DICE_ENABLE_COUNTERS
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#endif
+
+// =============================================================================
+// Performance Counters
+// =============================================================================
+
+// Counters are bumped in place through DICE_COUNT() in the modules that do
+// the work; with DICE_ENABLE_COUNTERS undefined the macros expand to nothing
+// and this file only provides the stub API.
+
+#ifdef DICE_ENABLE_COUNTERS
+uint64_t counters_now_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+#endif
+
+bool dice_counters_enabled(void) {
+#ifdef DICE_ENABLE_COUNTERS
+    return true;
+#else
+    return false;
+#endif
+}
+
+int dice_counters_get(const dice_context_t *ctx, dice_counters_t *out) {
+    if (!out) return -1;
+    memset(out, 0, sizeof(*out));
+    if (!ctx) return -1;
+
+#ifdef DICE_ENABLE_COUNTERS
+    *out = ctx->counters;
+    out->arena_used = ctx->arena_used;
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+void dice_counters_reset(dice_context_t *ctx) {
+    if (!ctx) return;
+
+#ifdef DICE_ENABLE_COUNTERS
+    memset(&ctx->counters, 0, sizeof(ctx->counters));
+    ctx->counters.arena_high_water = ctx->arena_used;
+#endif
+}
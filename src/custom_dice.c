@@ -4,6 +4,10 @@
 #include <string.h>
 #include <stdio.h>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 // =============================================================================
 // Custom Dice Implementation
 // =============================================================================
@@ -25,17 +29,199 @@ dice_custom_side_t dice_custom_side(int64_t value, const char *label) {
         }
     }
     
+    side.weight = 1;
+    return side;
+}
+
+dice_custom_side_t dice_custom_weighted_side(int64_t value, const char *label, uint32_t weight) {
+    dice_custom_side_t side = dice_custom_side(value, label);
+    side.weight = weight ? weight : 1;
     return side;
 }
 
+// =============================================================================
+// Weighted Sides (Vose alias method)
+// =============================================================================
+
+#define ALIAS_LIST_END UINT32_MAX
+
+static uint64_t side_weight(const dice_custom_side_t *side) {
+    return side->weight ? side->weight : 1;
+}
+
+static void alias_push(dice_alias_entry_t *table, uint32_t *head, uint32_t i) {
+    table[i].alias = *head;
+    *head = i;
+}
+
+static uint32_t alias_pop(dice_alias_entry_t *table, uint32_t *head) {
+    uint32_t i = *head;
+    *head = table[i].alias;
+    return i;
+}
+
+// Integer Vose construction: every side's weight is scaled by side_count so
+// each column holds exactly total_weight, making the table exact. The small
+// and large work lists are threaded through the alias fields, which are only
+// assigned once a side leaves its list, so no scratch memory is needed.
+static void alias_build(const dice_custom_die_t *die, dice_alias_entry_t *table) {
+    uint64_t column = die->total_weight;
+    uint32_t small = ALIAS_LIST_END;
+    uint32_t large = ALIAS_LIST_END;
+    
+    for (uint32_t i = 0; i < (uint32_t)die->side_count; i++) {
+        table[i].keep = side_weight(&die->sides[i]) * die->side_count;
+        table[i].reserved = 0;
+        alias_push(table, table[i].keep < column ? &small : &large, i);
+    }
+    
+    while (small != ALIAS_LIST_END && large != ALIAS_LIST_END) {
+        uint32_t l = alias_pop(table, &small);
+        uint32_t g = large;
+        table[l].alias = g;
+        table[g].keep -= column - table[l].keep;
+        if (table[g].keep < column) {
+            alias_pop(table, &large);
+            alias_push(table, &small, g);
+        }
+    }
+    
+    // Whatever remains fills its column exactly
+    while (large != ALIAS_LIST_END) {
+        uint32_t g = alias_pop(table, &large);
+        table[g].keep = column;
+        table[g].alias = g;
+    }
+    while (small != ALIAS_LIST_END) {
+        uint32_t l = alias_pop(table, &small);
+        table[l].keep = column;
+        table[l].alias = l;
+    }
+}
+
+bool custom_die_init_weights(dice_context_t *ctx, dice_custom_die_t *die, bool use_arena) {
+    die->total_weight = 0;
+    die->alias = NULL;
+    if (die->side_count == 0) return true;
+    
+    uint64_t first = side_weight(&die->sides[0]);
+    uint64_t total = 0;
+    bool uniform = true;
+    for (size_t i = 0; i < die->side_count; i++) {
+        uint64_t weight = side_weight(&die->sides[i]);
+        uniform = uniform && weight == first;
+        total += weight;
+    }
+    
+    // Equal weights roll exactly like an unweighted die
+    if (uniform) return true;
+    
+    // A draw spans side_count * total_weight values
+    if (die->side_count >= ALIAS_LIST_END || total > UINT64_MAX / die->side_count) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Custom die weights too large");
+        ctx->error.has_error = true;
+        return false;
+    }
+    
+    size_t size = die->side_count * sizeof(dice_alias_entry_t);
+    dice_alias_entry_t *table = use_arena ? arena_alloc_scratch(ctx, size) : malloc(size);
+    if (!table) {
+        if (!use_arena) {
+            snprintf(ctx->error.message, sizeof(ctx->error.message),
+                    "Failed to allocate memory for custom die weights");
+            ctx->error.has_error = true;
+        }
+        return false;
+    }
+    
+    die->total_weight = total;
+    alias_build(die, table);
+    die->alias = table;
+    return true;
+}
+
+// Generations come from one process-wide counter, so a binding recorded
+// against one registry can never match another registry (or a later state of
+// the same one) by accident
+static uint64_t registry_next_generation(void) {
+#if defined(__GNUC__)
+    static uint64_t counter;
+    return __atomic_add_fetch(&counter, 1, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    static volatile __int64 counter;
+    return (uint64_t)_InterlockedIncrement64(&counter);
+#else
+    static uint64_t counter;
+    return ++counter;
+#endif
+}
+
+uint64_t hash_fnv1a(const char *key, size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)key[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Index slot holding name, or the empty slot where it would go
+static size_t registry_find_slot(const dice_custom_die_registry_t *registry, const char *name) {
+    size_t mask = registry->index_capacity - 1;
+    size_t slot = (size_t)hash_fnv1a(name, strlen(name)) & mask;
+    
+    while (registry->index[slot] != 0 &&
+           strcmp(registry->dice[registry->index[slot] - 1].name, name) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Keep at least two index slots per die so probe chains stay short
+static bool registry_reserve_index(dice_custom_die_registry_t *registry, size_t dice_count) {
+    if (registry->index_capacity >= dice_count * 2) return true;
+    
+    size_t capacity = registry->index_capacity ? registry->index_capacity : 16;
+    while (capacity < dice_count * 2) capacity <<= 1;
+    
+    uint32_t *index = calloc(capacity, sizeof(uint32_t));
+    if (!index) return false;
+    
+    free(registry->index);
+    registry->index = index;
+    registry->index_capacity = capacity;
+    for (size_t i = 0; i < registry->count; i++) {
+        registry->index[registry_find_slot(registry, registry->dice[i].name)] = (uint32_t)(i + 1);
+    }
+    return true;
+}
+
+static void free_die_contents(dice_custom_die_t *die) {
+    free((void*)die->name);
+    
+    // Free labels from sides
+    for (size_t j = 0; j < die->side_count; j++) {
+        free((void*)die->sides[j].label);
+    }
+    free(die->sides);
+    free(die->alias);
+}
+
+static bool registry_unshare(dice_context_t *ctx);
+
 int dice_register_custom_die(dice_context_t *ctx, const char *name, 
                              const dice_custom_side_t *sides, size_t side_count) {
     if (!ctx || !name || !sides || side_count == 0) return -1;
     
+    if (ctx->registry_shared && !registry_unshare(ctx)) return -1;
+    
+    dice_custom_die_registry_t *registry = &ctx->custom_dice;
+    
     // Check if we need to expand the registry
-    if (ctx->custom_dice.count >= ctx->custom_dice.capacity) {
-        size_t new_capacity = ctx->custom_dice.capacity == 0 ? 4 : ctx->custom_dice.capacity * 2;
-        dice_custom_die_t *new_dice = realloc(ctx->custom_dice.dice, 
+    if (registry->count >= registry->capacity) {
+        size_t new_capacity = registry->capacity == 0 ? 4 : registry->capacity * 2;
+        dice_custom_die_t *new_dice = realloc(registry->dice, 
                                               new_capacity * sizeof(dice_custom_die_t));
         if (!new_dice) {
             snprintf(ctx->error.message, sizeof(ctx->error.message),
@@ -43,17 +229,26 @@ int dice_register_custom_die(dice_context_t *ctx, const char *name,
             ctx->error.has_error = true;
             return -1;
         }
-        ctx->custom_dice.dice = new_dice;
-        ctx->custom_dice.capacity = new_capacity;
+        registry->dice = new_dice;
+        registry->capacity = new_capacity;
+        // The array may have moved; stale bindings must not survive a later failure
+        registry->generation = registry_next_generation();
+    }
+    if (!registry_reserve_index(registry, registry->count + 1)) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Failed to allocate memory for custom dice registry");
+        ctx->error.has_error = true;
+        return -1;
     }
     
     // Create the custom die
-    dice_custom_die_t *die = &ctx->custom_dice.dice[ctx->custom_dice.count];
-    die->name = strdup(name);
-    die->side_count = side_count;
-    die->sides = malloc(side_count * sizeof(dice_custom_side_t));
-    if (!die->sides) {
-        free((void*)die->name);
+    dice_custom_die_t die;
+    die.name = strdup(name);
+    die.side_count = side_count;
+    die.sides = malloc(side_count * sizeof(dice_custom_side_t));
+    if (!die.name || !die.sides) {
+        free((void*)die.name);
+        free(die.sides);
         snprintf(ctx->error.message, sizeof(ctx->error.message),
                 "Failed to allocate memory for custom die sides");
         ctx->error.has_error = true;
@@ -62,39 +257,120 @@ int dice_register_custom_die(dice_context_t *ctx, const char *name,
     
     // Copy sides
     for (size_t i = 0; i < side_count; i++) {
-        die->sides[i] = dice_custom_side(sides[i].value, sides[i].label);
+        die.sides[i] = dice_custom_weighted_side(sides[i].value, sides[i].label, sides[i].weight);
+    }
+    if (!custom_die_init_weights(ctx, &die, false)) {
+        free_die_contents(&die);
+        return -1;
     }
     
-    ctx->custom_dice.count++;
+    // Re-registering a name replaces the die in its existing slot
+    size_t slot = registry_find_slot(registry, name);
+    if (registry->index[slot] != 0) {
+        dice_custom_die_t *existing = &registry->dice[registry->index[slot] - 1];
+        free_die_contents(existing);
+        *existing = die;
+    } else {
+        registry->dice[registry->count] = die;
+        registry->index[slot] = (uint32_t)(++registry->count);
+    }
     
+    // Invalidates every binding made against the previous registry state
+    registry->generation = registry_next_generation();
     return 0;
 }
 
 const dice_custom_die_t* dice_lookup_custom_die(const dice_context_t *ctx, const char *name) {
-    if (!ctx || !name) return NULL;
+    if (!ctx || !name || ctx->custom_dice.index_capacity == 0) return NULL;
     
-    for (size_t i = 0; i < ctx->custom_dice.count; i++) {
-        if (strcmp(ctx->custom_dice.dice[i].name, name) == 0) {
-            return &ctx->custom_dice.dice[i];
-        }
-    }
+    const dice_custom_die_registry_t *registry = &ctx->custom_dice;
+    uint32_t entry = registry->index[registry_find_slot(registry, name)];
+    return entry ? &registry->dice[entry - 1] : NULL;
+}
+
+const dice_custom_die_t* registry_resolve(const dice_context_t *ctx, const char *name,
+                                          const dice_custom_die_t *bound, uint64_t generation) {
+    if (bound && generation == ctx->custom_dice.generation) return bound;
+    return dice_lookup_custom_die(ctx, name);
+}
+
+typedef struct {
+    const dice_context_t *ctx;
+    size_t unbound;
+} binder_t;
+
+static void bind_dice_op(const dice_ast_node_t *node, void *user_data) {
+    binder_t *binder = user_data;
+    if (!node->data.dice_op.custom_name) return;
     
-    return NULL;
+    // The tree handed to dice_bind_custom_dice is mutable; visitors are const
+    dice_ast_node_t *mutable_node = (dice_ast_node_t*)node;
+    const dice_custom_die_t *die = dice_lookup_custom_die(binder->ctx, node->data.dice_op.custom_name);
+    mutable_node->data.dice_op.bound_die = die;
+    mutable_node->data.dice_op.bound_generation = die ? binder->ctx->custom_dice.generation : 0;
+    if (!die) binder->unbound++;
+}
+
+int dice_bind_custom_dice(const dice_context_t *ctx, dice_ast_node_t *node) {
+    if (!ctx || !node) return -1;
+    
+    binder_t binder = {ctx, 0};
+    dice_ast_visitor_t visitor;
+    memset(&visitor, 0, sizeof(visitor));
+    visitor.visit_dice_op = bind_dice_op;
+    visitor.user_data = &binder;
+    if (!ast_walk(node, &visitor)) return -1;
+    return (int)binder.unbound;
 }
 
 void dice_clear_custom_dice(dice_context_t *ctx) {
     if (!ctx) return;
     
-    for (size_t i = 0; i < ctx->custom_dice.count; i++) {
-        dice_custom_die_t *die = &ctx->custom_dice.dice[i];
-        free((void*)die->name);
-        
-        // Free labels from sides
-        for (size_t j = 0; j < die->side_count; j++) {
-            free((void*)die->sides[j].label);
-        }
-        free(die->sides);
+    if (ctx->registry_shared) {
+        // Detach from the template's registry, which is never written
+        registry_release(ctx);
+        ctx->custom_dice.generation = registry_next_generation();
+        return;
     }
     
-    ctx->custom_dice.count = 0;
-}
\ No newline at end of file
+    dice_custom_die_registry_t *registry = &ctx->custom_dice;
+    for (size_t i = 0; i < registry->count; i++) {
+        free_die_contents(&registry->dice[i]);
+    }
+    if (registry->index) {
+        memset(registry->index, 0, registry->index_capacity * sizeof(uint32_t));
+    }
+    
+    registry->count = 0;
+    registry->generation = registry_next_generation();
+}
+
+void registry_release(dice_context_t *ctx) {
+    if (!ctx->registry_shared) {
+        dice_clear_custom_dice(ctx);
+        free(ctx->custom_dice.dice);
+        free(ctx->custom_dice.index);
+    }
+    memset(&ctx->custom_dice, 0, sizeof(ctx->custom_dice));
+    ctx->registry_shared = false;
+}
+
+void registry_share(dice_context_t *ctx, const dice_custom_die_registry_t *frozen) {
+    registry_release(ctx);
+    ctx->custom_dice = *frozen;
+    ctx->registry_shared = true;
+}
+
+// Copy-on-write: a clone's first change to its dice starts from a private
+// copy of the template's registry
+static bool registry_unshare(dice_context_t *ctx) {
+    dice_custom_die_registry_t shared = ctx->custom_dice;
+    memset(&ctx->custom_dice, 0, sizeof(ctx->custom_dice));
+    ctx->registry_shared = false;
+    
+    for (size_t i = 0; i < shared.count; i++) {
+        const dice_custom_die_t *die = &shared.dice[i];
+        if (dice_register_custom_die(ctx, die->name, die->sides, die->side_count) != 0) return false;
+    }
+    return true;
+}
@@ -29,6 +29,7 @@ dice_context_t* dice_context_create(size_t arena_size, dice_features_t features)
     
     // Set default policy
     ctx->policy = dice_default_policy();
+    ctx->trace_level = DICE_TRACE_FULL;
     
     // Set default RNG
     dice_rng_vtable_t rng = dice_create_system_rng(0);
@@ -42,9 +43,9 @@ dice_context_t* dice_context_create(size_t arena_size, dice_features_t features)
     // Register default FATE dice if FATE feature is enabled
     if (features & DICE_FEATURE_FATE) {
         dice_custom_side_t fate_sides[] = {
-            {-1, "-"},
-            {0, " "},
-            {1, "+"}
+            {-1, "-", 1},
+            {0, " ", 1},
+            {1, "+", 1}
         };
         if (dice_register_custom_die(ctx, "F", fate_sides, 3) != 0) {
             // If registration fails, clean up and return NULL
@@ -64,19 +65,24 @@ void dice_context_destroy(dice_context_t *ctx) {
         ctx->rng.cleanup(ctx->rng.state);
     }
     
-    // Cleanup custom dice registry
-    dice_clear_custom_dice(ctx);
-    free(ctx->custom_dice.dice);
+    // Cleanup custom dice registry (a template's shared registry is left alone)
+    registry_release(ctx);
     
-    free(ctx->arena);
-    free(ctx);
+    // Deliver and free the packed trace
+    trace_release(ctx);
+    
+    arena_release(ctx);
+    if (!ctx->external_arena) free(ctx->arena);
+    
+    dice_context_template_release(ctx->origin);
+    if (!ctx->external_context) free(ctx);
 }
 
 void dice_context_reset(dice_context_t *ctx) {
     if (!ctx) return;
     
-    // Reset arena
-    ctx->arena_used = 0;
+    // Reset arena (growth chunks are kept for reuse)
+    dice_arena_rewind(ctx, 0);
     
     // Clear error
     ctx->error.has_error = false;
@@ -84,10 +90,14 @@ void dice_context_reset(dice_context_t *ctx) {
     ctx->error.message[0] = '\0';
     
     // Clear trace
-    memset(&ctx->trace, 0, sizeof(ctx->trace));
+    dice_clear_trace(ctx);
     
-    // Clear custom dice registry
-    dice_clear_custom_dice(ctx);
+    // Clear custom dice registry; a clone goes back to its template's dice
+    if (ctx->origin) {
+        registry_share(ctx, template_registry(ctx->origin));
+    } else {
+        dice_clear_custom_dice(ctx);
+    }
 }
 
 int dice_context_set_rng(dice_context_t *ctx, const dice_rng_vtable_t *rng_vtable) {
@@ -139,6 +149,8 @@ dice_policy_t dice_default_policy(void) {
         .max_dice_count = 1000,
         .max_sides = 1000000,
         .max_explosion_depth = 10,
+        .max_depth = 256,
+        .max_nodes = 100000,
         .allow_negative_dice = false,
         .strict_mode = false
     };
@@ -150,9 +162,70 @@ const char* dice_version(void) {
 }
 
 // =============================================================================
-// Simple Wrapper Functions (No Static State)
+// Simple Wrapper Functions (Thread-Local Context)
 // =============================================================================
 
+// Each thread lazily creates one context with a xoshiro256++ engine and reuses
+// it for every simple-API call, rewinding the arena instead of recreating it,
+// so steady-state calls make no heap allocations. Compilers without
+// thread-local storage fall back to a temporary context per call.
+
+#if defined(_MSC_VER)
+#define DICE_THREAD_LOCAL __declspec(thread)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#define DICE_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define DICE_THREAD_LOCAL __thread
+#endif
+
+#define SIMPLE_ARENA_SIZE 4096
+
+static dice_context_t* simple_context_create(void) {
+    dice_context_t *ctx = dice_context_create(SIMPLE_ARENA_SIZE, DICE_FEATURE_ALL);
+    if (!ctx) return NULL;
+    
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(0);
+    if (!rng.state) {
+        dice_context_destroy(ctx);
+        return NULL;
+    }
+    dice_context_set_rng(ctx, &rng);
+    dice_context_set_arena_growth(ctx, SIMPLE_ARENA_SIZE);
+    ctx->trace_level = DICE_TRACE_OFF;
+    return ctx;
+}
+
+#ifdef DICE_THREAD_LOCAL
+static DICE_THREAD_LOCAL dice_context_t *simple_ctx = NULL;
+#endif
+
+static dice_context_t* simple_acquire(void) {
+#ifdef DICE_THREAD_LOCAL
+    if (!simple_ctx) simple_ctx = simple_context_create();
+    return simple_ctx;
+#else
+    return simple_context_create();
+#endif
+}
+
+// Leave the context as a fresh call expects it; custom dice (FATE) are kept
+static void simple_release(dice_context_t *ctx) {
+#ifdef DICE_THREAD_LOCAL
+    dice_arena_rewind(ctx, 0);
+    memset(&ctx->trace, 0, sizeof(ctx->trace));
+    dice_clear_error(ctx);
+#else
+    dice_context_destroy(ctx);
+#endif
+}
+
+void dice_thread_cleanup(void) {
+#ifdef DICE_THREAD_LOCAL
+    dice_context_destroy(simple_ctx);
+    simple_ctx = NULL;
+#endif
+}
+
 int dice_roll(int sides) {
     return dice_roll_multiple(1, sides);
 }
@@ -160,94 +233,130 @@ int dice_roll(int sides) {
 int dice_roll_multiple(int count, int sides) {
     if (count <= 0 || sides <= 0) return -1;
     
-    // Create temporary context for this operation
-    dice_context_t *ctx = dice_context_create(1024, DICE_FEATURE_BASIC);
+    dice_context_t *ctx = simple_acquire();
     if (!ctx) return -1;
     
-    // Use time-based seed for randomness
-    dice_rng_vtable_t rng = dice_create_system_rng(0);
-    dice_context_set_rng(ctx, &rng);
-    
+    int block[EVAL_ROLL_BLOCK];
     int sum = 0;
-    for (int i = 0; i < count; i++) {
-        int roll = ctx->rng.roll(ctx->rng.state, sides);
-        if (roll < 0) {
-            dice_context_destroy(ctx);
-            return -1;
+    for (int done = 0; done < count; ) {
+        size_t n = count - done < EVAL_ROLL_BLOCK ? (size_t)(count - done) : EVAL_ROLL_BLOCK;
+        if (rng_roll_n(ctx, sides, block, n) != 0) {
+            sum = -1;
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            sum += block[i];
         }
-        sum += roll;
+        done += (int)n;
     }
     
-    dice_context_destroy(ctx);
+    simple_release(ctx);
     return sum;
 }
 
 int dice_roll_individual(int count, int sides, int *results) {
     if (count <= 0 || sides <= 0 || !results) return -1;
     
-    // Create temporary context for this operation
-    dice_context_t *ctx = dice_context_create(1024, DICE_FEATURE_BASIC);
+    dice_context_t *ctx = simple_acquire();
     if (!ctx) return -1;
     
-    // Use time-based seed for randomness
-    dice_rng_vtable_t rng = dice_create_system_rng(0);
-    dice_context_set_rng(ctx, &rng);
-    
-    int sum = 0;
-    for (int i = 0; i < count; i++) {
-        int roll = ctx->rng.roll(ctx->rng.state, sides);
-        if (roll < 0) {
-            dice_context_destroy(ctx);
-            return -1;
+    int sum = -1;
+    if (rng_roll_n(ctx, sides, results, (size_t)count) == 0) {
+        sum = 0;
+        for (int i = 0; i < count; i++) {
+            sum += results[i];
         }
-        results[i] = roll;
-        sum += roll;
     }
     
-    dice_context_destroy(ctx);
+    simple_release(ctx);
     return sum;
 }
 
+static int simple_roll_expression(dice_context_t *ctx, const char *dice_notation) {
+    dice_eval_result_t result = dice_roll_expression(ctx, dice_notation);
+    
+    int ret_val = -1;
+    if (result.success && !dice_has_error(ctx)) {
+        ret_val = (int)result.value;
+    }
+    return ret_val;
+}
+
 int dice_roll_notation(const char *dice_notation) {
     if (!dice_notation) return -1;
     
-    // Create temporary context for this operation
-    dice_context_t *ctx = dice_context_create(4096, DICE_FEATURE_ALL);
+    dice_context_t *ctx = simple_acquire();
     if (!ctx) return -1;
     
-    // Use time-based seed for randomness
-    dice_rng_vtable_t rng = dice_create_system_rng(0);
-    dice_context_set_rng(ctx, &rng);
+    int ret_val = simple_roll_expression(ctx, dice_notation);
+    simple_release(ctx);
+    return ret_val;
+}
+
+int dice_roll_batch(int sides, size_t n, int *out) {
+    if (sides <= 0 || (n > 0 && !out)) return -1;
     
-    dice_eval_result_t result = dice_roll_expression(ctx, dice_notation);
+    dice_context_t *ctx = simple_acquire();
+    if (!ctx) return -1;
     
-    int ret_val = -1;
-    if (result.success && !dice_has_error(ctx)) {
-        ret_val = (int)result.value;
+    int status = rng_roll_n(ctx, sides, out, n) == 0 ? 0 : -1;
+    simple_release(ctx);
+    return status;
+}
+
+int dice_roll_notation_batch(const char *dice_notation, size_t n, int64_t *out) {
+    if (!dice_notation || (n > 0 && !out)) return -1;
+    
+    dice_context_t *ctx = simple_acquire();
+    if (!ctx) return -1;
+    
+    dice_ast_node_t *ast = dice_parse(ctx, dice_notation);
+    dice_program_t *program = NULL;
+    if (ast && dice_optimize(ctx, ast) == 0) {
+        program = dice_compile(ctx, ast);
     }
     
-    dice_context_destroy(ctx);
-    return ret_val;
+    int status = -1;
+    if (program) {
+        // The program is self-contained, so the parse scratch is reused per sample
+        dice_arena_rewind(ctx, 0);
+        status = dice_program_evaluate_batch(ctx, program, n, out);
+        dice_program_destroy(program);
+    }
+    
+    simple_release(ctx);
+    return status;
+}
+
+void dice_thread_seed(uint64_t seed) {
+    dice_context_t *ctx = simple_acquire();
+    if (!ctx) return;
+    
+    ctx->rng.init(ctx->rng.state, seed);
+    simple_release(ctx);
 }
 
 int dice_roll_quick(const char *dice_notation, uint32_t seed) {
     if (!dice_notation) return -1;
     
-    // Create temporary context for this operation
-    dice_context_t *ctx = dice_context_create(4096, DICE_FEATURE_ALL);
+    dice_context_t *ctx = simple_acquire();
     if (!ctx) return -1;
     
-    // Use provided seed or time-based for randomness
-    dice_rng_vtable_t rng = dice_create_system_rng(seed);
-    dice_context_set_rng(ctx, &rng);
+    if (seed == 0) {
+        int ret_val = simple_roll_expression(ctx, dice_notation);
+        simple_release(ctx);
+        return ret_val;
+    }
     
-    dice_eval_result_t result = dice_roll_expression(ctx, dice_notation);
+    // Seeded rolls run on a temporarily reseeded engine; the thread's own
+    // stream resumes afterwards
+    uint64_t saved[4];
+    rng_xoshiro_get_state(&ctx->rng, saved);
+    ctx->rng.init(ctx->rng.state, seed);
     
-    int ret_val = -1;
-    if (result.success && !dice_has_error(ctx)) {
-        ret_val = (int)result.value;
-    }
+    int ret_val = simple_roll_expression(ctx, dice_notation);
     
-    dice_context_destroy(ctx);
+    rng_xoshiro_set_state(&ctx->rng, saved);
+    simple_release(ctx);
     return ret_val;
-}
\ No newline at end of file
+}
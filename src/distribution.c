@@ -0,0 +1,847 @@
+#include "dice.h"
+#include "internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// =============================================================================
+// Exact Distribution Engine
+// =============================================================================
+
+// Largest dense support the engine will materialize
+#define DIST_MAX_SUPPORT ((size_t)1 << 26)
+
+// Below this many multiply-adds direct convolution beats the FFT
+#define DIST_DIRECT_CONVOLUTION_LIMIT ((size_t)1 << 15)
+
+// Upper bound on keep/drop dynamic programming work (state transitions)
+#define DIST_SELECTION_WORK_LIMIT 2000000000.0
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static void dist_set_error(dice_context_t *ctx, const char *message) {
+    snprintf(ctx->error.message, sizeof(ctx->error.message), "%s", message);
+    ctx->error.has_error = true;
+}
+
+static dice_distribution_t* dist_alloc(dice_context_t *ctx, int64_t min_value, size_t size) {
+    if (size == 0 || size > DIST_MAX_SUPPORT) {
+        dist_set_error(ctx, "Distribution support too large for exact analysis");
+        return NULL;
+    }
+    
+    dice_distribution_t *dist = malloc(sizeof(dice_distribution_t));
+    if (!dist) {
+        dist_set_error(ctx, "Failed to allocate memory for distribution");
+        return NULL;
+    }
+    
+    dist->pmf = calloc(size, sizeof(double));
+    if (!dist->pmf) {
+        free(dist);
+        dist_set_error(ctx, "Failed to allocate memory for distribution");
+        return NULL;
+    }
+    
+    dist->min_value = min_value;
+    dist->size = size;
+    return dist;
+}
+
+static dice_distribution_t* dist_constant(dice_context_t *ctx, int64_t value) {
+    dice_distribution_t *dist = dist_alloc(ctx, value, 1);
+    if (dist) dist->pmf[0] = 1.0;
+    return dist;
+}
+
+static bool dist_is_constant(const dice_distribution_t *dist, int64_t *value) {
+    if (dist->size != 1) return false;
+    *value = dist->min_value;
+    return true;
+}
+
+// Drop zero-probability entries at both ends
+static void dist_trim(dice_distribution_t *dist) {
+    size_t lo = 0, hi = dist->size;
+    while (lo + 1 < hi && dist->pmf[lo] <= 0.0) lo++;
+    while (hi - 1 > lo && dist->pmf[hi - 1] <= 0.0) hi--;
+    
+    if (lo > 0) {
+        memmove(dist->pmf, dist->pmf + lo, (hi - lo) * sizeof(double));
+    }
+    dist->min_value += (int64_t)lo;
+    dist->size = hi - lo;
+}
+
+// -----------------------------------------------------------------------------
+// Convolution (direct for small inputs, radix-2 FFT for large ones)
+// -----------------------------------------------------------------------------
+
+static void fft(double *re, double *im, size_t n, bool inverse) {
+    // Bit-reversal permutation
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            double t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    
+    for (size_t len = 2; len <= n; len <<= 1) {
+        double angle = 2.0 * M_PI / (double)len * (inverse ? 1.0 : -1.0);
+        double w_re = cos(angle), w_im = sin(angle);
+        for (size_t i = 0; i < n; i += len) {
+            double cur_re = 1.0, cur_im = 0.0;
+            for (size_t k = 0; k < len / 2; k++) {
+                size_t a = i + k, b = i + k + len / 2;
+                double v_re = re[b] * cur_re - im[b] * cur_im;
+                double v_im = re[b] * cur_im + im[b] * cur_re;
+                re[b] = re[a] - v_re;
+                im[b] = im[a] - v_im;
+                re[a] += v_re;
+                im[a] += v_im;
+                double next_re = cur_re * w_re - cur_im * w_im;
+                cur_im = cur_re * w_im + cur_im * w_re;
+                cur_re = next_re;
+            }
+        }
+    }
+    
+    if (inverse) {
+        for (size_t i = 0; i < n; i++) {
+            re[i] /= (double)n;
+            im[i] /= (double)n;
+        }
+    }
+}
+
+static bool convolve_fft(const double *a, size_t na, const double *b, size_t nb, double *out) {
+    size_t out_size = na + nb - 1;
+    size_t n = 1;
+    while (n < out_size) n <<= 1;
+    
+    double *buf = calloc(4 * n, sizeof(double));
+    if (!buf) return false;
+    double *a_re = buf, *a_im = buf + n, *b_re = buf + 2 * n, *b_im = buf + 3 * n;
+    
+    memcpy(a_re, a, na * sizeof(double));
+    memcpy(b_re, b, nb * sizeof(double));
+    fft(a_re, a_im, n, false);
+    fft(b_re, b_im, n, false);
+    
+    for (size_t i = 0; i < n; i++) {
+        double re = a_re[i] * b_re[i] - a_im[i] * b_im[i];
+        double im = a_re[i] * b_im[i] + a_im[i] * b_re[i];
+        a_re[i] = re;
+        a_im[i] = im;
+    }
+    fft(a_re, a_im, n, true);
+    
+    // Round-off can leave tiny negative probabilities
+    for (size_t i = 0; i < out_size; i++) {
+        out[i] = a_re[i] > 0.0 ? a_re[i] : 0.0;
+    }
+    
+    free(buf);
+    return true;
+}
+
+// Distribution of X + Y for independent X and Y
+static dice_distribution_t* dist_convolve(dice_context_t *ctx, const dice_distribution_t *x,
+                                          const dice_distribution_t *y) {
+    dice_distribution_t *out = dist_alloc(ctx, x->min_value + y->min_value, x->size + y->size - 1);
+    if (!out) return NULL;
+    
+    if (x->size == 1 || y->size == 1 ||
+        x->size * y->size <= DIST_DIRECT_CONVOLUTION_LIMIT) {
+        for (size_t i = 0; i < x->size; i++) {
+            double p = x->pmf[i];
+            if (p == 0.0) continue;
+            for (size_t j = 0; j < y->size; j++) {
+                out->pmf[i + j] += p * y->pmf[j];
+            }
+        }
+    } else if (!convolve_fft(x->pmf, x->size, y->pmf, y->size, out->pmf)) {
+        dice_distribution_destroy(out);
+        dist_set_error(ctx, "Failed to allocate memory for convolution");
+        return NULL;
+    }
+    
+    return out;
+}
+
+// Distribution of the sum of count independent copies of die
+static dice_distribution_t* dist_sum_iid(dice_context_t *ctx, const dice_distribution_t *die, int64_t count) {
+    dice_distribution_t *result = dist_constant(ctx, 0);
+    dice_distribution_t *base = dist_convolve(ctx, die, result); // copy of die
+    if (!result || !base) {
+        dice_distribution_destroy(result);
+        dice_distribution_destroy(base);
+        return NULL;
+    }
+    
+    // Binary exponentiation over convolution
+    while (count > 0) {
+        if (count & 1) {
+            dice_distribution_t *next = dist_convolve(ctx, result, base);
+            dice_distribution_destroy(result);
+            result = next;
+            if (!result) break;
+        }
+        count >>= 1;
+        if (count > 0) {
+            dice_distribution_t *next = dist_convolve(ctx, base, base);
+            dice_distribution_destroy(base);
+            base = next;
+            if (!base) break;
+        }
+    }
+    
+    dice_distribution_destroy(base);
+    if (ctx->error.has_error) {
+        dice_distribution_destroy(result);
+        return NULL;
+    }
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+// Arithmetic on distributions
+// -----------------------------------------------------------------------------
+
+static dice_distribution_t* dist_negate(dice_context_t *ctx, const dice_distribution_t *x) {
+    dice_distribution_t *out = dist_alloc(ctx, -(x->min_value + (int64_t)x->size - 1), x->size);
+    if (!out) return NULL;
+    for (size_t i = 0; i < x->size; i++) {
+        out->pmf[x->size - 1 - i] = x->pmf[i];
+    }
+    return out;
+}
+
+// Distribution of op(X, Y) by enumerating the joint support
+static dice_distribution_t* dist_combine(dice_context_t *ctx, const dice_distribution_t *x,
+                                         const dice_distribution_t *y, dice_binary_op_t op) {
+    int64_t lo = INT64_MAX, hi = INT64_MIN;
+    
+    for (int pass = 0; pass < 2; pass++) {
+        dice_distribution_t *out = NULL;
+        if (pass == 1) {
+            if ((uint64_t)(hi - lo) >= DIST_MAX_SUPPORT) {
+                dist_set_error(ctx, "Distribution support too large for exact analysis");
+                return NULL;
+            }
+            out = dist_alloc(ctx, lo, (size_t)(hi - lo) + 1);
+            if (!out) return NULL;
+        }
+        
+        for (size_t i = 0; i < x->size; i++) {
+            if (x->pmf[i] == 0.0) continue;
+            int64_t a = x->min_value + (int64_t)i;
+            for (size_t j = 0; j < y->size; j++) {
+                if (y->pmf[j] == 0.0) continue;
+                int64_t b = y->min_value + (int64_t)j;
+                int64_t v;
+                if (op == DICE_OP_MUL) {
+                    v = a * b;
+                } else {
+                    if (b == 0) {
+                        dice_distribution_destroy(out);
+                        dist_set_error(ctx, "Division by zero");
+                        return NULL;
+                    }
+                    v = a / b;
+                }
+                
+                if (pass == 0) {
+                    if (v < lo) lo = v;
+                    if (v > hi) hi = v;
+                } else {
+                    out->pmf[v - lo] += x->pmf[i] * y->pmf[j];
+                }
+            }
+        }
+        
+        if (pass == 1) return out;
+    }
+    return NULL;
+}
+
+// Multiplication by a constant keeps the support sparse; handle it without enumeration
+static dice_distribution_t* dist_scale(dice_context_t *ctx, const dice_distribution_t *x, int64_t k) {
+    if (k == 0) return dist_constant(ctx, 0);
+    if (k < 0) {
+        dice_distribution_t *neg = dist_negate(ctx, x);
+        if (!neg) return NULL;
+        dice_distribution_t *out = dist_scale(ctx, neg, -k);
+        dice_distribution_destroy(neg);
+        return out;
+    }
+    
+    if ((x->size - 1) > DIST_MAX_SUPPORT / (uint64_t)k) {
+        dist_set_error(ctx, "Distribution support too large for exact analysis");
+        return NULL;
+    }
+    
+    dice_distribution_t *out = dist_alloc(ctx, x->min_value * k, (x->size - 1) * (size_t)k + 1);
+    if (!out) return NULL;
+    for (size_t i = 0; i < x->size; i++) {
+        out->pmf[i * (size_t)k] = x->pmf[i];
+    }
+    return out;
+}
+
+// -----------------------------------------------------------------------------
+// Dice operations
+// -----------------------------------------------------------------------------
+
+static bool dist_matches(int64_t roll, dice_binary_op_t op, int64_t value) {
+    switch (op) {
+        case DICE_OP_GT: return roll > value;
+        case DICE_OP_LT: return roll < value;
+        case DICE_OP_GTE: return roll >= value;
+        case DICE_OP_LTE: return roll <= value;
+        case DICE_OP_EQ: return roll == value;
+        case DICE_OP_NEQ: return roll != value;
+        default: return false;
+    }
+}
+
+static bool dist_valid_comparison(dice_binary_op_t op) {
+    return op == DICE_OP_GT || op == DICE_OP_LT || op == DICE_OP_GTE ||
+           op == DICE_OP_LTE || op == DICE_OP_EQ || op == DICE_OP_NEQ;
+}
+
+static dice_distribution_t* dist_uniform_die(dice_context_t *ctx, int64_t sides) {
+    dice_distribution_t *die = dist_alloc(ctx, 1, (size_t)sides);
+    if (!die) return NULL;
+    for (int64_t i = 0; i < sides; i++) {
+        die->pmf[i] = 1.0 / (double)sides;
+    }
+    return die;
+}
+
+// One exploding die: g_0 is the plain die, and g_j (at most j explosions left)
+// keeps faces below the threshold or adds an exploded face to g_{j-1}
+static dice_distribution_t* dist_exploding_die(dice_context_t *ctx, int64_t sides, int64_t explode_at) {
+    int64_t depth = ctx->policy.max_explosion_depth;
+    if (explode_at <= 0) explode_at = sides;
+    if (explode_at > sides || depth <= 0) return dist_uniform_die(ctx, sides);
+    
+    if ((double)sides * (double)(depth + 1) > (double)DIST_MAX_SUPPORT) {
+        dist_set_error(ctx, "Distribution support too large for exact analysis");
+        return NULL;
+    }
+    size_t size = (size_t)(sides * (depth + 1));
+    dice_distribution_t *die = dist_alloc(ctx, 1, size);
+    if (!die) return NULL;
+    double *prev = calloc(size, sizeof(double));
+    if (!prev) {
+        dice_distribution_destroy(die);
+        dist_set_error(ctx, "Failed to allocate memory for distribution");
+        return NULL;
+    }
+    
+    // pmf[i] is the probability of total i + 1
+    double face = 1.0 / (double)sides;
+    for (int64_t v = 0; v < sides; v++) die->pmf[v] = face;
+    
+    for (int64_t j = 1; j <= depth; j++) {
+        size_t prev_size = (size_t)(sides * j);
+        memcpy(prev, die->pmf, prev_size * sizeof(double));
+        memset(die->pmf, 0, (size_t)(sides * (j + 1)) * sizeof(double));
+        
+        for (int64_t v = 1; v < explode_at; v++) die->pmf[v - 1] = face;
+        for (size_t y = 0; y < prev_size; y++) {
+            double weight = prev[y] * face;
+            if (weight == 0.0) continue;
+            for (int64_t v = explode_at; v <= sides; v++) die->pmf[y + (size_t)v] += weight;
+        }
+    }
+    
+    free(prev);
+    dist_trim(die);
+    return die;
+}
+
+static dice_distribution_t* dist_custom_die(dice_context_t *ctx, const dice_custom_die_t *custom_die) {
+    int64_t lo = INT64_MAX, hi = INT64_MIN;
+    for (size_t i = 0; i < custom_die->side_count; i++) {
+        if (custom_die->sides[i].value < lo) lo = custom_die->sides[i].value;
+        if (custom_die->sides[i].value > hi) hi = custom_die->sides[i].value;
+    }
+    
+    if ((uint64_t)(hi - lo) >= DIST_MAX_SUPPORT) {
+        dist_set_error(ctx, "Distribution support too large for exact analysis");
+        return NULL;
+    }
+    
+    dice_distribution_t *die = dist_alloc(ctx, lo, (size_t)(hi - lo) + 1);
+    if (!die) return NULL;
+    for (size_t i = 0; i < custom_die->side_count; i++) {
+        double p = 1.0 / (double)custom_die->side_count;
+        if (custom_die->alias) {
+            uint32_t weight = custom_die->sides[i].weight ? custom_die->sides[i].weight : 1;
+            p = (double)weight / (double)custom_die->total_weight;
+        }
+        die->pmf[custom_die->sides[i].value - lo] += p;
+    }
+    return die;
+}
+
+// log of the binomial probability mass C(n, k) p^k (1-p)^(n-k), for 0 < p < 1
+static double log_binomial_pmf(int64_t n, int64_t k, double log_p, double log_q) {
+    return lgamma((double)n + 1.0) - lgamma((double)k + 1.0) - lgamma((double)(n - k) + 1.0) +
+           (double)k * log_p + (double)(n - k) * log_q;
+}
+
+// Sum of the keep highest/lowest `keep` of `count` uniform dice with `sides` faces.
+// Faces are visited from the kept end inward; with r dice still unassigned and
+// v faces left, the number showing the current face is Binomial(r, 1/v).
+static dice_distribution_t* dist_keep(dice_context_t *ctx, int64_t count, int64_t sides,
+                                      int64_t keep, bool keep_high) {
+    if (keep == 0) return dist_constant(ctx, 0);
+    
+    double work = (double)sides * (double)(count + 1) * (double)(count + 1) * (double)(keep * sides + 1);
+    if (work > DIST_SELECTION_WORK_LIMIT || (uint64_t)(keep * sides) >= DIST_MAX_SUPPORT) {
+        dist_set_error(ctx, "Keep/drop selection too large for exact analysis");
+        return NULL;
+    }
+    
+    size_t sums = (size_t)(keep * sides) + 1;
+    size_t states = (size_t)(count + 1) * sums;
+    double *cur = calloc(states, sizeof(double));
+    double *next = calloc(states, sizeof(double));
+    double *binom = calloc((size_t)count + 1, sizeof(double));
+    dice_distribution_t *out = dist_alloc(ctx, 0, sums);
+    if (!cur || !next || !binom || !out) {
+        free(cur); free(next); free(binom);
+        dice_distribution_destroy(out);
+        if (!ctx->error.has_error) dist_set_error(ctx, "Failed to allocate memory for selection analysis");
+        return NULL;
+    }
+    
+    // cur[r * sums + t]: r dice unassigned, kept sum t, fewer than `keep` kept so far
+    cur[(size_t)count * sums] = 1.0;
+    
+    for (int64_t step = 0; step < sides; step++) {
+        int64_t face = keep_high ? sides - step : step + 1;
+        int64_t faces_left = sides - step;
+        memset(next, 0, states * sizeof(double));
+        
+        for (int64_t r = 1; r <= count; r++) {
+            int64_t kept = count - r;
+            int64_t room = keep - kept;
+            
+            // Binomial(r, 1/faces_left) for the number of dice showing this face
+            if (faces_left == 1) {
+                memset(binom, 0, (size_t)(r + 1) * sizeof(double));
+                binom[r] = 1.0;
+            } else {
+                double log_p = -log((double)faces_left);
+                double log_q = log1p(-1.0 / (double)faces_left);
+                for (int64_t c = 0; c <= r; c++) {
+                    binom[c] = exp(log_binomial_pmf(r, c, log_p, log_q));
+                }
+            }
+            
+            for (size_t t = 0; t < sums; t++) {
+                double p = cur[(size_t)r * sums + t];
+                if (p == 0.0) continue;
+                
+                for (int64_t c = 0; c <= r; c++) {
+                    if (binom[c] == 0.0) continue;
+                    double q = p * binom[c];
+                    int64_t take = c < room ? c : room;
+                    size_t t2 = t + (size_t)(take * face);
+                    
+                    if (take == room || r - c == 0) {
+                        // Selection complete: the remaining dice cannot be kept
+                        out->pmf[t2] += q;
+                    } else {
+                        next[(size_t)(r - c) * sums + t2] += q;
+                    }
+                }
+            }
+        }
+        
+        double *swap = cur;
+        cur = next;
+        next = swap;
+    }
+    
+    free(cur);
+    free(next);
+    free(binom);
+    dist_trim(out);
+    return out;
+}
+
+static dice_distribution_t* dist_filter(dice_context_t *ctx, int64_t count, int64_t sides,
+                                        const dice_selection_t *selection) {
+    if (!selection) {
+        dist_set_error(ctx, "Filter operation has no selection");
+        return NULL;
+    }
+    
+    if (selection->is_conditional) {
+        if (!dist_valid_comparison(selection->comparison_op)) {
+            dist_set_error(ctx, selection->is_reroll ?
+                           "Unknown comparison operator in reroll operation" :
+                           "Unknown comparison operator in conditional filter");
+            return NULL;
+        }
+        
+        dice_distribution_t *die = dist_alloc(ctx, 0, (size_t)sides + 1);
+        if (!die) return NULL;
+        
+        if (selection->is_reroll) {
+            // Rerolled dice end up uniform over the faces that do not match
+            int64_t keepers = 0;
+            for (int64_t v = 1; v <= sides; v++) {
+                if (!dist_matches(v, selection->comparison_op, selection->comparison_value)) keepers++;
+            }
+            if (keepers == 0) {
+                dice_distribution_destroy(die);
+                dist_set_error(ctx, "Reroll condition matches every face");
+                return NULL;
+            }
+            for (int64_t v = 1; v <= sides; v++) {
+                if (!dist_matches(v, selection->comparison_op, selection->comparison_value)) {
+                    die->pmf[v] = 1.0 / (double)keepers;
+                }
+            }
+        } else {
+            // Matching dice contribute their face, the rest contribute 0
+            for (int64_t v = 1; v <= sides; v++) {
+                size_t slot = dist_matches(v, selection->comparison_op, selection->comparison_value) ? (size_t)v : 0;
+                die->pmf[slot] += 1.0 / (double)sides;
+            }
+        }
+        
+        dist_trim(die);
+        dice_distribution_t *out = dist_sum_iid(ctx, die, count);
+        dice_distribution_destroy(die);
+        return out;
+    }
+    
+    // Count-based keep/drop, using the same selection count rules as evaluation
+    int64_t keep;
+    if (selection->is_drop_operation) {
+        keep = selection->count >= count ? 0 : count - selection->count;
+    } else {
+        keep = selection->count > count ? count : selection->count;
+    }
+    if (keep < 0) {
+        dist_set_error(ctx, "Invalid selection count (must be non-negative)");
+        return NULL;
+    }
+    
+    return dist_keep(ctx, count, sides, keep, selection->select_high);
+}
+
+// Successes among count dice: each die is a 0/1 trial, so the sum is binomial
+static dice_distribution_t* dist_pool(dice_context_t *ctx, int64_t count, int64_t sides,
+                                      const dice_selection_t *selection) {
+    if (!selection || !dist_valid_comparison(selection->comparison_op)) {
+        dist_set_error(ctx, selection ? "Unknown comparison operator in success pool" :
+                       "Success pool has no comparison");
+        return NULL;
+    }
+    
+    dice_distribution_t *die = dist_alloc(ctx, 0, 2);
+    if (!die) return NULL;
+    for (int64_t v = 1; v <= sides; v++) {
+        bool success = dist_matches(v, selection->comparison_op, selection->comparison_value);
+        die->pmf[success ? 1 : 0] += 1.0 / (double)sides;
+    }
+    
+    dist_trim(die);
+    dice_distribution_t *out = dist_sum_iid(ctx, die, count);
+    dice_distribution_destroy(die);
+    return out;
+}
+
+static dice_distribution_t* dist_node(dice_context_t *ctx, const dice_ast_node_t *node);
+
+// Distribution of a dice node for fixed count and sides
+static dice_distribution_t* dist_dice_fixed(dice_context_t *ctx, const dice_ast_node_t *node,
+                                            int64_t count, int64_t sides) {
+    if (!eval_check_dice_count(ctx, count)) return NULL;
+    
+    if (node->data.dice_op.dice_type == DICE_DICE_CUSTOM) {
+        const dice_custom_die_t *custom_die = node->data.dice_op.custom_die;
+        if (!custom_die && node->data.dice_op.custom_name) {
+            custom_die = dice_lookup_custom_die(ctx, node->data.dice_op.custom_name);
+            if (!custom_die) {
+                snprintf(ctx->error.message, sizeof(ctx->error.message),
+                        "Unknown custom die: %s", node->data.dice_op.custom_name);
+                ctx->error.has_error = true;
+                return NULL;
+            }
+        }
+        if (!custom_die || custom_die->side_count == 0) {
+            dist_set_error(ctx, custom_die ? "Custom die has no sides" : "Custom die has no definition or name");
+            return NULL;
+        }
+        
+        dice_distribution_t *die = dist_custom_die(ctx, custom_die);
+        if (!die) return NULL;
+        dice_distribution_t *out = dist_sum_iid(ctx, die, count);
+        dice_distribution_destroy(die);
+        return out;
+    }
+    
+    if (!eval_check_dice_sides(ctx, sides)) return NULL;
+    
+    if (node->data.dice_op.dice_type == DICE_DICE_FILTER) {
+        return dist_filter(ctx, count, sides, node->data.dice_op.selection);
+    }
+    
+    if (node->data.dice_op.dice_type == DICE_DICE_POOL) {
+        return dist_pool(ctx, count, sides, node->data.dice_op.selection);
+    }
+    
+    dice_distribution_t *die = NULL;
+    if (node->data.dice_op.dice_type == DICE_DICE_EXPLODING) {
+        const dice_ast_node_t *threshold = node->data.dice_op.modifier;
+        die = dist_exploding_die(ctx, sides, threshold ? threshold->data.literal.value : 0);
+    } else {
+        die = dist_uniform_die(ctx, sides);
+    }
+    if (!die) return NULL;
+    dice_distribution_t *out = dist_sum_iid(ctx, die, count);
+    dice_distribution_destroy(die);
+    return out;
+}
+
+// Accumulate weight * src into dst (dst covers src's support)
+static void dist_accumulate(dice_distribution_t *dst, const dice_distribution_t *src, double weight) {
+    for (size_t i = 0; i < src->size; i++) {
+        dst->pmf[(size_t)(src->min_value - dst->min_value) + i] += weight * src->pmf[i];
+    }
+}
+
+static dice_distribution_t* dist_dice_op(dice_context_t *ctx, const dice_ast_node_t *node) {
+    dice_distribution_t *count_dist = node->data.dice_op.count ?
+        dist_node(ctx, node->data.dice_op.count) : dist_constant(ctx, 1);
+    if (!count_dist) return NULL;
+    
+    dice_distribution_t *sides_dist = NULL;
+    if (node->data.dice_op.dice_type == DICE_DICE_CUSTOM) {
+        sides_dist = dist_constant(ctx, 0);
+    } else {
+        sides_dist = dist_node(ctx, node->data.dice_op.sides);
+    }
+    if (!sides_dist) {
+        dice_distribution_destroy(count_dist);
+        return NULL;
+    }
+    
+    int64_t count, sides;
+    dice_distribution_t *out = NULL;
+    if (dist_is_constant(count_dist, &count) && dist_is_constant(sides_dist, &sides)) {
+        out = dist_dice_fixed(ctx, node, count, sides);
+    } else {
+        // Random count or sides: mixture over every (count, sides) outcome
+        dice_distribution_t **parts = calloc(count_dist->size * sides_dist->size, sizeof(*parts));
+        int64_t lo = INT64_MAX, hi = INT64_MIN;
+        bool ok = parts != NULL;
+        
+        for (size_t i = 0; ok && i < count_dist->size; i++) {
+            if (count_dist->pmf[i] == 0.0) continue;
+            for (size_t j = 0; ok && j < sides_dist->size; j++) {
+                if (sides_dist->pmf[j] == 0.0) continue;
+                dice_distribution_t *part = dist_dice_fixed(ctx, node,
+                    count_dist->min_value + (int64_t)i, sides_dist->min_value + (int64_t)j);
+                if (!part) {
+                    ok = false;
+                    break;
+                }
+                parts[i * sides_dist->size + j] = part;
+                if (part->min_value < lo) lo = part->min_value;
+                if (part->min_value + (int64_t)part->size - 1 > hi) hi = part->min_value + (int64_t)part->size - 1;
+            }
+        }
+        
+        if (ok) out = dist_alloc(ctx, lo, (size_t)(hi - lo) + 1);
+        for (size_t i = 0; parts && i < count_dist->size; i++) {
+            for (size_t j = 0; j < sides_dist->size; j++) {
+                dice_distribution_t *part = parts[i * sides_dist->size + j];
+                if (!part) continue;
+                if (out) dist_accumulate(out, part, count_dist->pmf[i] * sides_dist->pmf[j]);
+                dice_distribution_destroy(part);
+            }
+        }
+        free(parts);
+        if (!parts && !ctx->error.has_error) {
+            dist_set_error(ctx, "Failed to allocate memory for distribution");
+        }
+    }
+    
+    dice_distribution_destroy(count_dist);
+    dice_distribution_destroy(sides_dist);
+    return out;
+}
+
+// One operator of a chain; takes ownership of left
+static dice_distribution_t* dist_binary_step(dice_context_t *ctx, const dice_ast_node_t *node,
+                                             dice_distribution_t *left) {
+    dice_distribution_t *right = dist_node(ctx, node->data.binary_op.right);
+    if (!right) {
+        dice_distribution_destroy(left);
+        return NULL;
+    }
+    
+    dice_distribution_t *out = NULL;
+    int64_t k;
+    
+    switch (node->data.binary_op.op) {
+        case DICE_OP_ADD:
+            out = dist_convolve(ctx, left, right);
+            break;
+        case DICE_OP_SUB: {
+            dice_distribution_t *neg = dist_negate(ctx, right);
+            if (neg) out = dist_convolve(ctx, left, neg);
+            dice_distribution_destroy(neg);
+            break;
+        }
+        case DICE_OP_MUL:
+            if (dist_is_constant(right, &k)) {
+                out = dist_scale(ctx, left, k);
+            } else if (dist_is_constant(left, &k)) {
+                out = dist_scale(ctx, right, k);
+            } else {
+                out = dist_combine(ctx, left, right, DICE_OP_MUL);
+            }
+            break;
+        case DICE_OP_DIV:
+            out = dist_combine(ctx, left, right, DICE_OP_DIV);
+            break;
+        default:
+            dist_set_error(ctx, "Unknown binary operator");
+            break;
+    }
+    
+    dice_distribution_destroy(left);
+    dice_distribution_destroy(right);
+    if (out) dist_trim(out);
+    return out;
+}
+
+// Chains like 1d6+1d6+...+1d6 are folded in a loop along their left operands
+static dice_distribution_t* dist_binary_op(dice_context_t *ctx, const dice_ast_node_t *node) {
+    ast_spine_t spine;
+    if (!ast_spine_init(&spine, node)) {
+        dist_set_error(ctx, "Failed to allocate memory for distribution");
+        return NULL;
+    }
+    
+    dice_distribution_t *acc = dist_node(ctx, spine.nodes[spine.length - 1]->data.binary_op.left);
+    for (size_t i = spine.length; acc && i > 0; i--) {
+        acc = dist_binary_step(ctx, spine.nodes[i - 1], acc);
+    }
+    
+    ast_spine_release(&spine);
+    return acc;
+}
+
+static dice_distribution_t* dist_node(dice_context_t *ctx, const dice_ast_node_t *node) {
+    if (!node) {
+        dist_set_error(ctx, "Cannot analyze empty expression");
+        return NULL;
+    }
+    
+    switch (node->type) {
+        case DICE_NODE_LITERAL:
+            return dist_constant(ctx, node->data.literal.value);
+        case DICE_NODE_BINARY_OP:
+            return dist_binary_op(ctx, node);
+        case DICE_NODE_DICE_OP:
+            return dist_dice_op(ctx, node);
+        case DICE_NODE_ANNOTATION:
+            return dist_node(ctx, node->data.annotation.child);
+        case DICE_NODE_FUNCTION_CALL:
+            snprintf(ctx->error.message, sizeof(ctx->error.message),
+                    "Function calls not yet supported: %s", node->data.function_call.name);
+            ctx->error.has_error = true;
+            return NULL;
+    }
+    
+    dist_set_error(ctx, "Unknown AST node type");
+    return NULL;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+dice_distribution_t* dice_analyze(dice_context_t *ctx, const dice_ast_node_t *node) {
+    if (!ctx) return NULL;
+    return dist_node(ctx, node);
+}
+
+void dice_distribution_destroy(dice_distribution_t *dist) {
+    if (!dist) return;
+    free(dist->pmf);
+    free(dist);
+}
+
+double dice_distribution_probability(const dice_distribution_t *dist, int64_t value) {
+    if (!dist || value < dist->min_value || value >= dist->min_value + (int64_t)dist->size) {
+        return 0.0;
+    }
+    return dist->pmf[value - dist->min_value];
+}
+
+double dice_distribution_cdf(const dice_distribution_t *dist, int64_t value) {
+    if (!dist || value < dist->min_value) return 0.0;
+    
+    double total = 0.0;
+    size_t last = (size_t)(value - dist->min_value);
+    for (size_t i = 0; i < dist->size && i <= last; i++) {
+        total += dist->pmf[i];
+    }
+    return total < 1.0 ? total : 1.0;
+}
+
+double dice_distribution_mean(const dice_distribution_t *dist) {
+    if (!dist) return 0.0;
+    
+    double mean = 0.0;
+    for (size_t i = 0; i < dist->size; i++) {
+        mean += (double)i * dist->pmf[i];
+    }
+    return (double)dist->min_value + mean;
+}
+
+double dice_distribution_variance(const dice_distribution_t *dist) {
+    if (!dist) return 0.0;
+    
+    // Work relative to min_value to keep the squares small
+    double mean = dice_distribution_mean(dist) - (double)dist->min_value;
+    double variance = 0.0;
+    for (size_t i = 0; i < dist->size; i++) {
+        double d = (double)i - mean;
+        variance += d * d * dist->pmf[i];
+    }
+    return variance;
+}
+
+int64_t dice_distribution_quantile(const dice_distribution_t *dist, double p) {
+    if (!dist) return 0;
+    
+    double total = 0.0;
+    for (size_t i = 0; i < dist->size; i++) {
+        total += dist->pmf[i];
+        // Small tolerance so round-off does not push e.g. the median one step right
+        if (total >= p - 1e-12) {
+            return dist->min_value + (int64_t)i;
+        }
+    }
+    return dist->min_value + (int64_t)dist->size - 1;
+}
@@ -2,201 +2,638 @@
 #include "internal.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
+#include <limits.h>
 #include <string.h>
 #include <time.h>
 
 // =============================================================================
-// Evaluator Implementation (Stateless)
+// Shared Evaluation Primitives (tree evaluator and program interpreter)
 // =============================================================================
 
-dice_eval_result_t dice_evaluate(dice_context_t *ctx, const dice_ast_node_t *node) {
-    dice_eval_result_t result = {0, false};
+bool eval_check_dice_count(dice_context_t *ctx, int64_t count) {
+    if (count <= 0) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Dice count must be positive, got %lld", (long long)count);
+        ctx->error.has_error = true;
+        return false;
+    }
     
-    if (!ctx || !node) {
-        return result;
+    if (count > ctx->policy.max_dice_count) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Too many dice: %lld exceeds limit of %d", 
+                (long long)count, ctx->policy.max_dice_count);
+        ctx->error.has_error = true;
+        return false;
     }
     
-    switch (node->type) {
-        case DICE_NODE_LITERAL:
-            result.value = node->data.literal.value;
-            result.success = true;
-            break;
-            
-        case DICE_NODE_BINARY_OP: {
-            dice_eval_result_t left = dice_evaluate(ctx, node->data.binary_op.left);
-            if (!left.success) return left;
-            
-            dice_eval_result_t right = dice_evaluate(ctx, node->data.binary_op.right);
-            if (!right.success) return right;
-            
-            switch (node->data.binary_op.op) {
-                case DICE_OP_ADD:
-                    result.value = left.value + right.value;
-                    break;
-                case DICE_OP_SUB:
-                    result.value = left.value - right.value;
-                    break;
-                case DICE_OP_MUL:
-                    result.value = left.value * right.value;
-                    break;
-                case DICE_OP_DIV:
-                    if (right.value == 0) {
-                        snprintf(ctx->error.message, sizeof(ctx->error.message),
-                                "Division by zero");
-                        ctx->error.has_error = true;
-                        return result;
-                    }
-                    result.value = left.value / right.value;
-                    break;
-                default:
-                    snprintf(ctx->error.message, sizeof(ctx->error.message),
-                            "Unknown binary operator");
-                    ctx->error.has_error = true;
-                    return result;
-            }
-            result.success = true;
-            break;
+    return true;
+}
+
+bool eval_check_dice_sides(dice_context_t *ctx, int64_t sides) {
+    if (sides <= 0) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Dice sides must be positive, got %lld", (long long)sides);
+        ctx->error.has_error = true;
+        return false;
+    }
+    
+    if (sides > ctx->policy.max_sides) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Too many sides: %lld exceeds limit of %d", 
+                (long long)sides, ctx->policy.max_sides);
+        ctx->error.has_error = true;
+        return false;
+    }
+    
+    return true;
+}
+
+int64_t eval_roll_basic(dice_context_t *ctx, int64_t count, int sides) {
+    int64_t sum = 0;
+    bool full_trace = ctx->trace_level == DICE_TRACE_FULL;
+    bool record = ctx->results != NULL;
+    int block[EVAL_ROLL_BLOCK];
+    
+    if (record) results_begin_op(ctx, sides);
+    for (int64_t done = 0; done < count; ) {
+        size_t n = count - done < EVAL_ROLL_BLOCK ? (size_t)(count - done) : EVAL_ROLL_BLOCK;
+        if (rng_roll_n(ctx, sides, block, n) != 0) {
+            snprintf(ctx->error.message, sizeof(ctx->error.message),
+                    "RNG error during dice roll");
+            ctx->error.has_error = true;
+            return 0;
         }
+        if (record) results_add_rolls(ctx, block, NULL, n);
         
-        case DICE_NODE_DICE_OP: {
-            // Evaluate count
-            int64_t count = 1;
-            if (node->data.dice_op.count) {
-                dice_eval_result_t count_result = dice_evaluate(ctx, node->data.dice_op.count);
-                if (!count_result.success) return count_result;
-                count = count_result.value;
-            }
+        for (size_t i = 0; i < n; i++) {
+            // Add to trace
+            if (full_trace) trace_atomic_roll(ctx, sides, block[i]);
             
-            // Validation
-            if (count <= 0) {
-                snprintf(ctx->error.message, sizeof(ctx->error.message),
-                        "Dice count must be positive, got %lld", (long long)count);
-                ctx->error.has_error = true;
-                return result;
+            sum += block[i];
+        }
+        done += (int64_t)n;
+    }
+    
+    trace_summary_add(ctx, (uint64_t)count, 0, 0);
+    return sum;
+}
+
+// Uniform doubles in (0, 1) from 53 random bits each
+static bool eval_uniform_n(dice_context_t *ctx, double *out, size_t n) {
+    uint64_t bits[EVAL_ROLL_BLOCK];
+    for (size_t done = 0; done < n; ) {
+        size_t block = n - done < EVAL_ROLL_BLOCK ? n - done : EVAL_ROLL_BLOCK;
+        if (rng_rand_n(ctx, (uint64_t)1 << 53, bits, block) != 0) {
+            snprintf(ctx->error.message, sizeof(ctx->error.message),
+                    "RNG error during dice roll");
+            ctx->error.has_error = true;
+            return false;
+        }
+        for (size_t i = 0; i < block; i++) {
+            out[done + i] = ((double)(bits[i] & (((uint64_t)1 << 53) - 1)) + 0.5) / 9007199254740992.0;
+        }
+        done += block;
+    }
+    return true;
+}
+
+// Explosion chain lengths are drawn directly instead of rolling until a die
+// misses: each roll explodes with probability q = (S - T + 1) / S, so the
+// number of explosions K is geometric, P(K >= k) = q^k, and one uniform U
+// gives K = floor(log(U) / log(q)). Given K, the exploded faces are uniform
+// on [T, S] and the last face is uniform on [1, T - 1], or on [1, S] when
+// the chain was cut off at the depth limit. Every face then comes from the
+// bulk roll_n path, so the cost tracks the number of faces, not retries.
+static int64_t exploding_rng_error(dice_context_t *ctx) {
+    snprintf(ctx->error.message, sizeof(ctx->error.message),
+            "RNG error during dice roll");
+    ctx->error.has_error = true;
+    return 0;
+}
+
+int64_t eval_roll_exploding(dice_context_t *ctx, int64_t count, int sides, int64_t explode_at,
+                            bool compounding) {
+    int depth = ctx->policy.max_explosion_depth;
+    if (explode_at <= 0) explode_at = sides;
+    if (explode_at > sides || depth <= 0) {
+        return eval_roll_basic(ctx, count, sides);
+    }
+    int threshold = (int)explode_at;
+    
+    bool full_trace = ctx->trace_level == DICE_TRACE_FULL;
+    bool record = ctx->results != NULL;
+    double q = (double)(sides - threshold + 1) / (double)sides;
+    double log_q = log(q);
+    int exploded_sides = sides - threshold + 1;
+    double uniforms[EVAL_ROLL_BLOCK];
+    int chain[EVAL_ROLL_BLOCK];
+    int last_free[EVAL_ROLL_BLOCK];
+    int last_capped[EVAL_ROLL_BLOCK];
+    int exploded[EVAL_ROLL_BLOCK];
+    int64_t sum = 0;
+    uint64_t explosions = 0;
+    
+    if (record) results_begin_op(ctx, sides);
+    for (int64_t done = 0; done < count; ) {
+        size_t n = count - done < EVAL_ROLL_BLOCK ? (size_t)(count - done) : EVAL_ROLL_BLOCK;
+        
+        // Chain length per die; log_q is 0 when every face explodes (1d1!)
+        if (!eval_uniform_n(ctx, uniforms, n)) return 0;
+        size_t free_count = 0;
+        size_t block_explosions = 0;
+        for (size_t i = 0; i < n; i++) {
+            double u = uniforms[i];
+            // Most dice do not explode at all (u > q), which needs no log
+            double k = u > q ? 0.0 : log_q < 0.0 ? floor(log(u) / log_q) : (double)depth;
+            chain[i] = k >= (double)depth ? depth : (int)k;
+            if (chain[i] < depth) free_count++;
+            block_explosions += (size_t)chain[i];
+        }
+        
+        // Last faces: below the threshold, or anything for chains at the limit
+        if (free_count > 0 && rng_roll_n(ctx, threshold - 1, last_free, free_count) != 0) return exploding_rng_error(ctx);
+        if (free_count < n && rng_roll_n(ctx, sides, last_capped, n - free_count) != 0) return exploding_rng_error(ctx);
+        
+        size_t next_free = 0, next_capped = 0;
+        size_t pending = block_explosions, buffered = 0, next_exploded = 0;
+        for (size_t i = 0; i < n; i++) {
+            int64_t die = 0;
+            for (int j = 0; j < chain[i]; j++) {
+                if (next_exploded == buffered) {
+                    buffered = pending < EVAL_ROLL_BLOCK ? pending : EVAL_ROLL_BLOCK;
+                    pending -= buffered;
+                    next_exploded = 0;
+                    if (exploded_sides == 1) {
+                        for (size_t e = 0; e < buffered; e++) exploded[e] = 1;
+                    } else if (rng_roll_n(ctx, exploded_sides, exploded, buffered) != 0) {
+                        return exploding_rng_error(ctx);
+                    }
+                }
+                int face = exploded[next_exploded++] + threshold - 1;
+                if (full_trace && !compounding) trace_atomic_roll(ctx, sides, face);
+                if (record && !compounding) results_add_value(ctx, face, true);
+                die += face;
             }
             
-            if (count > ctx->policy.max_dice_count) {
+            int face = chain[i] < depth ? last_free[next_free++] : last_capped[next_capped++];
+            die += face;
+            if (full_trace) trace_atomic_roll(ctx, sides, compounding ? (int)die : face);
+            if (record) results_add_value(ctx, compounding ? die : face, true);
+            sum += die;
+        }
+        
+        explosions += block_explosions;
+        done += (int64_t)n;
+    }
+    
+    DICE_COUNT(ctx, explosions, explosions);
+    trace_summary_add(ctx, (uint64_t)count + explosions, 0, 0);
+    return sum;
+}
+
+bool eval_pick_custom_sides(dice_context_t *ctx, size_t side_count, uint64_t total_weight,
+                            const dice_alias_entry_t *alias, uint64_t *out, size_t n) {
+    // Generate random indices for the sides; weighted dice treat them as alias columns
+    if (rng_rand_n(ctx, side_count, out, n) != 0) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "RNG error during dice roll");
+        ctx->error.has_error = true;
+        return false;
+    }
+    
+    for (size_t i = 0; i < n; i++) {
+        if (out[i] >= side_count) {
+            // Fallback to simple modulo if rand function misbehaves
+            out[i] = out[i] % side_count;
+        }
+    }
+    if (!alias) return true;
+    
+    // The threshold is a separate draw, so no single draw spans side_count * total_weight
+    uint64_t thresholds[EVAL_ROLL_BLOCK];
+    for (size_t done = 0; done < n; ) {
+        size_t block = n - done < EVAL_ROLL_BLOCK ? n - done : EVAL_ROLL_BLOCK;
+        if (rng_rand_n(ctx, total_weight, thresholds, block) != 0) {
+            snprintf(ctx->error.message, sizeof(ctx->error.message),
+                    "RNG error during dice roll");
+            ctx->error.has_error = true;
+            return false;
+        }
+        for (size_t i = 0; i < block; i++) {
+            uint64_t column = out[done + i];
+            out[done + i] = thresholds[i] % total_weight < alias[column].keep ? column : alias[column].alias;
+        }
+        done += block;
+    }
+    return true;
+}
+
+static bool eval_uniform(dice_context_t *ctx, double *out) {
+    return eval_uniform_n(ctx, out, 1);
+}
+
+// Stirling series tail: log(k!) - [(k + 1/2) log(k + 1) - (k + 1) + log(2 pi) / 2]
+static double binomial_stirling_tail(double k) {
+    static const double tail[10] = {
+        0.0810614667953272, 0.0413406959554092, 0.0276779256849983, 0.02079067210376509,
+        0.0166446911898211, 0.0138761288230707, 0.0118967099458917, 0.0104112652619720,
+        0.00925546218271273, 0.00833056343336287
+    };
+    if (k <= 9.0) return tail[(int)k];
+    double kp1sq = (k + 1.0) * (k + 1.0);
+    return (1.0 / 12.0 - (1.0 / 360.0 - 1.0 / 1260.0 / kp1sq) / kp1sq) / (k + 1.0);
+}
+
+// Small means: count geometric waiting times until they pass n (np + 1 draws expected)
+static bool binomial_inversion(dice_context_t *ctx, int64_t n, double p, int64_t *out) {
+    double log_q = log1p(-p);
+    double waited = 0.0;
+    int64_t successes = 0;
+    
+    for (;;) {
+        double u;
+        if (!eval_uniform(ctx, &u)) return false;
+        waited += ceil(log(u) / log_q);
+        if (waited > (double)n) break;
+        successes++;
+    }
+    *out = successes;
+    return true;
+}
+
+// BTRS accepts well over half its candidates; this many rejections means a broken RNG
+#define BINOMIAL_BTRS_MAX_TRIES 1000
+
+// Hormann's BTRS transformed rejection for np >= 10, p <= 1/2 (O(1) expected draws)
+static bool binomial_btrs(dice_context_t *ctx, int64_t n, double p, int64_t *out) {
+    double count = (double)n;
+    double stddev = sqrt(count * p * (1.0 - p));
+    double b = 1.15 + 2.53 * stddev;
+    double a = -0.0873 + 0.0248 * b + 0.01 * p;
+    double c = count * p + 0.5;
+    double v_r = 0.92 - 4.2 / b;
+    double r = p / (1.0 - p);
+    double alpha = (2.83 + 5.1 / b) * stddev;
+    double m = floor((count + 1.0) * p);
+    
+    for (int tries = 0; tries < BINOMIAL_BTRS_MAX_TRIES; tries++) {
+        double u, v;
+        if (!eval_uniform(ctx, &u) || !eval_uniform(ctx, &v)) return false;
+        u -= 0.5;
+        double us = 0.5 - fabs(u);
+        double k = floor((2.0 * a / us + b) * u + c);
+        if (k < 0.0 || k > count) continue;
+        if (us >= 0.07 && v <= v_r) {
+            *out = (int64_t)k;
+            return true;
+        }
+        
+        v = log(v * alpha / (a / (us * us) + b));
+        double bound = (m + 0.5) * log((m + 1.0) / (r * (count - m + 1.0))) +
+                       (count + 1.0) * log((count - m + 1.0) / (count - k + 1.0)) +
+                       (k + 0.5) * log(r * (count - k + 1.0) / (k + 1.0)) +
+                       binomial_stirling_tail(m) + binomial_stirling_tail(count - m) -
+                       binomial_stirling_tail(k) - binomial_stirling_tail(count - k);
+        if (v <= bound) {
+            *out = (int64_t)k;
+            return true;
+        }
+    }
+    
+    snprintf(ctx->error.message, sizeof(ctx->error.message),
+            "RNG error during dice roll: binomial sampling did not converge");
+    ctx->error.has_error = true;
+    return false;
+}
+
+bool eval_sample_binomial(dice_context_t *ctx, int64_t n, double p, int64_t *out) {
+    if (n <= 0 || p <= 0.0) {
+        *out = 0;
+        return true;
+    }
+    if (p >= 1.0) {
+        *out = n;
+        return true;
+    }
+    
+    // Sample the rarer outcome and mirror it
+    bool mirrored = p > 0.5;
+    double rare = mirrored ? 1.0 - p : p;
+    int64_t k;
+    bool ok = (double)n * rare < 10.0 ? binomial_inversion(ctx, n, rare, &k)
+                                      : binomial_btrs(ctx, n, rare, &k);
+    if (!ok) return false;
+    *out = mirrored ? n - k : k;
+    return true;
+}
+
+// =============================================================================
+// Evaluator Implementation (Stateless)
+// =============================================================================
+
+// Frames live on the C stack up to this height, then move to the arena
+#define EVAL_LOCAL_FRAMES 64
+
+// One pending node; stage counts the children evaluated so far
+typedef struct {
+    const dice_ast_node_t *node;
+    int64_t value;      // Left operand or dice count, held between stages
+    int32_t depth;      // Nesting depth, checked against policy.max_depth
+    int32_t stage;
+} eval_frame_t;
+
+typedef struct {
+    eval_frame_t *frames;
+    size_t count;
+    size_t capacity;
+    size_t nodes;       // Nodes visited so far
+    size_t node_budget; // policy.max_nodes, or SIZE_MAX when unlimited
+    int depth_limit;    // policy.max_depth, or INT_MAX when unlimited
+} eval_stack_t;
+
+static void eval_limit_error(dice_context_t *ctx, const eval_stack_t *stack) {
+    if (stack->nodes >= stack->node_budget) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Expression exceeds node limit of %d", ctx->policy.max_nodes);
+    } else {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Expression exceeds nesting depth limit of %d", ctx->policy.max_depth);
+    }
+    ctx->error.has_error = true;
+}
+
+// Visit a child: 0 when its value is ready (literals need no frame),
+// 1 when a frame was pushed for it, -1 on error
+static inline int eval_descend(dice_context_t *ctx, eval_stack_t *stack, const dice_ast_node_t *node,
+                               int depth, int64_t *value) {
+    if (!node) return -1;
+    
+    if (stack->nodes >= stack->node_budget || depth > stack->depth_limit) {
+        eval_limit_error(ctx, stack);
+        return -1;
+    }
+    stack->nodes++;
+    
+    if (node->type == DICE_NODE_LITERAL) {
+        *value = node->data.literal.value;
+        return 0;
+    }
+    
+    if (stack->count == stack->capacity) {
+        size_t capacity = stack->capacity * 2;
+        eval_frame_t *grown = arena_alloc_scratch(ctx, capacity * sizeof(eval_frame_t));
+        if (!grown) {
+            snprintf(ctx->error.message, sizeof(ctx->error.message),
+                    "Failed to allocate memory for evaluation stack");
+            ctx->error.has_error = true;
+            return -1;
+        }
+        memcpy(grown, stack->frames, stack->count * sizeof(eval_frame_t));
+        stack->frames = grown;
+        stack->capacity = capacity;
+    }
+    
+    eval_frame_t *frame = &stack->frames[stack->count++];
+    frame->node = node;
+    frame->value = 0;
+    frame->depth = depth;
+    frame->stage = 0;
+    return 1;
+}
+
+static bool eval_binary_op(dice_context_t *ctx, dice_binary_op_t op, int64_t left, int64_t right, int64_t *out) {
+    switch (op) {
+        case DICE_OP_ADD:
+            *out = left + right;
+            return true;
+        case DICE_OP_SUB:
+            *out = left - right;
+            return true;
+        case DICE_OP_MUL:
+            *out = left * right;
+            return true;
+        case DICE_OP_DIV:
+            if (right == 0) {
                 snprintf(ctx->error.message, sizeof(ctx->error.message),
-                        "Too many dice: %lld exceeds limit of %d", 
-                        (long long)count, ctx->policy.max_dice_count);
+                        "Division by zero");
                 ctx->error.has_error = true;
-                return result;
+                return false;
             }
+            *out = left / right;
+            return true;
+        default:
+            snprintf(ctx->error.message, sizeof(ctx->error.message),
+                    "Unknown binary operator");
+            ctx->error.has_error = true;
+            return false;
+    }
+}
+
+static bool eval_roll_custom_node(dice_context_t *ctx, const dice_ast_node_t *node, int64_t count, int64_t *out) {
+    const dice_custom_die_t *custom_die = NULL;
+    
+    if (node->data.dice_op.custom_die) {
+        // Inline custom die
+        custom_die = node->data.dice_op.custom_die;
+    } else if (node->data.dice_op.custom_name) {
+        // Named custom die - look up in registry
+        custom_die = registry_resolve(ctx, node->data.dice_op.custom_name,
+                                      node->data.dice_op.bound_die,
+                                      node->data.dice_op.bound_generation);
+        if (!custom_die) {
+            snprintf(ctx->error.message, sizeof(ctx->error.message),
+                    "Unknown custom die: %s", node->data.dice_op.custom_name);
+            ctx->error.has_error = true;
+            return false;
+        }
+    } else {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Custom die has no definition or name");
+        ctx->error.has_error = true;
+        return false;
+    }
+    
+    if (custom_die->side_count == 0) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Custom die has no sides");
+        ctx->error.has_error = true;
+        return false;
+    }
+    
+    // Roll custom dice
+    int64_t sum = 0;
+    bool full_trace = ctx->trace_level == DICE_TRACE_FULL;
+    bool record = ctx->results != NULL;
+    uint64_t picks[EVAL_ROLL_BLOCK];
+    if (record) results_begin_op(ctx, (int)custom_die->side_count);
+    for (int64_t done = 0; done < count; ) {
+        size_t n = count - done < EVAL_ROLL_BLOCK ? (size_t)(count - done) : EVAL_ROLL_BLOCK;
+        if (!eval_pick_custom_sides(ctx, custom_die->side_count, custom_die->total_weight,
+                                    custom_die->alias, picks, n)) {
+            return false;
+        }
+        
+        for (size_t i = 0; i < n; i++) {
+            int64_t roll_value = custom_die->sides[picks[i]].value;
             
-            int64_t sum = 0;
+            // Add to trace (use side count as "sides" for tracing purposes)
+            if (full_trace) trace_atomic_roll(ctx, (int)custom_die->side_count, (int)roll_value);
+            if (record) results_add_value(ctx, roll_value, true);
             
-            if (node->data.dice_op.dice_type == DICE_DICE_CUSTOM) {
-                // Handle custom dice
-                const dice_custom_die_t *custom_die = NULL;
-                
-                if (node->data.dice_op.custom_die) {
-                    // Inline custom die
-                    custom_die = node->data.dice_op.custom_die;
-                } else if (node->data.dice_op.custom_name) {
-                    // Named custom die - look up in registry
-                    custom_die = dice_lookup_custom_die(ctx, node->data.dice_op.custom_name);
-                    if (!custom_die) {
-                        snprintf(ctx->error.message, sizeof(ctx->error.message),
-                                "Unknown custom die: %s", node->data.dice_op.custom_name);
-                        ctx->error.has_error = true;
-                        return result;
-                    }
-                } else {
-                    snprintf(ctx->error.message, sizeof(ctx->error.message),
-                            "Custom die has no definition or name");
-                    ctx->error.has_error = true;
-                    return result;
+            sum += roll_value;
+        }
+        done += (int64_t)n;
+    }
+    trace_summary_add(ctx, (uint64_t)count, 0, 0);
+    
+    *out = sum;
+    return true;
+}
+
+// Standard dice (basic or with selection) once count and sides are known
+static bool eval_roll_standard_node(dice_context_t *ctx, const dice_ast_node_t *node,
+                                    int64_t count, int64_t sides, int64_t *out) {
+    if (!eval_check_dice_sides(ctx, sides)) {
+        return false;
+    }
+    
+    if (node->data.dice_op.dice_type == DICE_DICE_FILTER) {
+        // Handle filter operations (kh/kl/dh/dl/s>N/s<N unified)
+        *out = evaluate_dice_filter(ctx, count, (int)sides, node->data.dice_op.selection);
+    } else if (node->data.dice_op.dice_type == DICE_DICE_POOL) {
+        *out = evaluate_dice_pool(ctx, count, (int)sides, node->data.dice_op.selection);
+    } else if (node->data.dice_op.dice_type == DICE_DICE_EXPLODING) {
+        // Explosion thresholds are literals; NULL explodes on the maximum
+        const dice_ast_node_t *threshold = node->data.dice_op.modifier;
+        *out = eval_roll_exploding(ctx, count, (int)sides,
+                                   threshold ? threshold->data.literal.value : 0,
+                                   node->data.dice_op.compounding);
+    } else {
+        // Roll standard dice (basic operation)
+        *out = eval_roll_basic(ctx, count, (int)sides);
+    }
+    
+    // Errors are set by the roll itself
+    return !ctx->error.has_error;
+}
+
+// Post-order walk over an explicit stack: no C recursion, so the call
+// stack used is the same for any expression shape
+static dice_eval_result_t evaluate_node(dice_context_t *ctx, const dice_ast_node_t *root) {
+    dice_eval_result_t result = {0, false};
+    
+    if (!ctx || !root) {
+        return result;
+    }
+    
+    eval_frame_t local_frames[EVAL_LOCAL_FRAMES];
+    eval_stack_t stack = {
+        .frames = local_frames,
+        .capacity = EVAL_LOCAL_FRAMES,
+        .node_budget = ctx->policy.max_nodes > 0 ? (size_t)ctx->policy.max_nodes : SIZE_MAX,
+        .depth_limit = ctx->policy.max_depth > 0 ? ctx->policy.max_depth : INT_MAX
+    };
+    
+    int64_t value = 0; // Value of the node completed last
+    if (eval_descend(ctx, &stack, root, 0, &value) < 0) return result;
+    
+    while (stack.count > 0) {
+        eval_frame_t *frame = &stack.frames[stack.count - 1];
+        const dice_ast_node_t *node = frame->node;
+        int stage = frame->stage;
+        int pending;
+        
+        switch (node->type) {
+            case DICE_NODE_BINARY_OP:
+                if (stage == 0) {
+                    // The left operand continues a chain like 1+2+3, so it does not nest
+                    frame->stage = 1;
+                    pending = eval_descend(ctx, &stack, node->data.binary_op.left, frame->depth, &value);
+                    if (pending < 0) return result;
+                    if (pending) continue;
                 }
-                
-                if (custom_die->side_count == 0) {
-                    snprintf(ctx->error.message, sizeof(ctx->error.message),
-                            "Custom die has no sides");
-                    ctx->error.has_error = true;
-                    return result;
+                if (stage <= 1) {
+                    frame->value = value;
+                    frame->stage = 2;
+                    pending = eval_descend(ctx, &stack, node->data.binary_op.right, frame->depth + 1, &value);
+                    if (pending < 0) return result;
+                    if (pending) continue;
                 }
-                
-                // Roll custom dice
-                for (int i = 0; i < count; i++) {
-                    // Generate random index for the side
-                    uint64_t rand_val = ctx->rng.rand(ctx->rng.state, custom_die->side_count);
-                    if (rand_val >= custom_die->side_count) {
-                        // Fallback to simple modulo if rand function misbehaves
-                        rand_val = rand_val % custom_die->side_count;
+                if (!eval_binary_op(ctx, node->data.binary_op.op, frame->value, value, &value)) return result;
+                break;
+            
+            case DICE_NODE_DICE_OP:
+                // Count, then sides, then the roll, as the RNG stream expects
+                if (stage == 0) {
+                    value = 1;
+                    frame->stage = 1;
+                    if (node->data.dice_op.count) {
+                        pending = eval_descend(ctx, &stack, node->data.dice_op.count, frame->depth + 1, &value);
+                        if (pending < 0) return result;
+                        if (pending) continue;
                     }
-                    
-                    int64_t roll_value = custom_die->sides[rand_val].value;
-                    
-                    // Add to trace (use side count as "sides" for tracing purposes)
-                    trace_atomic_roll(ctx, (int)custom_die->side_count, (int)roll_value);
-                    
-                    sum += roll_value;
-                }
-                
-            } else {
-                // Handle standard dice (basic or with selection)
-                dice_eval_result_t sides_result = dice_evaluate(ctx, node->data.dice_op.sides);
-                if (!sides_result.success) return sides_result;
-                int64_t sides = sides_result.value;
-                
-                if (sides <= 0) {
-                    snprintf(ctx->error.message, sizeof(ctx->error.message),
-                            "Dice sides must be positive, got %lld", (long long)sides);
-                    ctx->error.has_error = true;
-                    return result;
-                }
-                
-                if (sides > ctx->policy.max_sides) {
-                    snprintf(ctx->error.message, sizeof(ctx->error.message),
-                            "Too many sides: %lld exceeds limit of %d", 
-                            (long long)sides, ctx->policy.max_sides);
-                    ctx->error.has_error = true;
-                    return result;
                 }
-                
-                if (node->data.dice_op.dice_type == DICE_DICE_FILTER) {
-                    // Handle filter operations (kh/kl/dh/dl/s>N/s<N unified)
-                    sum = evaluate_dice_filter(ctx, count, (int)sides, node->data.dice_op.selection);
-                    if (ctx->error.has_error) {
-                        return result; // Error was set by evaluate_dice_filter
+                if (stage <= 1) {
+                    if (!eval_check_dice_count(ctx, value)) {
+                        return result;
                     }
-                } else {
-                    // Roll standard dice (basic operation)
-                    for (int i = 0; i < count; i++) {
-                        int roll = ctx->rng.roll(ctx->rng.state, (int)sides);
-                        if (roll < 0) {
-                            snprintf(ctx->error.message, sizeof(ctx->error.message),
-                                    "RNG error during dice roll");
-                            ctx->error.has_error = true;
-                            return result;
-                        }
-                        
-                        // Add to trace
-                        trace_atomic_roll(ctx, (int)sides, roll);
-                        
-                        sum += roll;
+                    if (node->data.dice_op.dice_type == DICE_DICE_CUSTOM) {
+                        if (!eval_roll_custom_node(ctx, node, value, &value)) return result;
+                        break;
                     }
+                    
+                    frame->value = value;
+                    frame->stage = 2;
+                    pending = eval_descend(ctx, &stack, node->data.dice_op.sides, frame->depth + 1, &value);
+                    if (pending < 0) return result;
+                    if (pending) continue;
                 }
-            }
+                if (!eval_roll_standard_node(ctx, node, frame->value, value, &value)) return result;
+                break;
             
-            result.value = sum;
-            result.success = true;
-            break;
+            case DICE_NODE_FUNCTION_CALL:
+                // Function calls not yet implemented
+                snprintf(ctx->error.message, sizeof(ctx->error.message),
+                        "Function calls not yet supported: %s", 
+                        node->data.function_call.name);
+                ctx->error.has_error = true;
+                return result;
+            
+            case DICE_NODE_ANNOTATION:
+                // Evaluate child and ignore annotation
+                if (stage == 0) {
+                    frame->stage = 1;
+                    pending = eval_descend(ctx, &stack, node->data.annotation.child, frame->depth, &value);
+                    if (pending < 0) return result;
+                    if (pending) continue;
+                }
+                break;
+            
+            default:
+                return result;
         }
         
-        case DICE_NODE_FUNCTION_CALL:
-            // Function calls not yet implemented
-            snprintf(ctx->error.message, sizeof(ctx->error.message),
-                    "Function calls not yet supported: %s", 
-                    node->data.function_call.name);
-            ctx->error.has_error = true;
-            break;
-            
-        case DICE_NODE_ANNOTATION:
-            // Evaluate child and ignore annotation
-            return dice_evaluate(ctx, node->data.annotation.child);
+        stack.count--;
     }
     
+    result.value = value;
+    result.success = true;
+    return result;
+}
+
+dice_eval_result_t dice_evaluate(dice_context_t *ctx, const dice_ast_node_t *node) {
+#ifdef DICE_ENABLE_COUNTERS
+    if (!ctx) return evaluate_node(ctx, node);
+    
+    uint64_t start = counters_now_ns();
+    dice_eval_result_t result = evaluate_node(ctx, node);
+    DICE_COUNT(ctx, evaluate_calls, 1);
+    DICE_COUNT(ctx, evaluate_ns, counters_now_ns() - start);
     return result;
+#else
+    return evaluate_node(ctx, node);
+#endif
 }
 
 // Comparison function for sorting dice rolls
@@ -212,11 +649,146 @@ static int compare_rolls_asc(const void *a, const void *b) {
     return roll_a - roll_b; // Ascending order
 }
 
-int64_t evaluate_dice_filter(dice_context_t *ctx, int64_t count, int sides, const dice_selection_t *selection) {
-    if (!ctx || !selection) return 0;
+// Faces up to this size are ranked with a histogram, larger ones with quickselect
+#define SELECT_HISTOGRAM_MAX_SIDES 4096
+
+// Value of the k-th (1-based) die in ranking order, by in-place quickselect on a copy.
+// Pivots are chosen deterministically so no RNG draws are consumed.
+static int select_threshold_quickselect(dice_context_t *ctx, const int *rolls, int64_t count,
+                                        int64_t k, bool select_high, bool *ok) {
+    int *values = arena_alloc_scratch(ctx, (size_t)count * sizeof(int));
+    if (!values) {
+        *ok = false;
+        return 0;
+    }
+    
+    // Rank on negated values for keep-high so one ascending select serves both
+    for (int64_t i = 0; i < count; i++) {
+        values[i] = select_high ? -rolls[i] : rolls[i];
+    }
+    
+    int64_t lo = 0, hi = count - 1, target = k - 1;
+    while (lo < hi) {
+        // Median of three
+        int64_t mid = lo + (hi - lo) / 2;
+        int a = values[lo], b = values[mid], c = values[hi];
+        int pivot = (a < b) ? ((b < c) ? b : (a < c ? c : a)) : ((a < c) ? a : (b < c ? c : b));
+        
+        // Three-way partition: [lo, lt) < pivot, [lt, gt] == pivot, (gt, hi] > pivot
+        int64_t lt = lo, gt = hi, i = lo;
+        while (i <= gt) {
+            if (values[i] < pivot) {
+                int t = values[i]; values[i] = values[lt]; values[lt] = t;
+                lt++;
+                i++;
+            } else if (values[i] > pivot) {
+                int t = values[i]; values[i] = values[gt]; values[gt] = t;
+                gt--;
+            } else {
+                i++;
+            }
+        }
+        
+        if (target < lt) {
+            hi = lt - 1;
+        } else if (target > gt) {
+            lo = gt + 1;
+        } else {
+            lo = hi = target;
+            values[target] = pivot;
+        }
+    }
+    
+    return select_high ? -values[target] : values[target];
+}
+
+// Value of the k-th (1-based) die in ranking order, counting faces
+static int select_threshold_histogram(dice_context_t *ctx, const int *rolls, int64_t count,
+                                      int sides, int64_t k, bool select_high, bool *ok) {
+    int64_t *histogram = arena_try_alloc(ctx, ((size_t)sides + 1) * sizeof(int64_t));
+    if (!histogram) {
+        // Small fixed arenas may not fit the histogram but still fit a copy of the rolls
+        return select_threshold_quickselect(ctx, rolls, count, k, select_high, ok);
+    }
+    
+    for (int64_t i = 0; i < count; i++) {
+        if (rolls[i] < 1 || rolls[i] > sides) {
+            // Out-of-range values from a custom RNG; rank them generically
+            return select_threshold_quickselect(ctx, rolls, count, k, select_high, ok);
+        }
+        histogram[rolls[i]]++;
+    }
     
+    int64_t seen = 0;
+    for (int step = 0; step < sides; step++) {
+        int face = select_high ? sides - step : step + 1;
+        seen += histogram[face];
+        if (seen >= k) return face;
+    }
+    return select_high ? 1 : sides;
+}
+
+// Mark the k best dice (highest or lowest) in selected[], choosing among tied
+// dice exactly as the original exchange sort did:
+//
+//   for i: for j > i: if (rolls[j] beats rolls[i]) swap(i, j)
+//
+// Each pass of that sort rotates the "records" (strict running best values)
+// one step. Dice worse than the threshold never influence which tied dice
+// win, and every die strictly better than the threshold moves the earliest
+// tied die to behind all tied dice seen so far. So the tied dice form a queue
+// in index order: each better die pops the front and pushes it to the back,
+// and the first (k - #better) dice left in the queue are selected.
+static bool select_dice_by_rank(dice_context_t *ctx, const int *rolls, int64_t count, int sides,
+                                int64_t k, bool select_high, bool *selected) {
+    bool ok = true;
+    int threshold = sides <= SELECT_HISTOGRAM_MAX_SIDES ?
+        select_threshold_histogram(ctx, rolls, count, sides, k, select_high, &ok) :
+        select_threshold_quickselect(ctx, rolls, count, k, select_high, &ok);
+    if (!ok) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Failed to allocate memory for dice selection");
+        ctx->error.has_error = true;
+        return false;
+    }
+    
+    int64_t *ties = arena_alloc_scratch(ctx, (size_t)count * sizeof(int64_t));
+    if (!ties) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Failed to allocate memory for dice selection");
+        ctx->error.has_error = true;
+        return false;
+    }
+    
+    // Ring buffer of tied indices; capacity count never overflows since it
+    // only ever holds each tied die once
+    int64_t head = 0, queued = 0, better = 0;
+    for (int64_t i = 0; i < count; i++) {
+        int roll = rolls[i];
+        bool beats = select_high ? roll > threshold : roll < threshold;
+        
+        selected[i] = beats;
+        if (beats) {
+            better++;
+            if (queued > 0) {
+                ties[(head + queued) % count] = ties[head];
+                head = (head + 1) % count;
+            }
+        } else if (roll == threshold) {
+            ties[(head + queued) % count] = i;
+            queued++;
+        }
+    }
+    
+    for (int64_t i = 0; i < k - better; i++) {
+        selected[ties[(head + i) % count]] = true;
+    }
+    return true;
+}
+
+static int64_t filter_dice(dice_context_t *ctx, int64_t count, int sides, const dice_selection_t *selection) {
     // Allocate array to store all roll results
-    int *rolls = arena_alloc(ctx, count * sizeof(int));
+    int *rolls = arena_alloc_scratch(ctx, count * sizeof(int));
     if (!rolls) {
         snprintf(ctx->error.message, sizeof(ctx->error.message),
                 "Failed to allocate memory for dice rolls");
@@ -225,7 +797,7 @@ int64_t evaluate_dice_filter(dice_context_t *ctx, int64_t count, int sides, cons
     }
     
     // Allocate array to track which dice are selected
-    bool *selected = arena_alloc(ctx, count * sizeof(bool));
+    bool *selected = arena_alloc_scratch(ctx, count * sizeof(bool));
     if (!selected) {
         snprintf(ctx->error.message, sizeof(ctx->error.message),
                 "Failed to allocate memory for selection tracking");
@@ -239,18 +811,18 @@ int64_t evaluate_dice_filter(dice_context_t *ctx, int64_t count, int sides, cons
     }
     
     // Roll all dice and store results
-    for (int i = 0; i < count; i++) {
-        int roll = ctx->rng.roll(ctx->rng.state, sides);
-        if (roll < 0) {
-            snprintf(ctx->error.message, sizeof(ctx->error.message),
-                    "RNG error during dice roll");
-            ctx->error.has_error = true;
-            return 0;
-        }
-        rolls[i] = roll;
+    if (rng_roll_n(ctx, sides, rolls, (size_t)count) != 0) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "RNG error during dice roll");
+        ctx->error.has_error = true;
+        return 0;
     }
     
     int64_t sum = 0;
+    bool full_trace = ctx->trace_level == DICE_TRACE_FULL;
+    bool record = ctx->results != NULL;
+    size_t first_die = record ? results_begin_op(ctx, sides) : 0;
+    uint64_t total_rerolls = 0;
     
     if (selection->is_conditional && selection->is_reroll) {
         // Reroll operations (r, r1, r>N, r<N, etc.)
@@ -292,11 +864,11 @@ int64_t evaluate_dice_filter(dice_context_t *ctx, int64_t count, int sides, cons
                 
                 if (matches_reroll_condition) {
                     // Mark as rerolled for tracing
-                    trace_atomic_roll_selected(ctx, sides, roll, false);
+                    if (full_trace) trace_atomic_roll_selected(ctx, sides, roll, false);
                     
                     // Reroll the die
-                    int new_roll = ctx->rng.roll(ctx->rng.state, sides);
-                    if (new_roll < 0) {
+                    int new_roll;
+                    if (rng_roll_n(ctx, sides, &new_roll, 1) != 0 || new_roll < 0) {
                         snprintf(ctx->error.message, sizeof(ctx->error.message),
                                 "RNG error during reroll");
                         ctx->error.has_error = true;
@@ -310,6 +882,7 @@ int64_t evaluate_dice_filter(dice_context_t *ctx, int64_t count, int sides, cons
             }
             
             if (reroll_count >= max_rerolls) {
+                DICE_COUNT(ctx, reroll_limit_hits, 1);
                 snprintf(ctx->error.message, sizeof(ctx->error.message),
                         "Maximum reroll limit (%d) exceeded for die %d", max_rerolls, i + 1);
                 ctx->error.has_error = true;
@@ -317,6 +890,11 @@ int64_t evaluate_dice_filter(dice_context_t *ctx, int64_t count, int sides, cons
             }
             
             // Store final result
+            total_rerolls += (uint64_t)reroll_count;
+            if (record) {
+                results_add_value(ctx, roll, true);
+                results_set_rerolls(ctx, first_die + (size_t)i, (uint32_t)reroll_count);
+            }
             rolls[i] = roll;
             selected[i] = true; // All dice are selected in reroll operations
             sum += roll;
@@ -393,76 +971,207 @@ int64_t evaluate_dice_filter(dice_context_t *ctx, int64_t count, int sides, cons
         
         // Special case: if selecting 0 dice (drop all or more), return 0
         if (actual_select_count == 0) {
+            if (record) results_add_rolls(ctx, rolls, selected, (size_t)count);
             return 0;
         }
         
-        // We need to track original indices to mark the correct dice as selected
-        // Create an array of indices paired with values for sorting
-        typedef struct {
-            int value;
-            int original_index;
-        } roll_with_index_t;
-        
-        roll_with_index_t *indexed_rolls = arena_alloc(ctx, count * sizeof(roll_with_index_t));
-        if (!indexed_rolls) {
-            snprintf(ctx->error.message, sizeof(ctx->error.message),
-                    "Failed to allocate memory for indexed rolls");
-            ctx->error.has_error = true;
+        if (!select_dice_by_rank(ctx, rolls, count, sides, actual_select_count,
+                                 selection->select_high, selected)) {
             return 0;
         }
-        
-        // Fill the indexed array
         for (int i = 0; i < count; i++) {
-            indexed_rolls[i].value = rolls[i];
-            indexed_rolls[i].original_index = i;
+            if (selected[i]) sum += rolls[i];
         }
-        
-        // Sort indexed rolls based on selection type
-        if (selection->select_high) {
-            // Sort high to low - we want the highest values first
-            for (int i = 0; i < count - 1; i++) {
-                for (int j = i + 1; j < count; j++) {
-                    if (indexed_rolls[j].value > indexed_rolls[i].value) {
-                        roll_with_index_t temp = indexed_rolls[i];
-                        indexed_rolls[i] = indexed_rolls[j];
-                        indexed_rolls[j] = temp;
-                    }
-                }
+    }
+    
+    // Rerolled dice were recorded one by one above
+    if (record && !(selection->is_conditional && selection->is_reroll)) {
+        results_add_rolls(ctx, rolls, selected, (size_t)count);
+    }
+    
+    // Now add all dice to trace with their selection status
+    uint64_t dropped = 0;
+    for (int i = 0; i < count; i++) {
+        if (!selected[i]) dropped++;
+        if (full_trace) trace_atomic_roll_selected(ctx, sides, rolls[i], selected[i]);
+    }
+    trace_summary_add(ctx, (uint64_t)count + total_rerolls, total_rerolls, dropped);
+    
+    return sum;
+}
+
+// The faces of a die that satisfy a comparison: lo, lo + 1, ... with skip left out
+typedef struct {
+    int64_t lo;
+    int64_t skip;       // excluded face (NEQ), or 0
+    int64_t matches;    // number of matching faces
+} face_set_t;
+
+static bool face_set_init(dice_context_t *ctx, int sides, dice_binary_op_t op, int64_t value,
+                          const char *unknown_op_message, face_set_t *set) {
+    // Values past either end compare like the nearest value just outside the faces
+    int64_t v = value < 0 ? 0 : value > (int64_t)sides + 1 ? (int64_t)sides + 1 : value;
+    int64_t lo = 1, hi = sides;
+    set->skip = 0;
+    
+    switch (op) {
+        case DICE_OP_GT:  lo = v + 1; break;
+        case DICE_OP_GTE: lo = v < 1 ? 1 : v; break;
+        case DICE_OP_LT:  hi = v - 1; break;
+        case DICE_OP_LTE: hi = v > sides ? sides : v; break;
+        case DICE_OP_EQ:  lo = v; hi = v; break;
+        case DICE_OP_NEQ: if (v >= 1 && v <= sides) set->skip = v; break;
+        default:
+            snprintf(ctx->error.message, sizeof(ctx->error.message), "%s", unknown_op_message);
+            ctx->error.has_error = true;
+            return false;
+    }
+    
+    set->lo = lo;
+    if (lo < 1 || hi > sides || lo > hi) {
+        set->matches = 0;
+    } else {
+        set->matches = hi - lo + 1 - (set->skip ? 1 : 0);
+    }
+    return true;
+}
+
+static int64_t face_set_face(const face_set_t *set, int64_t index) {
+    int64_t face = set->lo + index;
+    return set->skip && face >= set->skip ? face + 1 : face;
+}
+
+// Untraced conditional selection: the number of matching dice is
+// Binomial(count, matches / sides) and, given that number, each matching die
+// is uniform over the matching faces, so only those dice are rolled
+static int64_t filter_conditional_sampled(dice_context_t *ctx, int64_t count, int sides,
+                                          const dice_selection_t *selection) {
+    face_set_t set;
+    if (!face_set_init(ctx, sides, selection->comparison_op, selection->comparison_value,
+                       "Unknown comparison operator in conditional filter", &set)) {
+        return 0;
+    }
+    
+    int64_t selected;
+    if (!eval_sample_binomial(ctx, count, (double)set.matches / (double)sides, &selected)) return 0;
+    trace_summary_add(ctx, (uint64_t)count, 0, (uint64_t)(count - selected));
+    
+    if (set.matches == 1) return selected * face_set_face(&set, 0);
+    
+    int64_t sum = 0;
+    int block[EVAL_ROLL_BLOCK];
+    for (int64_t done = 0; done < selected; ) {
+        size_t n = selected - done < EVAL_ROLL_BLOCK ? (size_t)(selected - done) : EVAL_ROLL_BLOCK;
+        if (rng_roll_n(ctx, (int)set.matches, block, n) != 0) {
+            snprintf(ctx->error.message, sizeof(ctx->error.message),
+                    "RNG error during dice roll");
+            ctx->error.has_error = true;
+            return 0;
+        }
+        for (size_t i = 0; i < n; i++) sum += face_set_face(&set, block[i] - 1);
+        done += (int64_t)n;
+    }
+    return sum;
+}
+
+int64_t evaluate_dice_pool(dice_context_t *ctx, int64_t count, int sides, const dice_selection_t *selection) {
+    if (!ctx || !selection) return 0;
+    
+    face_set_t set;
+    if (!face_set_init(ctx, sides, selection->comparison_op, selection->comparison_value,
+                       "Unknown comparison operator in success pool", &set)) {
+        return 0;
+    }
+    
+    int64_t successes = 0;
+    bool full_trace = ctx->trace_level == DICE_TRACE_FULL;
+    bool record = ctx->results != NULL;
+    if (!full_trace && !record) {
+        // Only the count matters, so draw it directly
+        if (!eval_sample_binomial(ctx, count, (double)set.matches / (double)sides, &successes)) return 0;
+    } else {
+        int64_t hi = face_set_face(&set, set.matches - 1);
+        int block[EVAL_ROLL_BLOCK];
+        if (record) results_begin_op(ctx, sides);
+        for (int64_t done = 0; done < count; ) {
+            size_t n = count - done < EVAL_ROLL_BLOCK ? (size_t)(count - done) : EVAL_ROLL_BLOCK;
+            if (rng_roll_n(ctx, sides, block, n) != 0) {
+                snprintf(ctx->error.message, sizeof(ctx->error.message),
+                        "RNG error during dice roll");
+                ctx->error.has_error = true;
+                return 0;
             }
-        } else {
-            // Sort low to high - we want the lowest values first
-            for (int i = 0; i < count - 1; i++) {
-                for (int j = i + 1; j < count; j++) {
-                    if (indexed_rolls[j].value < indexed_rolls[i].value) {
-                        roll_with_index_t temp = indexed_rolls[i];
-                        indexed_rolls[i] = indexed_rolls[j];
-                        indexed_rolls[j] = temp;
-                    }
-                }
+            for (size_t i = 0; i < n; i++) {
+                bool success = set.matches > 0 && block[i] >= set.lo && block[i] <= hi &&
+                               block[i] != set.skip;
+                if (full_trace) trace_atomic_roll_selected(ctx, sides, block[i], success);
+                if (record) results_add_value(ctx, block[i], success);
+                if (success) successes++;
             }
-        }
-        
-        // Mark the selected dice and sum them
-        for (int i = 0; i < actual_select_count; i++) {
-            int original_idx = indexed_rolls[i].original_index;
-            selected[original_idx] = true;
-            sum += indexed_rolls[i].value;
+            done += (int64_t)n;
         }
     }
     
-    // Now add all dice to trace with their selection status
-    for (int i = 0; i < count; i++) {
-        trace_atomic_roll_selected(ctx, sides, rolls[i], selected[i]);
+    trace_summary_add(ctx, (uint64_t)count, 0, (uint64_t)(count - successes));
+    return successes;
+}
+
+int64_t evaluate_dice_filter(dice_context_t *ctx, int64_t count, int sides, const dice_selection_t *selection) {
+    if (!ctx || !selection) return 0;
+    
+    if (selection->is_conditional && !selection->is_reroll && ctx->trace_level != DICE_TRACE_FULL &&
+        !ctx->results) {
+        return filter_conditional_sampled(ctx, count, sides, selection);
     }
     
+    size_t mark = dice_arena_mark(ctx);
+    size_t trace_count = ctx->trace.count;
+    int64_t sum = filter_dice(ctx, count, sides, selection);
+    
+    // The roll buffers are dead now; reclaim them unless trace entries were
+    // allocated after them (packed traces live on the heap)
+    if (ctx->trace.count == trace_count || ctx->trace_packing) {
+        dice_arena_rewind(ctx, mark);
+    }
     return sum;
 }
 
+int dice_evaluate_batch(dice_context_t *ctx, const dice_ast_node_t *node, size_t n, int64_t *out) {
+    if (!ctx || !node || (n > 0 && !out)) return -1;
+    
+    dice_trace_level_t saved_level = ctx->trace_level;
+    ctx->trace_level = DICE_TRACE_OFF;
+    
+    // Everything a sample allocates past this point is scratch; reclaim it per sample
+    size_t arena_mark = dice_arena_mark(ctx);
+    int status = 0;
+    
+    for (size_t i = 0; i < n; i++) {
+        dice_eval_result_t result = dice_evaluate(ctx, node);
+        dice_arena_rewind(ctx, arena_mark);
+        
+        if (!result.success) {
+            status = -1;
+            break;
+        }
+        out[i] = result.value;
+    }
+    
+    ctx->trace_level = saved_level;
+    return status;
+}
+
 dice_eval_result_t dice_roll_expression(dice_context_t *ctx, const char *expression_str) {
     dice_eval_result_t result = {0, false};
     
     if (!ctx || !expression_str) return result;
     
+    if (ctx->parse_cache) {
+        const dice_program_t *program = dice_parse_cache_get(ctx->parse_cache, ctx, expression_str);
+        if (!program) return result;
+        return dice_program_evaluate(ctx, program);
+    }
+    
     dice_ast_node_t *ast = dice_parse(ctx, expression_str);
     if (!ast) return result;
     
@@ -20,8 +20,41 @@ extern "C" {
  */
 void* arena_alloc(dice_context_t *ctx, size_t size);
 
+/**
+ * @brief Arena allocation without zero-initialization, for scratch buffers
+ * @param ctx Context handle containing the arena
+ * @param size Number of bytes to allocate
+ * @return Pointer to allocated memory or NULL on failure
+ */
+void* arena_alloc_scratch(dice_context_t *ctx, size_t size);
+
+/**
+ * @brief Zeroed arena allocation for optional buffers; failure leaves the error state untouched
+ * @param ctx Context handle containing the arena
+ * @param size Number of bytes to allocate
+ * @return Pointer to allocated memory or NULL when it does not fit
+ */
+void* arena_try_alloc(dice_context_t *ctx, size_t size);
+
+/**
+ * @brief Free every growth chunk (the fixed first block is kept)
+ * @param ctx Context handle containing the arena
+ */
+void arena_release(dice_context_t *ctx);
+
+/**
+ * @brief Arena growth chunk; base is the logical arena offset of data[0]
+ */
+struct dice_arena_chunk {
+    struct dice_arena_chunk *next;
+    size_t base;
+    size_t size;
+    char data[];
+};
+
 /**
  * @brief Add atomic roll entry to trace log
+ * @note Callers check for DICE_TRACE_FULL once per dice operation
  * @param ctx Context handle for tracing
  * @param sides Number of sides on the die
  * @param result The actual roll result
@@ -37,6 +70,78 @@ void trace_atomic_roll(dice_context_t *ctx, int sides, int result);
  */
 void trace_atomic_roll_selected(dice_context_t *ctx, int sides, int result, bool selected);
 
+/**
+ * @brief Add one dice operation's totals to the trace summary
+ * @param ctx Context handle for tracing
+ * @param rolled Dice rolled, including rerolls
+ * @param rerolls Dice rolled again by reroll operations
+ * @param dropped Dice rolled but not counted
+ */
+void trace_summary_add(dice_context_t *ctx, uint64_t rolled, uint64_t rerolls, uint64_t dropped);
+
+/**
+ * @brief Start recording a dice operation into ctx->results
+ * @param ctx Context handle
+ * @param sides Sides per die of the operation
+ * @return Index the operation's first die will get
+ * @note This and the other results_* functions do nothing unless
+ *       dice_evaluate_ex() set ctx->results; callers test it before loops
+ */
+size_t results_begin_op(dice_context_t *ctx, int sides);
+
+/**
+ * @brief Append dice to the operation being recorded
+ * @param ctx Context handle
+ * @param rolls Faces, in rolling order
+ * @param selected Whether each die counts, or NULL when all do
+ * @param n Number of dice
+ */
+void results_add_rolls(dice_context_t *ctx, const int *rolls, const bool *selected, size_t n);
+
+/**
+ * @brief Append one die to the operation being recorded
+ * @param ctx Context handle
+ * @param value Face or custom side value
+ * @param kept Whether the die counts toward the total
+ */
+void results_add_value(dice_context_t *ctx, int64_t value, bool kept);
+
+/**
+ * @brief Store the reroll count of a die already in the results
+ * @param ctx Context handle
+ * @param die Die index (from results_begin_op plus its position)
+ * @param rerolls Times the die was rerolled
+ */
+void results_set_rerolls(dice_context_t *ctx, size_t die, uint32_t rerolls);
+
+/**
+ * @brief Flush packed trace records to the sink and free the buffer
+ * @param ctx Context handle
+ */
+void trace_release(dice_context_t *ctx);
+
+/**
+ * @brief Count the dice of a success pool (NdS>N, NdS<N) that satisfy its comparison
+ * @param ctx Context handle for RNG and tracing
+ * @param count Number of dice (already validated)
+ * @param sides Sides per die (already validated)
+ * @param selection Conditional selection holding the comparison
+ * @return Number of successes
+ * @note Below DICE_TRACE_FULL the count is drawn from its binomial distribution
+ *       without rolling the dice
+ */
+int64_t evaluate_dice_pool(dice_context_t *ctx, int64_t count, int sides, const dice_selection_t *selection);
+
+/**
+ * @brief Draw from Binomial(n, p) using the context RNG
+ * @param ctx Context handle for RNG
+ * @param n Number of trials
+ * @param p Success probability
+ * @param out Receives the number of successes
+ * @return true on success; false with the context error set on RNG failure
+ */
+bool eval_sample_binomial(dice_context_t *ctx, int64_t n, double p, int64_t *out);
+
 /**
  * @brief Evaluate dice filter operations (unified keep/drop/conditional)
  * @param ctx Context handle for evaluation and tracing
@@ -44,9 +149,353 @@ void trace_atomic_roll_selected(dice_context_t *ctx, int sides, int result, bool
  * @param sides Number of sides on each die
  * @param selection Filter parameters (count, high/low, conditional, original syntax)
  * @return Sum of filtered dice values
+ * @note Below DICE_TRACE_FULL, conditional selections draw how many dice match
+ *       and roll only those
  */
 int64_t evaluate_dice_filter(dice_context_t *ctx, int64_t count, int sides, const dice_selection_t *selection);
 
+/**
+ * @brief Validate a dice count against positivity and policy limits
+ * @param ctx Context handle (error buffer and policy)
+ * @param count Dice count to check
+ * @return true if valid; false with the context error set otherwise
+ */
+bool eval_check_dice_count(dice_context_t *ctx, int64_t count);
+
+/**
+ * @brief Validate a die size against positivity and policy limits
+ * @param ctx Context handle (error buffer and policy)
+ * @param sides Number of sides to check
+ * @return true if valid; false with the context error set otherwise
+ */
+bool eval_check_dice_sides(dice_context_t *ctx, int64_t sides);
+
+/**
+ * @brief Roll and trace count basic dice
+ * @param ctx Context handle for RNG and tracing
+ * @param count Number of dice (already validated)
+ * @param sides Sides per die (already validated)
+ * @return Sum of the dice; 0 with the context error set on RNG failure
+ */
+int64_t eval_roll_basic(dice_context_t *ctx, int64_t count, int sides);
+
+/**
+ * @brief Roll and trace count exploding dice
+ * @param ctx Context handle for RNG, tracing, and max_explosion_depth
+ * @param count Number of dice (already validated)
+ * @param sides Sides per die (already validated)
+ * @param explode_at Faces at or above this explode; 0 for the maximum face
+ * @param compounding Trace each die's explosions as one value (NdS!!)
+ * @return Sum of the dice; 0 with the context error set on RNG failure
+ */
+int64_t eval_roll_exploding(dice_context_t *ctx, int64_t count, int sides, int64_t explode_at,
+                            bool compounding);
+
+/**
+ * @brief FNV-1a hash of len bytes of key
+ */
+uint64_t hash_fnv1a(const char *key, size_t len);
+
+/**
+ * @brief Resolve a named custom die, trusting a binding made at the current registry generation
+ * @param ctx Context whose registry is consulted
+ * @param name Die name (hash lookup when the binding is stale)
+ * @param bound Previously bound die, or NULL
+ * @param generation Registry generation recorded with the binding
+ * @return The die, or NULL if the name is not registered
+ */
+const dice_custom_die_t* registry_resolve(const dice_context_t *ctx, const char *name,
+                                          const dice_custom_die_t *bound, uint64_t generation);
+
+/**
+ * @brief Free the context's own custom dice registry, or detach a shared one
+ * @param ctx Context handle; its registry is left empty and unshared
+ */
+void registry_release(dice_context_t *ctx);
+
+/**
+ * @brief Point the context at a frozen registry it reads but never writes
+ * @param ctx Context handle; its own registry is released first
+ * @param frozen Registry that outlives the context (a template's)
+ * @note The first registration or clear gives the context a private copy
+ */
+void registry_share(dice_context_t *ctx, const dice_custom_die_registry_t *frozen);
+
+/**
+ * @brief A template's frozen custom dice registry
+ */
+const dice_custom_die_registry_t* template_registry(const dice_context_template_t *tmpl);
+
+/**
+ * @brief dice_ast_traverse() that reports failure to allocate its stack
+ * @param node Root node
+ * @param visitor Visitor callbacks
+ * @return true when every node was visited
+ * @note Iterative, so C stack use does not depend on the tree's shape
+ */
+bool ast_walk(const dice_ast_node_t *node, const dice_ast_visitor_t *visitor);
+
+// Spines up to this length need no heap allocation
+#define AST_LOCAL_SPINE 8
+
+/**
+ * @brief The binary nodes down a node's left operands, as in 1+2+...+N
+ */
+typedef struct {
+    const dice_ast_node_t **nodes;  // nodes[0] is the top; the leaf is the last node's left
+    size_t length;
+    const dice_ast_node_t *local[AST_LOCAL_SPINE];
+} ast_spine_t;
+
+/**
+ * @brief Collect the left spine of a binary node so passes can loop over long chains
+ * @param spine Spine to fill
+ * @param node Binary node at the top of the spine
+ * @return true on success, false if the node array could not be allocated
+ */
+bool ast_spine_init(ast_spine_t *spine, const dice_ast_node_t *node);
+
+/**
+ * @brief Release a spine's node array
+ */
+void ast_spine_release(ast_spine_t *spine);
+
+// Dice are rolled in blocks of this many values through the bulk RNG entry points
+#define EVAL_ROLL_BLOCK 256
+
+/**
+ * @brief Draw side indices for a block of custom die rolls
+ * @param ctx Context handle for RNG
+ * @param side_count Number of sides (must be > 0)
+ * @param total_weight Sum of side weights, or 0 for equally likely sides
+ * @param alias Alias table (side_count entries) when total_weight is nonzero
+ * @param out Receives n indices in [0, side_count-1]
+ * @param n Number of indices to draw
+ * @return true on success; false with the context error set otherwise
+ */
+bool eval_pick_custom_sides(dice_context_t *ctx, size_t side_count, uint64_t total_weight,
+                            const dice_alias_entry_t *alias, uint64_t *out, size_t n);
+
+/**
+ * @brief Set a custom die's total_weight and build its alias table
+ * @param ctx Context for errors and, with use_arena, the table allocation
+ * @param die Die whose sides are already filled in
+ * @param use_arena Allocate the table from ctx's arena instead of the heap
+ * @return true on success (die->alias stays NULL for equally weighted sides)
+ */
+bool custom_die_init_weights(dice_context_t *ctx, dice_custom_die_t *die, bool use_arena);
+
+/**
+ * @brief Roll n dice through the context RNG's roll_n, or a roll loop if absent
+ * @param ctx Context handle for RNG
+ * @param sides Sides per die
+ * @param out Receives n values in [1, sides]
+ * @param n Number of dice
+ * @return 0 on success, -1 on RNG error
+ */
+int rng_roll_n(dice_context_t *ctx, int sides, int *out, size_t n);
+
+/**
+ * @brief Draw n values through the context RNG's rand_n, or a rand loop if absent
+ * @param ctx Context handle for RNG
+ * @param max Exclusive upper bound
+ * @param out Receives n values in [0, max-1]
+ * @param n Number of values
+ * @return 0 on success, -1 on RNG error
+ */
+int rng_rand_n(dice_context_t *ctx, uint64_t max, uint64_t *out, size_t n);
+
+// Performance counter updates; they compile to nothing without DICE_ENABLE_COUNTERS
+#ifdef DICE_ENABLE_COUNTERS
+#define DICE_COUNT(ctx, field, n) ((ctx)->counters.field += (uint64_t)(n))
+#define DICE_COUNT_MAX(ctx, field, value) \
+    do { \
+        if ((uint64_t)(value) > (ctx)->counters.field) (ctx)->counters.field = (uint64_t)(value); \
+    } while (0)
+
+/**
+ * @brief Current monotonic clock reading in nanoseconds
+ */
+uint64_t counters_now_ns(void);
+
+/**
+ * @brief Collect and clear the rejections counted by the context's RNG engine
+ * @param rng Context RNG
+ * @return Rejections since the previous call (0 for engines that do not count)
+ */
+uint64_t rng_take_rejections(dice_rng_vtable_t *rng);
+#else
+#define DICE_COUNT(ctx, field, n) ((void)0)
+#define DICE_COUNT_MAX(ctx, field, value) ((void)0)
+#endif
+
+/**
+ * @brief Expand a seed into a raw xoshiro256++ state, as dice_create_xoshiro_rng() does
+ */
+void rng_xoshiro_seed_state(uint64_t seed, uint64_t s[4]);
+
+/**
+ * @brief Advance a raw xoshiro256++ state by 2^128 steps
+ */
+void rng_xoshiro_jump_state(uint64_t s[4]);
+
+/**
+ * @brief Copy the raw state out of a dice_create_xoshiro_rng() engine
+ * @return 0 on success, -1 if rng is not a xoshiro256++ engine
+ */
+int rng_xoshiro_get_state(const dice_rng_vtable_t *rng, uint64_t s[4]);
+
+/**
+ * @brief Load a raw state into a dice_create_xoshiro_rng() engine
+ * @return 0 on success, -1 if rng is not a xoshiro256++ engine
+ */
+int rng_xoshiro_set_state(dice_rng_vtable_t *rng, const uint64_t s[4]);
+
+/**
+ * @brief Create a xoshiro256++ engine whose state lives in caller storage
+ * @param storage At least sizeof(ctx->rng_inline) bytes, aligned for uint64_t
+ * @param seed Seed, as for dice_create_xoshiro_rng()
+ * @return Engine with no cleanup; it is valid as long as storage is
+ */
+dice_rng_vtable_t rng_xoshiro_inline(uint64_t *storage, uint64_t seed);
+
+// =============================================================================
+// Four-Lane xoshiro256++ (rng_lanes.c)
+// =============================================================================
+
+// Four independent xoshiro256++ states stored word-major, so s[w] holds word w
+// of every lane and loads as one vector
+typedef struct {
+    uint64_t s[4][4];
+} dice_xoshiro_lanes_t;
+
+/**
+ * @brief Fill out[] with dice in [1, range] using whole four-lane steps
+ * @param lanes Lane states, advanced in place
+ * @param range Die size
+ * @param threshold Lemire rejection threshold, (2^32 - range) % range
+ * @param out Output buffer
+ * @param n Slots available in out
+ * @return Dice written; stops once fewer than 4 slots remain
+ */
+typedef size_t (*rng_lanes_kernel_t)(dice_xoshiro_lanes_t *lanes, uint32_t range,
+                                     uint32_t threshold, int *out, size_t n);
+
+/**
+ * @brief Advance every lane once and return the four raw outputs in lane order
+ */
+void rng_lanes_step(dice_xoshiro_lanes_t *lanes, uint64_t raw[4]);
+
+/**
+ * @brief Portable kernel; every vector kernel matches it bit for bit
+ */
+size_t rng_lanes_fill_scalar(dice_xoshiro_lanes_t *lanes, uint32_t range,
+                             uint32_t threshold, int *out, size_t n);
+
+/**
+ * @brief Pick the widest kernel the running CPU supports (AVX2, SSE2, NEON or scalar)
+ */
+rng_lanes_kernel_t rng_lanes_best_kernel(void);
+
+// =============================================================================
+// Compiled Program Layout
+// =============================================================================
+
+// A dice_program_t is one contiguous, position-independent block: a header
+// followed by the sections below. All section references are byte offsets
+// from the start of the program and all strings are offsets into the string
+// pool (offset 0 is reserved for "no string").
+
+#define DICE_PROGRAM_MAGIC   0x47525044u  // "DPRG" little-endian
+#define DICE_PROGRAM_VERSION 4
+
+typedef enum {
+    DICE_OPC_PUSH,      // push a
+    DICE_OPC_ADD,       // pop r, pop l, push l + r
+    DICE_OPC_SUB,       // pop r, pop l, push l - r
+    DICE_OPC_MUL,       // pop r, pop l, push l * r
+    DICE_OPC_DIV,       // pop r, pop l, push l / r
+    DICE_OPC_ROLL,      // basic NdS
+    DICE_OPC_FILTER,    // NdS with selection aux
+    DICE_OPC_CUSTOM,    // N rolls of custom die aux
+    DICE_OPC_EXPLODE,   // NdS exploding at face aux (0 for the maximum)
+    DICE_OPC_POOL       // successes among NdS, comparison in selection aux
+} dice_opcode_t;
+
+// Operand flags: operand is popped from the stack instead of taken from a/b
+#define DICE_INSTR_COUNT_DYNAMIC 0x01
+#define DICE_INSTR_SIDES_DYNAMIC 0x02
+// DICE_OPC_EXPLODE only: explosions compound into one traced value (NdS!!)
+#define DICE_INSTR_COMPOUNDING   0x04
+
+typedef struct {
+    uint8_t opcode;     // dice_opcode_t
+    uint8_t flags;      // DICE_INSTR_* operand flags
+    uint16_t reserved;
+    uint32_t aux;       // selection or custom die index, or explosion threshold
+    int64_t a;          // literal value or constant dice count
+    int64_t b;          // constant die sides
+} dice_instr_t;
+
+typedef struct {
+    int64_t count;
+    int64_t comparison_value;
+    uint32_t comparison_op;     // dice_binary_op_t
+    uint32_t syntax;            // string offset of original syntax
+    uint8_t select_high;
+    uint8_t is_drop_operation;
+    uint8_t is_conditional;
+    uint8_t is_reroll;
+    uint32_t reserved;
+} dice_program_selection_t;
+
+typedef struct {
+    uint32_t name;              // string offset; 0 for inline dice
+    uint32_t registry_index;    // registry slot the name was bound to at compile time
+    uint32_t first_side;        // index into the side table (inline dice only)
+    uint32_t side_count;        // number of sides (inline dice only)
+    uint64_t registry_generation; // registry generation registry_index is valid for
+    uint64_t total_weight;      // inline dice: sum of side weights, 0 if unweighted
+} dice_program_die_t;
+
+typedef struct {
+    int64_t value;
+    uint32_t label;             // string offset
+    uint32_t reserved;
+} dice_program_side_t;
+
+struct dice_program {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t total_size;        // bytes, including this header
+    uint32_t max_stack;         // deepest value stack the program needs
+    uint32_t instr_offset;
+    uint32_t instr_count;
+    uint32_t selection_offset;
+    uint32_t selection_count;
+    uint32_t die_offset;
+    uint32_t die_count;
+    uint32_t side_offset;
+    uint32_t side_count;
+    uint32_t alias_offset;      // alias table parallel to the side table, or empty
+    uint32_t alias_count;       // side_count if any inline die is weighted, else 0
+    uint32_t string_offset;
+    uint32_t string_size;
+};
+
+#define DICE_PROGRAM_SECTION(program, offset, type) \
+    ((const type*)((const char*)(program) + (offset)))
+
+/**
+ * @brief Check that an untrusted block is a program the interpreter can run safely
+ * @param ctx Context whose policy bounds constant counts and sides; receives the error
+ * @param program Candidate program (8-byte aligned)
+ * @param size Bytes readable at program
+ * @return true if every offset, index, string and stack effect is in range
+ */
+bool program_validate(dice_context_t *ctx, const dice_program_t *program, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,21 +8,136 @@
 // Arena Allocator Implementation
 // =============================================================================
 
-void* arena_alloc(dice_context_t *ctx, size_t size) {
+// The arena is the fixed block handed to dice_context_create followed by an
+// optional list of growth chunks. arena_used is a logical offset across all of
+// them (chunk N starts where chunk N-1 ends), so any saved value of it is a
+// valid mark and rewinding is a single assignment.
+
+static void arena_set_oom(dice_context_t *ctx, size_t size, size_t available) {
+    snprintf(ctx->error.message, sizeof(ctx->error.message),
+            "Arena allocator out of memory: requested %zu, available %zu",
+            size, available);
+    ctx->error.code = -1;
+    ctx->error.has_error = true;
+}
+
+static void arena_free_chunks(dice_arena_chunk_t *chunk) {
+    while (chunk) {
+        dice_arena_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
+// Find the growth chunk holding logical offset arena_used (NULL = first block)
+static dice_arena_chunk_t* arena_locate(dice_context_t *ctx) {
+    if (ctx->arena_used < ctx->arena_size) return NULL;
+    
+    dice_arena_chunk_t *chunk = ctx->arena_current;
+    if (!chunk || chunk->base > ctx->arena_used) {
+        chunk = ctx->arena_chunks;
+    }
+    while (chunk && chunk->base + chunk->size <= ctx->arena_used && chunk->next) {
+        chunk = chunk->next;
+    }
+    return chunk;
+}
+
+static void* arena_alloc_raw(dice_context_t *ctx, size_t size, bool report_oom) {
     // Align to 8-byte boundary
-    size = (size + 7) & ~7;
-    
-    if (ctx->arena_used + size > ctx->arena_size) {
-        snprintf(ctx->error.message, sizeof(ctx->error.message), 
-                "Arena allocator out of memory: requested %zu, available %zu", 
-                size, ctx->arena_size - ctx->arena_used);
-        ctx->error.code = -1;
-        ctx->error.has_error = true;
+    size = (size + 7) & ~(size_t)7;
+    
+    dice_arena_chunk_t *chunk = arena_locate(ctx);
+    
+    // Fast path: fits in the block holding the current offset
+    if (!chunk) {
+        if (ctx->arena_used + size <= ctx->arena_size) {
+            void *ptr = (char*)ctx->arena + ctx->arena_used;
+            ctx->arena_used += size;
+            return ptr;
+        }
+    } else if (ctx->arena_used + size <= chunk->base + chunk->size) {
+        void *ptr = chunk->data + (ctx->arena_used - chunk->base);
+        ctx->arena_used += size;
+        ctx->arena_current = chunk;
+        return ptr;
+    }
+    
+    if (ctx->arena_chunk_size == 0) {
+        size_t end = chunk ? chunk->base + chunk->size : ctx->arena_size;
+        if (report_oom) arena_set_oom(ctx, size, end > ctx->arena_used ? end - ctx->arena_used : 0);
         return NULL;
     }
     
-    void *ptr = (char*)ctx->arena + ctx->arena_used;
-    ctx->arena_used += size;
-    memset(ptr, 0, size);
+    // Move to the next chunk, keeping it if a previous rewind left one big enough
+    dice_arena_chunk_t **link = chunk ? &chunk->next : &ctx->arena_chunks;
+    size_t base = chunk ? chunk->base + chunk->size : ctx->arena_size;
+    if (*link && (*link)->size < size) {
+        arena_free_chunks(*link);
+        *link = NULL;
+    }
+    
+    if (!*link) {
+        size_t chunk_size = ctx->arena_chunk_size > size ? ctx->arena_chunk_size : size;
+        dice_arena_chunk_t *fresh = malloc(sizeof(dice_arena_chunk_t) + chunk_size);
+        if (!fresh) {
+            if (report_oom) arena_set_oom(ctx, size, 0);
+            return NULL;
+        }
+        fresh->next = NULL;
+        fresh->base = base;
+        fresh->size = chunk_size;
+        *link = fresh;
+    }
+    
+    // The tail of the previous block is skipped
+    chunk = *link;
+    ctx->arena_current = chunk;
+    ctx->arena_used = chunk->base + size;
+    return chunk->data;
+}
+
+void* arena_alloc(dice_context_t *ctx, size_t size) {
+    void *ptr = arena_alloc_raw(ctx, size, true);
+    if (ptr) memset(ptr, 0, size);
+    DICE_COUNT_MAX(ctx, arena_high_water, ctx->arena_used);
+    return ptr;
+}
+
+void* arena_alloc_scratch(dice_context_t *ctx, size_t size) {
+    void *ptr = arena_alloc_raw(ctx, size, true);
+    DICE_COUNT_MAX(ctx, arena_high_water, ctx->arena_used);
+    return ptr;
+}
+
+void* arena_try_alloc(dice_context_t *ctx, size_t size) {
+    void *ptr = arena_alloc_raw(ctx, size, false);
+    if (ptr) memset(ptr, 0, size);
+    DICE_COUNT_MAX(ctx, arena_high_water, ctx->arena_used);
     return ptr;
-}
\ No newline at end of file
+}
+
+void arena_release(dice_context_t *ctx) {
+    arena_free_chunks(ctx->arena_chunks);
+    ctx->arena_chunks = NULL;
+    ctx->arena_current = NULL;
+}
+
+size_t dice_arena_mark(const dice_context_t *ctx) {
+    if (!ctx) return 0;
+    return ctx->arena_used;
+}
+
+void dice_arena_rewind(dice_context_t *ctx, size_t mark) {
+    if (!ctx || mark > ctx->arena_used) return;
+    
+    // Growth chunks past the mark are kept for reuse
+    ctx->arena_used = mark;
+}
+
+int dice_context_set_arena_growth(dice_context_t *ctx, size_t chunk_size) {
+    if (!ctx) return -1;
+    
+    ctx->arena_chunk_size = chunk_size;
+    return 0;
+}
@@ -0,0 +1,216 @@
+#include "dice.h"
+#include "internal.h"
+#include <stdio.h>
+#include <string.h>
+
+// =============================================================================
+// AST Optimizer
+// =============================================================================
+
+// The optimizer is an exit_node visitor, so every node is rewritten after its
+// children already are. Rewrites happen in place: a node either becomes a
+// literal, takes over the contents of one of its children, or has its
+// children rearranged. Nodes that drop out of the tree stay in the arena.
+//
+// Every rewrite keeps the order in which dice are rolled, so an optimized
+// tree draws the same RNG values and records the same trace as the original.
+
+typedef struct {
+    dice_context_t *ctx;
+    bool failed;
+} optimizer_t;
+
+static bool is_literal(const dice_ast_node_t *node, int64_t value) {
+    return node->type == DICE_NODE_LITERAL && node->data.literal.value == value;
+}
+
+static bool is_additive(const dice_ast_node_t *node) {
+    return node->type == DICE_NODE_BINARY_OP &&
+           (node->data.binary_op.op == DICE_OP_ADD || node->data.binary_op.op == DICE_OP_SUB);
+}
+
+// Fold l op r, refusing anything evaluation would reject or overflow on so
+// those cases still fail (or wrap) at run time exactly as before
+static bool fold_arith(dice_binary_op_t op, int64_t l, int64_t r, int64_t *out) {
+    switch (op) {
+        case DICE_OP_ADD:
+            if ((r > 0 && l > INT64_MAX - r) || (r < 0 && l < INT64_MIN - r)) return false;
+            *out = l + r;
+            return true;
+        case DICE_OP_SUB:
+            if ((r < 0 && l > INT64_MAX + r) || (r > 0 && l < INT64_MIN + r)) return false;
+            *out = l - r;
+            return true;
+        case DICE_OP_MUL:
+            if (l != 0 && r != 0) {
+                if ((l == -1 && r == INT64_MIN) || (r == -1 && l == INT64_MIN)) return false;
+                int64_t product = (int64_t)((uint64_t)l * (uint64_t)r);
+                if (product / r != l) return false;
+            }
+            *out = l * r;
+            return true;
+        case DICE_OP_DIV:
+            if (r == 0 || (l == INT64_MIN && r == -1)) return false;
+            *out = l / r;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void make_literal(dice_ast_node_t *node, int64_t value) {
+    memset(&node->data, 0, sizeof(node->data));
+    node->type = DICE_NODE_LITERAL;
+    node->data.literal.value = value;
+}
+
+// A plain NdS with constant operands: the only dice that can be merged
+static bool mergeable_dice(const dice_ast_node_t *node, int64_t *count, int64_t *sides) {
+    if (node->type != DICE_NODE_DICE_OP || node->data.dice_op.dice_type != DICE_DICE_BASIC ||
+        node->data.dice_op.selection || node->data.dice_op.modifier) {
+        return false;
+    }
+    
+    const dice_ast_node_t *count_node = node->data.dice_op.count;
+    const dice_ast_node_t *sides_node = node->data.dice_op.sides;
+    if (!sides_node || sides_node->type != DICE_NODE_LITERAL) return false;
+    if (count_node && count_node->type != DICE_NODE_LITERAL) return false;
+    
+    *count = count_node ? count_node->data.literal.value : 1;
+    *sides = sides_node->data.literal.value;
+    return *count > 0;
+}
+
+// Fold dice term `from` into `into` when both are the same NdS; merging never
+// produces a count evaluation would reject
+static bool merge_dice(optimizer_t *opt, dice_ast_node_t *into, const dice_ast_node_t *from) {
+    int64_t into_count, into_sides, from_count, from_sides;
+    if (!mergeable_dice(into, &into_count, &into_sides)) return false;
+    if (!mergeable_dice(from, &from_count, &from_sides)) return false;
+    if (into_sides != from_sides) return false;
+    if (from_count > (int64_t)opt->ctx->policy.max_dice_count - into_count) return false;
+    
+    if (!into->data.dice_op.count) {
+        dice_ast_node_t *count = arena_alloc(opt->ctx, sizeof(dice_ast_node_t));
+        if (!count) {
+            opt->failed = true;
+            return false;
+        }
+        count->type = DICE_NODE_LITERAL;
+        into->data.dice_op.count = count;
+    }
+    into->data.dice_op.count->data.literal.value = into_count + from_count;
+    return true;
+}
+
+static void optimize_binary(optimizer_t *opt, dice_ast_node_t *node) {
+    dice_binary_op_t op = node->data.binary_op.op;
+    dice_ast_node_t *left = node->data.binary_op.left;
+    dice_ast_node_t *right = node->data.binary_op.right;
+    if (!left || !right) return;
+    
+    // Literal arithmetic
+    int64_t value;
+    if (left->type == DICE_NODE_LITERAL && right->type == DICE_NODE_LITERAL) {
+        if (fold_arith(op, left->data.literal.value, right->data.literal.value, &value)) {
+            make_literal(node, value);
+        }
+        return;
+    }
+    
+    // Identities: x+0, 0+x, x-0, x*1, 1*x, x/1
+    if (((op == DICE_OP_ADD || op == DICE_OP_SUB) && is_literal(right, 0)) ||
+        ((op == DICE_OP_MUL || op == DICE_OP_DIV) && is_literal(right, 1))) {
+        *node = *left;
+        return;
+    }
+    if ((op == DICE_OP_ADD && is_literal(left, 0)) || (op == DICE_OP_MUL && is_literal(left, 1))) {
+        *node = *right;
+        return;
+    }
+    
+    if (!is_additive(node)) return;
+    
+    // NdS + MdS -> (N+M)dS
+    if (op == DICE_OP_ADD && merge_dice(opt, left, right)) {
+        *node = *left;
+        return;
+    }
+    
+    if (!is_additive(left)) return;
+    dice_binary_op_t inner_op = left->data.binary_op.op;
+    dice_ast_node_t *inner_left = left->data.binary_op.left;
+    dice_ast_node_t *inner_right = left->data.binary_op.right;
+    
+    // (x ± NdS) ± MdS with matching signs -> x ± (N+M)dS
+    if (inner_op == op && merge_dice(opt, inner_right, right)) {
+        *node = *left;
+        return;
+    }
+    
+    if (inner_right->type != DICE_NODE_LITERAL) return;
+    int64_t inner_value = inner_right->data.literal.value;
+    
+    // (x ± a) ± b -> x ± c, collecting constants at the end of a sum
+    if (right->type == DICE_NODE_LITERAL) {
+        int64_t a = inner_value, b = right->data.literal.value, c;
+        if (inner_op == DICE_OP_SUB && !fold_arith(DICE_OP_SUB, 0, a, &a)) return;
+        if (op == DICE_OP_SUB && !fold_arith(DICE_OP_SUB, 0, b, &b)) return;
+        if (!fold_arith(DICE_OP_ADD, a, b, &c)) return;
+        
+        if (c == 0) {
+            *node = *inner_left;
+        } else {
+            node->data.binary_op.op = DICE_OP_ADD;
+            node->data.binary_op.left = inner_left;
+            right->data.literal.value = c;
+        }
+        return;
+    }
+    
+    // (x ± a) ± y -> (x ± y) ± a: moves the constant past y, which keeps the
+    // dice in their rolling order and lets y merge with dice at the end of x
+    left->data.binary_op.op = op;
+    left->data.binary_op.left = inner_left;
+    left->data.binary_op.right = right;
+    node->data.binary_op.op = inner_op;
+    node->data.binary_op.left = left;
+    node->data.binary_op.right = inner_right;
+    optimize_binary(opt, left);
+}
+
+static void optimize_exit(const dice_ast_node_t *node, void *user_data) {
+    optimizer_t *opt = user_data;
+    if (opt->failed) return;
+    
+    // The tree handed to dice_optimize is mutable; the visitor API is const
+    // only because most visitors just read
+    dice_ast_node_t *mutable_node = (dice_ast_node_t*)node;
+    if (node->type == DICE_NODE_BINARY_OP) {
+        optimize_binary(opt, mutable_node);
+    }
+}
+
+int dice_optimize(dice_context_t *ctx, dice_ast_node_t *node) {
+    if (!ctx) return -1;
+    if (!node) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Cannot optimize empty expression");
+        ctx->error.has_error = true;
+        return -1;
+    }
+    
+    optimizer_t opt = {ctx, false};
+    dice_ast_visitor_t visitor;
+    memset(&visitor, 0, sizeof(visitor));
+    visitor.exit_node = optimize_exit;
+    visitor.user_data = &opt;
+    if (!ast_walk(node, &visitor)) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Failed to allocate memory for optimizer");
+        ctx->error.has_error = true;
+        return -1;
+    }
+    
+    return opt.failed ? -1 : 0;
+}
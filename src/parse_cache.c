@@ -0,0 +1,219 @@
+#include "dice.h"
+#include "internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =============================================================================
+// Parse Cache (normalized expression text -> compiled program, LRU bounded)
+// =============================================================================
+
+typedef struct parse_cache_entry {
+    char *key;
+    uint64_t hash;
+    dice_program_t *program;
+    struct parse_cache_entry *bucket_next;  // Hash chain
+    struct parse_cache_entry *lru_prev;     // Towards most recently used
+    struct parse_cache_entry *lru_next;     // Towards least recently used
+} parse_cache_entry_t;
+
+struct dice_parse_cache {
+    parse_cache_entry_t **buckets;
+    size_t bucket_count;            // Power of two
+    parse_cache_entry_t *lru_head;  // Most recently used
+    parse_cache_entry_t *lru_tail;  // Least recently used
+    size_t entries;
+    size_t capacity;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+};
+
+// Trim the ends and collapse space/tab runs to one space; the parser treats
+// any such run the same way, so this never changes the meaning. Other
+// whitespace is not interchangeable with a space (keep/drop lookahead accepts
+// only ' ' and '\t'), so it is copied verbatim like quoted side labels.
+static size_t normalize_expression(const char *expression, char *out) {
+    size_t len = 0;
+    bool pending_space = false;
+    bool quoted = false;
+    
+    for (const char *p = expression; *p; p++) {
+        if (*p == '"') quoted = !quoted;
+        if (!quoted && (*p == ' ' || *p == '\t')) {
+            pending_space = len > 0;
+            continue;
+        }
+        if (pending_space) {
+            out[len++] = ' ';
+            pending_space = false;
+        }
+        out[len++] = *p;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+static void lru_unlink(dice_parse_cache_t *cache, parse_cache_entry_t *entry) {
+    if (entry->lru_prev) entry->lru_prev->lru_next = entry->lru_next;
+    else cache->lru_head = entry->lru_next;
+    if (entry->lru_next) entry->lru_next->lru_prev = entry->lru_prev;
+    else cache->lru_tail = entry->lru_prev;
+    entry->lru_prev = entry->lru_next = NULL;
+}
+
+static void lru_push_front(dice_parse_cache_t *cache, parse_cache_entry_t *entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+    if (cache->lru_head) cache->lru_head->lru_prev = entry;
+    cache->lru_head = entry;
+    if (!cache->lru_tail) cache->lru_tail = entry;
+}
+
+static void free_entry(parse_cache_entry_t *entry) {
+    dice_program_destroy(entry->program);
+    free(entry->key);
+    free(entry);
+}
+
+static void evict_lru(dice_parse_cache_t *cache) {
+    parse_cache_entry_t *victim = cache->lru_tail;
+    if (!victim) return;
+    
+    parse_cache_entry_t **link = &cache->buckets[victim->hash & (cache->bucket_count - 1)];
+    while (*link != victim) link = &(*link)->bucket_next;
+    *link = victim->bucket_next;
+    
+    lru_unlink(cache, victim);
+    free_entry(victim);
+    cache->entries--;
+    cache->evictions++;
+}
+
+dice_parse_cache_t* dice_parse_cache_create(size_t capacity) {
+    if (capacity == 0) return NULL;
+    
+    dice_parse_cache_t *cache = calloc(1, sizeof(dice_parse_cache_t));
+    if (!cache) return NULL;
+    
+    // Keep chains short: at least two buckets per entry
+    size_t bucket_count = 16;
+    while (bucket_count < capacity * 2) bucket_count <<= 1;
+    
+    cache->buckets = calloc(bucket_count, sizeof(parse_cache_entry_t*));
+    if (!cache->buckets) {
+        free(cache);
+        return NULL;
+    }
+    
+    cache->bucket_count = bucket_count;
+    cache->capacity = capacity;
+    return cache;
+}
+
+void dice_parse_cache_clear(dice_parse_cache_t *cache) {
+    if (!cache) return;
+    
+    parse_cache_entry_t *entry = cache->lru_head;
+    while (entry) {
+        parse_cache_entry_t *next = entry->lru_next;
+        free_entry(entry);
+        entry = next;
+    }
+    
+    memset(cache->buckets, 0, cache->bucket_count * sizeof(parse_cache_entry_t*));
+    cache->lru_head = cache->lru_tail = NULL;
+    cache->entries = 0;
+}
+
+void dice_parse_cache_destroy(dice_parse_cache_t *cache) {
+    if (!cache) return;
+    
+    dice_parse_cache_clear(cache);
+    free(cache->buckets);
+    free(cache);
+}
+
+const dice_program_t* dice_parse_cache_get(dice_parse_cache_t *cache, dice_context_t *ctx,
+                                           const char *expression_str) {
+    if (!cache || !ctx || !expression_str) return NULL;
+    
+    char *key = malloc(strlen(expression_str) + 1);
+    if (!key) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Failed to allocate memory for parse cache key");
+        ctx->error.has_error = true;
+        return NULL;
+    }
+    size_t key_len = normalize_expression(expression_str, key);
+    uint64_t hash = hash_fnv1a(key, key_len);
+    
+    parse_cache_entry_t **bucket = &cache->buckets[hash & (cache->bucket_count - 1)];
+    for (parse_cache_entry_t *entry = *bucket; entry; entry = entry->bucket_next) {
+        if (entry->hash == hash && strcmp(entry->key, key) == 0) {
+            free(key);
+            cache->hits++;
+            if (entry != cache->lru_head) {
+                lru_unlink(cache, entry);
+                lru_push_front(cache, entry);
+            }
+            return entry->program;
+        }
+    }
+    
+    cache->misses++;
+    
+    // The program does not reference the AST, so the parse scratch is released
+    size_t mark = dice_arena_mark(ctx);
+    dice_ast_node_t *ast = dice_parse(ctx, key);
+    if (ast && dice_optimize(ctx, ast) != 0) ast = NULL;
+    dice_program_t *program = ast ? dice_compile(ctx, ast) : NULL;
+    dice_arena_rewind(ctx, mark);
+    if (!program) {
+        free(key);
+        return NULL;
+    }
+    
+    parse_cache_entry_t *entry = calloc(1, sizeof(parse_cache_entry_t));
+    if (!entry) {
+        dice_program_destroy(program);
+        free(key);
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Failed to allocate memory for parse cache entry");
+        ctx->error.has_error = true;
+        return NULL;
+    }
+    
+    if (cache->entries >= cache->capacity) {
+        evict_lru(cache);
+    }
+    
+    entry->key = key;
+    entry->hash = hash;
+    entry->program = program;
+    entry->bucket_next = *bucket;
+    *bucket = entry;
+    lru_push_front(cache, entry);
+    cache->entries++;
+    
+    return program;
+}
+
+dice_parse_cache_stats_t dice_parse_cache_get_stats(const dice_parse_cache_t *cache) {
+    dice_parse_cache_stats_t stats = {0};
+    if (!cache) return stats;
+    
+    stats.hits = cache->hits;
+    stats.misses = cache->misses;
+    stats.evictions = cache->evictions;
+    stats.entries = cache->entries;
+    stats.capacity = cache->capacity;
+    return stats;
+}
+
+int dice_context_set_parse_cache(dice_context_t *ctx, dice_parse_cache_t *cache) {
+    if (!ctx) return -1;
+    
+    ctx->parse_cache = cache;
+    return 0;
+}
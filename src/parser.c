@@ -1,24 +1,76 @@
 #include "dice.h"
 #include "internal.h"
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 
 // =============================================================================
-// Parser Implementation (EBNF Grammar)
+// Lexer
 // =============================================================================
 
+// The lexer makes one pass over the input, handing the parser one token of
+// lookahead. Tokens are spans into the input; only die names and side labels,
+// which live on in the AST, are copied. The input is bounded by an end
+// pointer, so it does not have to be NUL-terminated.
+
+typedef enum {
+    TOKEN_END,          // End of input (or a lexical error, see failed)
+    TOKEN_NUMBER,       // [0-9]+, value in token.value
+    TOKEN_LETTER,       // A single letter (d, k, h, l, s, r), lowercased in token.c
+    TOKEN_NAME,         // [A-Za-z][A-Za-z0-9]* lexed right after 'd'
+    TOKEN_STRING,       // "...", the span excludes the quotes
+    TOKEN_GTE,          // >=
+    TOKEN_LTE,          // <=
+    TOKEN_NEQ,          // <>
+    TOKEN_EQEQ,         // ==
+    TOKEN_BANGBANG,     // !! (only when adjacent)
+    TOKEN_CHAR          // Any other single character, in token.c
+} token_type_t;
+
+typedef struct {
+    token_type_t type;
+    char c;
+    const char *start;
+    size_t length;
+    int64_t value;
+} token_t;
+
 typedef struct parser_state {
     dice_context_t *ctx;
     const char *input;
-    const char *pos;
+    const char *end;
+    const char *pos;    // Lexer cursor, just past the lookahead token
+    token_t token;      // Lookahead
+    int depth;          // Open groups and signs, checked against policy.max_depth
+    size_t nodes;       // AST nodes created, checked against policy.max_nodes
+    bool failed;        // An error was reported during this parse
+    bool missing;       // ...and it was parse_primary's "Expected number" error
 } parser_state_t;
 
-static void skip_whitespace(parser_state_t *state) {
-    while (isspace(*state->pos)) {
-        state->pos++;
-    }
+// Inline dice with up to this many sides are collected without arena growth
+#define PARSE_LOCAL_SIDES 32
+
+// Report the first error of a parse; follow-on errors are dropped
+static void parse_error(parser_state_t *state, const char *format, ...) {
+    if (state->failed) return;
+    
+    va_list args;
+    va_start(args, format);
+    vsnprintf(state->ctx->error.message, sizeof(state->ctx->error.message), format, args);
+    va_end(args);
+    state->ctx->error.has_error = true;
+    state->failed = true;
+}
+
+static void* parse_alloc(parser_state_t *state, size_t size) {
+    void *ptr = arena_alloc(state->ctx, size);
+    if (!ptr) state->failed = true; // the arena has set the error
+    return ptr;
+}
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
 }
 
 static bool is_digit(char c) {
@@ -29,8 +81,151 @@ static bool is_letter(char c) {
     return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
 }
 
-static dice_ast_node_t* create_node(dice_context_t *ctx, dice_node_type_t type) {
-    dice_ast_node_t *node = arena_alloc(ctx, sizeof(dice_ast_node_t));
+// Lex the next token into state->token; name_mode reads a whole alphanumeric
+// run as a die name
+static void next_token(parser_state_t *state, bool name_mode) {
+    const char *p = state->pos;
+    const char *end = state->end;
+    while (p < end && is_space(*p)) p++;
+    
+    token_t *token = &state->token;
+    token->type = TOKEN_END;
+    token->start = p;
+    token->length = 0;
+    if (p == end) {
+        state->pos = p;
+        return;
+    }
+    
+    char c = *p;
+    const char *next = p + 1;
+    char following = next < end ? *next : '\0';
+    
+    if (is_digit(c)) {
+        int64_t value = 0;
+        for (; p < end && is_digit(*p); p++) {
+            int digit = *p - '0';
+            if (value > (INT64_MAX - digit) / 10) {
+                parse_error(state, "Number too large: '%.*s'", (int)(p - token->start + 1), token->start);
+                state->pos = end;
+                token->type = TOKEN_END;
+                return;
+            }
+            value = value * 10 + digit;
+        }
+        token->type = TOKEN_NUMBER;
+        token->value = value;
+        next = p;
+    } else if (is_letter(c) && name_mode) {
+        while (next < end && (is_letter(*next) || is_digit(*next))) next++;
+        token->type = TOKEN_NAME;
+    } else if (is_letter(c)) {
+        token->type = TOKEN_LETTER;
+        token->c = c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+    } else if (c == '"') {
+        while (next < end && *next != '"') next++;
+        if (next == end) {
+            parse_error(state, "Unterminated string in custom die definition");
+            state->pos = end;
+            token->type = TOKEN_END;
+            return;
+        }
+        token->type = TOKEN_STRING;
+        token->start = p + 1;
+        token->length = (size_t)(next - token->start);
+        state->pos = next + 1;
+        return;
+    } else if (c == '>' && following == '=') {
+        token->type = TOKEN_GTE;
+        next++;
+    } else if (c == '<' && following == '=') {
+        token->type = TOKEN_LTE;
+        next++;
+    } else if (c == '<' && following == '>') {
+        token->type = TOKEN_NEQ;
+        next++;
+    } else if (c == '=' && following == '=') {
+        token->type = TOKEN_EQEQ;
+        next++;
+    } else if (c == '!' && following == '!') {
+        token->type = TOKEN_BANGBANG;
+        next++;
+    } else {
+        token->type = TOKEN_CHAR;
+        token->c = c;
+    }
+    
+    token->length = (size_t)(next - token->start);
+    state->pos = next;
+}
+
+static void advance(parser_state_t *state) {
+    next_token(state, false);
+}
+
+static bool token_is(const parser_state_t *state, char c) {
+    return state->token.type == TOKEN_CHAR && state->token.c == c;
+}
+
+static bool token_is_letter(const parser_state_t *state, char c) {
+    return state->token.type == TOKEN_LETTER && state->token.c == c;
+}
+
+// End of input or a binary operator, where an optional modifier value may be left out
+static bool token_ends_operand(const parser_state_t *state) {
+    return state->token.type == TOKEN_END || token_is(state, '+') || token_is(state, '-') ||
+           token_is(state, '*') || token_is(state, '/');
+}
+
+// The raw character right after the lookahead token ('\0' at the end of input)
+static char char_after_token(const parser_state_t *state) {
+    const char *after = state->token.start + state->token.length;
+    return after < state->end ? *after : '\0';
+}
+
+// NUL-terminated arena copy of an input span
+static char* copy_span(parser_state_t *state, const char *start, size_t length) {
+    char *copy = parse_alloc(state, length + 1);
+    if (!copy) return NULL;
+    
+    memcpy(copy, start, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+// Arena copy of prefix followed by value in decimal, e.g. "s>=" and 4 -> "s>=4";
+// built by hand since snprintf dominates the cost of short modifiers
+static char* make_syntax(parser_state_t *state, const char *prefix, int64_t value) {
+    char buffer[32];
+    size_t length = strlen(prefix);
+    memcpy(buffer, prefix, length);
+    
+    char digits[24];
+    size_t count = 0;
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    do {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) buffer[length++] = '-';
+    while (count) buffer[length++] = digits[--count];
+    
+    return copy_span(state, buffer, length);
+}
+
+// =============================================================================
+// Parser Implementation (EBNF Grammar)
+// =============================================================================
+
+static dice_ast_node_t* create_node(parser_state_t *state, dice_node_type_t type) {
+    int limit = state->ctx->policy.max_nodes;
+    if (limit > 0 && state->nodes >= (size_t)limit) {
+        parse_error(state, "Expression exceeds node limit of %d", limit);
+        return NULL;
+    }
+    state->nodes++;
+    
+    dice_ast_node_t *node = parse_alloc(state, sizeof(dice_ast_node_t));
     if (node) {
         node->type = type;
         // Initialize custom dice fields
@@ -38,242 +233,373 @@ static dice_ast_node_t* create_node(dice_context_t *ctx, dice_node_type_t type)
             node->data.dice_op.custom_name = NULL;
             node->data.dice_op.custom_die = NULL;
             node->data.dice_op.selection = NULL;
+            node->data.dice_op.compounding = false;
         }
     }
     return node;
 }
 
+static dice_ast_node_t* create_literal(parser_state_t *state, int64_t value) {
+    dice_ast_node_t *node = create_node(state, DICE_NODE_LITERAL);
+    if (node) node->data.literal.value = value;
+    return node;
+}
+
 // Forward declarations
 static dice_ast_node_t* parse_expression(parser_state_t *state);
 static dice_ast_node_t* parse_sum(parser_state_t *state);
 static dice_ast_node_t* parse_product(parser_state_t *state);
 static dice_ast_node_t* parse_unary(parser_state_t *state);
 static dice_ast_node_t* parse_primary(parser_state_t *state);
+static dice_ast_node_t* parse_group(parser_state_t *state);
+static dice_ast_node_t* parse_dice_rest(parser_state_t *state, dice_ast_node_t *count);
 static dice_custom_die_t* parse_custom_die_definition(parser_state_t *state);
+static bool parse_explosion(parser_state_t *state, dice_ast_node_t *node);
 
+// One pass over {...}: sides collect in a local buffer that moves to the
+// arena (doubling) only for large tables
 static dice_custom_die_t* parse_custom_die_definition(parser_state_t *state) {
-    skip_whitespace(state);
+    advance(state); // consume '{'
     
-    if (*state->pos != '{') {
-        return NULL;
-    }
-    
-    const char *start_pos = state->pos;
-    state->pos++; // consume '{'
-    skip_whitespace(state);
-    
-    // Count sides by parsing through the definition
-    const char *temp_pos = state->pos;
+    dice_custom_side_t local[PARSE_LOCAL_SIDES];
+    dice_custom_side_t *sides = local;
+    size_t capacity = PARSE_LOCAL_SIDES;
     size_t side_count = 0;
-    int brace_depth = 0;
-    bool in_quotes = false;
-    bool expecting_value = true;
-    
-    while (*temp_pos && (brace_depth > 0 || *temp_pos != '}')) {
-        if (*temp_pos == '"' && (temp_pos == state->pos || *(temp_pos - 1) != '\\')) {
-            in_quotes = !in_quotes;
-            // If we're starting a quote and expecting a value, we found the start of a value
-            if (in_quotes && expecting_value) {
-                expecting_value = false;
-            }
-        } else if (!in_quotes) {
-            if (*temp_pos == '{') brace_depth++;
-            else if (*temp_pos == '}') brace_depth--;
-            else if (*temp_pos == ',' && brace_depth == 0 && !expecting_value) {
-                side_count++;
-                expecting_value = true;
-            } else if (!isspace(*temp_pos) && expecting_value) {
-                expecting_value = false;
-            }
-        }
-        temp_pos++;
-    }
-    
-    if (expecting_value == false) side_count++; // Count the last item
-    
-    if (side_count == 0) {
-        snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                "Empty custom die definition");
-        state->ctx->error.has_error = true;
-        return NULL;
-    }
-    
-    // Allocate custom die
-    dice_custom_die_t *custom_die = arena_alloc(state->ctx, sizeof(dice_custom_die_t));
-    if (!custom_die) return NULL;
-    
-    custom_die->sides = arena_alloc(state->ctx, side_count * sizeof(dice_custom_side_t));
-    if (!custom_die->sides) return NULL;
     
-    custom_die->name = NULL; // Inline die has no name
-    custom_die->side_count = 0;
-    
-    // Parse sides
-    while (*state->pos && *state->pos != '}') {
-        skip_whitespace(state);
-        
-        if (*state->pos == '}') break;
+    while (!token_is(state, '}')) {
+        if (state->token.type == TOKEN_END) {
+            parse_error(state, "Expected closing '}' in custom die definition");
+            return NULL;
+        }
         
         int64_t value = 0;
         const char *label = NULL;
         
-        // Check if it's a number
-        if (is_digit(*state->pos) || *state->pos == '-') {
-            // Parse numeric value
-            bool negative = false;
-            if (*state->pos == '-') {
-                negative = true;
-                state->pos++;
-            }
-            
-            while (is_digit(*state->pos)) {
-                value = value * 10 + (*state->pos - '0');
-                state->pos++;
+        if (state->token.type == TOKEN_NUMBER || token_is(state, '-')) {
+            // Numeric value, optionally labelled: 1, -1, 2:"two"
+            bool negative = token_is(state, '-');
+            if (negative) advance(state);
+            if (state->token.type != TOKEN_NUMBER) {
+                parse_error(state, "Expected number after '-' in custom die definition");
+                return NULL;
             }
+            value = negative ? -state->token.value : state->token.value;
+            advance(state);
             
-            if (negative) value = -value;
-            
-            skip_whitespace(state);
-            
-            // Check for label after colon
-            if (*state->pos == ':') {
-                state->pos++; // consume ':'
-                skip_whitespace(state);
-                
-                if (*state->pos == '"') {
-                    // Parse quoted string label
-                    state->pos++; // consume opening quote
-                    const char *start = state->pos;
-                    while (*state->pos && *state->pos != '"') {
-                        state->pos++;
-                    }
-                    if (*state->pos == '"') {
-                        size_t len = state->pos - start;
-                        char *label_copy = arena_alloc(state->ctx, len + 1);
-                        if (label_copy) {
-                            memcpy(label_copy, start, len);
-                            label_copy[len] = '\0';
-                            label = label_copy;
-                        }
-                        state->pos++; // consume closing quote
-                    }
+            if (token_is(state, ':')) {
+                advance(state);
+                if (state->token.type != TOKEN_STRING) {
+                    parse_error(state, "Expected quoted label after ':' in custom die definition");
+                    return NULL;
                 }
+                label = copy_span(state, state->token.start, state->token.length);
+                if (!label) return NULL;
+                advance(state);
             }
-        } else if (*state->pos == '"') {
+        } else if (state->token.type == TOKEN_STRING) {
             // Quoted string without explicit value - use index as value
-            value = custom_die->side_count + 1; // 1-based indexing for implicit numbering
-            
-            state->pos++; // consume opening quote
-            const char *start = state->pos;
-            while (*state->pos && *state->pos != '"') {
-                state->pos++;
-            }
-            if (*state->pos == '"') {
-                size_t len = state->pos - start;
-                char *label_copy = arena_alloc(state->ctx, len + 1);
-                if (label_copy) {
-                    memcpy(label_copy, start, len);
-                    label_copy[len] = '\0';
-                    label = label_copy;
-                }
-                state->pos++; // consume closing quote
-            }
+            value = (int64_t)side_count + 1; // 1-based indexing for implicit numbering
+            label = copy_span(state, state->token.start, state->token.length);
+            if (!label) return NULL;
+            advance(state);
         } else {
-            // Invalid syntax
-            snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                    "Expected number or quoted string in custom die definition");
-            state->ctx->error.has_error = true;
+            parse_error(state, "Expected number or quoted string in custom die definition");
             return NULL;
         }
         
-        // Add the side
-        if (custom_die->side_count < side_count) {
-            custom_die->sides[custom_die->side_count].value = value;
-            custom_die->sides[custom_die->side_count].label = label;
-            custom_die->side_count++;
+        // Optional relative weight: {0:"miss"*97, 1:"hit"*3}
+        uint32_t weight = 1;
+        if (token_is(state, '*')) {
+            advance(state);
+            if (state->token.type != TOKEN_NUMBER || state->token.value == 0 ||
+                (uint64_t)state->token.value > UINT32_MAX) {
+                parse_error(state, "Custom die side weight must be between 1 and %u", (unsigned)UINT32_MAX);
+                return NULL;
+            }
+            weight = (uint32_t)state->token.value;
+            advance(state);
         }
         
-        skip_whitespace(state);
+        // Add the side
+        if (side_count == capacity) {
+            dice_custom_side_t *grown = arena_alloc_scratch(state->ctx, 2 * capacity * sizeof(dice_custom_side_t));
+            if (!grown) {
+                state->failed = true;
+                return NULL;
+            }
+            memcpy(grown, sides, side_count * sizeof(dice_custom_side_t));
+            sides = grown;
+            capacity *= 2;
+        }
+        sides[side_count].value = value;
+        sides[side_count].label = label;
+        sides[side_count].weight = weight;
+        side_count++;
         
         // Check for comma or end
-        if (*state->pos == ',') {
-            state->pos++; // consume comma
-        } else if (*state->pos != '}') {
-            snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                    "Expected ',' or '}' in custom die definition");
-            state->ctx->error.has_error = true;
+        if (token_is(state, ',')) {
+            advance(state);
+        } else if (!token_is(state, '}')) {
+            parse_error(state, "Expected ',' or '}' in custom die definition");
             return NULL;
         }
     }
     
-    if (*state->pos != '}') {
-        snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                "Expected closing '}' in custom die definition");
-        state->ctx->error.has_error = true;
+    if (side_count == 0) {
+        parse_error(state, "Empty custom die definition");
         return NULL;
     }
+    advance(state); // consume '}'
+    
+    dice_custom_die_t *custom_die = parse_alloc(state, sizeof(dice_custom_die_t));
+    if (!custom_die) return NULL;
     
-    state->pos++; // consume '}'
+    if (sides == local) {
+        custom_die->sides = parse_alloc(state, side_count * sizeof(dice_custom_side_t));
+        if (!custom_die->sides) return NULL;
+        memcpy(custom_die->sides, local, side_count * sizeof(dice_custom_side_t));
+    } else {
+        custom_die->sides = sides;
+    }
+    custom_die->name = NULL; // Inline die has no name
+    custom_die->side_count = side_count;
+    
+    if (!custom_die_init_weights(state->ctx, custom_die, true)) {
+        state->failed = true;
+        return NULL;
+    }
     return custom_die;
 }
 
 static dice_ast_node_t* parse_number(parser_state_t *state) {
-    skip_whitespace(state);
-    
-    if (!is_digit(*state->pos)) {
+    if (state->token.type != TOKEN_NUMBER) {
         return NULL;
     }
     
-    int64_t value = 0;
-    while (is_digit(*state->pos)) {
-        value = value * 10 + (*state->pos - '0');
-        state->pos++;
+    dice_ast_node_t *node = create_literal(state, state->token.value);
+    advance(state);
+    return node;
+}
+
+// Exploding suffix after the sides: '!' or '!!', then an optional '>N'
+// threshold that explodes on N and above (the maximum face by default)
+static bool parse_explosion(parser_state_t *state, dice_ast_node_t *node) {
+    if (node->data.dice_op.dice_type != DICE_DICE_BASIC) {
+        parse_error(state, "Exploding dice require numeric sides");
+        return false;
     }
     
-    dice_ast_node_t *node = create_node(state->ctx, DICE_NODE_LITERAL);
-    if (node) {
-        node->data.literal.value = value;
+    bool compounding = state->token.type == TOKEN_BANGBANG;
+    advance(state); // consume '!' or '!!'
+    
+    dice_ast_node_t *threshold = NULL;
+    if (token_is(state, '>') || state->token.type == TOKEN_GTE) {
+        if (state->token.type == TOKEN_GTE) {
+            parse_error(state, "Expected explosion threshold after '>'");
+            return false;
+        }
+        advance(state);
+        threshold = parse_number(state);
+        if (!threshold) {
+            parse_error(state, "Expected explosion threshold after '>'");
+            return false;
+        }
+        if (threshold->data.literal.value < 2) {
+            parse_error(state, "Explosion threshold must be at least 2, got %lld",
+                        (long long)threshold->data.literal.value);
+            return false;
+        }
     }
-    return node;
+    
+    node->data.dice_op.dice_type = DICE_DICE_EXPLODING;
+    node->data.dice_op.modifier = threshold;
+    node->data.dice_op.compounding = compounding;
+    return true;
 }
 
-static dice_ast_node_t* parse_dice(parser_state_t *state) {
-    skip_whitespace(state);
+// Keep/drop: k, h (keep highest) or l (drop lowest), then an optional count
+static bool parse_keep_drop(parser_state_t *state, dice_ast_node_t *node) {
+    char op1 = state->token.c;
+    advance(state); // Skip operator
+    
+    // Parse the count (can be expression or default to 1)
+    dice_ast_node_t *select_count = NULL;
+    if (token_is(state, '(')) {
+        select_count = parse_primary(state);
+    } else if (state->token.type == TOKEN_NUMBER) {
+        select_count = parse_number(state);
+    } else {
+        select_count = create_literal(state, 1);
+    }
     
-    dice_ast_node_t *count = NULL;
+    if (!select_count) {
+        parse_error(state, "Failed to parse selection count after %c modifier", op1);
+        return false;
+    }
+    if (select_count->type != DICE_NODE_LITERAL) {
+        parse_error(state, "Expression selection counts not yet implemented");
+        return false;
+    }
     
-    // Check if there's a count before 'd'
-    const char *saved_pos = state->pos;
-    if (is_digit(*state->pos)) {
-        count = parse_number(state);
-        skip_whitespace(state);
-        
-        // If no 'd' follows, this isn't a dice expression
-        if (*state->pos != 'd' && *state->pos != 'D') {
-            state->pos = saved_pos;
-            return NULL;
-        }
-    } else if (*state->pos != 'd' && *state->pos != 'D') {
-        return NULL;
+    dice_selection_t *selection = parse_alloc(state, sizeof(dice_selection_t));
+    char *syntax = parse_alloc(state, 2);
+    if (!selection || !syntax) return false;
+    syntax[0] = op1;
+    syntax[1] = '\0';
+    
+    selection->count = select_count->data.literal.value;
+    selection->is_conditional = false;
+    selection->is_reroll = false;
+    selection->comparison_op = DICE_OP_ADD; // Unused for non-conditional
+    selection->comparison_value = 0; // Unused for non-conditional
+    selection->select_high = true; // 'k' and 'h' keep high; drop low keeps the high remainder
+    selection->is_drop_operation = op1 == 'l';
+    selection->original_syntax = syntax;
+    
+    node->data.dice_op.dice_type = DICE_DICE_FILTER;
+    node->data.dice_op.modifier = select_count;
+    node->data.dice_op.selection = selection;
+    return true;
+}
+
+// Conditional selection (s) and reroll (r): an optional comparison operator
+// and value; a bare 's' or 'r' means =1, and 'sN' or 'rN' mean =N
+static bool parse_conditional(parser_state_t *state, dice_ast_node_t *node) {
+    char letter = state->token.c;
+    bool reroll = letter == 'r';
+    advance(state); // consume 's' or 'r'
+    
+    dice_binary_op_t comp_op = DICE_OP_EQ; // Default to equals
+    bool explicit_op = true;
+    switch (state->token.type) {
+        case TOKEN_GTE: comp_op = DICE_OP_GTE; break;
+        case TOKEN_LTE: comp_op = DICE_OP_LTE; break;
+        case TOKEN_NEQ: comp_op = DICE_OP_NEQ; break;
+        case TOKEN_EQEQ:
+            // r==N is accepted as rN; selection only spells equality s=N
+            if (!reroll) {
+                parse_error(state, "Expected numeric value after 's' operator");
+                return false;
+            }
+            break;
+        case TOKEN_CHAR:
+            if (state->token.c == '=') comp_op = DICE_OP_EQ;
+            else if (state->token.c == '>') comp_op = DICE_OP_GT;
+            else if (state->token.c == '<') comp_op = DICE_OP_LT;
+            else explicit_op = false;
+            break;
+        default:
+            explicit_op = false;
+            break;
     }
     
-    // Consume 'd' or 'D'
-    if (*state->pos == 'd' || *state->pos == 'D') {
-        state->pos++;
+    if (explicit_op) {
+        advance(state);
+    } else if (state->token.type != TOKEN_NUMBER && !token_ends_operand(state)) {
+        parse_error(state, "Expected comparison operator after '%c' (>, <, >=, <=, =, <>) or numeric value",
+                    letter);
+        return false;
+    }
+    
+    // Parse comparison value (default to 1 if not provided, but fail for incomplete operators)
+    dice_ast_node_t *comp_value = NULL;
+    if (state->token.type == TOKEN_NUMBER) {
+        comp_value = parse_number(state);
+    } else if (token_ends_operand(state)) {
+        if (comp_op != DICE_OP_EQ) {
+            parse_error(state, "Missing comparison value after comparison operator");
+            return false;
+        }
+        comp_value = create_literal(state, 1);
     } else {
-        return NULL;
+        parse_error(state, "Expected numeric value after '%c' operator", letter);
+        return false;
+    }
+    if (!comp_value) return false;
+    
+    dice_selection_t *selection = parse_alloc(state, sizeof(dice_selection_t));
+    if (!selection) return false;
+    
+    selection->is_conditional = true;
+    selection->is_reroll = reroll;
+    selection->comparison_op = comp_op;
+    selection->comparison_value = comp_value->data.literal.value;
+    selection->count = 0; // Not used for conditional selection
+    selection->select_high = false; // Not used for conditional selection
+    selection->is_drop_operation = false; // Not used for conditional selection
+    
+    // Create original syntax string
+    const char *op_str = "";
+    switch (comp_op) {
+        case DICE_OP_GT: op_str = ">"; break;
+        case DICE_OP_LT: op_str = "<"; break;
+        case DICE_OP_GTE: op_str = ">="; break;
+        case DICE_OP_LTE: op_str = "<="; break;
+        case DICE_OP_EQ: op_str = reroll ? "" : "="; break; // For r1, don't show the = operator
+        case DICE_OP_NEQ: op_str = "<>"; break;
+        default: op_str = "?"; break;
+    }
+    
+    char prefix[4] = {letter, '\0'};
+    strcat(prefix, op_str);
+    selection->original_syntax = make_syntax(state, prefix, selection->comparison_value);
+    if (!selection->original_syntax) return false;
+    
+    // Update the node to be a filter operation
+    node->data.dice_op.dice_type = DICE_DICE_FILTER;
+    node->data.dice_op.modifier = comp_value;
+    node->data.dice_op.selection = selection;
+    return true;
+}
+
+// Success pool: NdS>N counts dice showing N or more, NdS<N dice showing N or less
+static bool parse_pool(parser_state_t *state, dice_ast_node_t *node) {
+    if (node->data.dice_op.dice_type != DICE_DICE_BASIC) {
+        parse_error(state, "Success pools require numeric sides");
+        return false;
+    }
+    
+    char op = *state->token.start;
+    dice_ast_node_t *target = NULL;
+    if (state->token.type == TOKEN_CHAR) {
+        advance(state);
+        target = parse_number(state);
+    }
+    if (!target) {
+        parse_error(state, "Expected success target after '%c'", op);
+        return false;
     }
     
-    skip_whitespace(state);
+    dice_selection_t *selection = parse_alloc(state, sizeof(dice_selection_t));
+    if (!selection) return false;
+    
+    selection->is_conditional = true;
+    selection->comparison_op = op == '>' ? DICE_OP_GTE : DICE_OP_LTE;
+    selection->comparison_value = target->data.literal.value;
+    
+    char prefix[2] = {op, '\0'};
+    selection->original_syntax = make_syntax(state, prefix, selection->comparison_value);
+    if (!selection->original_syntax) return false;
     
-    dice_ast_node_t *node = create_node(state->ctx, DICE_NODE_DICE_OP);
+    node->data.dice_op.dice_type = DICE_DICE_POOL;
+    node->data.dice_op.modifier = target;
+    node->data.dice_op.selection = selection;
+    return true;
+}
+
+// Everything from the 'd' on; count is NULL for an implicit single die
+static dice_ast_node_t* parse_dice_rest(parser_state_t *state, dice_ast_node_t *count) {
+    // Consume 'd'; a letter after it starts a custom die name
+    next_token(state, true);
+    
+    dice_ast_node_t *node = create_node(state, DICE_NODE_DICE_OP);
     if (!node) return NULL;
     
     node->data.dice_op.count = count;
     node->data.dice_op.modifier = NULL;
     
     // Check for custom die syntax
-    if (*state->pos == '{') {
+    if (token_is(state, '{')) {
         // Inline custom die definition: 1d{-1,0,1}
         dice_custom_die_t *custom_die = parse_custom_die_definition(state);
         if (!custom_die) return NULL;
@@ -283,32 +609,27 @@ static dice_ast_node_t* parse_dice(parser_state_t *state) {
         node->data.dice_op.custom_die = custom_die;
         node->data.dice_op.custom_name = NULL;
         
-    } else if (is_letter(*state->pos)) {
+    } else if (state->token.type == TOKEN_NAME) {
         // Named custom die: 1dF
-        const char *name_start = state->pos;
-        while (is_letter(*state->pos) || is_digit(*state->pos)) {
-            state->pos++;
-        }
-        
-        size_t name_len = state->pos - name_start;
-        char *name = arena_alloc(state->ctx, name_len + 1);
+        char *name = copy_span(state, state->token.start, state->token.length);
         if (!name) return NULL;
-        
-        memcpy(name, name_start, name_len);
-        name[name_len] = '\0';
+        advance(state);
         
         node->data.dice_op.dice_type = DICE_DICE_CUSTOM;
         node->data.dice_op.sides = NULL;
         node->data.dice_op.custom_die = NULL;
         node->data.dice_op.custom_name = name;
         
+        // Bind now so evaluation skips the lookup while the registry is unchanged
+        const dice_custom_die_t *bound = dice_lookup_custom_die(state->ctx, name);
+        node->data.dice_op.bound_die = bound;
+        node->data.dice_op.bound_generation = bound ? state->ctx->custom_dice.generation : 0;
+        
     } else {
-        // Standard numeric sides
-        dice_ast_node_t *sides = parse_number(state);
+        // Standard sides: a number or a parenthesized expression, e.g. 2d(4*2)
+        dice_ast_node_t *sides = token_is(state, '(') ? parse_group(state) : parse_number(state);
         if (!sides) {
-            snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                    "Expected number of sides, custom die name, or custom die definition after 'd'");
-            state->ctx->error.has_error = true;
+            parse_error(state, "Expected number of sides, custom die name, or custom die definition after 'd'");
             return NULL;
         }
         
@@ -316,398 +637,122 @@ static dice_ast_node_t* parse_dice(parser_state_t *state) {
         node->data.dice_op.sides = sides;
     }
     
-    // Check for keep/drop modifiers: k, h (keep), l (drop) - single character only
-    skip_whitespace(state);
-    if ((*state->pos == 'k' || *state->pos == 'K' || 
-         *state->pos == 'h' || *state->pos == 'H' ||
-         *state->pos == 'l' || *state->pos == 'L') &&
-        (is_digit(*(state->pos + 1)) || *(state->pos + 1) == ' ' || *(state->pos + 1) == '\t' || 
-         *(state->pos + 1) == '(' || *(state->pos + 1) == '\0' || *(state->pos + 1) == '+' || 
-         *(state->pos + 1) == '-' || *(state->pos + 1) == '*' || *(state->pos + 1) == '/')) {
-        
-        char op1 = tolower(*state->pos);
-        
-        // Single-character operators only: k, h (keep), l (drop)
-        state->pos += 1; // Skip operator
-        
-        // Parse the count (can be expression or default to 1)
-        skip_whitespace(state);
-        dice_ast_node_t *select_count = NULL;
-        
-        // Check if there's a number, expression, or nothing (default to 1)
-        if (*state->pos == '(') {
-            // Parse parenthesized expression
-            select_count = parse_primary(state);
-        } else if (is_digit(*state->pos)) {
-            // Parse number
-            select_count = parse_number(state);
-        } else {
-            // Default to 1
-            select_count = create_node(state->ctx, DICE_NODE_LITERAL);
-            if (select_count) {
-                select_count->data.literal.value = 1;
-            }
-        }
-        
-        if (!select_count) {
-            snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                    "Failed to parse selection count after %c modifier", op1);
-            state->ctx->error.has_error = true;
-            return NULL;
-        }
-        
-        // Create selection structure
-        dice_selection_t *selection = arena_alloc(state->ctx, sizeof(dice_selection_t));
-        if (!selection) return NULL;
-        
-        // Initialize conditional selection fields
-        selection->is_conditional = false;
-        selection->is_reroll = false;
-        selection->comparison_op = DICE_OP_ADD; // Unused for non-conditional
-        selection->comparison_value = 0; // Unused for non-conditional
-        
-        // Evaluate the selection count - now supports expressions
-        selection->count = 1; // Default value
-        if (select_count->type == DICE_NODE_LITERAL) {
-            selection->count = select_count->data.literal.value;
-        } else {
-            // For now, expressions are not fully supported - need to evaluate at runtime
-            // Store the AST node for later evaluation
-            snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                    "Expression selection counts not yet implemented");
-            state->ctx->error.has_error = true;
-            return NULL;
-        }
-        
-        // Determine selection parameters based on new operators
-        char *syntax = arena_alloc(state->ctx, 2);
-        if (!syntax) return NULL;
-        syntax[0] = op1;
-        syntax[1] = '\0';
-        
-        if (op1 == 'k' || op1 == 'h') { // keep high ('k' and 'h' are aliases)
-            selection->select_high = true;
-            selection->is_drop_operation = false;
-            selection->original_syntax = syntax;
-        } else if (op1 == 'l') { // drop low ('l' replaces 'd')
-            selection->select_high = true; // drop low = keep high remaining dice
-            selection->is_drop_operation = true;
-            selection->original_syntax = syntax;
-        } else {
-            snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                    "Unknown selection operator: %c", op1);
-            state->ctx->error.has_error = true;
-            return NULL;
-        }
-        
-        // Update the node to be a filter operation
-        node->data.dice_op.dice_type = DICE_DICE_FILTER;
-        node->data.dice_op.modifier = select_count;
-        node->data.dice_op.selection = selection;
-        
-    } else if (*state->pos == 's' || *state->pos == 'S') {
-        // Check for conditional selection: s>N, s<N, s>=N, s<=N, s==N, s!=N, or just sN (defaults to s=N)
-        state->pos++; // consume 's'
-        skip_whitespace(state);
-        
-        // Parse comparison operator or detect default case
-        dice_binary_op_t comp_op = DICE_OP_EQ; // Default to equals
-        
-        if (*state->pos == '>' && *(state->pos + 1) == '=') {
-            comp_op = DICE_OP_GTE;
-            state->pos += 2;
-        } else if (*state->pos == '<' && *(state->pos + 1) == '=') {
-            comp_op = DICE_OP_LTE;
-            state->pos += 2;
-        } else if (*state->pos == '<' && *(state->pos + 1) == '>') {
-            comp_op = DICE_OP_NEQ;
-            state->pos += 2;
-        } else if (*state->pos == '=') {
-            comp_op = DICE_OP_EQ;
-            state->pos++;
-        } else if (*state->pos == '>') {
-            comp_op = DICE_OP_GT;
-            state->pos++;
-        } else if (*state->pos == '<') {
-            comp_op = DICE_OP_LT;
-            state->pos++;
-        } else if (is_digit(*state->pos)) {
-            // No operator provided - default to equals
-            comp_op = DICE_OP_EQ;
-        } else if (*state->pos == '\0' || *state->pos == ' ' || *state->pos == '\t' ||
-                   *state->pos == '+' || *state->pos == '-' || *state->pos == '*' || *state->pos == '/') {
-            // No value provided - default to s=1
-            comp_op = DICE_OP_EQ;
-        } else {
-            snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                    "Expected comparison operator after 's' (>, <, >=, <=, =, <>) or numeric value");
-            state->ctx->error.has_error = true;
-            return NULL;
-        }
-        
-        skip_whitespace(state);
-        
-        // Parse comparison value (default to 1 if not provided, but fail for incomplete operators)
-        dice_ast_node_t *comp_value = NULL;
-        
-        if (is_digit(*state->pos)) {
-            comp_value = parse_number(state);
-        } else if (*state->pos == '\0' || *state->pos == ' ' || *state->pos == '\t' ||
-                   *state->pos == '+' || *state->pos == '-' || *state->pos == '*' || *state->pos == '/') {
-            // Check if we have an incomplete comparison operator (like s> with no value)
-            if (comp_op != DICE_OP_EQ) {
-                snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                        "Missing comparison value after comparison operator");
-                state->ctx->error.has_error = true;
-                return NULL;
-            }
-            // Default to 1 only for 's' or 'sN' cases (not 's>' cases)
-            comp_value = create_node(state->ctx, DICE_NODE_LITERAL);
-            if (comp_value) {
-                comp_value->data.literal.value = 1;
-            }
-        } else {
-            snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                    "Expected numeric value after 's' operator");
-            state->ctx->error.has_error = true;
-            return NULL;
-        }
-        
-        if (!comp_value || comp_value->type != DICE_NODE_LITERAL) {
-            snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                    "Failed to parse comparison value for 's' operator");
-            state->ctx->error.has_error = true;
-            return NULL;
-        }
-        
-        // Create conditional selection structure
-        dice_selection_t *selection = arena_alloc(state->ctx, sizeof(dice_selection_t));
-        if (!selection) return NULL;
-        
-        selection->is_conditional = true;
-        selection->is_reroll = false;
-        selection->comparison_op = comp_op;
-        selection->comparison_value = comp_value->data.literal.value;
-        selection->count = 0; // Not used for conditional selection
-        selection->select_high = false; // Not used for conditional selection
-        selection->is_drop_operation = false; // Not used for conditional selection
-        
-        // Create original syntax string
-        const char *op_str = "";
-        switch (comp_op) {
-            case DICE_OP_GT: op_str = ">"; break;
-            case DICE_OP_LT: op_str = "<"; break;
-            case DICE_OP_GTE: op_str = ">="; break;
-            case DICE_OP_LTE: op_str = "<="; break;
-            case DICE_OP_EQ: op_str = "="; break;
-            case DICE_OP_NEQ: op_str = "<>"; break;
-            default: op_str = "?"; break;
-        }
-        
-        size_t syntax_len = snprintf(NULL, 0, "s%s%lld", op_str, (long long)comp_value->data.literal.value) + 1;
-        char *syntax = arena_alloc(state->ctx, syntax_len);
-        if (!syntax) return NULL;
-        snprintf(syntax, syntax_len, "s%s%lld", op_str, (long long)comp_value->data.literal.value);
-        selection->original_syntax = syntax;
-        
-        // Update the node to be a filter operation
-        node->data.dice_op.dice_type = DICE_DICE_FILTER;
-        node->data.dice_op.modifier = comp_value;
-        node->data.dice_op.selection = selection;
-        
-    } else if (*state->pos == 'r' || *state->pos == 'R') {
-        // Check for reroll modifier: r, r1, r>N, r<N, r>=N, r<=N, r==N, r!=N
-        state->pos++; // consume 'r'
-        skip_whitespace(state);
+    // Check for exploding modifiers: !, !! (compounding), !>N, !!>N
+    if (token_is(state, '!') || state->token.type == TOKEN_BANGBANG) {
+        if (!parse_explosion(state, node)) return NULL;
         
-        // Parse comparison operator or detect default case (reroll 1s)
-        dice_binary_op_t comp_op = DICE_OP_EQ; // Default to equals
-        
-        if (*state->pos == '>' && *(state->pos + 1) == '=') {
-            comp_op = DICE_OP_GTE;
-            state->pos += 2;
-        } else if (*state->pos == '<' && *(state->pos + 1) == '=') {
-            comp_op = DICE_OP_LTE;
-            state->pos += 2;
-        } else if (*state->pos == '<' && *(state->pos + 1) == '>') {
-            comp_op = DICE_OP_NEQ;
-            state->pos += 2;
-        } else if (*state->pos == '=' && *(state->pos + 1) == '=') {
-            comp_op = DICE_OP_EQ;
-            state->pos += 2;
-        } else if (*state->pos == '=') {
-            comp_op = DICE_OP_EQ;
-            state->pos++;
-        } else if (*state->pos == '>') {
-            comp_op = DICE_OP_GT;
-            state->pos++;
-        } else if (*state->pos == '<') {
-            comp_op = DICE_OP_LT;
-            state->pos++;
-        } else if (is_digit(*state->pos)) {
-            // No operator provided - default to equals
-            comp_op = DICE_OP_EQ;
-        } else if (*state->pos == '\0' || *state->pos == ' ' || *state->pos == '\t' ||
-                   *state->pos == '+' || *state->pos == '-' || *state->pos == '*' || *state->pos == '/') {
-            // No value provided - default to r1 (reroll 1s)
-            comp_op = DICE_OP_EQ;
-        } else {
-            snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                    "Expected comparison operator after 'r' (>, <, >=, <=, =, <>) or numeric value");
-            state->ctx->error.has_error = true;
-            return NULL;
-        }
-        
-        skip_whitespace(state);
-        
-        // Parse comparison value (default to 1 if not provided)
-        dice_ast_node_t *comp_value = NULL;
-        
-        if (is_digit(*state->pos)) {
-            comp_value = parse_number(state);
-        } else if (*state->pos == '\0' || *state->pos == ' ' || *state->pos == '\t' ||
-                   *state->pos == '+' || *state->pos == '-' || *state->pos == '*' || *state->pos == '/') {
-            // Check if we have an incomplete comparison operator (like r> with no value)
-            if (comp_op != DICE_OP_EQ) {
-                snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                        "Missing comparison value after comparison operator");
-                state->ctx->error.has_error = true;
-                return NULL;
-            }
-            // Default to 1 only for 'r' or 'rN' cases (not 'r>' cases)
-            comp_value = create_node(state->ctx, DICE_NODE_LITERAL);
-            if (comp_value) {
-                comp_value->data.literal.value = 1;
-            }
-        } else {
-            snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                    "Expected numeric value after 'r' operator");
-            state->ctx->error.has_error = true;
-            return NULL;
-        }
-        
-        if (!comp_value || comp_value->type != DICE_NODE_LITERAL) {
-            snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                    "Failed to parse comparison value for 'r' operator");
-            state->ctx->error.has_error = true;
+        if (state->token.type == TOKEN_LETTER) {
+            parse_error(state, "Exploding dice cannot be combined with keep, drop, select, or reroll modifiers");
             return NULL;
         }
-        
-        // Create reroll selection structure
-        dice_selection_t *selection = arena_alloc(state->ctx, sizeof(dice_selection_t));
-        if (!selection) return NULL;
-        
-        selection->is_conditional = true;
-        selection->is_reroll = true;
-        selection->comparison_op = comp_op;
-        selection->comparison_value = comp_value->data.literal.value;
-        selection->count = 0; // Not used for reroll
-        selection->select_high = false; // Not used for reroll
-        selection->is_drop_operation = false; // Not used for reroll
-        
-        // Create original syntax string
-        const char *op_str = "";
-        switch (comp_op) {
-            case DICE_OP_GT: op_str = ">"; break;
-            case DICE_OP_LT: op_str = "<"; break;
-            case DICE_OP_GTE: op_str = ">="; break;
-            case DICE_OP_LTE: op_str = "<="; break;
-            case DICE_OP_EQ: op_str = ""; break; // For r1, don't show the = operator
-            case DICE_OP_NEQ: op_str = "<>"; break;
-            default: op_str = "?"; break;
+        return node;
+    }
+    
+    // Keep/drop letters are modifiers only when a count, a blank, '(' or an
+    // operator follows; anything else is left over as unexpected input
+    bool parsed = true;
+    if (token_is_letter(state, 'k') || token_is_letter(state, 'h') || token_is_letter(state, 'l')) {
+        char next = char_after_token(state);
+        if (is_digit(next) || next == ' ' || next == '\t' || next == '(' || next == '\0' ||
+            next == '+' || next == '-' || next == '*' || next == '/') {
+            parsed = parse_keep_drop(state, node);
         }
-        
-        size_t syntax_len = snprintf(NULL, 0, "r%s%lld", op_str, (long long)comp_value->data.literal.value) + 1;
-        char *syntax = arena_alloc(state->ctx, syntax_len);
-        if (!syntax) return NULL;
-        snprintf(syntax, syntax_len, "r%s%lld", op_str, (long long)comp_value->data.literal.value);
-        selection->original_syntax = syntax;
-        
-        // Update the node to be a filter operation
-        node->data.dice_op.dice_type = DICE_DICE_FILTER;
-        node->data.dice_op.modifier = comp_value;
-        node->data.dice_op.selection = selection;
+    } else if (token_is_letter(state, 's') || token_is_letter(state, 'r')) {
+        parsed = parse_conditional(state, node);
+    } else if (token_is(state, '>') || token_is(state, '<') ||
+               state->token.type == TOKEN_GTE || state->token.type == TOKEN_LTE ||
+               state->token.type == TOKEN_NEQ) {
+        parsed = parse_pool(state, node);
     }
     
-    return node;
+    return parsed ? node : NULL;
+}
+
+// Groups and signs are the only recursion in the grammar; bound it
+static bool enter_nesting(parser_state_t *state) {
+    int limit = state->ctx->policy.max_depth;
+    if (limit > 0 && state->depth >= limit) {
+        parse_error(state, "Expression exceeds nesting depth limit of %d", limit);
+        return false;
+    }
+    state->depth++;
+    return true;
 }
 
 static dice_ast_node_t* parse_group(parser_state_t *state) {
-    skip_whitespace(state);
-    
-    if (*state->pos != '(') {
+    if (!token_is(state, '(')) {
         return NULL;
     }
     
-    state->pos++; // consume '('
+    if (!enter_nesting(state)) return NULL;
+    advance(state); // consume '('
     dice_ast_node_t *expr = parse_expression(state);
+    state->depth--;
     if (!expr) return NULL;
     
-    skip_whitespace(state);
-    if (*state->pos != ')') {
-        snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                "Expected closing parenthesis");
-        state->ctx->error.has_error = true;
+    if (!token_is(state, ')')) {
+        parse_error(state, "Expected closing parenthesis");
         return NULL;
     }
     
-    state->pos++; // consume ')'
+    advance(state); // consume ')'
     return expr;
 }
 
 static dice_ast_node_t* parse_primary(parser_state_t *state) {
-    skip_whitespace(state);
-    
     dice_ast_node_t *result = NULL;
     
-    if (*state->pos == '(') {
+    if (token_is(state, '(')) {
         result = parse_group(state);
-    } else if (is_digit(*state->pos) || *state->pos == 'd' || *state->pos == 'D') {
-        // Try dice first, then number
-        const char *saved_pos = state->pos;
-        result = parse_dice(state);
-        if (!result && !state->ctx->error.has_error) {
-            state->pos = saved_pos;
-            result = parse_number(state);
+        
+        // A parenthesized dice count: (2+1)d6
+        if (result && token_is_letter(state, 'd')) {
+            result = parse_dice_rest(state, result);
         }
+    } else if (state->token.type == TOKEN_NUMBER) {
+        // A number, or the count of a dice expression
+        result = parse_number(state);
+        if (result && token_is_letter(state, 'd')) {
+            result = parse_dice_rest(state, result);
+        }
+    } else if (token_is_letter(state, 'd')) {
+        result = parse_dice_rest(state, NULL);
     }
     
-    if (!result && !state->ctx->error.has_error) {
-        snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                "Expected number, dice expression, or parenthesized expression");
-        state->ctx->error.has_error = true;
+    if (!result && !state->failed) {
+        parse_error(state, "Expected number, dice expression, or parenthesized expression");
+        state->missing = true;
     }
     
     return result;
 }
 
 static dice_ast_node_t* parse_unary(parser_state_t *state) {
-    skip_whitespace(state);
-    
-    if (*state->pos == '+' || *state->pos == '-') {
-        dice_binary_op_t op = (*state->pos == '+') ? DICE_OP_ADD : DICE_OP_SUB;
-        state->pos++;
+    if (token_is(state, '+') || token_is(state, '-')) {
+        bool negate = token_is(state, '-');
+        if (!enter_nesting(state)) return NULL;
+        advance(state);
         
         dice_ast_node_t *operand = parse_unary(state);
+        state->depth--;
         if (!operand) return NULL;
         
-        if (op == DICE_OP_ADD) {
+        if (!negate) {
             // Unary plus is identity
             return operand;
-        } else {
-            // Unary minus: create 0 - operand
-            dice_ast_node_t *zero = create_node(state->ctx, DICE_NODE_LITERAL);
-            if (!zero) return NULL;
-            zero->data.literal.value = 0;
-            
-            dice_ast_node_t *node = create_node(state->ctx, DICE_NODE_BINARY_OP);
-            if (!node) return NULL;
-            
-            node->data.binary_op.op = DICE_OP_SUB;
-            node->data.binary_op.left = zero;
-            node->data.binary_op.right = operand;
-            return node;
         }
+        
+        // Unary minus: create 0 - operand
+        dice_ast_node_t *zero = create_literal(state, 0);
+        if (!zero) return NULL;
+        
+        dice_ast_node_t *node = create_node(state, DICE_NODE_BINARY_OP);
+        if (!node) return NULL;
+        
+        node->data.binary_op.op = DICE_OP_SUB;
+        node->data.binary_op.left = zero;
+        node->data.binary_op.right = operand;
+        return node;
     }
     
     return parse_primary(state);
@@ -717,29 +762,21 @@ static dice_ast_node_t* parse_product(parser_state_t *state) {
     dice_ast_node_t *left = parse_unary(state);
     if (!left) return NULL;
     
-    while (1) {
-        skip_whitespace(state);
-        
-        dice_binary_op_t op;
-        if (*state->pos == '*') {
-            op = DICE_OP_MUL;
-        } else if (*state->pos == '/') {
-            op = DICE_OP_DIV;
-        } else {
-            break;
-        }
-        
-        state->pos++; // consume operator
+    while (token_is(state, '*') || token_is(state, '/')) {
+        dice_binary_op_t op = token_is(state, '*') ? DICE_OP_MUL : DICE_OP_DIV;
+        advance(state); // consume operator
         
         dice_ast_node_t *right = parse_unary(state);
         if (!right) {
-            snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                    "Expected expression after operator");
-            state->ctx->error.has_error = true;
+            if (state->missing) {
+                // Name the dangling operator; any more specific error stands
+                state->failed = false;
+                parse_error(state, "Expected expression after operator");
+            }
             return NULL;
         }
         
-        dice_ast_node_t *node = create_node(state->ctx, DICE_NODE_BINARY_OP);
+        dice_ast_node_t *node = create_node(state, DICE_NODE_BINARY_OP);
         if (!node) return NULL;
         
         node->data.binary_op.op = op;
@@ -755,29 +792,21 @@ static dice_ast_node_t* parse_sum(parser_state_t *state) {
     dice_ast_node_t *left = parse_product(state);
     if (!left) return NULL;
     
-    while (1) {
-        skip_whitespace(state);
-        
-        dice_binary_op_t op;
-        if (*state->pos == '+') {
-            op = DICE_OP_ADD;
-        } else if (*state->pos == '-') {
-            op = DICE_OP_SUB;
-        } else {
-            break;
-        }
-        
-        state->pos++; // consume operator
+    while (token_is(state, '+') || token_is(state, '-')) {
+        dice_binary_op_t op = token_is(state, '+') ? DICE_OP_ADD : DICE_OP_SUB;
+        advance(state); // consume operator
         
         dice_ast_node_t *right = parse_product(state);
         if (!right) {
-            snprintf(state->ctx->error.message, sizeof(state->ctx->error.message),
-                    "Expected expression after operator");
-            state->ctx->error.has_error = true;
+            if (state->missing) {
+                // Name the dangling operator; any more specific error stands
+                state->failed = false;
+                parse_error(state, "Expected expression after operator");
+            }
             return NULL;
         }
         
-        dice_ast_node_t *node = create_node(state->ctx, DICE_NODE_BINARY_OP);
+        dice_ast_node_t *node = create_node(state, DICE_NODE_BINARY_OP);
         if (!node) return NULL;
         
         node->data.binary_op.op = op;
@@ -793,27 +822,44 @@ static dice_ast_node_t* parse_expression(parser_state_t *state) {
     return parse_sum(state);
 }
 
-dice_ast_node_t* dice_parse(dice_context_t *ctx, const char *expression_str) {
-    if (!ctx || !expression_str) return NULL;
-    
+static dice_ast_node_t* parse_input(dice_context_t *ctx, const char *text, size_t length) {
     parser_state_t state = {
         .ctx = ctx,
-        .input = expression_str,
-        .pos = expression_str
+        .input = text,
+        .end = text + length,
+        .pos = text
     };
+    advance(&state);
     
     dice_ast_node_t *result = parse_expression(&state);
     
-    if (result) {
-        skip_whitespace(&state);
-        if (*state.pos != '\0') {
-            // Unexpected characters at end
-            snprintf(ctx->error.message, sizeof(ctx->error.message),
-                    "Unexpected characters at end of expression: '%s'", state.pos);
-            ctx->error.has_error = true;
-            return NULL;
-        }
+    if (result && state.token.type != TOKEN_END) {
+        // Unexpected characters at end (a string token starts past its quote)
+        const char *rest = state.token.type == TOKEN_STRING ? state.token.start - 1 : state.token.start;
+        parse_error(&state, "Unexpected characters at end of expression: '%.*s'",
+                    (int)(state.end - rest), rest);
     }
     
+    // A lexical error can cut the input short after a complete expression
+    return state.failed ? NULL : result;
+}
+
+dice_ast_node_t* dice_parse_n(dice_context_t *ctx, const char *text, size_t length) {
+    if (!ctx || (!text && length > 0)) return NULL;
+    if (!text) text = "";
+
+#ifdef DICE_ENABLE_COUNTERS
+    uint64_t start = counters_now_ns();
+    dice_ast_node_t *result = parse_input(ctx, text, length);
+    DICE_COUNT(ctx, parse_calls, 1);
+    DICE_COUNT(ctx, parse_ns, counters_now_ns() - start);
     return result;
-}
\ No newline at end of file
+#else
+    return parse_input(ctx, text, length);
+#endif
+}
+
+dice_ast_node_t* dice_parse(dice_context_t *ctx, const char *expression_str) {
+    if (!ctx || !expression_str) return NULL;
+    return dice_parse_n(ctx, expression_str, strlen(expression_str));
+}
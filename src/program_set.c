@@ -0,0 +1,387 @@
+#include "dice.h"
+#include "internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// =============================================================================
+// Program Sets (serialized compiled programs)
+// =============================================================================
+
+// A program set is one position-independent block: a header, an entry table
+// sorted by key, the key string pool, then each program copied verbatim at an
+// 8-byte aligned offset. Programs already reference everything by offset, so
+// a mapped file is evaluated in place.
+
+#define DICE_PROGRAM_SET_MAGIC   0x54455344u  // "DSET" little-endian
+#define DICE_PROGRAM_SET_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t program_version;   // DICE_PROGRAM_VERSION of the programs inside
+    uint64_t total_size;
+    uint32_t entry_count;
+    uint32_t entry_offset;
+    uint32_t key_offset;
+    uint32_t key_size;
+} program_set_header_t;
+
+typedef struct {
+    uint64_t program_offset;
+    uint32_t program_size;
+    uint32_t key;               // offset into the key pool
+} program_set_entry_t;
+
+struct dice_program_set {
+    const program_set_header_t *header;
+    void *mapping;              // mmap'd file, or NULL
+    size_t mapping_size;
+    void *buffer;               // file read into memory, or NULL
+};
+
+static uint64_t align8(uint64_t size) {
+    return (size + 7u) & ~(uint64_t)7u;
+}
+
+static void program_set_error(dice_context_t *ctx, const char *message, const char *detail) {
+    if (detail) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message), "%s: %s", message, detail);
+    } else {
+        snprintf(ctx->error.message, sizeof(ctx->error.message), "%s", message);
+    }
+    ctx->error.has_error = true;
+}
+
+static const program_set_entry_t* set_entries(const program_set_header_t *header) {
+    return (const program_set_entry_t*)((const char*)header + header->entry_offset);
+}
+
+static const char* set_keys(const program_set_header_t *header) {
+    return (const char*)header + header->key_offset;
+}
+
+// Sort entry indices by key; qsort takes no context, and sets are small
+static void sort_by_key(size_t *order, size_t count, const char *const *keys) {
+    for (size_t i = 1; i < count; i++) {
+        size_t moving = order[i];
+        size_t j = i;
+        for (; j > 0 && strcmp(keys[order[j - 1]], keys[moving]) > 0; j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = moving;
+    }
+}
+
+size_t dice_program_set_encoded_size(const dice_program_t *const *programs,
+                                     const char *const *keys, size_t count) {
+    if ((count > 0 && (!programs || !keys)) || count > UINT32_MAX) return 0;
+    
+    uint64_t key_size = 1; // offset 0 is the empty string
+    uint64_t program_size = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!programs[i] || !keys[i]) return 0;
+        key_size += strlen(keys[i]) + 1;
+        program_size += align8(programs[i]->total_size);
+    }
+    
+    uint64_t total = align8(sizeof(program_set_header_t)) +
+                     align8((uint64_t)count * sizeof(program_set_entry_t)) +
+                     align8(key_size) + program_size;
+    if (key_size > UINT32_MAX || total > SIZE_MAX) return 0;
+    return (size_t)total;
+}
+
+int dice_program_set_encode(dice_context_t *ctx, const dice_program_t *const *programs,
+                            const char *const *keys, size_t count, void *buffer, size_t size) {
+    if (!ctx) return -1;
+    
+    size_t needed = dice_program_set_encoded_size(programs, keys, count);
+    if (needed == 0) {
+        program_set_error(ctx, "Invalid program set arguments", NULL);
+        return -1;
+    }
+    if (!buffer || size < needed || ((uintptr_t)buffer & 7u) != 0) {
+        program_set_error(ctx, "Program set buffer too small or misaligned", NULL);
+        return -1;
+    }
+    
+    size_t *order = malloc((count > 0 ? count : 1) * sizeof(size_t));
+    if (!order) {
+        program_set_error(ctx, "Failed to allocate memory for program set", NULL);
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) order[i] = i;
+    sort_by_key(order, count, keys);
+    for (size_t i = 1; i < count; i++) {
+        if (strcmp(keys[order[i - 1]], keys[order[i]]) == 0) {
+            program_set_error(ctx, "Duplicate program set key", keys[order[i]]);
+            free(order);
+            return -1;
+        }
+    }
+    
+    memset(buffer, 0, needed);
+    program_set_header_t *header = buffer;
+    header->magic = DICE_PROGRAM_SET_MAGIC;
+    header->version = DICE_PROGRAM_SET_VERSION;
+    header->program_version = DICE_PROGRAM_VERSION;
+    header->total_size = needed;
+    header->entry_count = (uint32_t)count;
+    header->entry_offset = (uint32_t)align8(sizeof(program_set_header_t));
+    header->key_offset = header->entry_offset + (uint32_t)align8((uint64_t)count * sizeof(program_set_entry_t));
+    
+    program_set_entry_t *entries = (program_set_entry_t*)((char*)buffer + header->entry_offset);
+    char *key_pool = (char*)buffer + header->key_offset;
+    uint32_t key_size = 1;
+    for (size_t i = 0; i < count; i++) {
+        size_t len = strlen(keys[order[i]]) + 1;
+        memcpy(key_pool + key_size, keys[order[i]], len);
+        entries[i].key = key_size;
+        key_size += (uint32_t)len;
+    }
+    header->key_size = key_size;
+    
+    uint64_t offset = header->key_offset + align8(key_size);
+    for (size_t i = 0; i < count; i++) {
+        const dice_program_t *source = programs[order[i]];
+        dice_program_t *copy = (dice_program_t*)((char*)buffer + offset);
+        memcpy(copy, source, source->total_size);
+        
+        // Registry slots mean nothing in another process; generation 0 never
+        // matches a live registry, so named dice are looked up by name
+        dice_program_die_t *dice = (dice_program_die_t*)((char*)copy + copy->die_offset);
+        for (uint32_t d = 0; d < copy->die_count; d++) {
+            if (!dice[d].name) continue;
+            dice[d].registry_index = 0;
+            dice[d].registry_generation = 0;
+        }
+        
+        entries[i].program_offset = offset;
+        entries[i].program_size = source->total_size;
+        offset += align8(source->total_size);
+    }
+    
+    free(order);
+    return 0;
+}
+
+int dice_program_set_save(dice_context_t *ctx, const char *path, const dice_program_t *const *programs,
+                          const char *const *keys, size_t count) {
+    if (!ctx) return -1;
+    if (!path) {
+        program_set_error(ctx, "Program set path is NULL", NULL);
+        return -1;
+    }
+    
+    size_t size = dice_program_set_encoded_size(programs, keys, count);
+    if (size == 0) {
+        program_set_error(ctx, "Invalid program set arguments", NULL);
+        return -1;
+    }
+    
+    // malloc memory is suitably aligned for the 8-byte fields
+    void *buffer = malloc(size);
+    if (!buffer) {
+        program_set_error(ctx, "Failed to allocate memory for program set", NULL);
+        return -1;
+    }
+    if (dice_program_set_encode(ctx, programs, keys, count, buffer, size) != 0) {
+        free(buffer);
+        return -1;
+    }
+    
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        free(buffer);
+        program_set_error(ctx, "Cannot open program set file for writing", path);
+        return -1;
+    }
+    bool ok = fwrite(buffer, 1, size, file) == size;
+    ok = fclose(file) == 0 && ok;
+    free(buffer);
+    if (!ok) {
+        program_set_error(ctx, "Failed to write program set file", path);
+        return -1;
+    }
+    return 0;
+}
+
+static bool program_set_validate(dice_context_t *ctx, const void *data, size_t size) {
+    const program_set_header_t *header = data;
+    if (!data || ((uintptr_t)data & 7u) != 0 || size < sizeof(program_set_header_t)) {
+        program_set_error(ctx, "Invalid program set", "missing, misaligned or truncated header");
+        return false;
+    }
+    if (header->magic != DICE_PROGRAM_SET_MAGIC) {
+        program_set_error(ctx, "Invalid program set", "bad magic (not a program set, or other byte order)");
+        return false;
+    }
+    if (header->version != DICE_PROGRAM_SET_VERSION || header->program_version != DICE_PROGRAM_VERSION) {
+        program_set_error(ctx, "Invalid program set", "unsupported version");
+        return false;
+    }
+    if (header->total_size > size ||
+        header->entry_offset % 8 != 0 || header->entry_offset < sizeof(program_set_header_t) ||
+        (uint64_t)header->entry_offset + (uint64_t)header->entry_count * sizeof(program_set_entry_t) >
+            header->key_offset ||
+        header->key_size == 0 || (uint64_t)header->key_offset + header->key_size > header->total_size) {
+        program_set_error(ctx, "Invalid program set", "section out of bounds");
+        return false;
+    }
+    
+    const char *keys = set_keys(header);
+    if (keys[0] != '\0' || keys[header->key_size - 1] != '\0') {
+        program_set_error(ctx, "Invalid program set", "bad key pool");
+        return false;
+    }
+    
+    const program_set_entry_t *entries = set_entries(header);
+    uint64_t programs_start = header->key_offset + (uint64_t)header->key_size;
+    for (uint32_t i = 0; i < header->entry_count; i++) {
+        const program_set_entry_t *entry = &entries[i];
+        if (entry->key == 0 || entry->key >= header->key_size ||
+            (i > 0 && strcmp(keys + entries[i - 1].key, keys + entry->key) >= 0)) {
+            program_set_error(ctx, "Invalid program set", "keys missing or out of order");
+            return false;
+        }
+        if (entry->program_offset % 8 != 0 || entry->program_offset < programs_start ||
+            entry->program_offset > header->total_size ||
+            entry->program_size > header->total_size - entry->program_offset) {
+            program_set_error(ctx, "Invalid program set", "program out of bounds");
+            return false;
+        }
+        
+        const dice_program_t *program = (const dice_program_t*)((const char*)data + entry->program_offset);
+        if (!program_validate(ctx, program, entry->program_size)) return false;
+    }
+    return true;
+}
+
+dice_program_set_t* dice_program_set_view(dice_context_t *ctx, const void *data, size_t size) {
+    if (!ctx) return NULL;
+    if (!program_set_validate(ctx, data, size)) return NULL;
+    
+    dice_program_set_t *set = calloc(1, sizeof(dice_program_set_t));
+    if (!set) {
+        program_set_error(ctx, "Failed to allocate memory for program set", NULL);
+        return NULL;
+    }
+    set->header = data;
+    return set;
+}
+
+dice_program_set_t* dice_program_set_open(dice_context_t *ctx, const char *path) {
+    if (!ctx) return NULL;
+    if (!path) {
+        program_set_error(ctx, "Program set path is NULL", NULL);
+        return NULL;
+    }
+
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        program_set_error(ctx, "Cannot open program set file", path);
+        return NULL;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        program_set_error(ctx, "Program set file is empty or unreadable", path);
+        return NULL;
+    }
+    
+    size_t size = (size_t)info.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        program_set_error(ctx, "Cannot map program set file", path);
+        return NULL;
+    }
+    
+    dice_program_set_t *set = dice_program_set_view(ctx, mapping, size);
+    if (!set) {
+        munmap(mapping, size);
+        return NULL;
+    }
+    set->mapping = mapping;
+    set->mapping_size = size;
+    return set;
+#else
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        program_set_error(ctx, "Cannot open program set file", path);
+        return NULL;
+    }
+    
+    void *buffer = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) size = ftell(file);
+    if (size > 0 && fseek(file, 0, SEEK_SET) == 0) buffer = malloc((size_t)size);
+    bool ok = buffer && fread(buffer, 1, (size_t)size, file) == (size_t)size;
+    fclose(file);
+    if (!ok) {
+        free(buffer);
+        program_set_error(ctx, "Cannot read program set file", path);
+        return NULL;
+    }
+    
+    dice_program_set_t *set = dice_program_set_view(ctx, buffer, (size_t)size);
+    if (!set) {
+        free(buffer);
+        return NULL;
+    }
+    set->buffer = buffer;
+    return set;
+#endif
+}
+
+void dice_program_set_close(dice_program_set_t *set) {
+    if (!set) return;
+
+#ifndef _WIN32
+    if (set->mapping) munmap(set->mapping, set->mapping_size);
+#endif
+    free(set->buffer);
+    free(set);
+}
+
+size_t dice_program_set_count(const dice_program_set_t *set) {
+    return set ? set->header->entry_count : 0;
+}
+
+const char* dice_program_set_key(const dice_program_set_t *set, size_t index) {
+    if (!set || index >= set->header->entry_count) return NULL;
+    return set_keys(set->header) + set_entries(set->header)[index].key;
+}
+
+const dice_program_t* dice_program_set_get(const dice_program_set_t *set, size_t index) {
+    if (!set || index >= set->header->entry_count) return NULL;
+    return (const dice_program_t*)((const char*)set->header + set_entries(set->header)[index].program_offset);
+}
+
+const dice_program_t* dice_program_set_find(const dice_program_set_t *set, const char *key) {
+    if (!set || !key) return NULL;
+    
+    const program_set_entry_t *entries = set_entries(set->header);
+    const char *keys = set_keys(set->header);
+    size_t lo = 0, hi = set->header->entry_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(keys + entries[mid].key, key);
+        if (cmp == 0) return dice_program_set_get(set, mid);
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,117 @@
+#include "dice.h"
+#include "internal.h"
+#include <stdio.h>
+#include <string.h>
+
+// =============================================================================
+// Per-Die Results (dice_evaluate_ex)
+// =============================================================================
+
+size_t results_begin_op(dice_context_t *ctx, int sides) {
+    dice_results_t *results = ctx->results;
+    if (!results) return 0;
+    
+    if (results->op_count == results->op_capacity) {
+        results->truncated = true;
+        ctx->results_op_open = false;
+        return results->die_count;
+    }
+    
+    dice_results_op_t *op = &results->ops[results->op_count++];
+    op->sides = sides;
+    op->first = results->die_count;
+    op->count = 0;
+    ctx->results_op_open = true;
+    return results->die_count;
+}
+
+// Room for up to n more dice in the open operation
+static size_t results_reserve(dice_context_t *ctx, size_t n) {
+    dice_results_t *results = ctx->results;
+    if (!ctx->results_op_open) return 0;
+    
+    size_t room = results->die_capacity - results->die_count;
+    if (n > room) {
+        results->truncated = true;
+        n = room;
+    }
+    results->ops[results->op_count - 1].count += n;
+    return n;
+}
+
+static void results_set_kept(uint8_t *kept, size_t die, bool value) {
+    uint8_t bit = (uint8_t)(1u << (die & 7));
+    kept[die >> 3] = value ? (uint8_t)(kept[die >> 3] | bit) : (uint8_t)(kept[die >> 3] & ~bit);
+}
+
+void results_add_rolls(dice_context_t *ctx, const int *rolls, const bool *selected, size_t n) {
+    if (!ctx->results) return;
+    
+    dice_results_t *results = ctx->results;
+    n = results_reserve(ctx, n);
+    size_t first = results->die_count;
+    
+    for (size_t i = 0; i < n; i++) {
+        results->values[first + i] = rolls[i];
+        results_set_kept(results->kept, first + i, selected ? selected[i] : true);
+    }
+    if (results->rerolls) memset(results->rerolls + first, 0, n * sizeof(uint32_t));
+    results->die_count += n;
+}
+
+void results_add_value(dice_context_t *ctx, int64_t value, bool kept) {
+    if (!ctx->results || results_reserve(ctx, 1) == 0) return;
+    
+    dice_results_t *results = ctx->results;
+    size_t die = results->die_count++;
+    results->values[die] = value;
+    results_set_kept(results->kept, die, kept);
+    if (results->rerolls) results->rerolls[die] = 0;
+}
+
+void results_set_rerolls(dice_context_t *ctx, size_t die, uint32_t rerolls) {
+    dice_results_t *results = ctx->results;
+    if (results && results->rerolls && die < results->die_count) {
+        results->rerolls[die] = rerolls;
+    }
+}
+
+// Bind the buffer for one evaluation; false when it cannot take any dice
+static bool results_bind(dice_context_t *ctx, dice_results_t *results) {
+    results->die_count = 0;
+    results->op_count = 0;
+    results->truncated = false;
+    if ((results->die_capacity > 0 && (!results->values || !results->kept)) ||
+        (results->op_capacity > 0 && !results->ops)) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Results buffer is missing an array for its capacity");
+        ctx->error.has_error = true;
+        return false;
+    }
+    
+    ctx->results = results;
+    ctx->results_op_open = false;
+    return true;
+}
+
+dice_eval_result_t dice_evaluate_ex(dice_context_t *ctx, const dice_ast_node_t *node,
+                                    dice_results_t *results) {
+    dice_eval_result_t result = {0, false};
+    if (!ctx || !results) return dice_evaluate(ctx, node);
+    if (!results_bind(ctx, results)) return result;
+    
+    result = dice_evaluate(ctx, node);
+    ctx->results = NULL;
+    return result;
+}
+
+dice_eval_result_t dice_program_evaluate_ex(dice_context_t *ctx, const dice_program_t *program,
+                                            dice_results_t *results) {
+    dice_eval_result_t result = {0, false};
+    if (!ctx || !results) return dice_program_evaluate(ctx, program);
+    if (!results_bind(ctx, results)) return result;
+    
+    result = dice_program_evaluate(ctx, program);
+    ctx->results = NULL;
+    return result;
+}
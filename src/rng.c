@@ -25,10 +25,40 @@ static int system_rng_roll(void *state, int sides) {
     return (rand() % sides) + 1;
 }
 
+// rand() covers RAND_MAX + 1 values; wider ranges concatenate several calls
+static uint64_t system_rand_below(uint64_t max) {
+    const uint64_t radix = (uint64_t)RAND_MAX + 1;
+    uint64_t value = 0;
+    uint64_t span = 1;
+    while (span < max) {
+        value = value * radix + (uint64_t)rand();
+        if (span > UINT64_MAX / radix) break; // value already spans 64 bits
+        span *= radix;
+    }
+    return value % max;
+}
+
 static uint64_t system_rng_rand(void *state, uint64_t max) {
     (void)state; // unused
     if (max == 0) return 0;
-    return rand() % max;
+    return system_rand_below(max);
+}
+
+static int system_rng_roll_n(void *state, int sides, int *out, size_t n) {
+    (void)state; // unused
+    if (sides <= 0) return -1;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (rand() % sides) + 1;
+    }
+    return 0;
+}
+
+static int system_rng_rand_n(void *state, uint64_t max, uint64_t *out, size_t n) {
+    (void)state; // unused
+    for (size_t i = 0; i < n; i++) {
+        out[i] = max ? system_rand_below(max) : 0;
+    }
+    return 0;
 }
 
 static void system_rng_cleanup(void *state) {
@@ -43,14 +73,445 @@ dice_rng_vtable_t dice_create_system_rng(uint64_t seed) {
         .roll = system_rng_roll,
         .rand = system_rng_rand,
         .cleanup = system_rng_cleanup,
-        .state = state
+        .state = state,
+        .roll_n = system_rng_roll_n,
+        .rand_n = system_rng_rand_n
     };
     
     rng.init(state, seed);
     return rng;
 }
 
-// Placeholder for xoshiro - just use system RNG for now
+// =============================================================================
+// Bulk Entry Points (engine roll_n/rand_n with a generic fallback)
+// =============================================================================
+
+static int rng_roll_n_engine(dice_context_t *ctx, int sides, int *out, size_t n) {
+    if (ctx->rng.roll_n) {
+        return ctx->rng.roll_n(ctx->rng.state, sides, out, n);
+    }
+    
+    for (size_t i = 0; i < n; i++) {
+        int roll = ctx->rng.roll(ctx->rng.state, sides);
+        if (roll < 0) return -1;
+        out[i] = roll;
+    }
+    return 0;
+}
+
+static int rng_rand_n_engine(dice_context_t *ctx, uint64_t max, uint64_t *out, size_t n) {
+    if (ctx->rng.rand_n) {
+        return ctx->rng.rand_n(ctx->rng.state, max, out, n);
+    }
+    
+    for (size_t i = 0; i < n; i++) {
+        out[i] = ctx->rng.rand(ctx->rng.state, max);
+    }
+    return 0;
+}
+
+int rng_roll_n(dice_context_t *ctx, int sides, int *out, size_t n) {
+    int status = rng_roll_n_engine(ctx, sides, out, n);
+    DICE_COUNT(ctx, rng_calls, n);
+    DICE_COUNT(ctx, rng_rejections, rng_take_rejections(&ctx->rng));
+    return status;
+}
+
+int rng_rand_n(dice_context_t *ctx, uint64_t max, uint64_t *out, size_t n) {
+    int status = rng_rand_n_engine(ctx, max, out, n);
+    DICE_COUNT(ctx, rng_calls, n);
+    DICE_COUNT(ctx, rng_rejections, rng_take_rejections(&ctx->rng));
+    return status;
+}
+
+// =============================================================================
+// xoshiro256++ (per-context state, no libc rand() involvement)
+// =============================================================================
+
+// xoshiro256++ state - lives entirely behind the vtable's state pointer
+typedef struct {
+    uint64_t s[4];
+#ifdef DICE_ENABLE_COUNTERS
+    uint64_t rejections;        // Draws discarded by range reduction
+#endif
+} xoshiro_rng_state_t;
+
+static inline uint64_t rotl64(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// SplitMix64 step, used to expand a single 64-bit seed into a full state
+static uint64_t splitmix64_next(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t xoshiro_next(xoshiro_rng_state_t *st) {
+    uint64_t *s = st->s;
+    const uint64_t result = rotl64(s[0] + s[3], 23) + s[0];
+    const uint64_t t = s[1] << 17;
+    
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl64(s[3], 45);
+    
+    return result;
+}
+
+// Full 64x64 -> 128 bit multiply, returning the high half and storing the low half
+static inline uint64_t mul_64x64_hi(uint64_t a, uint64_t b, uint64_t *lo) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 m = (unsigned __int128)a * b;
+    *lo = (uint64_t)m;
+    return (uint64_t)(m >> 64);
+#else
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t p0 = a_lo * b_lo;
+    uint64_t p1 = a_lo * b_hi;
+    uint64_t p2 = a_hi * b_lo;
+    uint64_t p3 = a_hi * b_hi;
+    uint64_t mid = (p0 >> 32) + (uint32_t)p1 + (uint32_t)p2;
+    *lo = (mid << 32) | (uint32_t)p0;
+    return p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+#endif
+}
+
+static int xoshiro_rng_init(void *state, uint64_t seed) {
+    xoshiro_rng_state_t *s = (xoshiro_rng_state_t*)state;
+    if (!s) return -1;
+    
+    uint64_t x = seed ? seed : ((uint64_t)time(NULL) ^ (uint64_t)(uintptr_t)state);
+    for (int i = 0; i < 4; i++) {
+        s->s[i] = splitmix64_next(&x);
+    }
+#ifdef DICE_ENABLE_COUNTERS
+    s->rejections = 0;
+#endif
+    return 0;
+}
+
+// Lemire's nearly-divisionless reduction of the top 32 bits into [0, range)
+static inline uint32_t xoshiro_bounded32(xoshiro_rng_state_t *s, uint32_t range) {
+    uint64_t m = (xoshiro_next(s) >> 32) * range;
+    uint32_t low = (uint32_t)m;
+    if (low < range) {
+        uint32_t threshold = (uint32_t)(-range) % range;
+        while (low < threshold) {
+#ifdef DICE_ENABLE_COUNTERS
+            s->rejections++;
+#endif
+            m = (xoshiro_next(s) >> 32) * range;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+// 64-bit variant of the same reduction into [0, max)
+static inline uint64_t xoshiro_bounded64(xoshiro_rng_state_t *s, uint64_t max) {
+    uint64_t low;
+    uint64_t high = mul_64x64_hi(xoshiro_next(s), max, &low);
+    if (low < max) {
+        uint64_t threshold = (0 - max) % max;
+        while (low < threshold) {
+#ifdef DICE_ENABLE_COUNTERS
+            s->rejections++;
+#endif
+            high = mul_64x64_hi(xoshiro_next(s), max, &low);
+        }
+    }
+    return high;
+}
+
+static int xoshiro_rng_roll(void *state, int sides) {
+    if (sides <= 0 || !state) return -1;
+    return (int)xoshiro_bounded32((xoshiro_rng_state_t*)state, (uint32_t)sides) + 1;
+}
+
+static uint64_t xoshiro_rng_rand(void *state, uint64_t max) {
+    if (max == 0 || !state) return 0;
+    return xoshiro_bounded64((xoshiro_rng_state_t*)state, max);
+}
+
+static int xoshiro_rng_roll_n(void *state, int sides, int *out, size_t n) {
+    if (sides <= 0 || !state) return -1;
+    
+    // Work on a local copy so the state stays in registers across the loop
+    xoshiro_rng_state_t s = *(xoshiro_rng_state_t*)state;
+    uint32_t range = (uint32_t)sides;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (int)xoshiro_bounded32(&s, range) + 1;
+    }
+    *(xoshiro_rng_state_t*)state = s;
+    return 0;
+}
+
+static int xoshiro_rng_rand_n(void *state, uint64_t max, uint64_t *out, size_t n) {
+    if (!state) return -1;
+    
+    xoshiro_rng_state_t s = *(xoshiro_rng_state_t*)state;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = max ? xoshiro_bounded64(&s, max) : 0;
+    }
+    *(xoshiro_rng_state_t*)state = s;
+    return 0;
+}
+
+static void xoshiro_rng_cleanup(void *state) {
+    free(state);
+}
+
+static void xoshiro_apply_jump(xoshiro_rng_state_t *st, const uint64_t jump[4]) {
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (jump[i] & ((uint64_t)1 << b)) {
+                s0 ^= st->s[0];
+                s1 ^= st->s[1];
+                s2 ^= st->s[2];
+                s3 ^= st->s[3];
+            }
+            xoshiro_next(st);
+        }
+    }
+    
+    st->s[0] = s0;
+    st->s[1] = s1;
+    st->s[2] = s2;
+    st->s[3] = s3;
+}
+
 dice_rng_vtable_t dice_create_xoshiro_rng(uint64_t seed) {
-    return dice_create_system_rng(seed);
-}
\ No newline at end of file
+    xoshiro_rng_state_t *state = malloc(sizeof(xoshiro_rng_state_t));
+    
+    dice_rng_vtable_t rng = {
+        .init = xoshiro_rng_init,
+        .roll = xoshiro_rng_roll,
+        .rand = xoshiro_rng_rand,
+        .cleanup = xoshiro_rng_cleanup,
+        .state = state,
+        .roll_n = xoshiro_rng_roll_n,
+        .rand_n = xoshiro_rng_rand_n
+    };
+    
+    rng.init(state, seed);
+    return rng;
+}
+
+int dice_xoshiro_jump(dice_rng_vtable_t *rng) {
+    static const uint64_t JUMP[4] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+    };
+    
+    if (!rng || rng->roll != xoshiro_rng_roll || !rng->state) return -1;
+    xoshiro_apply_jump((xoshiro_rng_state_t*)rng->state, JUMP);
+    return 0;
+}
+
+int dice_xoshiro_long_jump(dice_rng_vtable_t *rng) {
+    static const uint64_t LONG_JUMP[4] = {
+        0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL,
+        0x77710069854ee241ULL, 0x39109bb02acbe635ULL
+    };
+    
+    if (!rng || rng->roll != xoshiro_rng_roll || !rng->state) return -1;
+    xoshiro_apply_jump((xoshiro_rng_state_t*)rng->state, LONG_JUMP);
+    return 0;
+}
+
+void rng_xoshiro_seed_state(uint64_t seed, uint64_t s[4]) {
+    xoshiro_rng_state_t st;
+    xoshiro_rng_init(&st, seed);
+    for (int i = 0; i < 4; i++) s[i] = st.s[i];
+}
+
+void rng_xoshiro_jump_state(uint64_t s[4]) {
+    static const uint64_t JUMP[4] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+    };
+    
+    xoshiro_rng_state_t st;
+    for (int i = 0; i < 4; i++) st.s[i] = s[i];
+    xoshiro_apply_jump(&st, JUMP);
+    for (int i = 0; i < 4; i++) s[i] = st.s[i];
+}
+
+#ifdef DICE_ENABLE_COUNTERS
+uint64_t rng_take_rejections(dice_rng_vtable_t *rng) {
+    if (rng->roll != xoshiro_rng_roll || !rng->state) return 0;
+    
+    xoshiro_rng_state_t *st = (xoshiro_rng_state_t*)rng->state;
+    uint64_t rejections = st->rejections;
+    st->rejections = 0;
+    return rejections;
+}
+#endif
+
+// Cloned contexts keep their engine state inline
+typedef char rng_inline_fits[sizeof(xoshiro_rng_state_t) <= sizeof(((dice_context_t*)0)->rng_inline) ? 1 : -1];
+
+dice_rng_vtable_t rng_xoshiro_inline(uint64_t *storage, uint64_t seed) {
+    dice_rng_vtable_t rng = {
+        .init = xoshiro_rng_init,
+        .roll = xoshiro_rng_roll,
+        .rand = xoshiro_rng_rand,
+        .cleanup = NULL,
+        .state = storage,
+        .roll_n = xoshiro_rng_roll_n,
+        .rand_n = xoshiro_rng_rand_n
+    };
+    
+    rng.init(storage, seed);
+    return rng;
+}
+
+int rng_xoshiro_get_state(const dice_rng_vtable_t *rng, uint64_t s[4]) {
+    if (!rng || rng->roll != xoshiro_rng_roll || !rng->state) return -1;
+    
+    const xoshiro_rng_state_t *st = (const xoshiro_rng_state_t*)rng->state;
+    for (int i = 0; i < 4; i++) s[i] = st->s[i];
+    return 0;
+}
+
+int rng_xoshiro_set_state(dice_rng_vtable_t *rng, const uint64_t s[4]) {
+    if (!rng || rng->roll != xoshiro_rng_roll || !rng->state) return -1;
+    
+    xoshiro_rng_state_t *st = (xoshiro_rng_state_t*)rng->state;
+    for (int i = 0; i < 4; i++) st->s[i] = s[i];
+    return 0;
+}
+
+// =============================================================================
+// Four-lane xoshiro256++ (vector kernels in rng_lanes.c)
+// =============================================================================
+
+// The stream interleaves four lanes: raw output k comes from lane k % 4. Raw
+// outputs of the most recent lane step are buffered so single-value calls and
+// the bulk kernels consume exactly the same sequence.
+typedef struct {
+    dice_xoshiro_lanes_t lanes;
+    uint64_t buffer[4];         // Raw outputs of the last lane step
+    unsigned buffer_pos;        // Next unread buffer slot (4 = empty)
+    rng_lanes_kernel_t kernel;  // Chosen once for the running CPU
+} xoshiro_x4_state_t;
+
+static inline uint64_t xoshiro_x4_next(xoshiro_x4_state_t *st) {
+    if (st->buffer_pos == 4) {
+        rng_lanes_step(&st->lanes, st->buffer);
+        st->buffer_pos = 0;
+    }
+    return st->buffer[st->buffer_pos++];
+}
+
+static int xoshiro_x4_rng_init(void *state, uint64_t seed) {
+    xoshiro_x4_state_t *st = (xoshiro_x4_state_t*)state;
+    if (!st) return -1;
+    
+    // Lane l is the single-lane stream for this seed jumped l times, so the
+    // lanes never overlap
+    xoshiro_rng_state_t lane;
+    xoshiro_rng_init(&lane, seed ? seed : ((uint64_t)time(NULL) ^ (uint64_t)(uintptr_t)state));
+    for (int l = 0; l < 4; l++) {
+        static const uint64_t JUMP[4] = {
+            0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+            0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+        };
+        
+        for (int w = 0; w < 4; w++) {
+            st->lanes.s[w][l] = lane.s[w];
+        }
+        xoshiro_apply_jump(&lane, JUMP);
+    }
+    st->buffer_pos = 4;
+    return 0;
+}
+
+// Sequential Lemire acceptance over the interleaved stream
+static inline uint32_t xoshiro_x4_bounded32(xoshiro_x4_state_t *st, uint32_t range,
+                                            uint32_t threshold) {
+    uint64_t m;
+    do {
+        m = (xoshiro_x4_next(st) >> 32) * range;
+    } while ((uint32_t)m < threshold);
+    return (uint32_t)(m >> 32);
+}
+
+static int xoshiro_x4_rng_roll(void *state, int sides) {
+    if (sides <= 0 || !state) return -1;
+    uint32_t range = (uint32_t)sides;
+    return (int)xoshiro_x4_bounded32((xoshiro_x4_state_t*)state, range, (uint32_t)(-range) % range) + 1;
+}
+
+static uint64_t xoshiro_x4_rng_rand(void *state, uint64_t max) {
+    if (max == 0 || !state) return 0;
+    
+    xoshiro_x4_state_t *st = (xoshiro_x4_state_t*)state;
+    uint64_t threshold = (0 - max) % max;
+    uint64_t low, high;
+    do {
+        high = mul_64x64_hi(xoshiro_x4_next(st), max, &low);
+    } while (low < threshold);
+    return high;
+}
+
+static int xoshiro_x4_rng_roll_n(void *state, int sides, int *out, size_t n) {
+    if (sides <= 0 || !state) return -1;
+    
+    xoshiro_x4_state_t *st = (xoshiro_x4_state_t*)state;
+    uint32_t range = (uint32_t)sides;
+    uint32_t threshold = (uint32_t)(-range) % range;
+    size_t i = 0;
+    
+    // Use up buffered outputs so the kernel starts on a lane-step boundary
+    while (i < n && st->buffer_pos < 4) {
+        uint64_t m = (st->buffer[st->buffer_pos++] >> 32) * range;
+        if ((uint32_t)m >= threshold) out[i++] = (int)(m >> 32) + 1;
+    }
+    
+    i += st->kernel(&st->lanes, range, threshold, out + i, n - i);
+    
+    while (i < n) {
+        out[i++] = (int)xoshiro_x4_bounded32(st, range, threshold) + 1;
+    }
+    return 0;
+}
+
+static int xoshiro_x4_rng_rand_n(void *state, uint64_t max, uint64_t *out, size_t n) {
+    if (!state) return -1;
+    
+    for (size_t i = 0; i < n; i++) {
+        out[i] = xoshiro_x4_rng_rand(state, max);
+    }
+    return 0;
+}
+
+static void xoshiro_x4_rng_cleanup(void *state) {
+    free(state);
+}
+
+dice_rng_vtable_t dice_create_xoshiro_x4_rng(uint64_t seed) {
+    xoshiro_x4_state_t *state = malloc(sizeof(xoshiro_x4_state_t));
+    if (state) state->kernel = rng_lanes_best_kernel();
+    
+    dice_rng_vtable_t rng = {
+        .init = xoshiro_x4_rng_init,
+        .roll = xoshiro_x4_rng_roll,
+        .rand = xoshiro_x4_rng_rand,
+        .cleanup = xoshiro_x4_rng_cleanup,
+        .state = state,
+        .roll_n = xoshiro_x4_rng_roll_n,
+        .rand_n = xoshiro_x4_rng_rand_n
+    };
+    
+    rng.init(state, seed);
+    return rng;
+}
@@ -0,0 +1,262 @@
+#include "dice.h"
+#include "internal.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define RNG_LANES_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(RNG_LANES_SSE2) && defined(__GNUC__) && \
+    (defined(__clang__) || __GNUC__ >= 5)
+#define RNG_LANES_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__)
+#define RNG_LANES_NEON 1
+#include <arm_neon.h>
+#endif
+
+// =============================================================================
+// Four-Lane xoshiro256++ Kernels
+// =============================================================================
+
+// Every kernel advances all four lanes once per step and turns the four raw
+// outputs into dice in lane order, skipping the ones Lemire's method rejects.
+// That is exactly what the scalar step below followed by a sequential
+// accept/reject does, so every kernel produces the same dice for the same
+// lanes. Kernels only run while at least four output slots remain, which
+// guarantees each step's outputs are fully consumed.
+
+static inline uint64_t lanes_rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+void rng_lanes_step(dice_xoshiro_lanes_t *lanes, uint64_t raw[4]) {
+    for (int l = 0; l < 4; l++) {
+        uint64_t s0 = lanes->s[0][l], s1 = lanes->s[1][l];
+        uint64_t s2 = lanes->s[2][l], s3 = lanes->s[3][l];
+        const uint64_t t = s1 << 17;
+        
+        raw[l] = lanes_rotl(s0 + s3, 23) + s0;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = lanes_rotl(s3, 45);
+        
+        lanes->s[0][l] = s0;
+        lanes->s[1][l] = s1;
+        lanes->s[2][l] = s2;
+        lanes->s[3][l] = s3;
+    }
+}
+
+size_t rng_lanes_fill_scalar(dice_xoshiro_lanes_t *lanes, uint32_t range,
+                             uint32_t threshold, int *out, size_t n) {
+    size_t written = 0;
+    uint64_t raw[4];
+    
+    while (n - written >= 4) {
+        rng_lanes_step(lanes, raw);
+        for (int l = 0; l < 4; l++) {
+            uint64_t m = (raw[l] >> 32) * range;
+            if ((uint32_t)m >= threshold) out[written++] = (int)(m >> 32) + 1;
+        }
+    }
+    return written;
+}
+
+#ifdef RNG_LANES_SSE2
+
+#define SSE2_ROTL(x, k) _mm_or_si128(_mm_slli_epi64((x), (k)), _mm_srli_epi64((x), 64 - (k)))
+
+// Two registers of two lanes each; SSE2 is baseline on x86-64
+static size_t lanes_fill_sse2(dice_xoshiro_lanes_t *lanes, uint32_t range,
+                              uint32_t threshold, int *out, size_t n) {
+    __m128i a[4], b[4];
+    for (int w = 0; w < 4; w++) {
+        a[w] = _mm_loadu_si128((const __m128i*)&lanes->s[w][0]);
+        b[w] = _mm_loadu_si128((const __m128i*)&lanes->s[w][2]);
+    }
+    
+    const __m128i vrange = _mm_set1_epi32((int)range);
+    // Unsigned 32-bit compare via a sign-bias and the signed compare
+    const __m128i bias = _mm_set1_epi32((int)0x80000000u);
+    const __m128i vthreshold = _mm_set1_epi32((int)(threshold ^ 0x80000000u));
+    size_t written = 0;
+    
+    while (n - written >= 4) {
+        __m128i ra = _mm_add_epi64(SSE2_ROTL(_mm_add_epi64(a[0], a[3]), 23), a[0]);
+        __m128i rb = _mm_add_epi64(SSE2_ROTL(_mm_add_epi64(b[0], b[3]), 23), b[0]);
+        __m128i ta = _mm_slli_epi64(a[1], 17);
+        __m128i tb = _mm_slli_epi64(b[1], 17);
+        
+        a[2] = _mm_xor_si128(a[2], a[0]);  b[2] = _mm_xor_si128(b[2], b[0]);
+        a[3] = _mm_xor_si128(a[3], a[1]);  b[3] = _mm_xor_si128(b[3], b[1]);
+        a[1] = _mm_xor_si128(a[1], a[2]);  b[1] = _mm_xor_si128(b[1], b[2]);
+        a[0] = _mm_xor_si128(a[0], a[3]);  b[0] = _mm_xor_si128(b[0], b[3]);
+        a[2] = _mm_xor_si128(a[2], ta);    b[2] = _mm_xor_si128(b[2], tb);
+        a[3] = SSE2_ROTL(a[3], 45);        b[3] = SSE2_ROTL(b[3], 45);
+        
+        // (raw >> 32) * range: the low dword of each product is the rejection
+        // test, the high dword the die face
+        __m128i ma = _mm_mul_epu32(_mm_srli_epi64(ra, 32), vrange);
+        __m128i mb = _mm_mul_epu32(_mm_srli_epi64(rb, 32), vrange);
+        __m128i lows = _mm_unpacklo_epi64(_mm_shuffle_epi32(ma, _MM_SHUFFLE(2, 0, 2, 0)),
+                                          _mm_shuffle_epi32(mb, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i highs = _mm_unpacklo_epi64(_mm_shuffle_epi32(ma, _MM_SHUFFLE(3, 1, 3, 1)),
+                                           _mm_shuffle_epi32(mb, _MM_SHUFFLE(3, 1, 3, 1)));
+        highs = _mm_add_epi32(highs, _mm_set1_epi32(1));
+        int reject = _mm_movemask_ps(_mm_castsi128_ps(
+            _mm_cmplt_epi32(_mm_xor_si128(lows, bias), vthreshold)));
+        
+        if (!reject) {
+            _mm_storeu_si128((__m128i*)(out + written), highs);
+            written += 4;
+        } else {
+            int faces[4];
+            _mm_storeu_si128((__m128i*)faces, highs);
+            for (int l = 0; l < 4; l++) {
+                if (!(reject & (1 << l))) out[written++] = faces[l];
+            }
+        }
+    }
+    
+    for (int w = 0; w < 4; w++) {
+        _mm_storeu_si128((__m128i*)&lanes->s[w][0], a[w]);
+        _mm_storeu_si128((__m128i*)&lanes->s[w][2], b[w]);
+    }
+    return written;
+}
+
+#endif /* RNG_LANES_SSE2 */
+
+#ifdef RNG_LANES_AVX2
+
+#define AVX2_ROTL(x, k) _mm256_or_si256(_mm256_slli_epi64((x), (k)), _mm256_srli_epi64((x), 64 - (k)))
+
+__attribute__((target("avx2")))
+static size_t lanes_fill_avx2(dice_xoshiro_lanes_t *lanes, uint32_t range,
+                              uint32_t threshold, int *out, size_t n) {
+    __m256i s0 = _mm256_loadu_si256((const __m256i*)lanes->s[0]);
+    __m256i s1 = _mm256_loadu_si256((const __m256i*)lanes->s[1]);
+    __m256i s2 = _mm256_loadu_si256((const __m256i*)lanes->s[2]);
+    __m256i s3 = _mm256_loadu_si256((const __m256i*)lanes->s[3]);
+    
+    const __m256i vrange = _mm256_set1_epi64x((long long)range);
+    const __m256i vthreshold = _mm256_set1_epi64x((long long)threshold);
+    const __m256i low_mask = _mm256_set1_epi64x(0xffffffffLL);
+    const __m256i pack_high = _mm256_setr_epi32(1, 3, 5, 7, 1, 3, 5, 7);
+    size_t written = 0;
+    
+    while (n - written >= 4) {
+        __m256i raw = _mm256_add_epi64(AVX2_ROTL(_mm256_add_epi64(s0, s3), 23), s0);
+        __m256i t = _mm256_slli_epi64(s1, 17);
+        
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = AVX2_ROTL(s3, 45);
+        
+        // Both operands of the 64-bit compare are below 2^32, so signed is fine
+        __m256i m = _mm256_mul_epu32(_mm256_srli_epi64(raw, 32), vrange);
+        int reject = _mm256_movemask_pd(_mm256_castsi256_pd(
+            _mm256_cmpgt_epi64(vthreshold, _mm256_and_si256(m, low_mask))));
+        __m128i faces = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(m, pack_high));
+        faces = _mm_add_epi32(faces, _mm_set1_epi32(1));
+        
+        if (!reject) {
+            _mm_storeu_si128((__m128i*)(out + written), faces);
+            written += 4;
+        } else {
+            int values[4];
+            _mm_storeu_si128((__m128i*)values, faces);
+            for (int l = 0; l < 4; l++) {
+                if (!(reject & (1 << l))) out[written++] = values[l];
+            }
+        }
+    }
+    
+    _mm256_storeu_si256((__m256i*)lanes->s[0], s0);
+    _mm256_storeu_si256((__m256i*)lanes->s[1], s1);
+    _mm256_storeu_si256((__m256i*)lanes->s[2], s2);
+    _mm256_storeu_si256((__m256i*)lanes->s[3], s3);
+    return written;
+}
+
+#endif /* RNG_LANES_AVX2 */
+
+#ifdef RNG_LANES_NEON
+
+#define NEON_ROTL(x, k) vorrq_u64(vshlq_n_u64((x), (k)), vshrq_n_u64((x), 64 - (k)))
+
+static size_t lanes_fill_neon(dice_xoshiro_lanes_t *lanes, uint32_t range,
+                              uint32_t threshold, int *out, size_t n) {
+    uint64x2_t a[4], b[4];
+    for (int w = 0; w < 4; w++) {
+        a[w] = vld1q_u64(&lanes->s[w][0]);
+        b[w] = vld1q_u64(&lanes->s[w][2]);
+    }
+    
+    const uint32x2_t vrange = vdup_n_u32(range);
+    const uint32x4_t vthreshold = vdupq_n_u32(threshold);
+    size_t written = 0;
+    
+    while (n - written >= 4) {
+        uint64x2_t ra = vaddq_u64(NEON_ROTL(vaddq_u64(a[0], a[3]), 23), a[0]);
+        uint64x2_t rb = vaddq_u64(NEON_ROTL(vaddq_u64(b[0], b[3]), 23), b[0]);
+        uint64x2_t ta = vshlq_n_u64(a[1], 17);
+        uint64x2_t tb = vshlq_n_u64(b[1], 17);
+        
+        a[2] = veorq_u64(a[2], a[0]);  b[2] = veorq_u64(b[2], b[0]);
+        a[3] = veorq_u64(a[3], a[1]);  b[3] = veorq_u64(b[3], b[1]);
+        a[1] = veorq_u64(a[1], a[2]);  b[1] = veorq_u64(b[1], b[2]);
+        a[0] = veorq_u64(a[0], a[3]);  b[0] = veorq_u64(b[0], b[3]);
+        a[2] = veorq_u64(a[2], ta);    b[2] = veorq_u64(b[2], tb);
+        a[3] = NEON_ROTL(a[3], 45);    b[3] = NEON_ROTL(b[3], 45);
+        
+        uint64x2_t ma = vmull_u32(vshrn_n_u64(ra, 32), vrange);
+        uint64x2_t mb = vmull_u32(vshrn_n_u64(rb, 32), vrange);
+        uint32x4_t lows = vcombine_u32(vmovn_u64(ma), vmovn_u64(mb));
+        uint32x4_t faces = vaddq_u32(vcombine_u32(vshrn_n_u64(ma, 32), vshrn_n_u64(mb, 32)),
+                                     vdupq_n_u32(1));
+        uint32x4_t accept = vcgeq_u32(lows, vthreshold);
+        
+        if (vminvq_u32(accept) != 0) {
+            vst1q_s32(out + written, vreinterpretq_s32_u32(faces));
+            written += 4;
+        } else {
+            uint32_t values[4], keep[4];
+            vst1q_u32(values, faces);
+            vst1q_u32(keep, accept);
+            for (int l = 0; l < 4; l++) {
+                if (keep[l]) out[written++] = (int)values[l];
+            }
+        }
+    }
+    
+    for (int w = 0; w < 4; w++) {
+        vst1q_u64(&lanes->s[w][0], a[w]);
+        vst1q_u64(&lanes->s[w][2], b[w]);
+    }
+    return written;
+}
+
+#endif /* RNG_LANES_NEON */
+
+rng_lanes_kernel_t rng_lanes_best_kernel(void) {
+#ifdef RNG_LANES_AVX2
+    if (__builtin_cpu_supports("avx2")) return lanes_fill_avx2;
+#endif
+#ifdef RNG_LANES_SSE2
+    return lanes_fill_sse2;
+#elif defined(RNG_LANES_NEON)
+    return lanes_fill_neon;
+#else
+    return rng_lanes_fill_scalar;
+#endif
+}
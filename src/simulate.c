@@ -0,0 +1,392 @@
+#include "dice.h"
+#include "internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// =============================================================================
+// Parallel Monte Carlo Runner
+// =============================================================================
+
+// Samples are split into fixed-size chunks and chunk c always draws from the
+// seed's xoshiro256++ stream jumped c times. Workers pull chunks from a shared
+// counter, and per-chunk statistics are merged in chunk order afterwards, so
+// the outcome depends only on the seed and sample count -- never on the
+// thread count or on which worker ran which chunk.
+//
+// dice_simulate_stats() keeps no per-chunk state: each worker accumulates a
+// chunk into its own dice_stats_t and then waits its turn to merge it, so
+// chunks are still folded in chunk order.
+
+#define SIMULATE_CHUNK_SAMPLES 8192
+
+#ifdef _WIN32
+typedef HANDLE sim_thread_t;
+typedef CRITICAL_SECTION sim_mutex_t;
+#define sim_mutex_init(m) InitializeCriticalSection(m)
+#define sim_mutex_lock(m) EnterCriticalSection(m)
+#define sim_mutex_unlock(m) LeaveCriticalSection(m)
+#define sim_mutex_destroy(m) DeleteCriticalSection(m)
+typedef CONDITION_VARIABLE sim_cond_t;
+#define sim_cond_init(c) InitializeConditionVariable(c)
+#define sim_cond_wait(c, m) SleepConditionVariableCS((c), (m), INFINITE)
+#define sim_cond_broadcast(c) WakeAllConditionVariable(c)
+#define sim_cond_destroy(c) ((void)(c))
+#else
+typedef pthread_t sim_thread_t;
+typedef pthread_mutex_t sim_mutex_t;
+#define sim_mutex_init(m) pthread_mutex_init((m), NULL)
+#define sim_mutex_lock(m) pthread_mutex_lock(m)
+#define sim_mutex_unlock(m) pthread_mutex_unlock(m)
+#define sim_mutex_destroy(m) pthread_mutex_destroy(m)
+typedef pthread_cond_t sim_cond_t;
+#define sim_cond_init(c) pthread_cond_init((c), NULL)
+#define sim_cond_wait(c, m) pthread_cond_wait((c), (m))
+#define sim_cond_broadcast(c) pthread_cond_broadcast(c)
+#define sim_cond_destroy(c) pthread_cond_destroy(c)
+#endif
+
+typedef struct {
+    uint64_t count;
+    double mean;
+    double m2;       // Sum of squared deviations from the mean
+    int64_t min;
+    int64_t max;
+} sim_chunk_stats_t;
+
+typedef struct {
+    dice_context_t *parent;
+    const dice_program_t *program;
+    size_t samples;
+    size_t chunk_count;
+    const uint64_t (*chunk_states)[4];
+    int64_t *out;
+    sim_chunk_stats_t *stats;   // Per-chunk moments (dice_simulate summaries)
+    dice_stats_t *run;          // Accumulator fed in chunk order (dice_simulate_stats)
+    
+    sim_mutex_t lock;
+    sim_cond_t merged;          // Signalled whenever next_merge or error_chunk changes
+    size_t next_merge;          // Next chunk to merge into run
+    size_t next_chunk;
+    size_t chunk_limit;     // No chunk at or past this index is handed out
+    size_t error_chunk;     // Lowest failing chunk (chunk_count if none)
+    char error_message[sizeof(((dice_error_buffer_t*)0)->message)];
+} sim_shared_t;
+
+// Worker contexts borrow the parent's custom dice registry read-only
+static dice_context_t* sim_worker_create(const dice_context_t *parent) {
+    dice_context_t *worker = dice_context_create(parent->arena_size,
+                                                 parent->features & ~DICE_FEATURE_FATE);
+    if (!worker) return NULL;
+    
+    worker->policy = parent->policy;
+    worker->arena_chunk_size = parent->arena_chunk_size;
+    worker->trace_level = DICE_TRACE_OFF;
+    worker->custom_dice = parent->custom_dice;
+    
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(1);
+    if (!rng.state || dice_context_set_rng(worker, &rng) != 0) {
+        memset(&worker->custom_dice, 0, sizeof(worker->custom_dice));
+        dice_context_destroy(worker);
+        return NULL;
+    }
+    return worker;
+}
+
+static void sim_worker_destroy(dice_context_t *worker) {
+    memset(&worker->custom_dice, 0, sizeof(worker->custom_dice));
+    dice_context_destroy(worker);
+}
+
+static void sim_record_error(sim_shared_t *shared, size_t chunk, const char *message) {
+    sim_mutex_lock(&shared->lock);
+    if (chunk < shared->error_chunk) {
+        shared->error_chunk = chunk;
+        snprintf(shared->error_message, sizeof(shared->error_message), "%s", message);
+    }
+    // Chunks below this one were already handed out and still run, so the
+    // lowest failing chunk is found regardless of scheduling
+    if (chunk + 1 < shared->chunk_limit) shared->chunk_limit = chunk + 1;
+    // Chunks past the failure must stop waiting for their merge turn
+    sim_cond_broadcast(&shared->merged);
+    sim_mutex_unlock(&shared->lock);
+}
+
+// Fold a chunk's accumulator into the run once every earlier chunk has been
+static void sim_merge_in_order(sim_shared_t *shared, size_t chunk, const dice_stats_t *local) {
+    sim_mutex_lock(&shared->lock);
+    while (shared->next_merge != chunk && chunk < shared->error_chunk) {
+        sim_cond_wait(&shared->merged, &shared->lock);
+    }
+    if (chunk < shared->error_chunk) {
+        dice_stats_merge(shared->run, local);
+        shared->next_merge++;
+        sim_cond_broadcast(&shared->merged);
+    }
+    sim_mutex_unlock(&shared->lock);
+}
+
+static bool sim_run_chunk(sim_shared_t *shared, dice_context_t *worker, size_t chunk,
+                          dice_stats_t *local) {
+    size_t begin = chunk * SIMULATE_CHUNK_SAMPLES;
+    size_t end = begin + SIMULATE_CHUNK_SAMPLES;
+    if (end > shared->samples) end = shared->samples;
+    
+    rng_xoshiro_set_state(&worker->rng, shared->chunk_states[chunk]);
+    
+    sim_chunk_stats_t st = {0, 0.0, 0.0, INT64_MAX, INT64_MIN};
+    if (local) dice_stats_reset(local);
+    size_t mark = dice_arena_mark(worker);
+    for (size_t i = begin; i < end; i++) {
+        dice_eval_result_t result = dice_program_evaluate(worker, shared->program);
+        dice_arena_rewind(worker, mark);
+        if (!result.success) {
+            sim_record_error(shared, chunk, worker->error.has_error ?
+                             worker->error.message : "Simulation sample failed");
+            dice_clear_error(worker);
+            return false;
+        }
+        
+        if (shared->out) shared->out[i] = result.value;
+        if (local) {
+            dice_stats_add(local, result.value);
+            continue;
+        }
+        
+        // Welford update
+        double x = (double)result.value;
+        double delta = x - st.mean;
+        st.count++;
+        st.mean += delta / (double)st.count;
+        st.m2 += delta * (x - st.mean);
+        if (result.value < st.min) st.min = result.value;
+        if (result.value > st.max) st.max = result.value;
+    }
+    
+    if (local) {
+        sim_merge_in_order(shared, chunk, local);
+    } else {
+        shared->stats[chunk] = st;
+    }
+    return true;
+}
+
+static void sim_worker_loop(sim_shared_t *shared) {
+    dice_context_t *worker = sim_worker_create(shared->parent);
+    
+    // Chunk accumulator laid out like the run's, with its own histogram
+    dice_stats_t local;
+    dice_stats_t *local_stats = NULL;
+    if (shared->run) {
+        local = *shared->run;
+        local.buckets = NULL;
+        if (shared->run->buckets) local.buckets = malloc(local.bucket_count * sizeof(uint64_t));
+        if (local.buckets || !shared->run->buckets) local_stats = &local;
+        if (!local_stats && worker) {
+            sim_worker_destroy(worker);
+            worker = NULL;
+        }
+    }
+    
+    for (;;) {
+        sim_mutex_lock(&shared->lock);
+        size_t chunk = shared->next_chunk;
+        bool have_chunk = chunk < shared->chunk_limit;
+        if (have_chunk) shared->next_chunk++;
+        sim_mutex_unlock(&shared->lock);
+        if (!have_chunk) break;
+        
+        if (!worker) {
+            sim_record_error(shared, chunk, "Failed to create simulation worker context");
+            break;
+        }
+        sim_run_chunk(shared, worker, chunk, local_stats);
+    }
+    
+    if (local_stats) free(local_stats->buckets);
+    if (worker) sim_worker_destroy(worker);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI sim_thread_main(LPVOID arg) {
+    sim_worker_loop((sim_shared_t*)arg);
+    return 0;
+}
+
+static bool sim_thread_start(sim_thread_t *thread, sim_shared_t *shared) {
+    *thread = CreateThread(NULL, 0, sim_thread_main, shared, 0, NULL);
+    return *thread != NULL;
+}
+
+static void sim_thread_join(sim_thread_t thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+#else
+static void* sim_thread_main(void *arg) {
+    sim_worker_loop((sim_shared_t*)arg);
+    return NULL;
+}
+
+static bool sim_thread_start(sim_thread_t *thread, sim_shared_t *shared) {
+    return pthread_create(thread, NULL, sim_thread_main, shared) == 0;
+}
+
+static void sim_thread_join(sim_thread_t thread) {
+    pthread_join(thread, NULL);
+}
+#endif
+
+// Chan et al. pairwise combination, applied in chunk order
+static void sim_merge_stats(sim_chunk_stats_t *acc, const sim_chunk_stats_t *chunk) {
+    if (chunk->count == 0) return;
+    if (acc->count == 0) {
+        *acc = *chunk;
+        return;
+    }
+    
+    double n_a = (double)acc->count;
+    double n_b = (double)chunk->count;
+    double n = n_a + n_b;
+    double delta = chunk->mean - acc->mean;
+    
+    acc->mean += delta * n_b / n;
+    acc->m2 += chunk->m2 + delta * delta * n_a * n_b / n;
+    acc->count += chunk->count;
+    if (chunk->min < acc->min) acc->min = chunk->min;
+    if (chunk->max > acc->max) acc->max = chunk->max;
+}
+
+// Shared body of dice_simulate (run == NULL) and dice_simulate_stats
+static int sim_execute(dice_context_t *ctx, const dice_program_t *program, size_t samples,
+                       unsigned threads, uint64_t seed, int64_t *out,
+                       dice_simulation_summary_t *summary, dice_stats_t *run) {
+    size_t chunk_count = (samples + SIMULATE_CHUNK_SAMPLES - 1) / SIMULATE_CHUNK_SAMPLES;
+    uint64_t (*chunk_states)[4] = malloc(chunk_count * sizeof(*chunk_states));
+    sim_chunk_stats_t *stats = run ? NULL : calloc(chunk_count, sizeof(sim_chunk_stats_t));
+    if (!chunk_states || (!run && !stats)) {
+        free(chunk_states);
+        free(stats);
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "Failed to allocate memory for simulation");
+        ctx->error.has_error = true;
+        return -1;
+    }
+    
+    // One non-overlapping 2^128 segment of the seed's stream per chunk
+    rng_xoshiro_seed_state(seed, chunk_states[0]);
+    for (size_t c = 1; c < chunk_count; c++) {
+        memcpy(chunk_states[c], chunk_states[c - 1], sizeof(chunk_states[c]));
+        rng_xoshiro_jump_state(chunk_states[c]);
+    }
+    
+    sim_shared_t shared;
+    memset(&shared, 0, sizeof(shared));
+    shared.parent = ctx;
+    shared.program = program;
+    shared.samples = samples;
+    shared.chunk_count = chunk_count;
+    shared.chunk_states = (const uint64_t (*)[4])chunk_states;
+    shared.out = out;
+    shared.stats = stats;
+    shared.run = run;
+    shared.chunk_limit = chunk_count;
+    shared.error_chunk = chunk_count;
+    sim_mutex_init(&shared.lock);
+    sim_cond_init(&shared.merged);
+    
+    if (threads == 0) threads = 1;
+    if (threads > chunk_count) threads = (unsigned)chunk_count;
+    
+    // The calling thread is worker 0; if a thread fails to start, the
+    // remaining workers simply take its share
+    sim_thread_t *handles = threads > 1 ? malloc((threads - 1) * sizeof(sim_thread_t)) : NULL;
+    unsigned started = 0;
+    if (handles) {
+        while (started < threads - 1 && sim_thread_start(&handles[started], &shared)) {
+            started++;
+        }
+    }
+    sim_worker_loop(&shared);
+    for (unsigned t = 0; t < started; t++) {
+        sim_thread_join(handles[t]);
+    }
+    free(handles);
+    sim_cond_destroy(&shared.merged);
+    sim_mutex_destroy(&shared.lock);
+    
+    int status = 0;
+    if (shared.error_chunk < chunk_count) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message), "%s", shared.error_message);
+        ctx->error.has_error = true;
+        status = -1;
+    } else if (summary) {
+        sim_chunk_stats_t total = {0, 0.0, 0.0, 0, 0};
+        for (size_t c = 0; c < chunk_count; c++) {
+            sim_merge_stats(&total, &stats[c]);
+        }
+        summary->samples = total.count;
+        summary->mean = total.mean;
+        summary->variance = total.m2 / (double)total.count;
+        summary->min = total.min;
+        summary->max = total.max;
+    }
+    
+    free(chunk_states);
+    free(stats);
+    return status;
+}
+
+int dice_simulate(dice_context_t *ctx, const dice_program_t *program, size_t samples,
+                  unsigned threads, uint64_t seed, int64_t *out,
+                  dice_simulation_summary_t *summary) {
+    if (!ctx) return -1;
+    if (!program) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "No program to simulate");
+        ctx->error.has_error = true;
+        return -1;
+    }
+    if (summary) memset(summary, 0, sizeof(*summary));
+    if (samples == 0) return 0;
+    
+    return sim_execute(ctx, program, samples, threads, seed, out, summary, NULL);
+}
+
+int dice_simulate_stats(dice_context_t *ctx, const dice_program_t *program, size_t samples,
+                        unsigned threads, uint64_t seed, dice_stats_t *stats) {
+    if (!ctx) return -1;
+    if (!program || !stats) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message),
+                "No program or accumulator to simulate");
+        ctx->error.has_error = true;
+        return -1;
+    }
+    if (samples == 0) return 0;
+    
+    // Accumulate the run separately so a failing run leaves stats untouched
+    dice_stats_t run = *stats;
+    run.buckets = NULL;
+    if (stats->buckets) {
+        run.buckets = malloc(stats->bucket_count * sizeof(uint64_t));
+        if (!run.buckets) {
+            snprintf(ctx->error.message, sizeof(ctx->error.message),
+                    "Failed to allocate memory for simulation");
+            ctx->error.has_error = true;
+            return -1;
+        }
+    }
+    dice_stats_reset(&run);
+    
+    int status = sim_execute(ctx, program, samples, threads, seed, NULL, NULL, &run);
+    if (status == 0) dice_stats_merge(stats, &run);
+    
+    free(run.buckets);
+    return status;
+}
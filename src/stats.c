@@ -0,0 +1,309 @@
+#include "dice.h"
+#include "internal.h"
+#include <math.h>
+#include <string.h>
+
+// =============================================================================
+// Streaming Statistics
+// =============================================================================
+
+// Moments use Welford's update and Chan et al.'s pairwise merge. Quantiles use
+// the P-square algorithm (Jain & Chlamtac, 1985): five markers per quantile
+// whose heights are nudged by piecewise-parabolic interpolation as samples
+// arrive, so no sample is ever stored.
+
+// Desired marker position increments per sample, as fractions of (count - 1)
+static void quantile_fractions(double p, double fractions[5]) {
+    fractions[0] = 0.0;
+    fractions[1] = p / 2.0;
+    fractions[2] = p;
+    fractions[3] = (1.0 + p) / 2.0;
+    fractions[4] = 1.0;
+}
+
+static void quantile_init(dice_stats_quantile_t *q, double p) {
+    memset(q, 0, sizeof(*q));
+    q->p = p;
+}
+
+// Sort the first five samples and place the markers on them
+static void quantile_start(dice_stats_quantile_t *q) {
+    for (int i = 1; i < 5; i++) {
+        double h = q->height[i];
+        int j = i;
+        for (; j > 0 && q->height[j - 1] > h; j--) q->height[j] = q->height[j - 1];
+        q->height[j] = h;
+    }
+    
+    double fractions[5];
+    quantile_fractions(q->p, fractions);
+    for (int i = 0; i < 5; i++) {
+        q->position[i] = (double)(i + 1);
+        q->desired[i] = 1.0 + 4.0 * fractions[i];
+    }
+}
+
+static double quantile_parabolic(const dice_stats_quantile_t *q, int i, double d) {
+    const double *h = q->height;
+    const double *n = q->position;
+    return h[i] + d / (n[i + 1] - n[i - 1]) *
+           ((n[i] - n[i - 1] + d) * (h[i + 1] - h[i]) / (n[i + 1] - n[i]) +
+            (n[i + 1] - n[i] - d) * (h[i] - h[i - 1]) / (n[i] - n[i - 1]));
+}
+
+// count is the number of samples seen before x
+static void quantile_add(dice_stats_quantile_t *q, uint64_t count, double x) {
+    if (count < 5) {
+        q->height[count] = x;
+        if (count == 4) quantile_start(q);
+        return;
+    }
+    
+    double *h = q->height;
+    double *n = q->position;
+    
+    // Find the cell holding x, stretching the extremes if needed
+    int k;
+    if (x < h[0]) {
+        h[0] = x;
+        k = 0;
+    } else if (x >= h[4]) {
+        h[4] = x;
+        k = 3;
+    } else {
+        for (k = 0; k < 3 && x >= h[k + 1]; k++) {}
+    }
+    
+    for (int i = k + 1; i < 5; i++) n[i] += 1.0;
+    double fractions[5];
+    quantile_fractions(q->p, fractions);
+    for (int i = 0; i < 5; i++) q->desired[i] += fractions[i];
+    
+    // Move interior markers that drifted a whole position from where they belong
+    for (int i = 1; i < 4; i++) {
+        double drift = q->desired[i] - n[i];
+        if ((drift >= 1.0 && n[i + 1] - n[i] > 1.0) || (drift <= -1.0 && n[i - 1] - n[i] < -1.0)) {
+            double d = drift > 0 ? 1.0 : -1.0;
+            double candidate = quantile_parabolic(q, i, d);
+            if (h[i - 1] < candidate && candidate < h[i + 1]) {
+                h[i] = candidate;
+            } else {
+                int j = i + (int)d;
+                h[i] += d * (h[j] - h[i]) / (n[j] - n[i]);
+            }
+            n[i] += d;
+        }
+    }
+}
+
+// Approximate merge of two estimators that have both passed five samples
+static void quantile_merge_markers(dice_stats_quantile_t *into, uint64_t into_count,
+                                   const dice_stats_quantile_t *from, uint64_t from_count) {
+    double w_into = (double)into_count;
+    double w_from = (double)from_count;
+    double total = w_into + w_from;
+    
+    for (int i = 1; i < 4; i++) {
+        into->height[i] = (into->height[i] * w_into + from->height[i] * w_from) / total;
+        into->position[i] += from->position[i];
+    }
+    if (from->height[0] < into->height[0]) into->height[0] = from->height[0];
+    if (from->height[4] > into->height[4]) into->height[4] = from->height[4];
+    
+    double fractions[5];
+    quantile_fractions(into->p, fractions);
+    into->position[0] = 1.0;
+    into->position[4] = total;
+    for (int i = 0; i < 5; i++) {
+        into->desired[i] = 1.0 + (total - 1.0) * fractions[i];
+    }
+}
+
+static bool stats_accepts_config(const dice_stats_t *stats) {
+    return stats && stats->count == 0;
+}
+
+void dice_stats_init(dice_stats_t *stats) {
+    if (!stats) return;
+    
+    memset(stats, 0, sizeof(*stats));
+    stats->min = INT64_MAX;
+    stats->max = INT64_MIN;
+}
+
+int dice_stats_set_histogram(dice_stats_t *stats, int64_t min, int64_t bucket_width,
+                             uint64_t *buckets, size_t bucket_count) {
+    if (!stats_accepts_config(stats) || bucket_width <= 0 || !buckets || bucket_count == 0) {
+        return -1;
+    }
+    
+    memset(buckets, 0, bucket_count * sizeof(uint64_t));
+    stats->buckets = buckets;
+    stats->bucket_count = bucket_count;
+    stats->histogram_min = min;
+    stats->bucket_width = bucket_width;
+    return 0;
+}
+
+int dice_stats_add_quantile(dice_stats_t *stats, double p) {
+    if (!stats_accepts_config(stats) || !(p > 0.0 && p < 1.0) ||
+        stats->quantile_count >= DICE_STATS_MAX_QUANTILES) {
+        return -1;
+    }
+    
+    quantile_init(&stats->quantiles[stats->quantile_count++], p);
+    return 0;
+}
+
+void dice_stats_reset(dice_stats_t *stats) {
+    if (!stats) return;
+    
+    stats->count = 0;
+    stats->mean = 0.0;
+    stats->m2 = 0.0;
+    stats->min = INT64_MAX;
+    stats->max = INT64_MIN;
+    stats->underflow = 0;
+    stats->overflow = 0;
+    if (stats->buckets) memset(stats->buckets, 0, stats->bucket_count * sizeof(uint64_t));
+    for (size_t i = 0; i < stats->quantile_count; i++) {
+        quantile_init(&stats->quantiles[i], stats->quantiles[i].p);
+    }
+}
+
+void dice_stats_add(dice_stats_t *stats, int64_t value) {
+    double x = (double)value;
+    
+    for (size_t i = 0; i < stats->quantile_count; i++) {
+        quantile_add(&stats->quantiles[i], stats->count, x);
+    }
+    
+    if (stats->buckets) {
+        if (value < stats->histogram_min) {
+            stats->underflow++;
+        } else {
+            // Unsigned difference: exact even when the span exceeds INT64_MAX
+            uint64_t bucket = ((uint64_t)value - (uint64_t)stats->histogram_min) /
+                              (uint64_t)stats->bucket_width;
+            if (bucket < stats->bucket_count) {
+                stats->buckets[bucket]++;
+            } else {
+                stats->overflow++;
+            }
+        }
+    }
+    
+    // Welford update
+    double delta = x - stats->mean;
+    stats->count++;
+    stats->mean += delta / (double)stats->count;
+    stats->m2 += delta * (x - stats->mean);
+    if (value < stats->min) stats->min = value;
+    if (value > stats->max) stats->max = value;
+}
+
+void dice_stats_add_n(dice_stats_t *stats, const int64_t *values, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dice_stats_add(stats, values[i]);
+    }
+}
+
+int dice_stats_merge(dice_stats_t *into, const dice_stats_t *from) {
+    if (!into || !from) return -1;
+    
+    if ((into->buckets != NULL) != (from->buckets != NULL) ||
+        into->bucket_count != from->bucket_count ||
+        into->histogram_min != from->histogram_min ||
+        into->bucket_width != from->bucket_width ||
+        into->quantile_count != from->quantile_count) {
+        return -1;
+    }
+    for (size_t i = 0; i < into->quantile_count; i++) {
+        if (into->quantiles[i].p != from->quantiles[i].p) return -1;
+    }
+    if (from->count == 0) return 0;
+    
+    // Quantiles first, while into->count still describes into's estimators
+    for (size_t i = 0; i < into->quantile_count; i++) {
+        dice_stats_quantile_t *q = &into->quantiles[i];
+        const dice_stats_quantile_t *other = &from->quantiles[i];
+        
+        if (from->count < 5) {
+            // Raw samples: replay them exactly
+            for (uint64_t j = 0; j < from->count; j++) {
+                quantile_add(q, into->count + j, other->height[j]);
+            }
+        } else if (into->count < 5) {
+            dice_stats_quantile_t raw = *q;
+            *q = *other;
+            for (uint64_t j = 0; j < into->count; j++) {
+                quantile_add(q, from->count + j, raw.height[j]);
+            }
+        } else {
+            quantile_merge_markers(q, into->count, other, from->count);
+        }
+    }
+    
+    if (into->buckets) {
+        for (size_t i = 0; i < into->bucket_count; i++) {
+            into->buckets[i] += from->buckets[i];
+        }
+        into->underflow += from->underflow;
+        into->overflow += from->overflow;
+    }
+    
+    // Chan et al. pairwise combination
+    if (into->count == 0) {
+        into->mean = from->mean;
+        into->m2 = from->m2;
+    } else {
+        double n_a = (double)into->count;
+        double n_b = (double)from->count;
+        double n = n_a + n_b;
+        double delta = from->mean - into->mean;
+        into->mean += delta * n_b / n;
+        into->m2 += from->m2 + delta * delta * n_a * n_b / n;
+    }
+    into->count += from->count;
+    if (from->min < into->min) into->min = from->min;
+    if (from->max > into->max) into->max = from->max;
+    return 0;
+}
+
+double dice_stats_variance(const dice_stats_t *stats) {
+    if (!stats || stats->count == 0) return 0.0;
+    return stats->m2 / (double)stats->count;
+}
+
+double dice_stats_stddev(const dice_stats_t *stats) {
+    return sqrt(dice_stats_variance(stats));
+}
+
+int dice_stats_quantile(const dice_stats_t *stats, double p, double *out) {
+    if (!stats || !out || stats->count == 0) return -1;
+    
+    for (size_t i = 0; i < stats->quantile_count; i++) {
+        const dice_stats_quantile_t *q = &stats->quantiles[i];
+        if (q->p != p) continue;
+        
+        if (stats->count >= 5) {
+            *out = q->height[2];
+            return 0;
+        }
+        
+        // Nearest rank over the raw samples
+        double sorted[5];
+        size_t n = (size_t)stats->count;
+        memcpy(sorted, q->height, n * sizeof(double));
+        for (size_t a = 1; a < n; a++) {
+            double h = sorted[a];
+            size_t b = a;
+            for (; b > 0 && sorted[b - 1] > h; b--) sorted[b] = sorted[b - 1];
+            sorted[b] = h;
+        }
+        size_t rank = (size_t)ceil(p * (double)n);
+        *out = sorted[rank > 0 ? rank - 1 : 0];
+        return 0;
+    }
+    return -1;
+}
@@ -0,0 +1,122 @@
+#include "dice.h"
+#include "internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// =============================================================================
+// Context Templates (frozen configuration shared by cheap clones)
+// =============================================================================
+
+// Everything but the two counters is written once in
+// dice_context_template_create and only read afterwards, so clones on any
+// thread share it without locks; the counters are updated atomically
+struct dice_context_template {
+    uint64_t refs;              // Template handle plus one per live clone
+    uint64_t clones;            // Clones made so far; numbers their RNG streams
+    uint64_t seed;
+    dice_context_t frozen;      // Custom dice, policy, features, trace level, arena settings
+};
+
+static uint64_t template_atomic_add(uint64_t *value, int64_t delta) {
+#if defined(__GNUC__)
+    return __atomic_add_fetch(value, (uint64_t)delta, __ATOMIC_ACQ_REL);
+#elif defined(_MSC_VER)
+    return (uint64_t)_InterlockedExchangeAdd64((volatile __int64*)value, delta) + (uint64_t)delta;
+#else
+    return *value += (uint64_t)delta;
+#endif
+}
+
+const dice_custom_die_registry_t* template_registry(const dice_context_template_t *tmpl) {
+    return &tmpl->frozen.custom_dice;
+}
+
+dice_context_template_t* dice_context_template_create(const dice_context_t *source, uint64_t seed) {
+    if (!source) return NULL;
+    
+    dice_context_template_t *tmpl = calloc(1, sizeof(dice_context_template_t));
+    if (!tmpl) return NULL;
+    
+    tmpl->refs = 1;
+    tmpl->seed = seed ? seed : ((uint64_t)time(NULL) ^ (uint64_t)(uintptr_t)tmpl);
+    
+    dice_context_t *frozen = &tmpl->frozen;
+    frozen->arena_size = source->arena_size;
+    frozen->arena_chunk_size = source->arena_chunk_size;
+    frozen->features = source->features;
+    frozen->policy = source->policy;
+    frozen->trace_level = source->trace_level;
+    
+    // A private copy, in registration order, so later changes to source
+    // never reach the clones
+    const dice_custom_die_registry_t *registry = &source->custom_dice;
+    for (size_t i = 0; i < registry->count; i++) {
+        const dice_custom_die_t *die = &registry->dice[i];
+        if (dice_register_custom_die(frozen, die->name, die->sides, die->side_count) != 0) {
+            registry_release(frozen);
+            free(tmpl);
+            return NULL;
+        }
+    }
+    
+    return tmpl;
+}
+
+dice_context_template_t* dice_context_template_retain(dice_context_template_t *tmpl) {
+    if (tmpl) template_atomic_add(&tmpl->refs, 1);
+    return tmpl;
+}
+
+void dice_context_template_release(dice_context_template_t *tmpl) {
+    if (!tmpl || template_atomic_add(&tmpl->refs, -1) != 0) return;
+    
+    registry_release(&tmpl->frozen);
+    free(tmpl);
+}
+
+int dice_context_clone_into(dice_context_template_t *tmpl, dice_context_t *ctx,
+                            void *arena, size_t arena_size) {
+    if (!tmpl || !ctx || (!arena && arena_size > 0)) return -1;
+    
+    const dice_context_t *frozen = &tmpl->frozen;
+    memset(ctx, 0, sizeof(dice_context_t));
+    
+    ctx->arena = arena;
+    ctx->arena_size = arena_size;
+    ctx->arena_chunk_size = frozen->arena_chunk_size;
+    ctx->external_arena = true;
+    ctx->external_context = true;
+    
+    ctx->features = frozen->features;
+    ctx->policy = frozen->policy;
+    ctx->trace_level = frozen->trace_level;
+    
+    // Read in place until the clone changes its dice; sharing the generation
+    // keeps bindings made in one clone valid in every other
+    ctx->custom_dice = frozen->custom_dice;
+    ctx->registry_shared = true;
+    
+    // Clone n gets its own stream from the template seed
+    uint64_t n = template_atomic_add(&tmpl->clones, 1);
+    uint64_t seed = tmpl->seed + n * 0x9e3779b97f4a7c15ULL;
+    ctx->rng = rng_xoshiro_inline(ctx->rng_inline, seed ? seed : 1);
+    
+    ctx->origin = dice_context_template_retain(tmpl);
+    return 0;
+}
+
+// Arena starts after the context, at 16-byte alignment
+#define CLONE_ARENA_OFFSET ((sizeof(dice_context_t) + 15) & ~(size_t)15)
+
+dice_context_t* dice_context_clone(dice_context_template_t *tmpl) {
+    if (!tmpl) return NULL;
+    
+    size_t arena_size = tmpl->frozen.arena_size;
+    dice_context_t *ctx = malloc(CLONE_ARENA_OFFSET + arena_size);
+    if (!ctx) return NULL;
+    
+    dice_context_clone_into(tmpl, ctx, (char*)ctx + CLONE_ARENA_OFFSET, arena_size);
+    ctx->external_context = false;
+    return ctx;
+}
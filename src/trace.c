@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <limits.h>
 
 // =============================================================================
 // Tracing Implementation
@@ -22,13 +23,97 @@ static void add_trace_entry(dice_context_t *ctx, dice_trace_entry_t *entry) {
     }
     
     ctx->trace.count++;
+    DICE_COUNT(ctx, trace_entries, 1);
 }
 
 void trace_atomic_roll(dice_context_t *ctx, int sides, int result) {
     trace_atomic_roll_selected(ctx, sides, result, false);
 }
 
+// =============================================================================
+// Packed Trace Encoding
+// =============================================================================
+
+#define TRACE_PACKED_INITIAL 256
+#define TRACE_BATCH_DEFAULT 4096
+#define TRACE_RECORD_MAX 20     // Two 64-bit varints
+
+static uint64_t zigzag_encode(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t zigzag_decode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static size_t varint_put(uint8_t *out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static bool varint_get(const uint8_t *data, size_t length, size_t *offset, uint64_t *value) {
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64 && *offset < length; shift += 7) {
+        uint8_t byte = data[(*offset)++];
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int trace_sink_flush(dice_context_t *ctx) {
+    if (!ctx->trace_sink || ctx->trace_packed_length == 0) return 0;
+    
+    if (ctx->trace_sink(ctx->trace_sink_data, ctx->trace_packed, ctx->trace_packed_length) != 0) {
+        return -1;
+    }
+    ctx->trace_packed_length = 0;
+    return 0;
+}
+
+static void trace_pack_roll(dice_context_t *ctx, int sides, int result, bool selected) {
+    if (ctx->trace_packed_capacity - ctx->trace_packed_length < TRACE_RECORD_MAX) {
+        size_t capacity = ctx->trace_packed_capacity ? ctx->trace_packed_capacity * 2 : TRACE_PACKED_INITIAL;
+        uint8_t *grown = realloc(ctx->trace_packed, capacity);
+        if (!grown) {
+            snprintf(ctx->error.message, sizeof(ctx->error.message),
+                    "Out of memory recording trace");
+            ctx->error.has_error = true;
+            return;
+        }
+        ctx->trace_packed = grown;
+        ctx->trace_packed_capacity = capacity;
+    }
+    
+    uint8_t *out = ctx->trace_packed + ctx->trace_packed_length;
+    size_t n = varint_put(out, zigzag_encode(sides) << 1 | (selected ? 1 : 0));
+    n += varint_put(out + n, zigzag_encode(result));
+    ctx->trace_packed_length += n;
+    
+    ctx->trace.count++;
+    DICE_COUNT(ctx, trace_entries, 1);
+    
+    if (ctx->trace_packed_length >= ctx->trace_batch_bytes && trace_sink_flush(ctx) != 0 &&
+        !ctx->error.has_error) {
+        snprintf(ctx->error.message, sizeof(ctx->error.message), "Trace sink failed");
+        ctx->error.has_error = true;
+    }
+}
+
 void trace_atomic_roll_selected(dice_context_t *ctx, int sides, int result, bool selected) {
+    if (ctx->trace_packing) {
+        trace_pack_roll(ctx, sides, result, selected);
+        return;
+    }
+    
     dice_trace_entry_t *entry = arena_alloc(ctx, sizeof(dice_trace_entry_t));
     if (!entry) return;
     
@@ -40,6 +125,24 @@ void trace_atomic_roll_selected(dice_context_t *ctx, int sides, int result, bool
     add_trace_entry(ctx, entry);
 }
 
+void trace_summary_add(dice_context_t *ctx, uint64_t rolled, uint64_t rerolls, uint64_t dropped) {
+    // Counters see every roll, whatever the trace level
+    DICE_COUNT(ctx, dice_rolled, rolled);
+    DICE_COUNT(ctx, rerolls, rerolls);
+    if (ctx->trace_level == DICE_TRACE_OFF) return;
+    
+    ctx->trace.summary.dice_rolled += rolled;
+    ctx->trace.summary.rerolls += rerolls;
+    ctx->trace.summary.dropped += dropped;
+}
+
+int dice_context_set_trace_level(dice_context_t *ctx, dice_trace_level_t level) {
+    if (!ctx || level < DICE_TRACE_OFF || level > DICE_TRACE_FULL) return -1;
+    
+    ctx->trace_level = level;
+    return 0;
+}
+
 const dice_trace_t* dice_get_trace(const dice_context_t *ctx) {
     return ctx ? &ctx->trace : NULL;
 }
@@ -47,7 +150,112 @@ const dice_trace_t* dice_get_trace(const dice_context_t *ctx) {
 void dice_clear_trace(dice_context_t *ctx) {
     if (ctx) {
         memset(&ctx->trace, 0, sizeof(ctx->trace));
+        
+        // Bytes bound for a sink are delivered, or kept if it fails
+        if (trace_sink_flush(ctx) == 0 && !ctx->trace_sink) {
+            ctx->trace_packed_length = 0;
+        }
+    }
+}
+
+void trace_release(dice_context_t *ctx) {
+    trace_sink_flush(ctx);
+    free(ctx->trace_packed);
+    ctx->trace_packed = NULL;
+    ctx->trace_packed_length = 0;
+    ctx->trace_packed_capacity = 0;
+}
+
+int dice_context_set_trace_packed(dice_context_t *ctx, bool packed) {
+    if (!ctx) return -1;
+    
+    if (!packed && ctx->trace_packing) {
+        if (trace_sink_flush(ctx) != 0) return -1;
+        trace_release(ctx);
+        ctx->trace_sink = NULL;
+        ctx->trace_sink_data = NULL;
+    }
+    if (packed && !ctx->trace_packing) {
+        // Entries already listed in the arena are not mixed with packed ones
+        memset(&ctx->trace, 0, sizeof(ctx->trace));
     }
+    ctx->trace_packing = packed;
+    return 0;
+}
+
+int dice_context_set_trace_sink(dice_context_t *ctx, dice_trace_sink_fn sink,
+                                void *user_data, size_t batch_bytes) {
+    if (!ctx || dice_context_set_trace_packed(ctx, true) != 0) return -1;
+    if (trace_sink_flush(ctx) != 0) return -1;
+    
+    ctx->trace_sink = sink;
+    ctx->trace_sink_data = sink ? user_data : NULL;
+    ctx->trace_batch_bytes = batch_bytes ? batch_bytes : TRACE_BATCH_DEFAULT;
+    return 0;
+}
+
+int dice_trace_flush(dice_context_t *ctx) {
+    if (!ctx) return -1;
+    return trace_sink_flush(ctx);
+}
+
+const uint8_t* dice_trace_packed(const dice_context_t *ctx, size_t *length) {
+    size_t pending = ctx ? ctx->trace_packed_length : 0;
+    if (length) *length = pending;
+    return pending ? ctx->trace_packed : NULL;
+}
+
+int dice_trace_decode(const uint8_t *data, size_t length, size_t *offset, dice_trace_roll_t *roll) {
+    if (!offset || !roll || (!data && length > 0)) return -1;
+    if (*offset >= length) return 0;
+    
+    size_t pos = *offset;
+    uint64_t head, value;
+    if (!varint_get(data, length, &pos, &head) || !varint_get(data, length, &pos, &value)) {
+        return -1;
+    }
+    
+    int64_t sides = zigzag_decode(head >> 1);
+    int64_t result = zigzag_decode(value);
+    if (sides < INT_MIN || sides > INT_MAX || result < INT_MIN || result > INT_MAX) return -1;
+    
+    roll->sides = (int)sides;
+    roll->result = (int)result;
+    roll->selected = (head & 1) != 0;
+    *offset = pos;
+    return 1;
+}
+
+// =============================================================================
+// Trace Formatting
+// =============================================================================
+
+// Walks the traced dice in either representation
+typedef struct {
+    const dice_trace_entry_t *entry;
+    size_t offset;
+} trace_cursor_t;
+
+static bool trace_next_roll(const dice_context_t *ctx, trace_cursor_t *cursor, dice_trace_roll_t *roll) {
+    if (ctx->trace_packing) {
+        return dice_trace_decode(ctx->trace_packed, ctx->trace_packed_length, &cursor->offset, roll) == 1;
+    }
+    
+    while (cursor->entry) {
+        const dice_trace_entry_t *entry = cursor->entry;
+        cursor->entry = entry->next;
+        if (entry->type == TRACE_ATOMIC_ROLL) {
+            roll->sides = entry->data.atomic_roll.sides;
+            roll->result = entry->data.atomic_roll.result;
+            roll->selected = entry->data.atomic_roll.selected;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool trace_is_empty(const dice_context_t *ctx) {
+    return ctx->trace_packing ? ctx->trace_packed_length == 0 : ctx->trace.count == 0;
 }
 
 int dice_format_trace_string(const dice_context_t *ctx, char *buffer, size_t buffer_size) {
@@ -55,11 +263,8 @@ int dice_format_trace_string(const dice_context_t *ctx, char *buffer, size_t buf
         return -1;
     }
     
-    const dice_trace_t *trace = dice_get_trace(ctx);
-    if (!trace || trace->count == 0) {
-        if (buffer_size > 0) {
-            buffer[0] = '\0';
-        }
+    if (trace_is_empty(ctx)) {
+        buffer[0] = '\0';
         return 0;
     }
     
@@ -73,22 +278,17 @@ int dice_format_trace_string(const dice_context_t *ctx, char *buffer, size_t buf
     }
     pos += written;
     
-    // Iterate through trace entries
-    const dice_trace_entry_t *entry = trace->first;
-    while (entry && pos < buffer_size - 1) {
-        if (entry->type == TRACE_ATOMIC_ROLL) {
-            const char *marker = entry->data.atomic_roll.selected ? "*" : "";
-            written = snprintf(buffer + pos, buffer_size - pos, 
-                             "  d%d -> %d%s\n", 
-                             entry->data.atomic_roll.sides, 
-                             entry->data.atomic_roll.result,
-                             marker);
-            if (written < 0 || (size_t)written >= buffer_size - pos) {
-                return -1;
-            }
-            pos += written;
+    // Iterate through traced dice
+    trace_cursor_t cursor = {ctx->trace.first, 0};
+    dice_trace_roll_t roll;
+    while (pos < buffer_size - 1 && trace_next_roll(ctx, &cursor, &roll)) {
+        const char *marker = roll.selected ? "*" : "";
+        written = snprintf(buffer + pos, buffer_size - pos, 
+                         "  d%d -> %d%s\n", roll.sides, roll.result, marker);
+        if (written < 0 || (size_t)written >= buffer_size - pos) {
+            return -1;
         }
-        entry = entry->next;
+        pos += written;
     }
     
     return (int)pos;
@@ -99,25 +299,19 @@ int dice_format_trace_stream(const dice_context_t *ctx, FILE *stream) {
         return -1;
     }
     
-    const dice_trace_t *trace = dice_get_trace(ctx);
-    if (!trace || trace->count == 0) {
+    if (trace_is_empty(ctx)) {
         return 0;
     }
     
     fprintf(stream, "Individual dice results:\n");
     
-    // Iterate through trace entries
-    const dice_trace_entry_t *entry = trace->first;
-    while (entry) {
-        if (entry->type == TRACE_ATOMIC_ROLL) {
-            const char *marker = entry->data.atomic_roll.selected ? "*" : "";
-            fprintf(stream, "  d%d -> %d%s\n", 
-                   entry->data.atomic_roll.sides, 
-                   entry->data.atomic_roll.result,
-                   marker);
-        }
-        entry = entry->next;
+    // Iterate through traced dice
+    trace_cursor_t cursor = {ctx->trace.first, 0};
+    dice_trace_roll_t roll;
+    while (trace_next_roll(ctx, &cursor, &roll)) {
+        const char *marker = roll.selected ? "*" : "";
+        fprintf(stream, "  d%d -> %d%s\n", roll.sides, roll.result, marker);
     }
     
     return 0;
-}
\ No newline at end of file
+}
@@ -1,80 +1,145 @@
 #include "dice.h"
 #include "internal.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 // =============================================================================
 // AST Visitor Implementation
 // =============================================================================
 
-void dice_ast_traverse(const dice_ast_node_t *node, const dice_ast_visitor_t *visitor) {
-    if (!node || !visitor) {
-        return;
+// Frames live on the C stack up to this depth, then move to the heap
+#define WALK_LOCAL_FRAMES 64
+
+typedef struct {
+    const dice_ast_node_t *node;
+    size_t next;        // Next child slot to visit
+} walk_frame_t;
+
+// Child slot index of node; false once past the last slot (slots may be NULL)
+static bool ast_child(const dice_ast_node_t *node, size_t index, const dice_ast_node_t **child) {
+    switch (node->type) {
+        case DICE_NODE_BINARY_OP:
+            if (index > 1) return false;
+            *child = index == 0 ? node->data.binary_op.left : node->data.binary_op.right;
+            return true;
+        
+        case DICE_NODE_DICE_OP:
+            if (index > 2) return false;
+            *child = index == 0 ? node->data.dice_op.count :
+                     index == 1 ? node->data.dice_op.sides : node->data.dice_op.modifier;
+            return true;
+        
+        case DICE_NODE_FUNCTION_CALL:
+            if (index >= node->data.function_call.arg_count) return false;
+            *child = node->data.function_call.args[index];
+            return true;
+        
+        case DICE_NODE_ANNOTATION:
+            if (index > 0) return false;
+            *child = node->data.annotation.child;
+            return true;
+        
+        default:
+            return false;
     }
-    
-    // Call enter_node if provided
+}
+
+// Call enter_node, then the node's specific visitor
+static void walk_enter(const dice_ast_node_t *node, const dice_ast_visitor_t *visitor) {
     if (visitor->enter_node) {
         visitor->enter_node(node, visitor->user_data);
     }
     
-    // Call specific node visitor if provided
     switch (node->type) {
         case DICE_NODE_LITERAL:
-            if (visitor->visit_literal) {
-                visitor->visit_literal(node, visitor->user_data);
-            }
+            if (visitor->visit_literal) visitor->visit_literal(node, visitor->user_data);
             break;
-            
         case DICE_NODE_BINARY_OP:
-            if (visitor->visit_binary_op) {
-                visitor->visit_binary_op(node, visitor->user_data);
-            }
-            // Recursively visit children
-            dice_ast_traverse(node->data.binary_op.left, visitor);
-            dice_ast_traverse(node->data.binary_op.right, visitor);
+            if (visitor->visit_binary_op) visitor->visit_binary_op(node, visitor->user_data);
             break;
-            
         case DICE_NODE_DICE_OP:
-            if (visitor->visit_dice_op) {
-                visitor->visit_dice_op(node, visitor->user_data);
-            }
-            // Recursively visit children if they exist
-            if (node->data.dice_op.count) {
-                dice_ast_traverse(node->data.dice_op.count, visitor);
-            }
-            if (node->data.dice_op.sides) {
-                dice_ast_traverse(node->data.dice_op.sides, visitor);
-            }
-            if (node->data.dice_op.modifier) {
-                dice_ast_traverse(node->data.dice_op.modifier, visitor);
-            }
+            if (visitor->visit_dice_op) visitor->visit_dice_op(node, visitor->user_data);
             break;
-            
         case DICE_NODE_FUNCTION_CALL:
-            if (visitor->visit_function_call) {
-                visitor->visit_function_call(node, visitor->user_data);
-            }
-            // Recursively visit function arguments
-            for (size_t i = 0; i < node->data.function_call.arg_count; i++) {
-                dice_ast_traverse(node->data.function_call.args[i], visitor);
-            }
+            if (visitor->visit_function_call) visitor->visit_function_call(node, visitor->user_data);
             break;
-            
         case DICE_NODE_ANNOTATION:
-            if (visitor->visit_annotation) {
-                visitor->visit_annotation(node, visitor->user_data);
+            if (visitor->visit_annotation) visitor->visit_annotation(node, visitor->user_data);
+            break;
+    }
+}
+
+bool ast_walk(const dice_ast_node_t *node, const dice_ast_visitor_t *visitor) {
+    if (!node || !visitor) {
+        return true;
+    }
+    
+    walk_frame_t local_frames[WALK_LOCAL_FRAMES];
+    walk_frame_t *frames = local_frames;
+    size_t capacity = WALK_LOCAL_FRAMES;
+    size_t count = 0;
+    
+    walk_enter(node, visitor);
+    frames[count++] = (walk_frame_t){node, 0};
+    
+    while (count > 0) {
+        walk_frame_t *top = &frames[count - 1];
+        const dice_ast_node_t *child;
+        
+        if (!ast_child(top->node, top->next++, &child)) {
+            // All children done
+            if (visitor->exit_node) {
+                visitor->exit_node(top->node, visitor->user_data);
             }
-            // Recursively visit child if it exists
-            if (node->data.annotation.child) {
-                dice_ast_traverse(node->data.annotation.child, visitor);
+            count--;
+            continue;
+        }
+        if (!child) continue;
+        
+        if (count == capacity) {
+            walk_frame_t *grown = malloc(2 * capacity * sizeof(walk_frame_t));
+            if (!grown) {
+                if (frames != local_frames) free(frames);
+                return false;
             }
-            break;
+            memcpy(grown, frames, count * sizeof(walk_frame_t));
+            if (frames != local_frames) free(frames);
+            frames = grown;
+            capacity *= 2;
+        }
+        
+        walk_enter(child, visitor);
+        frames[count++] = (walk_frame_t){child, 0};
+    }
+    
+    if (frames != local_frames) free(frames);
+    return true;
+}
+
+void dice_ast_traverse(const dice_ast_node_t *node, const dice_ast_visitor_t *visitor) {
+    ast_walk(node, visitor);
+}
+
+bool ast_spine_init(ast_spine_t *spine, const dice_ast_node_t *node) {
+    size_t length = 0;
+    for (const dice_ast_node_t *n = node; n && n->type == DICE_NODE_BINARY_OP; n = n->data.binary_op.left) {
+        length++;
     }
     
-    // Call exit_node if provided
-    if (visitor->exit_node) {
-        visitor->exit_node(node, visitor->user_data);
+    spine->nodes = length <= AST_LOCAL_SPINE ? spine->local : malloc(length * sizeof(*spine->nodes));
+    spine->length = 0;
+    if (!spine->nodes) return false;
+    
+    for (const dice_ast_node_t *n = node; n && n->type == DICE_NODE_BINARY_OP; n = n->data.binary_op.left) {
+        spine->nodes[spine->length++] = n;
     }
+    return true;
+}
+
+void ast_spine_release(ast_spine_t *spine) {
+    if (spine->nodes != spine->local) free(spine->nodes);
+    spine->nodes = NULL;
 }
 
 // =============================================================================
@@ -186,6 +251,11 @@ static void trace_dice_op(const dice_ast_node_t *node, void *user_data) {
                 node->data.dice_op.selection->select_high ? "high" : "low");
     }
     
+    if (node->data.dice_op.compounding) {
+        print_indent(data->output, data->indent_str, data->depth);
+        fprintf(data->output, "compounding: true\n");
+    }
+    
     if (node->data.dice_op.count) {
         print_indent(data->output, data->indent_str, data->depth);
         fprintf(data->output, "count:\n");
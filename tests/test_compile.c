@@ -0,0 +1,290 @@
+#include "test_common.h"
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+static bool traces_equal(const dice_trace_t *a, const dice_trace_t *b) {
+    if (a->count != b->count) return false;
+    
+    const dice_trace_entry_t *ea = a->first;
+    const dice_trace_entry_t *eb = b->first;
+    while (ea && eb) {
+        if (ea->type != eb->type) return false;
+        if (ea->type == TRACE_ATOMIC_ROLL &&
+            (ea->data.atomic_roll.sides != eb->data.atomic_roll.sides ||
+             ea->data.atomic_roll.result != eb->data.atomic_roll.result ||
+             ea->data.atomic_roll.selected != eb->data.atomic_roll.selected)) {
+            return false;
+        }
+        ea = ea->next;
+        eb = eb->next;
+    }
+    return ea == NULL && eb == NULL;
+}
+
+// Evaluate an expression with the tree evaluator and the compiled program
+// from identical RNG states and compare results and traces
+static bool compiled_matches_tree(const char *expression, uint64_t seed, int rounds) {
+    dice_context_t *tree_ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_context_t *prog_ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_rng_vtable_t tree_rng = dice_create_xoshiro_rng(seed);
+    dice_rng_vtable_t prog_rng = dice_create_xoshiro_rng(seed);
+    dice_context_set_rng(tree_ctx, &tree_rng);
+    dice_context_set_rng(prog_ctx, &prog_rng);
+    
+    bool ok = true;
+    dice_ast_node_t *tree_ast = dice_parse(tree_ctx, expression);
+    dice_ast_node_t *prog_ast = dice_parse(prog_ctx, expression);
+    dice_program_t *program = prog_ast ? dice_compile(prog_ctx, prog_ast) : NULL;
+    if (!tree_ast || !program) ok = false;
+    
+    for (int i = 0; ok && i < rounds; i++) {
+        dice_clear_trace(tree_ctx);
+        dice_clear_trace(prog_ctx);
+        
+        dice_eval_result_t expected = dice_evaluate(tree_ctx, tree_ast);
+        dice_eval_result_t actual = dice_program_evaluate(prog_ctx, program);
+        
+        if (expected.success != actual.success || expected.value != actual.value ||
+            !traces_equal(dice_get_trace(tree_ctx), dice_get_trace(prog_ctx))) {
+            ok = false;
+        }
+    }
+    
+    dice_program_destroy(program);
+    dice_context_destroy(tree_ctx);
+    dice_context_destroy(prog_ctx);
+    return ok;
+}
+
+// =============================================================================
+// Compiled Program Tests
+// =============================================================================
+
+int test_compile_matches_tree_evaluator() {
+    const char *expressions[] = {
+        "42",
+        "2+3*4",
+        "(2+3)*4-7/2",
+        "3d6+2",
+        "d20",
+        "2d20-1d8*3",
+        "(1d6+2)*3",
+        "4d6k3",
+        "5d6l2",
+        "6d6s>3",
+        "8d10s<>1",
+        "3d6r<3",
+        "1d20r1+5",
+        "1d{-1,0,1}*4",
+        "4dF+1",
+        "2d{\"Earth\",\"Wind\",\"Fire\"}",
+        "100d6"
+    };
+    int n = sizeof(expressions) / sizeof(expressions[0]);
+    
+    for (int i = 0; i < n; i++) {
+        char message[128];
+        snprintf(message, sizeof(message), "Program matches tree evaluator for '%s'", expressions[i]);
+        TEST_ASSERT(compiled_matches_tree(expressions[i], 1000 + (uint64_t)i, 50), message);
+    }
+    
+    return 1;
+}
+
+int test_compile_dynamic_operands() {
+    // Hand-built AST with dice in the count and sides: (1d4)d(1d6+2)
+    dice_context_t *tree_ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_context_t *prog_ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_rng_vtable_t tree_rng = dice_create_xoshiro_rng(77);
+    dice_rng_vtable_t prog_rng = dice_create_xoshiro_rng(77);
+    dice_context_set_rng(tree_ctx, &tree_rng);
+    dice_context_set_rng(prog_ctx, &prog_rng);
+    
+    dice_ast_node_t node;
+    memset(&node, 0, sizeof(node));
+    node.type = DICE_NODE_DICE_OP;
+    node.data.dice_op.dice_type = DICE_DICE_BASIC;
+    node.data.dice_op.count = dice_parse(tree_ctx, "1d4");
+    node.data.dice_op.sides = dice_parse(tree_ctx, "1d6+2");
+    
+    dice_program_t *program = dice_compile(prog_ctx, &node);
+    TEST_ASSERT(program != NULL, "AST with dice in count and sides compiles");
+    
+    bool identical = true;
+    for (int i = 0; i < 100; i++) {
+        dice_eval_result_t expected = dice_evaluate(tree_ctx, &node);
+        dice_eval_result_t actual = dice_program_evaluate(prog_ctx, program);
+        if (!expected.success || !actual.success || expected.value != actual.value) {
+            identical = false;
+        }
+    }
+    TEST_ASSERT(identical, "Dynamic count/sides produce identical results");
+    
+    dice_program_destroy(program);
+    dice_context_destroy(tree_ctx);
+    dice_context_destroy(prog_ctx);
+    return 1;
+}
+
+int test_compile_errors() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    
+    // Policy limits reject constant operands at compile time
+    dice_policy_t policy = dice_default_policy();
+    policy.max_dice_count = 10;
+    policy.max_sides = 100;
+    dice_context_set_policy(ctx, &policy);
+    
+    dice_program_t *program = dice_compile(ctx, dice_parse(ctx, "11d6"));
+    TEST_ASSERT(program == NULL, "Dice count over policy limit is rejected at compile time");
+    TEST_ASSERT(dice_has_error(ctx), "Compile error is reported");
+    dice_clear_error(ctx);
+    
+    program = dice_compile(ctx, dice_parse(ctx, "1d1000"));
+    TEST_ASSERT(program == NULL, "Sides over policy limit are rejected at compile time");
+    dice_clear_error(ctx);
+    
+    program = dice_compile(ctx, dice_parse(ctx, "2dNOPE"));
+    TEST_ASSERT(program == NULL, "Unknown named die is rejected at compile time");
+    TEST_ASSERT(strstr(dice_get_error(ctx), "NOPE") != NULL, "Error names the unknown die");
+    dice_clear_error(ctx);
+    
+    TEST_ASSERT(dice_compile(ctx, NULL) == NULL, "NULL AST is rejected");
+    dice_clear_error(ctx);
+    
+    // A later, stricter policy also binds programs compiled before it
+    dice_program_t *wide = dice_compile(ctx, dice_parse(ctx, "8d100"));
+    TEST_ASSERT(wide != NULL, "Program within the policy compiles");
+    policy.max_dice_count = 4;
+    dice_context_set_policy(ctx, &policy);
+    TEST_ASSERT(!dice_program_evaluate(ctx, wide).success && dice_has_error(ctx),
+                "Constant dice count over a tightened limit is rejected at run time");
+    dice_clear_error(ctx);
+    policy.max_dice_count = 10;
+    policy.max_sides = 50;
+    dice_context_set_policy(ctx, &policy);
+    TEST_ASSERT(!dice_program_evaluate(ctx, wide).success && dice_has_error(ctx),
+                "Constant sides over a tightened limit are rejected at run time");
+    dice_clear_error(ctx);
+    policy.max_sides = 100;
+    dice_context_set_policy(ctx, &policy);
+    TEST_ASSERT(dice_program_evaluate(ctx, wide).success, "Program runs again under the original policy");
+    dice_program_destroy(wide);
+    
+    // Runtime errors still surface from the interpreter
+    program = dice_compile(ctx, dice_parse(ctx, "10/(1d1-1)"));
+    TEST_ASSERT(program != NULL, "Expression with runtime division by zero compiles");
+    dice_eval_result_t result = dice_program_evaluate(ctx, program);
+    TEST_ASSERT(!result.success, "Division by zero fails at run time");
+    TEST_ASSERT(dice_has_error(ctx), "Runtime error is reported");
+    dice_program_destroy(program);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_compile_outlives_arena() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    
+    dice_program_t *program = dice_compile(ctx, dice_parse(ctx, "3d{2,4,6}+1dF"));
+    TEST_ASSERT(program != NULL, "Custom dice expression compiles");
+    
+    // The program holds its own copy of inline dice; the arena can be recycled
+    ctx->arena_used = 0;
+    memset(ctx->arena, 0xAB, ctx->arena_size);
+    
+    bool in_range = true;
+    for (int i = 0; i < 200; i++) {
+        dice_clear_trace(ctx);
+        dice_eval_result_t result = dice_program_evaluate(ctx, program);
+        if (!result.success || result.value < 5 || result.value > 19) in_range = false;
+    }
+    TEST_ASSERT(in_range, "Program evaluates correctly after the arena is reused");
+    
+    dice_program_destroy(program);
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_compile_evaluate_batch() {
+    dice_context_t *a = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_context_t *b = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng_a = dice_create_xoshiro_rng(21);
+    dice_rng_vtable_t rng_b = dice_create_xoshiro_rng(21);
+    dice_context_set_rng(a, &rng_a);
+    dice_context_set_rng(b, &rng_b);
+    
+    dice_program_t *program = dice_compile(a, dice_parse(a, "4d6k3+1d{1,2,3}"));
+    TEST_ASSERT(program != NULL, "Expression compiles");
+    
+    int64_t batch[500];
+    size_t mark = dice_arena_mark(a);
+    TEST_ASSERT(dice_program_evaluate_batch(a, program, 500, batch) == 0, "Batch evaluation succeeds");
+    TEST_ASSERT(dice_arena_mark(a) == mark, "Batch does not grow the arena");
+    TEST_ASSERT(dice_get_trace(a)->count == 0, "Batch skips tracing");
+    
+    bool same = true;
+    size_t b_mark = dice_arena_mark(b);
+    for (int i = 0; i < 500; i++) {
+        dice_clear_trace(b);
+        dice_arena_rewind(b, b_mark);
+        dice_eval_result_t result = dice_program_evaluate(b, program);
+        if (!result.success || result.value != batch[i]) same = false;
+    }
+    TEST_ASSERT(same, "Batch matches successive single evaluations");
+    dice_program_destroy(program);
+    
+    program = dice_compile(a, dice_parse(a, "1d6/(1d2-1)"));
+    TEST_ASSERT(program != NULL, "Division expression compiles");
+    TEST_ASSERT(dice_program_evaluate_batch(a, program, 500, batch) == -1 && dice_has_error(a),
+                "A failing sample stops the batch");
+    dice_clear_error(a);
+    dice_program_destroy(program);
+    
+    TEST_ASSERT(dice_program_evaluate_batch(a, NULL, 1, batch) == -1, "NULL program rejected");
+    
+    dice_context_destroy(a);
+    dice_context_destroy(b);
+    return 1;
+}
+
+int test_compile_folding() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    const char *key = "k";
+    
+    // Folded constants leave the same program as the literal they fold to
+    const dice_program_t *programs[2];
+    programs[0] = dice_compile(ctx, dice_parse(ctx, "1+2*3+(4-1)"));
+    programs[1] = dice_compile(ctx, dice_parse(ctx, "10"));
+    TEST_ASSERT(programs[0] && programs[1], "Constant expressions compile");
+    TEST_ASSERT(dice_program_set_encoded_size(&programs[0], &key, 1) ==
+                dice_program_set_encoded_size(&programs[1], &key, 1), "Constants fold to one PUSH");
+    TEST_ASSERT(dice_program_evaluate(ctx, programs[0]).value == 10, "Folded value");
+    dice_program_destroy((dice_program_t*)programs[0]);
+    dice_program_destroy((dice_program_t*)programs[1]);
+    dice_context_destroy(ctx);
+    
+    // A long chain of dice terms is compiled in one pass and still matches
+    char *chain = malloc(500 * 6 + 1);
+    char *out = chain;
+    for (int i = 0; i < 500; i++) out += sprintf(out, i % 2 ? "+1d%d" : "+%dd6", i % 7 + 2);
+    TEST_ASSERT(compiled_matches_tree(chain + 1, 6, 3), "Long chain matches the tree evaluator");
+    free(chain);
+    return 1;
+}
+
+int main() {
+    printf("Running compiled program tests...\n\n");
+    
+    RUN_TEST(test_compile_matches_tree_evaluator);
+    RUN_TEST(test_compile_dynamic_operands);
+    RUN_TEST(test_compile_errors);
+    RUN_TEST(test_compile_outlives_arena);
+    RUN_TEST(test_compile_evaluate_batch);
+    RUN_TEST(test_compile_folding);
+    
+    printf("All compiled program tests passed!\n");
+    return 0;
+}
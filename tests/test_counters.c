@@ -0,0 +1,120 @@
+#include "test_common.h"
+
+// =============================================================================
+// Performance Counter Tests (DICE_ENABLE_COUNTERS)
+// =============================================================================
+
+int test_counters_disabled() {
+    if (dice_counters_enabled()) return 1;
+    
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_roll_expression(ctx, "4d6");
+    
+    dice_counters_t counters;
+    memset(&counters, 0xFF, sizeof(counters));
+    TEST_ASSERT(dice_counters_get(ctx, &counters) == -1, "Compiled-out counters report -1");
+    TEST_ASSERT(counters.dice_rolled == 0 && counters.parse_calls == 0, "Compiled-out counters read as zero");
+    dice_counters_reset(ctx);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_counters_rolls() {
+    if (!dice_counters_enabled()) return 1;
+    
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(11);
+    dice_context_set_rng(ctx, &rng);
+    dice_counters_reset(ctx);
+    
+    dice_counters_t counters;
+    TEST_ASSERT(dice_roll_expression(ctx, "3d6 + 2d8").success, "Expression rolls");
+    TEST_ASSERT(dice_counters_get(ctx, &counters) == 0, "Counters are readable");
+    TEST_ASSERT(counters.dice_rolled == 5, "Five dice rolled");
+    TEST_ASSERT(counters.rng_calls == 5, "One RNG value per die");
+    TEST_ASSERT(counters.parse_calls == 1 && counters.evaluate_calls == 1, "One parse and one evaluate");
+    TEST_ASSERT(counters.trace_entries == 5, "One trace entry per die");
+    TEST_ASSERT(counters.arena_used > 0 && counters.arena_high_water >= counters.arena_used,
+                "Arena usage and high-water mark tracked");
+    
+    // Counters ignore the trace level
+    dice_context_set_trace_level(ctx, DICE_TRACE_OFF);
+    dice_roll_expression(ctx, "10d10");
+    dice_counters_get(ctx, &counters);
+    TEST_ASSERT(counters.dice_rolled == 15 && counters.trace_entries == 5, "Untraced rolls are still counted");
+    
+    // Rerolls and explosions
+    dice_counters_reset(ctx);
+    dice_policy_t policy = ctx->policy;
+    policy.max_explosion_depth = 4;
+    dice_context_set_policy(ctx, &policy);
+    dice_roll_expression(ctx, "2d1!");
+    dice_counters_get(ctx, &counters);
+    TEST_ASSERT(counters.explosions == 8 && counters.dice_rolled == 10, "Explosions counted");
+    
+    dice_counters_reset(ctx);
+    dice_roll_expression(ctx, "1d1r1");
+    dice_counters_get(ctx, &counters);
+    TEST_ASSERT(counters.reroll_limit_hits == 1, "Reroll limit hit counted");
+    dice_clear_error(ctx);
+    
+    TEST_ASSERT(dice_roll_expression(ctx, "20d2r1").success, "Reroll expression rolls");
+    dice_counters_get(ctx, &counters);
+    TEST_ASSERT(counters.rerolls > 0 && counters.dice_rolled == 20 + counters.rerolls, "Rerolls counted");
+    
+    dice_counters_reset(ctx);
+    dice_counters_get(ctx, &counters);
+    TEST_ASSERT(counters.dice_rolled == 0 && counters.evaluate_ns == 0, "Reset zeroes the counters");
+    TEST_ASSERT(counters.arena_high_water == counters.arena_used, "Reset restarts the high-water mark");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_counters_compiled_and_rejections() {
+    if (!dice_counters_enabled()) return 1;
+    
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(3);
+    dice_context_set_rng(ctx, &rng);
+    dice_context_set_trace_level(ctx, DICE_TRACE_OFF);
+    
+    dice_program_t *program = dice_compile(ctx, dice_parse(ctx, "100d6"));
+    TEST_ASSERT(program != NULL, "Program compiles");
+    dice_counters_reset(ctx);
+    
+    int64_t out[1000];
+    TEST_ASSERT(dice_program_evaluate_batch(ctx, program, 1000, out) == 0, "Batch evaluates");
+    
+    dice_counters_t counters;
+    dice_counters_get(ctx, &counters);
+    TEST_ASSERT(counters.evaluate_calls == 1000, "Every program evaluation is counted");
+    TEST_ASSERT(counters.dice_rolled == 100000 && counters.rng_calls == 100000, "Compiled dice counted");
+    TEST_ASSERT(counters.evaluate_ns > 0, "Evaluation time accumulates");
+    TEST_ASSERT(counters.parse_calls == 0, "No parsing happened");
+    dice_program_destroy(program);
+    
+    // 2^32 mod 1610612737 leaves a quarter of all 32-bit draws to reject
+    dice_policy_t policy = ctx->policy;
+    policy.max_sides = 2000000000;
+    dice_context_set_policy(ctx, &policy);
+    TEST_ASSERT(dice_roll_expression(ctx, "1000d1610612737").success, "Huge dice roll");
+    dice_counters_get(ctx, &counters);
+    TEST_ASSERT(counters.rng_rejections > 0, "Range reduction rejections counted");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int main() {
+    printf("Running performance counter tests (%s)...\n\n",
+           dice_counters_enabled() ? "enabled" : "compiled out");
+    
+    RUN_TEST(test_counters_disabled);
+    RUN_TEST(test_counters_rolls);
+    RUN_TEST(test_counters_compiled_and_rejections);
+    
+    printf("All performance counter tests passed!\n");
+    return 0;
+}
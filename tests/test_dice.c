@@ -285,9 +285,9 @@ int test_custom_dice() {
     
     // Test 5: Register named FATE dice
     dice_custom_side_t fate_sides[] = {
-        {-1, "-"},
-        {0, " "},
-        {1, "+"}
+        {-1, "-", 1},
+        {0, " ", 1},
+        {1, "+", 1}
     };
     int reg_result = dice_register_custom_die(ctx, "F", fate_sides, 3);
     TEST_ASSERT(reg_result == 0, "dice_register_custom_die() succeeds for FATE dice");
@@ -306,7 +306,7 @@ int test_custom_dice() {
     
     // Test 8: Irregular numbered die
     dice_custom_side_t demon_sides[] = {
-        {0, NULL}, {1, NULL}, {3, NULL}, {5, NULL}, {7, NULL}, {9, NULL}, {11, NULL}
+        {0, NULL, 1}, {1, NULL, 1}, {3, NULL, 1}, {5, NULL, 1}, {7, NULL, 1}, {9, NULL, 1}, {11, NULL, 1}
     };
     reg_result = dice_register_custom_die(ctx, "Demon", demon_sides, 7);
     TEST_ASSERT(reg_result == 0, "dice_register_custom_die() succeeds for Demon dice");
@@ -273,6 +273,74 @@ int test_dice_limits() {
     return 1;
 }
 
+int test_simple_api_thread_context() {
+    // Consecutive calls continue one stream instead of reseeding per call
+    int distinct = 0;
+    int first = dice_roll(1000000);
+    for (int i = 0; i < 20; i++) {
+        if (dice_roll(1000000) != first) distinct++;
+    }
+    TEST_ASSERT(distinct > 15, "Back-to-back dice_roll() calls are not repeated");
+    
+    int seeded = dice_roll_quick("4d6k3+2", 4242);
+    TEST_ASSERT(seeded == dice_roll_quick("4d6k3+2", 4242), "Seeded quick rolls repeat");
+    TEST_ASSERT(dice_roll_notation("4dF+10") >= 6, "FATE dice stay registered between calls");
+    TEST_ASSERT(dice_roll_notation("3d") == -1, "Errors still return -1");
+    TEST_ASSERT(dice_roll_notation("2d6") >= 2, "Errors do not leak into the next call");
+    
+    // Long expressions grow the shared arena rather than failing
+    char expr[2048] = "1d6";
+    for (int i = 0; i < 150; i++) strcat(expr, "+1d6");
+    TEST_ASSERT(dice_roll_notation(expr) >= 151, "Expressions larger than the initial arena work");
+    
+    dice_thread_cleanup();
+    TEST_ASSERT(seeded == dice_roll_quick("4d6k3+2", 4242), "A fresh context after cleanup gives the same seeded roll");
+    dice_thread_cleanup();
+    dice_thread_cleanup();
+    
+    return 1;
+}
+
+int test_simple_api_batch() {
+    const size_t n = 60000;
+    int *dice = malloc(n * sizeof(int));
+    int64_t *a = malloc(n * sizeof(int64_t));
+    int64_t *b = malloc(n * sizeof(int64_t));
+    
+    TEST_ASSERT(dice_roll_batch(6, n, dice) == 0, "dice_roll_batch fills the buffer");
+    bool in_range = true;
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        if (dice[i] < 1 || dice[i] > 6) in_range = false;
+        sum += dice[i];
+    }
+    TEST_ASSERT(in_range, "Batch dice stay within 1..6");
+    TEST_ASSERT(fabs(sum / n - 3.5) < 0.05, "Batch dice average close to 3.5");
+    
+    dice_thread_seed(777);
+    TEST_ASSERT(dice_roll_notation_batch("4d6k3+(1+1)", n, a) == 0, "dice_roll_notation_batch fills the buffer");
+    dice_thread_seed(777);
+    TEST_ASSERT(dice_roll_notation_batch("4d6k3+(1+1)", n, b) == 0, "Reseeded batch succeeds");
+    TEST_ASSERT(memcmp(a, b, n * sizeof(int64_t)) == 0, "dice_thread_seed makes batches reproducible");
+    in_range = true;
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] < 5 || a[i] > 20) in_range = false;
+    }
+    TEST_ASSERT(in_range, "Batch results stay within 5..20");
+    
+    TEST_ASSERT(dice_roll_notation_batch("3d", 10, a) == -1, "Invalid notation fails");
+    TEST_ASSERT(dice_roll_notation_batch("1d6", 10, NULL) == -1, "Missing buffer fails");
+    TEST_ASSERT(dice_roll_notation_batch("1d6", 0, NULL) == 0, "Empty batch succeeds");
+    TEST_ASSERT(dice_roll_batch(0, 10, dice) == -1, "Zero sides fails");
+    TEST_ASSERT(dice_roll_notation("2d6") >= 2, "Simple API works after batches");
+    
+    free(dice);
+    free(a);
+    free(b);
+    dice_thread_cleanup();
+    return 1;
+}
+
 int main() {
     printf("Running core dice operation tests...\n\n");
     
@@ -284,6 +352,8 @@ int main() {
     RUN_TEST(test_dice_uniformity);
     RUN_TEST(test_multiple_dice_uniformity);
     RUN_TEST(test_dice_limits);
+    RUN_TEST(test_simple_api_thread_context);
+    RUN_TEST(test_simple_api_batch);
     
     printf("All core dice tests passed!\n");
     
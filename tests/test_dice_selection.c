@@ -228,6 +228,28 @@ int test_shorthand_syntax() {
     return 1;
 }
 
+int test_selection_small_arena() {
+    // Wide dice in a 4 KB arena leave no room for a per-face histogram
+    dice_context_t *ctx = dice_context_create(4096, DICE_FEATURE_ALL);
+    
+    dice_eval_result_t result = dice_roll_expression(ctx, "2d4000h1");
+    TEST_ASSERT(result.success, "2d4000h1 succeeds in a small arena");
+    TEST_ASSERT(result.value >= 1 && result.value <= 4000, "2d4000h1 result in valid range");
+    
+    dice_context_reset(ctx);
+    result = dice_roll_expression(ctx, "4d1000k3");
+    TEST_ASSERT(result.success, "4d1000k3 succeeds in a small arena");
+    TEST_ASSERT(result.value >= 3 && result.value <= 3000, "4d1000k3 result in valid range");
+    
+    dice_context_reset(ctx);
+    result = dice_roll_expression(ctx, "3d4096l1");
+    TEST_ASSERT(result.success, "3d4096l1 succeeds in a small arena");
+    TEST_ASSERT(result.value >= 2 && result.value <= 8192, "3d4096l1 result in valid range");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
 // =============================================================================
 // Test Runner
 // =============================================================================
@@ -242,6 +264,7 @@ int main() {
     RUN_TEST(test_selection_edge_cases);
     RUN_TEST(test_selection_in_complex_expressions);
     RUN_TEST(test_shorthand_syntax);
+    RUN_TEST(test_selection_small_arena);
     
     printf("All dice selection tests passed!\\n");
     return 0;
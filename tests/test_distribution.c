@@ -0,0 +1,257 @@
+#include "test_common.h"
+
+#define PROB_EPSILON 1e-9
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+static dice_distribution_t* analyze_expression(dice_context_t *ctx, const char *expression) {
+    dice_ast_node_t *ast = dice_parse(ctx, expression);
+    if (!ast) return NULL;
+    return dice_analyze(ctx, ast);
+}
+
+static bool near(double a, double b) {
+    return fabs(a - b) < PROB_EPSILON;
+}
+
+static double total_probability(const dice_distribution_t *dist) {
+    double total = 0.0;
+    for (size_t i = 0; i < dist->size; i++) total += dist->pmf[i];
+    return total;
+}
+
+// Brute-force keep/drop distribution by enumerating every roll of count dice
+static bool keep_matches_enumeration(dice_context_t *ctx, const char *expression,
+                                     int count, int sides, int keep, bool keep_high) {
+    dice_ast_node_t *ast = dice_parse(ctx, expression);
+    if (!ast || !ast->data.dice_op.selection) return false;
+    // The grammar only selects high dice; flip the selection for low
+    ast->data.dice_op.selection->select_high = keep_high;
+    dice_distribution_t *dist = dice_analyze(ctx, ast);
+    if (!dist) return false;
+    
+    double expected[256] = {0};
+    int total = 1;
+    for (int i = 0; i < count; i++) total *= sides;
+    
+    for (int code = 0; code < total; code++) {
+        int rolls[8];
+        int c = code;
+        for (int i = 0; i < count; i++) {
+            rolls[i] = c % sides + 1;
+            c /= sides;
+        }
+        // Insertion sort, descending for keep-high, ascending for keep-low
+        for (int i = 1; i < count; i++) {
+            int v = rolls[i], j = i - 1;
+            while (j >= 0 && (keep_high ? rolls[j] < v : rolls[j] > v)) {
+                rolls[j + 1] = rolls[j];
+                j--;
+            }
+            rolls[j + 1] = v;
+        }
+        int sum = 0;
+        for (int i = 0; i < keep; i++) sum += rolls[i];
+        expected[sum] += 1.0 / total;
+    }
+    
+    bool ok = true;
+    for (int v = 0; v < 256; v++) {
+        if (!near(dice_distribution_probability(dist, v), expected[v])) ok = false;
+    }
+    dice_distribution_destroy(dist);
+    return ok;
+}
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+int test_basic_distributions() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    
+    dice_distribution_t *d6 = analyze_expression(ctx, "1d6");
+    TEST_ASSERT(d6 != NULL, "1d6 analyzes");
+    TEST_ASSERT(d6->min_value == 1 && d6->size == 6, "1d6 support is 1..6");
+    TEST_ASSERT(near(dice_distribution_probability(d6, 4), 1.0 / 6.0), "P(1d6 == 4) is 1/6");
+    TEST_ASSERT(near(dice_distribution_mean(d6), 3.5), "1d6 mean is 3.5");
+    TEST_ASSERT(near(dice_distribution_variance(d6), 35.0 / 12.0), "1d6 variance is 35/12");
+    TEST_ASSERT(dice_distribution_quantile(d6, 0.5) == 3, "1d6 median is 3");
+    TEST_ASSERT(near(dice_distribution_cdf(d6, 2), 2.0 / 6.0), "P(1d6 <= 2) is 1/3");
+    TEST_ASSERT(near(dice_distribution_cdf(d6, 100), 1.0), "CDF saturates at 1");
+    dice_distribution_destroy(d6);
+    
+    dice_distribution_t *three = analyze_expression(ctx, "3d6");
+    TEST_ASSERT(three != NULL, "3d6 analyzes");
+    TEST_ASSERT(near(dice_distribution_probability(three, 10), 27.0 / 216.0), "P(3d6 == 10) is 27/216");
+    TEST_ASSERT(near(dice_distribution_probability(three, 3), 1.0 / 216.0), "P(3d6 == 3) is 1/216");
+    TEST_ASSERT(near(dice_distribution_mean(three), 10.5), "3d6 mean is 10.5");
+    dice_distribution_destroy(three);
+    
+    dice_distribution_t *lit = analyze_expression(ctx, "7");
+    TEST_ASSERT(lit != NULL && lit->size == 1 && lit->min_value == 7, "Literal is a point mass");
+    dice_distribution_destroy(lit);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_arithmetic_distributions() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    
+    dice_distribution_t *shifted = analyze_expression(ctx, "2d6+3");
+    TEST_ASSERT(shifted != NULL && shifted->min_value == 5 && shifted->size == 11, "2d6+3 support is 5..15");
+    TEST_ASSERT(near(dice_distribution_probability(shifted, 10), 6.0 / 36.0), "P(2d6+3 == 10) is 1/6");
+    dice_distribution_destroy(shifted);
+    
+    dice_distribution_t *diff = analyze_expression(ctx, "1d6-1d6");
+    TEST_ASSERT(diff != NULL && diff->min_value == -5 && diff->size == 11, "1d6-1d6 support is -5..5");
+    TEST_ASSERT(near(dice_distribution_probability(diff, 0), 6.0 / 36.0), "P(1d6-1d6 == 0) is 1/6");
+    TEST_ASSERT(near(dice_distribution_mean(diff), 0.0), "1d6-1d6 mean is 0");
+    dice_distribution_destroy(diff);
+    
+    dice_distribution_t *doubled = analyze_expression(ctx, "1d6*2");
+    TEST_ASSERT(doubled != NULL, "1d6*2 analyzes");
+    TEST_ASSERT(near(dice_distribution_probability(doubled, 4), 1.0 / 6.0), "P(1d6*2 == 4) is 1/6");
+    TEST_ASSERT(near(dice_distribution_probability(doubled, 5), 0.0), "Odd results are impossible");
+    dice_distribution_destroy(doubled);
+    
+    dice_distribution_t *product = analyze_expression(ctx, "1d4*1d4");
+    TEST_ASSERT(product != NULL, "1d4*1d4 analyzes");
+    TEST_ASSERT(near(dice_distribution_probability(product, 4), 3.0 / 16.0), "P(1d4*1d4 == 4) is 3/16");
+    dice_distribution_destroy(product);
+    
+    dice_distribution_t *halved = analyze_expression(ctx, "1d6/2");
+    TEST_ASSERT(halved != NULL, "1d6/2 analyzes");
+    TEST_ASSERT(near(dice_distribution_probability(halved, 0), 1.0 / 6.0), "Integer division truncates");
+    TEST_ASSERT(near(dice_distribution_probability(halved, 3), 1.0 / 6.0), "P(1d6/2 == 3) is 1/6");
+    dice_distribution_destroy(halved);
+    
+    dice_distribution_t *div_zero = analyze_expression(ctx, "1d6/0");
+    TEST_ASSERT(div_zero == NULL && dice_has_error(ctx), "Possible division by zero is an error");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_selection_distributions() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    
+    dice_distribution_t *stats = analyze_expression(ctx, "4d6k3");
+    TEST_ASSERT(stats != NULL, "4d6k3 analyzes");
+    TEST_ASSERT(near(dice_distribution_mean(stats), 15869.0 / 1296.0), "4d6k3 mean is 15869/1296");
+    TEST_ASSERT(near(dice_distribution_probability(stats, 18), 21.0 / 1296.0), "P(4d6k3 == 18) is 21/1296");
+    dice_distribution_destroy(stats);
+    
+    TEST_ASSERT(keep_matches_enumeration(ctx, "4d6k3", 4, 6, 3, true), "Keep highest 3 of 4d6 matches enumeration");
+    TEST_ASSERT(keep_matches_enumeration(ctx, "4d6k2", 4, 6, 2, false), "Keep lowest 2 of 4d6 matches enumeration");
+    TEST_ASSERT(keep_matches_enumeration(ctx, "5d4l2", 5, 4, 3, true), "Drop lowest 2 of 5d4 matches enumeration");
+    TEST_ASSERT(keep_matches_enumeration(ctx, "5d4l1", 5, 4, 4, false), "Drop highest 1 of 5d4 matches enumeration");
+    TEST_ASSERT(keep_matches_enumeration(ctx, "3d8k5", 3, 8, 3, true), "Keeping more than rolled keeps all");
+    
+    dice_distribution_t *dropped = analyze_expression(ctx, "2d6l3");
+    TEST_ASSERT(dropped != NULL && dropped->size == 1 && dropped->min_value == 0, "Dropping every die gives 0");
+    dice_distribution_destroy(dropped);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_conditional_distributions() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    
+    dice_distribution_t *success = analyze_expression(ctx, "1d6s>4");
+    TEST_ASSERT(success != NULL, "1d6s>4 analyzes");
+    TEST_ASSERT(near(dice_distribution_probability(success, 0), 4.0 / 6.0), "Non-matching dice count as 0");
+    TEST_ASSERT(near(dice_distribution_probability(success, 5), 1.0 / 6.0), "Matching dice keep their face");
+    dice_distribution_destroy(success);
+    
+    dice_distribution_t *reroll = analyze_expression(ctx, "3d6r1");
+    TEST_ASSERT(reroll != NULL, "3d6r1 analyzes");
+    TEST_ASSERT(near(dice_distribution_mean(reroll), 12.0), "3d6r1 mean is 3 * 4");
+    TEST_ASSERT(near(dice_distribution_probability(reroll, 3), 0.0), "Rerolled faces never appear");
+    dice_distribution_destroy(reroll);
+    
+    dice_distribution_t *fate = analyze_expression(ctx, "4dF");
+    TEST_ASSERT(fate != NULL, "4dF analyzes");
+    TEST_ASSERT(fate->min_value == -4 && fate->size == 9, "4dF support is -4..4");
+    TEST_ASSERT(near(dice_distribution_probability(fate, 4), 1.0 / 81.0), "P(4dF == 4) is 1/81");
+    TEST_ASSERT(near(dice_distribution_mean(fate), 0.0), "4dF mean is 0");
+    dice_distribution_destroy(fate);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_large_distribution() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    
+    // Large enough that the sum goes through the FFT path
+    dice_distribution_t *dist = analyze_expression(ctx, "100d100");
+    TEST_ASSERT(dist != NULL, "100d100 analyzes");
+    TEST_ASSERT(dist->min_value == 100 && dist->size == 9901, "100d100 support is 100..10000");
+    TEST_ASSERT(fabs(total_probability(dist) - 1.0) < 1e-9, "Probabilities sum to 1");
+    TEST_ASSERT(fabs(dice_distribution_mean(dist) - 5050.0) < 1e-6, "100d100 mean is 5050");
+    TEST_ASSERT(fabs(dice_distribution_variance(dist) - 83325.0) < 1e-3, "100d100 variance is 83325");
+    TEST_ASSERT(dice_distribution_quantile(dist, 0.5) == 5050, "100d100 median is 5050");
+    dice_distribution_destroy(dist);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_dynamic_count_distribution() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    
+    // Hand-built (1d2)d6: half 1d6, half 2d6
+    dice_ast_node_t node;
+    memset(&node, 0, sizeof(node));
+    node.type = DICE_NODE_DICE_OP;
+    node.data.dice_op.dice_type = DICE_DICE_BASIC;
+    node.data.dice_op.count = dice_parse(ctx, "1d2");
+    node.data.dice_op.sides = dice_parse(ctx, "6");
+    
+    dice_distribution_t *dist = dice_analyze(ctx, &node);
+    TEST_ASSERT(dist != NULL, "Dice with a random count analyze");
+    TEST_ASSERT(near(dice_distribution_probability(dist, 1), 0.5 / 6.0), "P(1) comes from 1d6 only");
+    TEST_ASSERT(near(dice_distribution_probability(dist, 7), 0.5 * 6.0 / 36.0), "P(7) comes from 2d6 only");
+    TEST_ASSERT(near(dice_distribution_mean(dist), 0.5 * 3.5 + 0.5 * 7.0), "Mean is the mixture mean");
+    dice_distribution_destroy(dist);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_distribution_errors() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    
+    TEST_ASSERT(dice_analyze(ctx, NULL) == NULL, "NULL AST is rejected");
+    TEST_ASSERT(dice_has_error(ctx), "Error is reported for NULL AST");
+    
+    dice_clear_error(ctx);
+    dice_distribution_t *dist = analyze_expression(ctx, "1d6r<7");
+    TEST_ASSERT(dist == NULL, "Reroll matching every face is rejected");
+    TEST_ASSERT(dice_has_error(ctx), "Error is reported for impossible reroll");
+    
+    dice_distribution_destroy(NULL);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int main() {
+    printf("Running distribution analysis tests...\n\n");
+    
+    RUN_TEST(test_basic_distributions);
+    RUN_TEST(test_arithmetic_distributions);
+    RUN_TEST(test_selection_distributions);
+    RUN_TEST(test_conditional_distributions);
+    RUN_TEST(test_large_distribution);
+    RUN_TEST(test_dynamic_count_distribution);
+    RUN_TEST(test_distribution_errors);
+    
+    printf("All distribution analysis tests passed!\n");
+    return 0;
+}
@@ -296,6 +296,240 @@ int test_evaluation_edge_cases() {
     return 1;
 }
 
+// =============================================================================
+// Batch Evaluation Tests
+// =============================================================================
+
+int test_batch_evaluation() {
+    // Large arena: the sequential replay below traces every die
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(4242);
+    dice_context_set_rng(ctx, &rng);
+    
+    dice_ast_node_t *ast = dice_parse(ctx, "4d6k3+2");
+    TEST_ASSERT(ast != NULL, "Expression parses for batch evaluation");
+    
+    size_t arena_before = ctx->arena_used;
+    size_t trace_before = dice_get_trace(ctx)->count;
+    
+    int64_t samples[500];
+    TEST_ASSERT(dice_evaluate_batch(ctx, ast, 500, samples) == 0, "Batch evaluation succeeds");
+    
+    bool in_range = true;
+    for (int i = 0; i < 500; i++) {
+        if (samples[i] < 5 || samples[i] > 20) in_range = false;
+    }
+    TEST_ASSERT(in_range, "All batch samples are in range");
+    TEST_ASSERT(ctx->arena_used == arena_before, "Batch evaluation does not grow the arena");
+    TEST_ASSERT(dice_get_trace(ctx)->count == trace_before, "Batch evaluation skips tracing");
+    
+    // Batch results match sequential evaluation with the same seed
+    dice_rng_vtable_t replay = dice_create_xoshiro_rng(4242);
+    dice_context_set_rng(ctx, &replay);
+    bool identical = true;
+    for (int i = 0; i < 500; i++) {
+        dice_eval_result_t result = dice_evaluate(ctx, ast);
+        if (!result.success || result.value != samples[i]) identical = false;
+    }
+    TEST_ASSERT(identical, "Batch samples match sequential evaluation");
+    TEST_ASSERT(dice_get_trace(ctx)->count > trace_before, "Tracing resumes after batch evaluation");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_batch_evaluation_errors() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    int64_t samples[4];
+    
+    dice_ast_node_t *ast = dice_parse(ctx, "10/(1d1-1)");
+    TEST_ASSERT(ast != NULL, "Expression parses");
+    TEST_ASSERT(dice_evaluate_batch(ctx, ast, 4, samples) == -1, "Batch stops on evaluation error");
+    TEST_ASSERT(dice_has_error(ctx), "Batch error is reported in context");
+    dice_clear_error(ctx);
+    
+    TEST_ASSERT(dice_evaluate_batch(ctx, NULL, 4, samples) == -1, "NULL AST is rejected");
+    TEST_ASSERT(dice_evaluate_batch(ctx, ast, 4, NULL) == -1, "NULL output buffer is rejected");
+    TEST_ASSERT(dice_evaluate_batch(ctx, ast, 0, NULL) == 0, "Empty batch succeeds");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_custom_registry_binding() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    
+    // A game-system-sized registry
+    char name[16];
+    bool all_found = true;
+    for (int i = 0; i < 64; i++) {
+        dice_custom_side_t sides[] = {{i, NULL, 1}, {i, NULL, 1}};
+        snprintf(name, sizeof(name), "Die%d", i);
+        TEST_ASSERT(dice_register_custom_die(ctx, name, sides, 2) == 0, "Named die registered");
+    }
+    for (int i = 0; i < 64; i++) {
+        snprintf(name, sizeof(name), "Die%d", i);
+        const dice_custom_die_t *die = dice_lookup_custom_die(ctx, name);
+        if (!die || die->sides[0].value != i) all_found = false;
+    }
+    TEST_ASSERT(all_found, "Every die is found through the hash index");
+    TEST_ASSERT(dice_lookup_custom_die(ctx, "Die64") == NULL, "Unregistered names are not found");
+    
+    dice_ast_node_t *ast = dice_parse(ctx, "3dDie17+1dF");
+    TEST_ASSERT(ast != NULL, "Expression parsed");
+    TEST_ASSERT(ast->data.binary_op.left->data.dice_op.bound_die == dice_lookup_custom_die(ctx, "Die17"),
+                "Parser binds named dice");
+    dice_program_t *program = dice_compile(ctx, ast);
+    dice_eval_result_t result = dice_evaluate(ctx, ast);
+    TEST_ASSERT(result.success && result.value >= 50 && result.value <= 52, "Bound die evaluates");
+    
+    // Re-registering replaces the die and invalidates earlier bindings
+    dice_custom_side_t replacement[] = {{100, NULL, 1}};
+    size_t count_before = ctx->custom_dice.count;
+    TEST_ASSERT(dice_register_custom_die(ctx, "Die17", replacement, 1) == 0, "Die re-registered");
+    TEST_ASSERT(ctx->custom_dice.count == count_before, "Re-registration reuses the slot");
+    result = dice_evaluate(ctx, ast);
+    TEST_ASSERT(result.success && result.value >= 299 && result.value <= 301, "Stale AST binding sees the new die");
+    result = dice_program_evaluate(ctx, program);
+    TEST_ASSERT(result.success && result.value >= 299 && result.value <= 301, "Stale program binding sees the new die");
+    TEST_ASSERT(dice_bind_custom_dice(ctx, ast) == 0, "AST rebinds cleanly");
+    
+    dice_ast_node_t *unknown = dice_parse(ctx, "1dLater");
+    TEST_ASSERT(unknown && dice_bind_custom_dice(ctx, unknown) == 1, "Unknown names are reported by bind");
+    dice_custom_side_t later[] = {{7, NULL, 1}};
+    dice_register_custom_die(ctx, "Later", later, 1);
+    TEST_ASSERT(dice_bind_custom_dice(ctx, unknown) == 0, "Dice registered after parsing can be bound");
+    TEST_ASSERT(dice_evaluate(ctx, unknown).value == 7, "Late-bound die evaluates");
+    
+    dice_clear_custom_dice(ctx);
+    result = dice_evaluate(ctx, ast);
+    TEST_ASSERT(!result.success && dice_has_error(ctx), "Cleared registry invalidates bindings");
+    dice_clear_error(ctx);
+    result = dice_program_evaluate(ctx, program);
+    TEST_ASSERT(!result.success && dice_has_error(ctx), "Cleared registry invalidates program bindings");
+    
+    dice_program_destroy(program);
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_custom_registry_failed_growth() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    
+    // Fill the registry (four slots, one taken by the built-in F) to capacity
+    char name[16];
+    for (int i = 0; ctx->custom_dice.count < ctx->custom_dice.capacity; i++) {
+        dice_custom_side_t sides[] = {{i, NULL, 1}};
+        snprintf(name, sizeof(name), "Die%d", i);
+        TEST_ASSERT(dice_register_custom_die(ctx, name, sides, 1) == 0, "Named die registered");
+    }
+    dice_ast_node_t *ast = dice_parse(ctx, "1dDie2");
+    TEST_ASSERT(ast && ast->data.dice_op.bound_die != NULL, "Parser binds the named die");
+    
+    // The next registration grows the array, then fails on its weights
+    size_t side_count = 65537;
+    dice_custom_side_t *huge = calloc(side_count, sizeof(dice_custom_side_t));
+    for (size_t i = 0; i < side_count; i++) huge[i].weight = UINT32_MAX;
+    huge[0].weight = 1;
+    TEST_ASSERT(dice_register_custom_die(ctx, "Huge", huge, side_count) == -1, "Oversized weights are rejected");
+    free(huge);
+    dice_clear_error(ctx);
+    
+    dice_eval_result_t result = dice_evaluate(ctx, ast);
+    TEST_ASSERT(result.success && result.value == 2, "Binding survives the moved registry");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_weighted_custom_dice() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(2024);
+    dice_context_set_rng(ctx, &rng);
+    
+    // 97:3 odds, without 97 copies of the miss side
+    dice_custom_side_t sides[] = {
+        dice_custom_weighted_side(0, "miss", 97),
+        dice_custom_weighted_side(1, "hit", 3)
+    };
+    TEST_ASSERT(dice_register_custom_die(ctx, "Shot", sides, 2) == 0, "Weighted die registered");
+    free((void*)sides[0].label);
+    free((void*)sides[1].label);
+    
+    const dice_custom_die_t *shot = dice_lookup_custom_die(ctx, "Shot");
+    TEST_ASSERT(shot && shot->side_count == 2 && shot->total_weight == 100 && shot->alias != NULL,
+                "Registration builds an alias table");
+    
+    dice_ast_node_t *ast = dice_parse(ctx, "1000dShot");
+    dice_eval_result_t result = dice_evaluate(ctx, ast);
+    TEST_ASSERT(result.success && result.value >= 10 && result.value <= 55, "Hits follow the 3% weight");
+    
+    // Inline weights, tree evaluator and compiled program alike
+    ast = dice_parse(ctx, "1000d{0*1, 1*9}");
+    TEST_ASSERT(ast && ast->data.dice_op.custom_die->total_weight == 10, "Inline weights are parsed");
+    result = dice_evaluate(ctx, ast);
+    TEST_ASSERT(result.success && result.value >= 850 && result.value <= 950, "Inline weighted die evaluates");
+    dice_program_t *program = dice_compile(ctx, ast);
+    TEST_ASSERT(program != NULL, "Weighted inline die compiles");
+    result = dice_program_evaluate(ctx, program);
+    TEST_ASSERT(result.success && result.value >= 850 && result.value <= 950, "Compiled weighted die evaluates");
+    dice_program_destroy(program);
+    
+    // Exact analysis uses the weights
+    dice_distribution_t *dist = dice_analyze(ctx, dice_parse(ctx, "1d{1:\"a\"*2, 2:\"b\", 3*5}"));
+    TEST_ASSERT(dist != NULL, "Weighted die analyzed");
+    TEST_ASSERT(fabs(dice_distribution_probability(dist, 1) - 0.25) < 1e-12 &&
+                fabs(dice_distribution_probability(dist, 3) - 0.625) < 1e-12, "PMF follows weights");
+    dice_distribution_destroy(dist);
+    
+    // A side with all the weight is the only outcome
+    ast = dice_parse(ctx, "200d{5*1000000, 7*1}");
+    result = dice_evaluate(ctx, ast);
+    TEST_ASSERT(result.success && result.value >= 1000 && result.value <= 1002, "Heavily skewed die evaluates");
+    
+    // Equal weights keep the unweighted draw sequence
+    TEST_ASSERT(dice_parse(ctx, "1d{1*4, 2*4}")->data.dice_op.custom_die->alias == NULL,
+                "Equal weights need no alias table");
+    dice_context_t *plain = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_rng_vtable_t a = dice_create_xoshiro_rng(9);
+    dice_rng_vtable_t b = dice_create_xoshiro_rng(9);
+    dice_context_set_rng(ctx, &a);
+    dice_context_set_rng(plain, &b);
+    int64_t weighted = dice_evaluate(ctx, dice_parse(ctx, "50d{1*4, 2*4, 6*4}")).value;
+    int64_t unweighted = dice_evaluate(plain, dice_parse(plain, "50d{1, 2, 6}")).value;
+    TEST_ASSERT(weighted == unweighted, "Uniform weights roll like unweighted sides");
+    dice_context_destroy(plain);
+    
+    TEST_ASSERT(dice_parse(ctx, "1d{1*0, 2}") == NULL && dice_has_error(ctx), "Zero weight is rejected");
+    dice_clear_error(ctx);
+    TEST_ASSERT(dice_parse(ctx, "1d{1*, 2}") == NULL && dice_has_error(ctx), "Missing weight is rejected");
+    dice_clear_error(ctx);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_weighted_custom_dice_default_engine() {
+    // Large weights must reach every alias column on the rand()-based engine
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng = dice_create_system_rng(77);
+    dice_context_set_rng(ctx, &rng);
+    
+    dice_ast_node_t *ast = dice_parse(ctx, "1000d{0*1000000000, 1*2000000000}");
+    int64_t hits = 0;
+    bool all_succeeded = true;
+    for (int i = 0; i < 20; i++) {
+        dice_eval_result_t result = dice_evaluate(ctx, ast);
+        all_succeeded = all_succeeded && result.success;
+        hits += result.value;
+    }
+    TEST_ASSERT(all_succeeded, "Heavily weighted die evaluates");
+    TEST_ASSERT(hits >= 13000 && hits <= 13700, "Side 1 comes up two thirds of the time");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
 int main() {
     printf("Running evaluation engine tests...\n\n");
     
@@ -311,6 +545,12 @@ int main() {
     RUN_TEST(test_nested_dice_expressions);
     RUN_TEST(test_evaluation_consistency);
     RUN_TEST(test_evaluation_edge_cases);
+    RUN_TEST(test_batch_evaluation);
+    RUN_TEST(test_batch_evaluation_errors);
+    RUN_TEST(test_custom_registry_binding);
+    RUN_TEST(test_custom_registry_failed_growth);
+    RUN_TEST(test_weighted_custom_dice);
+    RUN_TEST(test_weighted_custom_dice_default_engine);
     
     printf("All evaluation engine tests passed!\n");
     return 0;
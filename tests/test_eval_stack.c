@@ -0,0 +1,301 @@
+#include "test_common.h"
+#include <stdint.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// =============================================================================
+// Iterative Evaluator Tests (explicit stack, depth and node limits)
+// =============================================================================
+
+static dice_context_t* stack_context(uint64_t seed) {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_context_set_arena_growth(ctx, 1024 * 1024);
+    dice_context_set_trace_level(ctx, DICE_TRACE_OFF);
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(seed);
+    dice_context_set_rng(ctx, &rng);
+    return ctx;
+}
+
+// "term+term+...+term", as machine-generated templates produce
+static char* repeat_chain(const char *term, int terms) {
+    size_t length = strlen(term);
+    char *text = malloc((length + 1) * (size_t)terms + 1);
+    char *out = text;
+    for (int i = 0; i < terms; i++) {
+        if (i > 0) *out++ = '+';
+        memcpy(out, term, length);
+        out += length;
+    }
+    *out = '\0';
+    return text;
+}
+
+// open copies of prefix around "1", each closed by suffix
+static char* nest(const char *prefix, const char *suffix, int levels) {
+    size_t width = strlen(prefix) + strlen(suffix);
+    char *text = malloc(width * (size_t)levels + 2);
+    char *out = text;
+    for (int i = 0; i < levels; i++) out += sprintf(out, "%s", prefix);
+    *out++ = '1';
+    for (int i = 0; i < levels; i++) out += sprintf(out, "%s", suffix);
+    *out = '\0';
+    return text;
+}
+
+// 1+(1+(1+...)): every right operand nests one level deeper
+static dice_ast_node_t* right_nested(dice_ast_node_t *nodes, int levels) {
+    for (int i = 0; i <= levels; i++) {
+        dice_ast_node_t *literal = &nodes[2 * i + 1];
+        literal->type = DICE_NODE_LITERAL;
+        literal->data.literal.value = 1;
+        if (i == levels) break;
+        
+        dice_ast_node_t *node = &nodes[2 * i];
+        node->type = DICE_NODE_BINARY_OP;
+        node->data.binary_op.op = DICE_OP_ADD;
+        node->data.binary_op.left = literal;
+        node->data.binary_op.right = i + 1 == levels ? &nodes[2 * levels + 1] : &nodes[2 * (i + 1)];
+    }
+    return levels > 0 ? &nodes[0] : &nodes[1];
+}
+
+int test_eval_stack_matches_program() {
+    const char *expressions[] = {"3d6+2*4-1", "(1d4)d(1d6+2)", "-(2d6-(1d4*3))", "4d6k3+5d6!-2d10>8",
+                                 "((((1d20))))+((2)d(3))", "1d{1,2,3:\"x\"*2}*(1d6/2)", "-1d6--1d6"};
+    
+    for (size_t i = 0; i < sizeof(expressions) / sizeof(expressions[0]); i++) {
+        dice_context_t *ctx = stack_context(21);
+        dice_ast_node_t *ast = dice_parse(ctx, expressions[i]);
+        TEST_ASSERT(ast != NULL, "Expression parses");
+        dice_program_t *program = dice_compile(ctx, ast);
+        TEST_ASSERT(program != NULL, "Expression compiles");
+        
+        // The tree walk consumes the RNG in the same order as the program
+        bool same = true;
+        for (int round = 1; round <= 50; round++) {
+            dice_rng_vtable_t rng = dice_create_xoshiro_rng((uint64_t)round);
+            dice_context_set_rng(ctx, &rng);
+            dice_eval_result_t tree = dice_evaluate(ctx, ast);
+            rng = dice_create_xoshiro_rng((uint64_t)round);
+            dice_context_set_rng(ctx, &rng);
+            dice_eval_result_t compiled = dice_program_evaluate(ctx, program);
+            if (!tree.success || !compiled.success || tree.value != compiled.value) same = false;
+        }
+        TEST_ASSERT(same, "Tree and program agree roll for roll");
+        
+        dice_program_destroy(program);
+        dice_context_destroy(ctx);
+    }
+    
+    // Errors still surface from any depth
+    dice_context_t *ctx = stack_context(1);
+    TEST_ASSERT(!dice_roll_expression(ctx, "1+(2*(3/(1d1-1)))").success &&
+                strstr(dice_get_error(ctx), "Division by zero") != NULL, "Nested error reported");
+    dice_clear_error(ctx);
+    TEST_ASSERT(!dice_roll_expression(ctx, "2+(0)d6").success && dice_has_error(ctx), "Count checked");
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_eval_stack_long_chain() {
+    dice_context_t *ctx = stack_context(8);
+    
+    // A flat chain does not nest, so only the node budget applies
+    char *text = repeat_chain("1d6", 20000);
+    dice_ast_node_t *ast = dice_parse(ctx, text);
+    TEST_ASSERT(ast != NULL, "Chain of 20000 terms parses");
+    dice_eval_result_t result = dice_evaluate(ctx, ast);
+    TEST_ASSERT(result.success && result.value >= 20000 && result.value <= 120000,
+                "Chain of 20000 terms evaluates");
+    free(text);
+    
+    // 50001 terms are 100001 nodes, one past the default budget
+    text = repeat_chain("1", 50001);
+    TEST_ASSERT(dice_parse(ctx, text) == NULL && strstr(dice_get_error(ctx), "node limit of 100000") != NULL,
+                "Parser enforces the node budget");
+    dice_clear_error(ctx);
+    
+    dice_policy_t policy = ctx->policy;
+    policy.max_nodes = 0;
+    dice_context_set_policy(ctx, &policy);
+    ast = dice_parse(ctx, text);
+    TEST_ASSERT(ast != NULL, "Zero means unlimited");
+    dice_program_t *program = dice_compile(ctx, ast);
+    TEST_ASSERT(program != NULL && dice_evaluate(ctx, ast).value == 50001, "Unlimited tree compiles and evaluates");
+    free(text);
+    
+    // Trees and programs from a looser policy are held to the current one
+    policy.max_nodes = 100000;
+    dice_context_set_policy(ctx, &policy);
+    result = dice_evaluate(ctx, ast);
+    TEST_ASSERT(!result.success && strstr(dice_get_error(ctx), "node limit of 100000") != NULL,
+                "Evaluator enforces the node budget");
+    dice_clear_error(ctx);
+    TEST_ASSERT(dice_compile(ctx, ast) == NULL && dice_has_error(ctx), "Compiler enforces the node budget");
+    dice_clear_error(ctx);
+    dice_program_destroy(program);
+    
+    // Constants fold away, so the interpreter's check needs dice
+    text = repeat_chain("1d6", 2000);
+    program = dice_compile(ctx, dice_parse(ctx, text));
+    TEST_ASSERT(program != NULL, "Dice chain compiles");
+    policy.max_nodes = 1000;
+    dice_context_set_policy(ctx, &policy);
+    TEST_ASSERT(!dice_program_evaluate(ctx, program).success && dice_has_error(ctx),
+                "Program interpreter enforces the node budget");
+    dice_clear_error(ctx);
+    dice_program_destroy(program);
+    free(text);
+    
+    policy.max_nodes = 9;
+    dice_context_set_policy(ctx, &policy);
+    TEST_ASSERT(dice_roll_expression(ctx, "1+1+1+1+1").success, "Nine nodes within budget");
+    TEST_ASSERT(!dice_roll_expression(ctx, "1+1+1+1+1+1").success, "Eleven nodes over budget");
+    dice_clear_error(ctx);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_eval_stack_depth_limit() {
+    dice_context_t *ctx = stack_context(3);
+    
+    // Parentheses and signs count against the parser's nesting limit
+    char *text = nest("(", ")", 256);
+    TEST_ASSERT(dice_parse(ctx, text) != NULL, "256 nested groups parse");
+    free(text);
+    text = nest("(", ")", 257);
+    TEST_ASSERT(dice_parse(ctx, text) == NULL &&
+                strstr(dice_get_error(ctx), "nesting depth limit of 256") != NULL, "257 nested groups rejected");
+    dice_clear_error(ctx);
+    free(text);
+    text = nest("-", "", 257);
+    TEST_ASSERT(dice_parse(ctx, text) == NULL, "257 nested signs rejected");
+    dice_clear_error(ctx);
+    free(text);
+    text = nest("1+(", ")", 257);
+    TEST_ASSERT(dice_parse(ctx, text) == NULL &&
+                strstr(dice_get_error(ctx), "nesting depth limit of 256") != NULL,
+                "Depth error inside a right operand is reported as such");
+    dice_clear_error(ctx);
+    free(text);
+    text = nest("1d(", ")", 200);
+    dice_ast_node_t *ast = dice_parse(ctx, text);
+    TEST_ASSERT(ast != NULL && dice_evaluate(ctx, ast).value == 1, "Nested sides expressions evaluate");
+    free(text);
+    
+    // Hand-built trees are held to the same limit by the evaluator and compiler
+    dice_ast_node_t *nodes = calloc(2 * 512 + 2, sizeof(dice_ast_node_t));
+    ast = right_nested(nodes, 256);
+    dice_eval_result_t result = dice_evaluate(ctx, ast);
+    TEST_ASSERT(result.success && result.value == 257, "Depth 256 evaluates");
+    dice_program_t *program = dice_compile(ctx, ast);
+    TEST_ASSERT(program != NULL && dice_program_evaluate(ctx, program).value == 257, "Depth 256 compiles");
+    dice_program_destroy(program);
+    
+    ast = right_nested(nodes, 512);
+    result = dice_evaluate(ctx, ast);
+    TEST_ASSERT(!result.success && strstr(dice_get_error(ctx), "nesting depth limit of 256") != NULL,
+                "Depth 512 rejected");
+    dice_clear_error(ctx);
+    TEST_ASSERT(dice_compile(ctx, ast) == NULL && dice_has_error(ctx), "Compiler rejects depth 512");
+    dice_clear_error(ctx);
+    
+    dice_policy_t policy = ctx->policy;
+    policy.max_depth = 0;
+    dice_context_set_policy(ctx, &policy);
+    result = dice_evaluate(ctx, ast);
+    TEST_ASSERT(result.success && result.value == 513, "Zero means unlimited");
+    
+    // Constants fold away, so the interpreter's check needs dice
+    text = nest("1d2+(", ")", 512);
+    program = dice_compile(ctx, dice_parse(ctx, text));
+    TEST_ASSERT(program != NULL, "Unlimited nesting compiles");
+    free(text);
+    policy.max_depth = 256;
+    dice_context_set_policy(ctx, &policy);
+    TEST_ASSERT(!dice_program_evaluate(ctx, program).success && dice_has_error(ctx),
+                "Program interpreter enforces the depth limit");
+    dice_clear_error(ctx);
+    dice_program_destroy(program);
+    free(nodes);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+#ifndef _WIN32
+typedef struct {
+    dice_context_t *ctx;
+    const dice_ast_node_t *ast;
+    const char *chain;
+    dice_eval_result_t result;
+    bool passes_ok;
+} stack_worker_t;
+
+static void* stack_worker(void *arg) {
+    stack_worker_t *worker = arg;
+    worker->result = dice_evaluate(worker->ctx, worker->ast);
+    
+    // Every pass over parsed input loops along a chain instead of recursing
+    dice_ast_node_t *chain = dice_parse(worker->ctx, worker->chain);
+    dice_program_t *program = chain ? dice_compile(worker->ctx, chain) : NULL;
+    worker->passes_ok = chain && program && dice_program_evaluate(worker->ctx, program).success &&
+                        dice_bind_custom_dice(worker->ctx, chain) == 0 &&
+                        dice_optimize(worker->ctx, chain) == 0 && dice_evaluate(worker->ctx, chain).success;
+    dice_program_destroy(program);
+    
+    dice_distribution_t *dist = chain ? dice_analyze(worker->ctx, dice_parse(worker->ctx, "1+1+1+1+1+1+1+1")) : NULL;
+    worker->passes_ok = worker->passes_ok && dist != NULL;
+    dice_distribution_destroy(dist);
+    return NULL;
+}
+#endif
+
+int test_eval_stack_small_thread() {
+#ifndef _WIN32
+    enum { LEVELS = 200000 };
+    dice_context_t *ctx = stack_context(4);
+    dice_policy_t policy = ctx->policy;
+    policy.max_depth = 0;
+    policy.max_nodes = 0;
+    dice_context_set_policy(ctx, &policy);
+    
+    // Far deeper than a recursive walk could go in 128 KiB of stack
+    dice_ast_node_t *nodes = calloc(2 * LEVELS + 2, sizeof(dice_ast_node_t));
+    char *chain = repeat_chain("1d6", 20000);
+    stack_worker_t worker = {ctx, right_nested(nodes, LEVELS), chain, {0, false}, false};
+    
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, 128 * 1024);
+    pthread_t thread;
+    TEST_ASSERT(pthread_create(&thread, &attr, stack_worker, &worker) == 0, "Small-stack thread started");
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attr);
+    TEST_ASSERT(worker.result.success && worker.result.value == LEVELS + 1,
+                "Deep tree evaluates on a small stack");
+    TEST_ASSERT(worker.passes_ok, "Long chain parses, compiles, binds and optimizes on a small stack");
+    
+    // The frames went to the arena, not the thread's stack
+    TEST_ASSERT(dice_arena_mark(ctx) > (size_t)LEVELS * 24, "Evaluation stack grew into the arena");
+    
+    free(chain);
+    free(nodes);
+    dice_context_destroy(ctx);
+#endif
+    return 1;
+}
+
+int main() {
+    printf("Running iterative evaluator tests...\n\n");
+    
+    RUN_TEST(test_eval_stack_matches_program);
+    RUN_TEST(test_eval_stack_long_chain);
+    RUN_TEST(test_eval_stack_depth_limit);
+    RUN_TEST(test_eval_stack_small_thread);
+    
+    printf("All iterative evaluator tests passed!\n");
+    return 0;
+}
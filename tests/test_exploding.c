@@ -0,0 +1,250 @@
+#include "test_common.h"
+
+// =============================================================================
+// Exploding Dice Tests (!, !!, !>N)
+// =============================================================================
+
+// Roll without letting parse nodes and trace entries pile up in the arena
+static dice_eval_result_t roll(dice_context_t *ctx, const char *expression) {
+    dice_clear_trace(ctx);
+    size_t mark = dice_arena_mark(ctx);
+    dice_eval_result_t result = dice_roll_expression(ctx, expression);
+    dice_arena_rewind(ctx, mark);
+    return result;
+}
+
+static int set_explosion_depth(dice_context_t *ctx, int depth) {
+    dice_policy_t policy = ctx->policy;
+    policy.max_explosion_depth = depth;
+    return dice_context_set_policy(ctx, &policy);
+}
+
+int test_exploding_parse() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    
+    dice_ast_node_t *ast = dice_parse(ctx, "3d6!");
+    TEST_ASSERT(ast && ast->type == DICE_NODE_DICE_OP, "3d6! parses to a dice node");
+    TEST_ASSERT(ast->data.dice_op.dice_type == DICE_DICE_EXPLODING, "3d6! is an exploding die");
+    TEST_ASSERT(ast->data.dice_op.modifier == NULL, "3d6! explodes on the maximum face");
+    TEST_ASSERT(!ast->data.dice_op.compounding, "3d6! does not compound");
+    
+    ast = dice_parse(ctx, "2d10!!>8");
+    TEST_ASSERT(ast && ast->data.dice_op.dice_type == DICE_DICE_EXPLODING, "2d10!!>8 parses");
+    TEST_ASSERT(ast->data.dice_op.compounding, "!! compounds");
+    TEST_ASSERT(ast->data.dice_op.modifier && ast->data.dice_op.modifier->data.literal.value == 8,
+                "!!>8 records the threshold");
+    
+    ast = dice_parse(ctx, "1d6! + 2");
+    TEST_ASSERT(ast && ast->type == DICE_NODE_BINARY_OP, "Exploding dice combine with arithmetic");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_exploding_depth_limit() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    
+    // Every face of a d1 explodes, so the chain always runs to the limit
+    dice_eval_result_t result = dice_roll_expression(ctx, "1d1!");
+    TEST_ASSERT(result.success && result.value == 11, "1d1! stops after the default 10 explosions");
+    
+    TEST_ASSERT(set_explosion_depth(ctx, 3) == 0, "Explosion depth can be lowered");
+    result = dice_roll_expression(ctx, "2d1!");
+    TEST_ASSERT(result.success && result.value == 8, "2d1! honors max_explosion_depth");
+    
+    TEST_ASSERT(set_explosion_depth(ctx, 0) == 0, "Explosions can be disabled");
+    for (int i = 0; i < 200; i++) {
+        result = roll(ctx, "1d6!");
+        TEST_ASSERT(result.success && result.value >= 1 && result.value <= 6,
+                    "1d6! with depth 0 is a plain d6");
+    }
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_exploding_threshold() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(7);
+    dice_context_set_rng(ctx, &rng);
+    
+    bool saw_explosion = false;
+    for (int i = 0; i < 2000; i++) {
+        dice_eval_result_t result = roll(ctx, "1d6!>7");
+        TEST_ASSERT(result.success && result.value >= 1 && result.value <= 6,
+                    "A threshold above the sides never explodes");
+        
+        result = roll(ctx, "1d6!>4");
+        TEST_ASSERT(result.success && result.value >= 1, "1d6!>4 succeeds");
+        // Totals above 6 need at least one explosion
+        if (result.value > 6) saw_explosion = true;
+    }
+    TEST_ASSERT(saw_explosion, "1d6!>4 explodes");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_exploding_mean() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(2024);
+    dice_context_set_rng(ctx, &rng);
+    dice_context_set_trace_level(ctx, DICE_TRACE_OFF);
+    
+    // E[d6!] = 3.5 / (1 - 1/6) = 4.2 (the depth limit changes it by < 1e-7)
+    const int samples = 200000;
+    double total = 0.0;
+    for (int i = 0; i < samples; i++) {
+        dice_eval_result_t result = roll(ctx, "1d6!");
+        TEST_ASSERT(result.success, "1d6! sample succeeds");
+        total += (double)result.value;
+    }
+    double mean = total / samples;
+    TEST_ASSERT(fabs(mean - 4.2) < 0.03, "Mean of 1d6! is close to 4.2");
+    
+    // Explosions on 5+ happen a third of the time: E = 3.5 / (2/3) ~ 5.25
+    total = 0.0;
+    for (int i = 0; i < samples; i++) {
+        total += (double)roll(ctx, "1d6!>5").value;
+    }
+    mean = total / samples;
+    TEST_ASSERT(fabs(mean - 5.25) < 0.04, "Mean of 1d6!>5 is close to 5.25");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_exploding_mean_default_engine() {
+    // Chain lengths need 53-bit uniforms, which rand() alone cannot supply
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng = dice_create_system_rng(2024);
+    dice_context_set_rng(ctx, &rng);
+    dice_context_set_trace_level(ctx, DICE_TRACE_OFF);
+    
+    // E[3d6!] = 3 * 4.2 = 12.6
+    const int samples = 100000;
+    double total = 0.0;
+    for (int i = 0; i < samples; i++) {
+        total += (double)roll(ctx, "3d6!").value;
+    }
+    double mean = total / samples;
+    TEST_ASSERT(fabs(mean - 12.6) < 0.1, "Mean of 3d6! on the default engine is close to 12.6");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_exploding_trace() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    TEST_ASSERT(set_explosion_depth(ctx, 4) == 0, "Explosion depth set");
+    
+    dice_eval_result_t result = dice_roll_expression(ctx, "1d1!");
+    TEST_ASSERT(result.success && result.value == 5, "1d1! with depth 4 totals 5");
+    const dice_trace_t *trace = dice_get_trace(ctx);
+    TEST_ASSERT(trace->count == 5, "Each exploded roll is traced");
+    TEST_ASSERT(trace->summary.dice_rolled == 5, "Summary counts exploded rolls");
+    
+    dice_clear_trace(ctx);
+    result = dice_roll_expression(ctx, "1d1!!");
+    TEST_ASSERT(result.success && result.value == 5, "1d1!! with depth 4 totals 5");
+    trace = dice_get_trace(ctx);
+    TEST_ASSERT(trace->count == 1, "Compounding dice trace one entry per die");
+    TEST_ASSERT(trace->first->data.atomic_roll.result == 5, "The compounded entry holds the total");
+    TEST_ASSERT(trace->summary.dice_rolled == 5, "Summary still counts every roll");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_exploding_compiled_matches_tree() {
+    const char *expressions[] = {"500d6!", "3d6!!>5 + 2", "(1d4)d8!", "4d2!"};
+    dice_context_t *a = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_context_t *b = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    
+    for (size_t e = 0; e < sizeof(expressions) / sizeof(expressions[0]); e++) {
+        dice_rng_vtable_t rng_a = dice_create_xoshiro_rng(99 + e);
+        dice_rng_vtable_t rng_b = dice_create_xoshiro_rng(99 + e);
+        dice_context_set_rng(a, &rng_a);
+        dice_context_set_rng(b, &rng_b);
+        
+        dice_ast_node_t *ast = dice_parse(b, expressions[e]);
+        TEST_ASSERT(ast != NULL, "Expression parses");
+        dice_program_t *program = dice_compile(b, ast);
+        TEST_ASSERT(program != NULL, "Exploding expression compiles");
+        
+        bool same = true;
+        for (int i = 0; i < 100 && same; i++) {
+            size_t mark = dice_arena_mark(b);
+            dice_eval_result_t tree = roll(a, expressions[e]);
+            dice_eval_result_t compiled = dice_program_evaluate(b, program);
+            same = tree.success && compiled.success && tree.value == compiled.value;
+            dice_clear_trace(b);
+            dice_arena_rewind(b, mark);
+        }
+        TEST_ASSERT(same, "Compiled exploding dice match the tree evaluator");
+        dice_program_destroy(program);
+    }
+    
+    dice_context_destroy(a);
+    dice_context_destroy(b);
+    return 1;
+}
+
+int test_exploding_distribution() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    
+    dice_ast_node_t *ast = dice_parse(ctx, "1d6!");
+    dice_distribution_t *dist = ast ? dice_analyze(ctx, ast) : NULL;
+    TEST_ASSERT(dist != NULL, "1d6! has an exact distribution");
+    TEST_ASSERT(fabs(dice_distribution_probability(dist, 1) - 1.0 / 6.0) < 1e-12, "P(1) = 1/6");
+    TEST_ASSERT(dice_distribution_probability(dist, 6) == 0.0, "A total of 6 always explodes");
+    TEST_ASSERT(fabs(dice_distribution_probability(dist, 7) - 1.0 / 36.0) < 1e-12, "P(7) = 1/36");
+    TEST_ASSERT(fabs(dice_distribution_mean(dist) - 4.2) < 1e-6, "Exact mean of 1d6! is 4.2");
+    dice_distribution_destroy(dist);
+    
+    ast = dice_parse(ctx, "2d1!");
+    dist = ast ? dice_analyze(ctx, ast) : NULL;
+    TEST_ASSERT(dist && dist->size == 1 && dist->min_value == 22, "2d1! is the constant 22");
+    dice_distribution_destroy(dist);
+    
+    ast = dice_parse(ctx, "3d6!>5");
+    dist = ast ? dice_analyze(ctx, ast) : NULL;
+    TEST_ASSERT(dist != NULL, "3d6!>5 has an exact distribution");
+    TEST_ASSERT(fabs(dice_distribution_mean(dist) - 3.0 * 5.25) < 1e-3, "Mean of 3d6!>5 is about 15.75");
+    dice_distribution_destroy(dist);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_exploding_syntax_errors() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    const char *invalid[] = {"1d6!>", "1d6!>1", "1d6!>0", "4dF!", "1d{1,2}!", "4d6!k3", "4d6!r1"};
+    
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        dice_eval_result_t result = dice_roll_expression(ctx, invalid[i]);
+        TEST_ASSERT(!result.success, invalid[i]);
+        TEST_ASSERT(dice_has_error(ctx), "Invalid exploding syntax sets an error");
+        dice_clear_error(ctx);
+    }
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int main() {
+    printf("Running exploding dice tests...\n\n");
+    
+    RUN_TEST(test_exploding_parse);
+    RUN_TEST(test_exploding_depth_limit);
+    RUN_TEST(test_exploding_threshold);
+    RUN_TEST(test_exploding_mean);
+    RUN_TEST(test_exploding_mean_default_engine);
+    RUN_TEST(test_exploding_trace);
+    RUN_TEST(test_exploding_compiled_matches_tree);
+    RUN_TEST(test_exploding_distribution);
+    RUN_TEST(test_exploding_syntax_errors);
+    
+    printf("All exploding dice tests passed!\n");
+    return 0;
+}
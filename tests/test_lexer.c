@@ -0,0 +1,180 @@
+#include "test_common.h"
+
+// =============================================================================
+// Lexer and Length-Delimited Parsing Tests
+// =============================================================================
+
+static const char *expressions[] = {
+    "3d6+2", "(2+1)d6", "2d(4*2)", "4d6k3", "4d6 l", "10d6s>=4", "10d6s", "4d6r<2",
+    "4d6r==1", "10d10>8", "1d6!!>4", "4dF", "1d{-1,0:\"blank\"*2,1}", "-3 * (1d4 + 2) / 2",
+    "  2 D 6\t+\n1  "
+};
+#define EXPRESSION_COUNT (sizeof(expressions) / sizeof(expressions[0]))
+
+// Roll an AST from a freshly seeded generator
+static int64_t roll_seeded(dice_context_t *ctx, dice_ast_node_t *ast, uint64_t seed) {
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(seed);
+    dice_context_set_rng(ctx, &rng);
+    size_t mark = dice_arena_mark(ctx);
+    dice_eval_result_t result = dice_evaluate(ctx, ast);
+    dice_clear_trace(ctx);
+    dice_arena_rewind(ctx, mark);
+    return result.success ? result.value : INT64_MIN;
+}
+
+int test_parse_n_matches_parse() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_custom_side_t fate[] = {{-1, NULL, 1}, {0, NULL, 1}, {1, NULL, 1}};
+    dice_register_custom_die(ctx, "F", fate, 3);
+    
+    for (size_t i = 0; i < EXPRESSION_COUNT; i++) {
+        dice_ast_node_t *whole = dice_parse(ctx, expressions[i]);
+        dice_ast_node_t *sized = dice_parse_n(ctx, expressions[i], strlen(expressions[i]));
+        TEST_ASSERT(whole != NULL && sized != NULL, "Both entry points parse the expression");
+        
+        for (uint64_t seed = 1; seed <= 20; seed++) {
+            TEST_ASSERT(roll_seeded(ctx, whole, seed) == roll_seeded(ctx, sized, seed),
+                        "Both ASTs roll the same");
+        }
+    }
+    
+    TEST_ASSERT(dice_parse_n(ctx, "", 0) == NULL && dice_has_error(ctx), "Empty input is an error");
+    dice_clear_error(ctx);
+    TEST_ASSERT(dice_parse_n(ctx, NULL, 0) == NULL, "NULL input is rejected");
+    dice_clear_error(ctx);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_parse_n_buffer_slices() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    
+    // Not NUL-terminated: the bytes after the slice must never be read
+    char buffer[] = {'2', 'd', '6', '+', '1', '0', '0', 'x', 'x'};
+    dice_ast_node_t *ast = dice_parse_n(ctx, buffer, 5);
+    TEST_ASSERT(ast != NULL, "Slice of a larger buffer parses");
+    for (uint64_t seed = 1; seed <= 20; seed++) {
+        int64_t value = roll_seeded(ctx, ast, seed);
+        TEST_ASSERT(value >= 3 && value <= 13, "Slice parsed as 2d6+1");
+    }
+    
+    // A keep count defaults to 1 when the slice ends right after the letter
+    ast = dice_parse_n(ctx, "4d6k3", 4);
+    TEST_ASSERT(ast && ast->data.dice_op.selection && ast->data.dice_op.selection->count == 1,
+                "Keep at the end of a slice keeps one die");
+    
+    // Labels and names are copied out of the input
+    char text[] = "1d{7:\"seven\"}";
+    ast = dice_parse_n(ctx, text, strlen(text));
+    TEST_ASSERT(ast != NULL, "Labelled die parses");
+    memset(text, '#', strlen(text));
+    TEST_ASSERT(strcmp(ast->data.dice_op.custom_die->sides[0].label, "seven") == 0,
+                "Label survives the input buffer");
+    
+    // Embedded NUL bytes are stray characters
+    const char embedded[] = {'1', 'd', '6', '\0', '+', '1'};
+    TEST_ASSERT(dice_parse_n(ctx, embedded, sizeof(embedded)) == NULL && dice_has_error(ctx),
+                "Embedded NUL is rejected");
+    dice_clear_error(ctx);
+    
+    // A string closed only past the slice is unterminated
+    TEST_ASSERT(dice_parse_n(ctx, "1d{\"a\"}", 5) == NULL, "String cut by the slice is rejected");
+    TEST_ASSERT(strstr(dice_get_error(ctx), "Unterminated") != NULL, "Unterminated string reported");
+    dice_clear_error(ctx);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_lexer_large_custom_die() {
+    dice_context_t *ctx = dice_context_create(256 * 1024, DICE_FEATURE_ALL);
+    
+    // Far more sides than fit in the parser's local buffer
+    char text[8192];
+    size_t length = (size_t)snprintf(text, sizeof(text), "1d{");
+    for (int side = 1; side <= 500; side++) {
+        length += (size_t)snprintf(text + length, sizeof(text) - length, "%d:\"s%d\"*%d,",
+                                   side, side, side % 3 + 1);
+    }
+    length += (size_t)snprintf(text + length, sizeof(text) - length, "}");
+    
+    dice_ast_node_t *ast = dice_parse_n(ctx, text, length);
+    TEST_ASSERT(ast != NULL, "500-sided inline die parses");
+    
+    const dice_custom_die_t *die = ast->data.dice_op.custom_die;
+    TEST_ASSERT(die->side_count == 500, "Every side is kept");
+    bool sides_ok = true;
+    for (size_t i = 0; i < die->side_count; i++) {
+        char label[24];  // "s" and any size_t
+        snprintf(label, sizeof(label), "s%zu", i + 1);
+        if (die->sides[i].value != (int64_t)(i + 1) || strcmp(die->sides[i].label, label) != 0 ||
+            die->sides[i].weight != (i + 1) % 3 + 1) {
+            sides_ok = false;
+        }
+    }
+    TEST_ASSERT(sides_ok, "Sides keep their order, labels and weights");
+    
+    for (uint64_t seed = 1; seed <= 50; seed++) {
+        int64_t value = roll_seeded(ctx, ast, seed);
+        TEST_ASSERT(value >= 1 && value <= 500, "Large die rolls in range");
+    }
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_lexer_errors() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    
+    TEST_ASSERT(dice_parse(ctx, "9223372036854775807") != NULL, "INT64_MAX is a valid literal");
+    TEST_ASSERT(dice_parse(ctx, "9223372036854775808") == NULL, "Overflowing literal is rejected");
+    TEST_ASSERT(strstr(dice_get_error(ctx), "Number too large") != NULL, "Overflow reported");
+    dice_clear_error(ctx);
+    
+    TEST_ASSERT(dice_parse(ctx, "1d{1:\"open}") == NULL, "Unterminated label is rejected");
+    TEST_ASSERT(strstr(dice_get_error(ctx), "Unterminated") != NULL, "Unterminated label reported");
+    dice_clear_error(ctx);
+    
+    TEST_ASSERT(dice_parse(ctx, "1d{1:two}") == NULL, "Unquoted label is rejected");
+    dice_clear_error(ctx);
+    TEST_ASSERT(dice_parse(ctx, "1d{-}") == NULL, "Lone minus is rejected");
+    dice_clear_error(ctx);
+    
+    // The first error of a parse is the one reported
+    TEST_ASSERT(dice_parse(ctx, "2d6 +") == NULL, "Dangling operator is rejected");
+    TEST_ASSERT(strcmp(dice_get_error(ctx), "Expected expression after operator") == 0,
+                "Dangling operator reported");
+    dice_clear_error(ctx);
+    
+    // ...but an operand's own error is not replaced by the generic one
+    TEST_ASSERT(dice_parse(ctx, "1+99999999999999999999") == NULL, "Overflowing operand is rejected");
+    TEST_ASSERT(strstr(dice_get_error(ctx), "Number too large") != NULL, "Operand overflow reported");
+    dice_clear_error(ctx);
+    TEST_ASSERT(dice_parse(ctx, "2*1d{1:\"open}") == NULL, "Bad operand die is rejected");
+    TEST_ASSERT(strstr(dice_get_error(ctx), "Unterminated") != NULL, "Operand label error reported");
+    dice_clear_error(ctx);
+    TEST_ASSERT(dice_parse(ctx, "1+(2*)") == NULL, "Nested dangling operator is rejected");
+    TEST_ASSERT(strcmp(dice_get_error(ctx), "Expected expression after operator") == 0,
+                "Nested dangling operator reported");
+    dice_clear_error(ctx);
+    
+    TEST_ASSERT(dice_parse(ctx, "2d6 1d4") == NULL, "Trailing input is rejected");
+    TEST_ASSERT(strstr(dice_get_error(ctx), "'1d4'") != NULL, "Trailing input quoted in the error");
+    dice_clear_error(ctx);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int main() {
+    printf("Running lexer tests...\n\n");
+    
+    RUN_TEST(test_parse_n_matches_parse);
+    RUN_TEST(test_parse_n_buffer_slices);
+    RUN_TEST(test_lexer_large_custom_die);
+    RUN_TEST(test_lexer_errors);
+    
+    printf("All lexer tests passed!\n");
+    return 0;
+}
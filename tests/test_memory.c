@@ -167,6 +167,82 @@ int test_zero_arena_size() {
     return 1;
 }
 
+int test_arena_growth() {
+    // A tiny fixed arena fails; the same arena with growth enabled succeeds
+    const char *expr = "1d6+1d6+1d6+1d6+1d6+1d6+1d6+1d6+1d6+1d6+1d6+1d6+1d6+1d6+1d6+1d6";
+    dice_context_t *ctx = dice_context_create(64, DICE_FEATURE_ALL);
+    
+    dice_eval_result_t result = dice_roll_expression(ctx, expr);
+    TEST_ASSERT(!result.success, "Fixed 64-byte arena cannot hold the expression");
+    
+    dice_clear_error(ctx);
+    dice_context_reset(ctx);
+    TEST_ASSERT(dice_context_set_arena_growth(ctx, 256) == 0, "Arena growth enabled");
+    result = dice_roll_expression(ctx, expr);
+    TEST_ASSERT(result.success, "Growable arena holds the expression");
+    TEST_ASSERT(result.value >= 16 && result.value <= 96, "Result is valid across chunks");
+    TEST_ASSERT(dice_arena_mark(ctx) > ctx->arena_size, "Allocations spilled into growth chunks");
+    
+    // A single request larger than the chunk size gets its own chunk
+    dice_context_reset(ctx);
+    result = dice_roll_expression(ctx, "200d6k3");
+    TEST_ASSERT(result.success, "Oversized scratch request is served by a dedicated chunk");
+    
+    TEST_ASSERT(dice_context_set_arena_growth(NULL, 256) == -1, "NULL context is rejected");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_arena_mark_rewind() {
+    dice_context_t *ctx = dice_context_create(128, DICE_FEATURE_ALL);
+    dice_context_set_arena_growth(ctx, 128);
+    
+    dice_ast_node_t *kept = dice_parse(ctx, "2d6+3");
+    TEST_ASSERT(kept != NULL, "AST parsed before the mark");
+    size_t mark = dice_arena_mark(ctx);
+    
+    // Scratch work after the mark, spilling into growth chunks
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT(dice_parse(ctx, "1d4+1d6+1d8+1d10+1d12") != NULL, "Scratch parse succeeds");
+    }
+    size_t high_water = dice_arena_mark(ctx);
+    TEST_ASSERT(high_water > mark, "Scratch work advanced the arena");
+    
+    dice_arena_rewind(ctx, mark);
+    TEST_ASSERT(dice_arena_mark(ctx) == mark, "Rewind restores the mark");
+    
+    dice_eval_result_t result = dice_evaluate(ctx, kept);
+    TEST_ASSERT(result.success && result.value >= 5 && result.value <= 15, "AST before the mark is intact");
+    
+    // Replaying the same work reuses the retained chunks and lands at the same offset
+    dice_clear_trace(ctx);
+    dice_arena_rewind(ctx, mark);
+    for (int i = 0; i < 10; i++) {
+        dice_parse(ctx, "1d4+1d6+1d8+1d10+1d12");
+    }
+    TEST_ASSERT(dice_arena_mark(ctx) == high_water, "Retained chunks are reused after rewind");
+    
+    dice_arena_rewind(ctx, high_water + 1000);
+    TEST_ASSERT(dice_arena_mark(ctx) == high_water, "Rewinding forward is ignored");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_filter_scratch_reclaimed() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_ast_node_t *ast = dice_parse(ctx, "50d6k3");
+    int64_t values[100];
+    
+    size_t before = dice_arena_mark(ctx);
+    TEST_ASSERT(dice_evaluate_batch(ctx, ast, 100, values) == 0, "Untraced keep rolls succeed");
+    TEST_ASSERT(dice_arena_mark(ctx) == before, "Keep/drop scratch is reclaimed without tracing");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
 // =============================================================================
 // Memory Leak and Resource Tests
 // =============================================================================
@@ -298,6 +374,9 @@ int main() {
     RUN_TEST(test_arena_allocator_reuse);
     RUN_TEST(test_large_arena_handling);
     RUN_TEST(test_zero_arena_size);
+    RUN_TEST(test_arena_growth);
+    RUN_TEST(test_arena_mark_rewind);
+    RUN_TEST(test_filter_scratch_reclaimed);
     RUN_TEST(test_context_cleanup_completeness);
     RUN_TEST(test_rng_cleanup);
     RUN_TEST(test_trace_memory_management);
@@ -0,0 +1,144 @@
+#include "test_common.h"
+
+// =============================================================================
+// AST Optimizer Tests
+// =============================================================================
+
+static dice_ast_node_t* parse_optimized(dice_context_t *ctx, const char *expr) {
+    dice_ast_node_t *ast = dice_parse(ctx, expr);
+    if (!ast || dice_optimize(ctx, ast) != 0) return NULL;
+    return ast;
+}
+
+static bool is_dice(const dice_ast_node_t *node, int64_t count, int64_t sides) {
+    if (!node || node->type != DICE_NODE_DICE_OP) return false;
+    const dice_ast_node_t *count_node = node->data.dice_op.count;
+    const dice_ast_node_t *sides_node = node->data.dice_op.sides;
+    return count_node && count_node->type == DICE_NODE_LITERAL && count_node->data.literal.value == count &&
+           sides_node && sides_node->type == DICE_NODE_LITERAL && sides_node->data.literal.value == sides;
+}
+
+static size_t trace_length(const dice_context_t *ctx) {
+    size_t length = 0;
+    for (const dice_trace_entry_t *e = dice_get_trace(ctx)->first; e; e = e->next) length++;
+    return length;
+}
+
+int test_optimize_constant_folding() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    
+    dice_ast_node_t *ast = parse_optimized(ctx, "2*3+4-(8/2)");
+    TEST_ASSERT(ast && ast->type == DICE_NODE_LITERAL && ast->data.literal.value == 6, "Literal arithmetic folds");
+    
+    ast = parse_optimized(ctx, "(2+1)d(4*2)+0");
+    TEST_ASSERT(is_dice(ast, 3, 8), "Constant count and sides become literals and +0 is dropped");
+    
+    ast = parse_optimized(ctx, "1*(1d6-0)/1");
+    TEST_ASSERT(ast && ast->type == DICE_NODE_DICE_OP, "Identity operations are removed");
+    
+    ast = parse_optimized(ctx, "1d20+2+3-1");
+    TEST_ASSERT(ast && ast->type == DICE_NODE_BINARY_OP && ast->data.binary_op.op == DICE_OP_ADD &&
+                ast->data.binary_op.right->type == DICE_NODE_LITERAL &&
+                ast->data.binary_op.right->data.literal.value == 4, "Constants of a sum are collected");
+    
+    ast = parse_optimized(ctx, "1d20+3-3");
+    TEST_ASSERT(ast && ast->type == DICE_NODE_DICE_OP, "Cancelling constants disappear");
+    
+    // Errors stay errors
+    ast = parse_optimized(ctx, "1d6+10/0");
+    TEST_ASSERT(ast != NULL, "Division by zero still optimizes");
+    dice_eval_result_t result = dice_evaluate(ctx, ast);
+    TEST_ASSERT(!result.success && dice_has_error(ctx), "Division by zero still fails at evaluation");
+    dice_clear_error(ctx);
+    
+    ast = parse_optimized(ctx, "9223372036854775807+1");
+    TEST_ASSERT(ast && ast->type == DICE_NODE_BINARY_OP, "Overflowing folds are left alone");
+    
+    TEST_ASSERT(dice_optimize(ctx, NULL) == -1 && dice_has_error(ctx), "NULL AST rejected");
+    dice_clear_error(ctx);
+    TEST_ASSERT(dice_optimize(NULL, NULL) == -1, "NULL context rejected");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_optimize_merges_dice() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    
+    TEST_ASSERT(is_dice(parse_optimized(ctx, "1d6+1d6+1d6"), 3, 6), "Repeated dice merge");
+    TEST_ASSERT(is_dice(parse_optimized(ctx, "d6+d6"), 2, 6), "Implicit counts merge");
+    
+    dice_ast_node_t *ast = parse_optimized(ctx, "1d6+2+1d6+3");
+    TEST_ASSERT(ast && ast->type == DICE_NODE_BINARY_OP && is_dice(ast->data.binary_op.left, 2, 6) &&
+                ast->data.binary_op.right->data.literal.value == 5, "Constants between dice do not block merging");
+    
+    ast = parse_optimized(ctx, "-1d6-1d6");
+    TEST_ASSERT(ast && ast->type == DICE_NODE_BINARY_OP && ast->data.binary_op.op == DICE_OP_SUB &&
+                is_dice(ast->data.binary_op.right, 2, 6), "Subtracted dice merge");
+    
+    ast = parse_optimized(ctx, "1d6-1d6");
+    TEST_ASSERT(ast && ast->type == DICE_NODE_BINARY_OP, "Dice of opposite sign do not merge");
+    
+    ast = parse_optimized(ctx, "1d6+1d8+1d6");
+    TEST_ASSERT(ast && ast->type == DICE_NODE_BINARY_OP && ast->data.binary_op.left->type == DICE_NODE_BINARY_OP,
+                "Dice are not reordered to merge");
+    
+    ast = parse_optimized(ctx, "4d6k3+4d6k3");
+    TEST_ASSERT(ast && ast->type == DICE_NODE_BINARY_OP, "Selections do not merge");
+    
+    ast = parse_optimized(ctx, "600d6+600d6");
+    TEST_ASSERT(ast && ast->type == DICE_NODE_BINARY_OP, "Merges never exceed the dice count policy");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_optimize_preserves_results() {
+    const char *expressions[] = {
+        "1d6+1d6+1d6",
+        "(2+1)d(4*2)+0",
+        "2d6+1+1d6*1-0+3",
+        "-1d4-1d4+10",
+        "4d6k3+1d6+1d6",
+        "(1d4)d6+2d6+2d6",
+    };
+    
+    for (size_t i = 0; i < sizeof(expressions) / sizeof(expressions[0]); i++) {
+        dice_context_t *plain = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+        dice_context_t *optimized = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+        dice_rng_vtable_t a = dice_create_xoshiro_rng(77 + i);
+        dice_rng_vtable_t b = dice_create_xoshiro_rng(77 + i);
+        dice_context_set_rng(plain, &a);
+        dice_context_set_rng(optimized, &b);
+        
+        dice_ast_node_t *original = dice_parse(plain, expressions[i]);
+        dice_ast_node_t *simplified = parse_optimized(optimized, expressions[i]);
+        TEST_ASSERT(original && simplified, "Expression parses and optimizes");
+        
+        bool same = true;
+        for (int roll = 0; roll < 200 && same; roll++) {
+            dice_clear_trace(plain);
+            dice_clear_trace(optimized);
+            dice_eval_result_t x = dice_evaluate(plain, original);
+            dice_eval_result_t y = dice_evaluate(optimized, simplified);
+            same = x.success && y.success && x.value == y.value &&
+                   trace_length(plain) == trace_length(optimized);
+        }
+        TEST_ASSERT(same, "Optimized tree rolls the same values and trace");
+        
+        dice_context_destroy(plain);
+        dice_context_destroy(optimized);
+    }
+    return 1;
+}
+
+int main() {
+    printf("Running AST optimizer tests...\n\n");
+    
+    RUN_TEST(test_optimize_constant_folding);
+    RUN_TEST(test_optimize_merges_dice);
+    RUN_TEST(test_optimize_preserves_results);
+    
+    printf("All AST optimizer tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include "test_common.h"
+
+int test_cache_hits_and_misses() {
+    dice_context_t *ctx = dice_context_create(SMALL_ARENA_SIZE * 8, DICE_FEATURE_ALL);
+    dice_parse_cache_t *cache = dice_parse_cache_create(8);
+    TEST_ASSERT(cache != NULL, "Cache created");
+    
+    const dice_program_t *first = dice_parse_cache_get(cache, ctx, "3d6+2");
+    TEST_ASSERT(first != NULL, "First lookup compiles the expression");
+    const dice_program_t *second = dice_parse_cache_get(cache, ctx, "3d6+2");
+    TEST_ASSERT(second == first, "Second lookup returns the cached program");
+    const dice_program_t *spaced = dice_parse_cache_get(cache, ctx, "  3d6+2\t");
+    TEST_ASSERT(spaced == first, "Surrounding whitespace is normalized away");
+    
+    dice_parse_cache_stats_t stats = dice_parse_cache_get_stats(cache);
+    TEST_ASSERT(stats.hits == 2, "Two hits recorded");
+    TEST_ASSERT(stats.misses == 1, "One miss recorded");
+    TEST_ASSERT(stats.entries == 1 && stats.capacity == 8, "One entry cached");
+    TEST_ASSERT(ctx->arena_used == 0, "Miss releases its parse scratch");
+    
+    TEST_ASSERT(dice_parse_cache_get(cache, ctx, "3d") == NULL, "Parse errors are not cached");
+    TEST_ASSERT(dice_has_error(ctx), "Parse error is reported on the context");
+    TEST_ASSERT(dice_parse_cache_get_stats(cache).entries == 1, "Failed lookup adds no entry");
+    
+    dice_parse_cache_destroy(cache);
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_cache_keeps_quoted_labels() {
+    dice_context_t *ctx = dice_context_create(SMALL_ARENA_SIZE * 8, DICE_FEATURE_ALL);
+    dice_parse_cache_t *cache = dice_parse_cache_create(8);
+    
+    const dice_program_t *wide = dice_parse_cache_get(cache, ctx, "1d{1:\"a  b\"}");
+    const dice_program_t *narrow = dice_parse_cache_get(cache, ctx, "1d{1:\"a b\"}");
+    TEST_ASSERT(wide && narrow && wide != narrow, "Whitespace inside a label distinguishes entries");
+    const dice_program_t *spaced = dice_parse_cache_get(cache, ctx, " 1d{1:\"a  b\"}\t");
+    TEST_ASSERT(spaced == wide, "Whitespace outside the label is still normalized");
+    TEST_ASSERT(dice_parse_cache_get_stats(cache).entries == 2, "Two entries cached");
+    
+    dice_parse_cache_destroy(cache);
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_cache_keeps_other_whitespace() {
+    dice_context_t *cached_ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_context_t *plain_ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_parse_cache_t *cache = dice_parse_cache_create(16);
+    dice_context_set_parse_cache(cached_ctx, cache);
+    
+    // Keep/drop counts may follow a space or tab, but not other whitespace
+    const char *expressions[] = {"4d6k\n3", "4d6k\r3", "4d6k\v3", "4d6k\f3", "4d6k\t3", "4d6k 3", "4d6 +\n1"};
+    bool agree = true;
+    for (size_t i = 0; i < sizeof(expressions) / sizeof(expressions[0]); i++) {
+        dice_rng_vtable_t cached_rng = dice_create_xoshiro_rng(7 + i);
+        dice_rng_vtable_t plain_rng = dice_create_xoshiro_rng(7 + i);
+        dice_context_set_rng(cached_ctx, &cached_rng);
+        dice_context_set_rng(plain_ctx, &plain_rng);
+        dice_eval_result_t expected = dice_roll_expression(plain_ctx, expressions[i]);
+        dice_eval_result_t actual = dice_roll_expression(cached_ctx, expressions[i]);
+        if (expected.success != actual.success || expected.value != actual.value) agree = false;
+        dice_clear_error(plain_ctx);
+        dice_clear_error(cached_ctx);
+        dice_clear_trace(plain_ctx);
+        dice_clear_trace(cached_ctx);
+    }
+    TEST_ASSERT(agree, "Cached and uncached rolls agree on every kind of whitespace");
+    
+    dice_context_set_parse_cache(cached_ctx, NULL);
+    dice_parse_cache_destroy(cache);
+    dice_context_destroy(cached_ctx);
+    dice_context_destroy(plain_ctx);
+    return 1;
+}
+
+int test_cache_lru_eviction() {
+    dice_context_t *ctx = dice_context_create(SMALL_ARENA_SIZE * 8, DICE_FEATURE_ALL);
+    dice_parse_cache_t *cache = dice_parse_cache_create(2);
+    
+    dice_parse_cache_get(cache, ctx, "1d4");
+    dice_parse_cache_get(cache, ctx, "1d6");
+    dice_parse_cache_get(cache, ctx, "1d4");   // 1d4 is now most recently used
+    dice_parse_cache_get(cache, ctx, "1d8");   // evicts 1d6
+    
+    dice_parse_cache_stats_t stats = dice_parse_cache_get_stats(cache);
+    TEST_ASSERT(stats.entries == 2, "Cache stays within capacity");
+    TEST_ASSERT(stats.evictions == 1, "One eviction recorded");
+    
+    dice_parse_cache_get(cache, ctx, "1d4");
+    TEST_ASSERT(dice_parse_cache_get_stats(cache).hits == stats.hits + 1, "Recently used entry survived");
+    dice_parse_cache_get(cache, ctx, "1d6");
+    TEST_ASSERT(dice_parse_cache_get_stats(cache).misses == stats.misses + 1, "Least recently used entry was evicted");
+    
+    dice_parse_cache_clear(cache);
+    TEST_ASSERT(dice_parse_cache_get_stats(cache).entries == 0, "Clear empties the cache");
+    
+    dice_parse_cache_destroy(cache);
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_roll_expression_uses_cache() {
+    dice_context_t *cached_ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_context_t *plain_ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_rng_vtable_t cached_rng = dice_create_xoshiro_rng(42);
+    dice_rng_vtable_t plain_rng = dice_create_xoshiro_rng(42);
+    dice_context_set_rng(cached_ctx, &cached_rng);
+    dice_context_set_rng(plain_ctx, &plain_rng);
+    
+    dice_parse_cache_t *cache = dice_parse_cache_create(16);
+    TEST_ASSERT(dice_context_set_parse_cache(cached_ctx, cache) == 0, "Cache attached");
+    
+    const char *expressions[] = {"4d6k3", "2d20l1+5", "3d6r1", "5d10s>7", "4dF"};
+    bool identical = true;
+    for (int i = 0; i < 100; i++) {
+        const char *expr = expressions[i % 5];
+        dice_eval_result_t expected = dice_roll_expression(plain_ctx, expr);
+        dice_eval_result_t actual = dice_roll_expression(cached_ctx, expr);
+        if (!expected.success || !actual.success || expected.value != actual.value) {
+            identical = false;
+        }
+        dice_clear_trace(plain_ctx);
+        dice_clear_trace(cached_ctx);
+    }
+    TEST_ASSERT(identical, "Cached rolls match uncached rolls for the same RNG state");
+    
+    dice_parse_cache_stats_t stats = dice_parse_cache_get_stats(cache);
+    TEST_ASSERT(stats.misses == 5 && stats.hits == 95, "Each expression parsed once");
+    
+    dice_eval_result_t bad = dice_roll_expression(cached_ctx, "2d");
+    TEST_ASSERT(!bad.success && dice_has_error(cached_ctx), "Errors still surface through the cache");
+    
+    dice_context_set_parse_cache(cached_ctx, NULL);
+    dice_parse_cache_destroy(cache);
+    dice_context_destroy(cached_ctx);
+    dice_context_destroy(plain_ctx);
+    return 1;
+}
+
+int main() {
+    printf("Running parse cache tests...\n\n");
+    
+    RUN_TEST(test_cache_hits_and_misses);
+    RUN_TEST(test_cache_keeps_quoted_labels);
+    RUN_TEST(test_cache_keeps_other_whitespace);
+    RUN_TEST(test_cache_lru_eviction);
+    RUN_TEST(test_roll_expression_uses_cache);
+    
+    printf("All parse cache tests passed!\n");
+    return 0;
+}
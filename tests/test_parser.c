@@ -203,6 +203,28 @@ int test_parser_operator_precedence() {
     return 1;
 }
 
+int test_parser_expression_dice_operands() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    
+    dice_eval_result_t result = dice_roll_expression(ctx, "(2+1)d1");
+    TEST_ASSERT(result.success && result.value == 3, "Parenthesized dice count");
+    
+    result = dice_roll_expression(ctx, "3d(4/4)");
+    TEST_ASSERT(result.success && result.value == 3, "Parenthesized dice sides");
+    
+    result = dice_roll_expression(ctx, "(1+1) d (2*3)");
+    TEST_ASSERT(result.success && result.value >= 2 && result.value <= 12, "Whitespace around expression operands");
+    
+    result = dice_roll_expression(ctx, "(2+1)*2");
+    TEST_ASSERT(result.success && result.value == 6, "Groups not followed by d stay groups");
+    
+    result = dice_roll_expression(ctx, "2d(3");
+    TEST_ASSERT(!result.success && dice_has_error(ctx), "Unclosed sides expression fails");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
 int main() {
     printf("Running parser tests...\n\n");
     
@@ -215,6 +237,7 @@ int main() {
     RUN_TEST(test_parser_whitespace_handling);
     RUN_TEST(test_parser_large_expressions);
     RUN_TEST(test_parser_operator_precedence);
+    RUN_TEST(test_parser_expression_dice_operands);
     
     printf("All parser tests passed!\n");
     return 0;
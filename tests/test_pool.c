@@ -0,0 +1,220 @@
+#include "test_common.h"
+
+// =============================================================================
+// Success Pool and Sampled Selection Tests (NdS>N, NdS<N, untraced s>N)
+// =============================================================================
+
+// Roll without letting parse nodes and trace entries pile up in the arena
+static dice_eval_result_t roll(dice_context_t *ctx, const char *expression) {
+    dice_clear_trace(ctx);
+    size_t mark = dice_arena_mark(ctx);
+    dice_eval_result_t result = dice_roll_expression(ctx, expression);
+    dice_arena_rewind(ctx, mark);
+    return result;
+}
+
+// Total variation distance between samples of an expression and its exact distribution
+static double sampled_distance(dice_context_t *ctx, const char *expression, int samples) {
+    dice_ast_node_t *ast = dice_parse(ctx, expression);
+    dice_distribution_t *dist = ast ? dice_analyze(ctx, ast) : NULL;
+    if (!dist) return 1.0;
+    
+    int *histogram = calloc(dist->size, sizeof(int));
+    int outside = 0;
+    for (int i = 0; i < samples; i++) {
+        dice_eval_result_t result = roll(ctx, expression);
+        int64_t slot = result.value - dist->min_value;
+        if (!result.success || slot < 0 || slot >= (int64_t)dist->size) {
+            outside++;
+        } else {
+            histogram[slot]++;
+        }
+    }
+    
+    double distance = (double)outside / samples;
+    for (size_t i = 0; i < dist->size; i++) {
+        distance += fabs((double)histogram[i] / samples - dist->pmf[i]);
+    }
+    free(histogram);
+    dice_distribution_destroy(dist);
+    return distance / 2.0;
+}
+
+int test_pool_parse() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    
+    dice_ast_node_t *ast = dice_parse(ctx, "10d10>8");
+    TEST_ASSERT(ast && ast->data.dice_op.dice_type == DICE_DICE_POOL, "10d10>8 is a success pool");
+    TEST_ASSERT(ast->data.dice_op.selection->comparison_op == DICE_OP_GTE, "> counts N and above");
+    TEST_ASSERT(ast->data.dice_op.selection->comparison_value == 8, "Pool target is recorded");
+    
+    ast = dice_parse(ctx, "6d6<2 + 1");
+    TEST_ASSERT(ast && ast->type == DICE_NODE_BINARY_OP, "Pools combine with arithmetic");
+    TEST_ASSERT(ast->data.binary_op.left->data.dice_op.selection->comparison_op == DICE_OP_LTE,
+                "< counts N and below");
+    
+    const char *invalid[] = {"4d6>", "4d6<", "4dF>1", "1d{1,2}>1"};
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        TEST_ASSERT(!dice_roll_expression(ctx, invalid[i]).success, invalid[i]);
+        dice_clear_error(ctx);
+    }
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_pool_traced() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    
+    dice_eval_result_t result = dice_roll_expression(ctx, "8d6>5");
+    TEST_ASSERT(result.success && result.value >= 0 && result.value <= 8, "8d6>5 counts successes");
+    
+    const dice_trace_t *trace = dice_get_trace(ctx);
+    TEST_ASSERT(trace->count == 8, "Traced pools record every die");
+    int64_t successes = 0;
+    for (const dice_trace_entry_t *entry = trace->first; entry; entry = entry->next) {
+        bool hit = entry->data.atomic_roll.result >= 5;
+        TEST_ASSERT(entry->data.atomic_roll.selected == hit, "Successes are marked selected");
+        if (hit) successes++;
+    }
+    TEST_ASSERT(successes == result.value, "Result is the number of marked successes");
+    TEST_ASSERT(trace->summary.dropped == (uint64_t)(8 - result.value), "Failures count as dropped");
+    
+    TEST_ASSERT(roll(ctx, "5d6>1").value == 5, "Every face meets >1");
+    TEST_ASSERT(roll(ctx, "5d6>7").value == 0, "No face meets >7");
+    TEST_ASSERT(roll(ctx, "5d6<6").value == 5, "Every face meets <6");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_pool_sampled_distribution() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(31337);
+    dice_context_set_rng(ctx, &rng);
+    dice_context_set_trace_level(ctx, DICE_TRACE_OFF);
+    
+    // Small means use inversion, larger ones rejection, p > 1/2 mirrors
+    TEST_ASSERT(sampled_distance(ctx, "20d6>6", 40000) < 0.02, "20d6>6 (inversion) matches Binomial(20, 1/6)");
+    TEST_ASSERT(sampled_distance(ctx, "60d10>8", 40000) < 0.03, "60d10>8 (rejection) matches Binomial(60, 3/10)");
+    TEST_ASSERT(sampled_distance(ctx, "40d10>2", 40000) < 0.03, "40d10>2 (mirrored) matches Binomial(40, 9/10)");
+    
+    // Mean and variance of a large pool
+    const int samples = 20000;
+    double total = 0.0, squares = 0.0;
+    for (int i = 0; i < samples; i++) {
+        dice_eval_result_t result = roll(ctx, "1000d10>8");
+        TEST_ASSERT(result.success, "Large pool succeeds untraced");
+        total += (double)result.value;
+        squares += (double)result.value * (double)result.value;
+    }
+    double mean = total / samples;
+    double variance = squares / samples - mean * mean;
+    TEST_ASSERT(fabs(mean - 300.0) < 0.5, "1000d10>8 mean is 300");
+    TEST_ASSERT(fabs(variance - 210.0) < 10.0, "1000d10>8 variance is 210");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_pool_default_engine() {
+    // The system engine draws from rand(), so wide uniforms span several calls
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng = dice_create_system_rng(8675309);
+    dice_context_set_rng(ctx, &rng);
+    dice_context_set_trace_level(ctx, DICE_TRACE_OFF);
+    
+    TEST_ASSERT(sampled_distance(ctx, "10d10>6", 20000) < 0.03, "10d10>6 matches Binomial(10, 1/2)");
+    TEST_ASSERT(sampled_distance(ctx, "20d10s>6", 20000) < 0.04, "Untraced 20d10s>6 keeps its distribution");
+    
+    // Large means take the rejection sampler, which must accept
+    double total = 0.0;
+    bool all_succeeded = true;
+    const int samples = 2000;
+    for (int i = 0; i < samples; i++) {
+        dice_eval_result_t result = roll(ctx, "100d10s>6");
+        all_succeeded = all_succeeded && result.success;
+        total += (double)result.value;
+    }
+    TEST_ASSERT(all_succeeded, "100d10s>6 succeeds on the default engine");
+    TEST_ASSERT(fabs(total / samples - 340.0) < 5.0, "100d10s>6 mean is 40 dice of 8.5");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_conditional_sampled_distribution() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(4242);
+    dice_context_set_rng(ctx, &rng);
+    dice_context_set_trace_level(ctx, DICE_TRACE_OFF);
+    
+    TEST_ASSERT(sampled_distance(ctx, "6d6s>4", 40000) < 0.03, "Untraced 6d6s>4 keeps its distribution");
+    TEST_ASSERT(sampled_distance(ctx, "5d6s<>3", 40000) < 0.04, "Untraced 5d6s<>3 keeps its distribution");
+    TEST_ASSERT(sampled_distance(ctx, "8d4s=2", 40000) < 0.02, "Untraced 8d4s=2 keeps its distribution");
+    
+    dice_context_set_trace_level(ctx, DICE_TRACE_SUMMARY);
+    dice_eval_result_t result = roll(ctx, "10d6s>7");
+    TEST_ASSERT(result.success && result.value == 0, "Nothing matches s>7");
+    dice_clear_trace(ctx);
+    result = dice_roll_expression(ctx, "10d6s>=1");
+    const dice_trace_t *trace = dice_get_trace(ctx);
+    TEST_ASSERT(result.success && trace->count == 0, "Summary tracing records no entries");
+    TEST_ASSERT(trace->summary.dice_rolled == 10 && trace->summary.dropped == 0,
+                "Summary counts every die and no drops when all match");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_pool_compiled_matches_tree() {
+    const char *expressions[] = {"1000d10>8", "12d6<2 + 3d6s>4", "(1d4)d6>5"};
+    dice_trace_level_t levels[] = {DICE_TRACE_OFF, DICE_TRACE_FULL};
+    dice_context_t *a = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_context_t *b = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    
+    for (size_t l = 0; l < 2; l++) {
+        dice_context_set_trace_level(a, levels[l]);
+        dice_context_set_trace_level(b, levels[l]);
+        for (size_t e = 0; e < sizeof(expressions) / sizeof(expressions[0]); e++) {
+            dice_rng_vtable_t rng_a = dice_create_xoshiro_rng(5 + e);
+            dice_rng_vtable_t rng_b = dice_create_xoshiro_rng(5 + e);
+            dice_context_set_rng(a, &rng_a);
+            dice_context_set_rng(b, &rng_b);
+            
+            dice_ast_node_t *ast = dice_parse(b, expressions[e]);
+            dice_program_t *program = ast ? dice_compile(b, ast) : NULL;
+            TEST_ASSERT(program != NULL, "Pool expression compiles");
+            
+            bool same = true;
+            for (int i = 0; i < 100 && same; i++) {
+                size_t mark = dice_arena_mark(b);
+                dice_eval_result_t tree = roll(a, expressions[e]);
+                dice_eval_result_t compiled = dice_program_evaluate(b, program);
+                same = tree.success && compiled.success && tree.value == compiled.value;
+                dice_clear_trace(b);
+                dice_arena_rewind(b, mark);
+            }
+            TEST_ASSERT(same, "Compiled pools match the tree evaluator");
+            dice_program_destroy(program);
+        }
+    }
+    
+    dice_context_destroy(a);
+    dice_context_destroy(b);
+    return 1;
+}
+
+int main() {
+    printf("Running success pool tests...\n\n");
+    
+    RUN_TEST(test_pool_parse);
+    RUN_TEST(test_pool_traced);
+    RUN_TEST(test_pool_sampled_distribution);
+    RUN_TEST(test_pool_default_engine);
+    RUN_TEST(test_conditional_sampled_distribution);
+    RUN_TEST(test_pool_compiled_matches_tree);
+    
+    printf("All success pool tests passed!\n");
+    return 0;
+}
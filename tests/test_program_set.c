@@ -0,0 +1,312 @@
+#include "test_common.h"
+#include <stdint.h>
+#include <unistd.h>
+
+// =============================================================================
+// Program Set Tests (serialized compiled programs)
+// =============================================================================
+
+static const char *expressions[] = {"4d6k3", "1d20+5", "3dBoon+1d{0:\"miss\"*9, 1:\"hit\"}", "10d10>8"};
+static const char *keys[] = {"stat", "attack", "boon", "pool"};
+#define SET_SIZE (sizeof(expressions) / sizeof(expressions[0]))
+
+static void register_boon(dice_context_t *ctx) {
+    dice_custom_side_t sides[] = {{0, "blank", 2}, {1, "boon", 1}, {2, "double", 1}};
+    dice_register_custom_die(ctx, "Boon", sides, 3);
+}
+
+static bool compile_all(dice_context_t *ctx, dice_program_t *programs[SET_SIZE]) {
+    for (size_t i = 0; i < SET_SIZE; i++) {
+        dice_ast_node_t *ast = dice_parse(ctx, expressions[i]);
+        programs[i] = ast ? dice_compile(ctx, ast) : NULL;
+        if (!programs[i]) return false;
+    }
+    return true;
+}
+
+static void destroy_all(dice_program_t *programs[SET_SIZE]) {
+    for (size_t i = 0; i < SET_SIZE; i++) dice_program_destroy(programs[i]);
+}
+
+// Evaluate two programs from identically seeded generators
+static bool same_results(dice_context_t *a, const dice_program_t *pa,
+                         dice_context_t *b, const dice_program_t *pb, uint64_t seed) {
+    dice_rng_vtable_t rng_a = dice_create_xoshiro_rng(seed);
+    dice_rng_vtable_t rng_b = dice_create_xoshiro_rng(seed);
+    dice_context_set_rng(a, &rng_a);
+    dice_context_set_rng(b, &rng_b);
+    
+    for (int i = 0; i < 200; i++) {
+        size_t mark_a = dice_arena_mark(a);
+        size_t mark_b = dice_arena_mark(b);
+        dice_eval_result_t ra = dice_program_evaluate(a, pa);
+        dice_eval_result_t rb = dice_program_evaluate(b, pb);
+        dice_clear_trace(a);
+        dice_clear_trace(b);
+        dice_arena_rewind(a, mark_a);
+        dice_arena_rewind(b, mark_b);
+        if (!ra.success || !rb.success || ra.value != rb.value) return false;
+    }
+    return true;
+}
+
+// Word holding total_weight of the boon expression's inline {0*9, 1} die: an
+// unnamed die record with side_count 2 and generation 0, followed by weight 10
+static uint64_t* find_inline_die_weight(uint64_t *words, size_t count) {
+    for (size_t w = 3; w < count; w++) {
+        if (words[w] == 10 && words[w - 1] == 0 && (uint32_t)words[w - 3] == 0 &&
+            (uint32_t)(words[w - 2] >> 32) == 2) {
+            return &words[w];
+        }
+    }
+    return NULL;
+}
+
+int test_program_set_buffer_roundtrip() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    register_boon(ctx);
+    dice_program_t *programs[SET_SIZE];
+    TEST_ASSERT(compile_all(ctx, programs), "Expressions compile");
+    dice_context_t *other = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    register_boon(other);
+    
+    size_t size = dice_program_set_encoded_size((const dice_program_t *const *)programs, keys, SET_SIZE);
+    TEST_ASSERT(size > 0 && size % 8 == 0, "Encoded size is a multiple of 8");
+    uint64_t *buffer = calloc(size / 8, sizeof(uint64_t));
+    TEST_ASSERT(dice_program_set_encode(ctx, (const dice_program_t *const *)programs, keys, SET_SIZE,
+                                        buffer, size) == 0, "Set encodes");
+    
+    dice_program_set_t *set = dice_program_set_view(ctx, buffer, size);
+    TEST_ASSERT(set != NULL, "Encoded buffer is a valid set");
+    TEST_ASSERT(dice_program_set_count(set) == SET_SIZE, "Every program is present");
+    
+    // Keys come back sorted
+    for (size_t i = 1; i < SET_SIZE; i++) {
+        TEST_ASSERT(strcmp(dice_program_set_key(set, i - 1), dice_program_set_key(set, i)) < 0,
+                    "Keys are sorted");
+    }
+    TEST_ASSERT(dice_program_set_key(set, SET_SIZE) == NULL, "Out of range key is NULL");
+    TEST_ASSERT(dice_program_set_get(set, SET_SIZE) == NULL, "Out of range program is NULL");
+    
+    for (size_t i = 0; i < SET_SIZE; i++) {
+        const dice_program_t *loaded = dice_program_set_find(set, keys[i]);
+        TEST_ASSERT(loaded != NULL, "Program found by key");
+        TEST_ASSERT(same_results(ctx, programs[i], other, loaded, 100 + i),
+                    "Loaded program matches the original");
+    }
+    TEST_ASSERT(dice_program_set_find(set, "missing") == NULL, "Unknown key is not found");
+    TEST_ASSERT(dice_program_set_find(set, "") == NULL, "Empty key is not found");
+    
+    dice_program_set_close(set);
+    free(buffer);
+    destroy_all(programs);
+    dice_context_destroy(other);
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_program_set_file_roundtrip() {
+    dice_context_t *writer = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    register_boon(writer);
+    dice_program_t *programs[SET_SIZE];
+    TEST_ASSERT(compile_all(writer, programs), "Expressions compile");
+    
+    char path[64];
+    snprintf(path, sizeof(path), "program_set_test_%d.bin", (int)getpid());
+    TEST_ASSERT(dice_program_set_save(writer, path, (const dice_program_t *const *)programs,
+                                      keys, SET_SIZE) == 0, "Set saved");
+    
+    // A fresh context registers its dice in a different order
+    dice_context_t *reader = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_custom_side_t filler[] = {{42, NULL, 1}};
+    dice_register_custom_die(reader, "Filler", filler, 1);
+    register_boon(reader);
+    
+    dice_program_set_t *set = dice_program_set_open(reader, path);
+    TEST_ASSERT(set != NULL, "Saved set opens");
+    for (size_t i = 0; i < SET_SIZE; i++) {
+        const dice_program_t *loaded = dice_program_set_find(set, keys[i]);
+        TEST_ASSERT(loaded && same_results(writer, programs[i], reader, loaded, 7 + i),
+                    "Mapped program matches the original in another context");
+    }
+    
+    // Named dice are resolved at evaluation time
+    dice_context_t *bare = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_eval_result_t result = dice_program_evaluate(bare, dice_program_set_find(set, "boon"));
+    TEST_ASSERT(!result.success && dice_has_error(bare), "Unregistered named die is an error");
+    dice_program_set_close(set);
+    
+    TEST_ASSERT(dice_program_set_open(reader, "no/such/program_set.bin") == NULL && dice_has_error(reader),
+                "Missing file is an error");
+    dice_clear_error(reader);
+    
+    remove(path);
+    destroy_all(programs);
+    dice_context_destroy(bare);
+    dice_context_destroy(reader);
+    dice_context_destroy(writer);
+    return 1;
+}
+
+int test_program_set_rejects_corruption() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    register_boon(ctx);
+    dice_program_t *programs[SET_SIZE];
+    TEST_ASSERT(compile_all(ctx, programs), "Expressions compile");
+    
+    size_t size = dice_program_set_encoded_size((const dice_program_t *const *)programs, keys, SET_SIZE);
+    uint64_t *buffer = calloc(size / 8, sizeof(uint64_t));
+    uint64_t *copy = calloc(size / 8, sizeof(uint64_t));
+    dice_program_set_encode(ctx, (const dice_program_t *const *)programs, keys, SET_SIZE, buffer, size);
+    
+    // Every truncation is caught
+    bool all_rejected = true;
+    for (size_t cut = 0; cut < size; cut += 8) {
+        dice_program_set_t *set = dice_program_set_view(ctx, buffer, cut);
+        if (set) {
+            all_rejected = false;
+            dice_program_set_close(set);
+        }
+        dice_clear_error(ctx);
+    }
+    TEST_ASSERT(all_rejected, "Truncated sets are rejected");
+    
+    // Flipping any byte either still validates or is rejected, but never crashes
+    // when the result is evaluated
+    int rejected = 0;
+    for (size_t offset = 0; offset < size; offset++) {
+        memcpy(copy, buffer, size);
+        ((unsigned char*)copy)[offset] ^= 0x5A;
+        dice_program_set_t *set = dice_program_set_view(ctx, copy, size);
+        if (!set) {
+            rejected++;
+        } else {
+            for (size_t i = 0; i < dice_program_set_count(set); i++) {
+                size_t mark = dice_arena_mark(ctx);
+                dice_program_evaluate(ctx, dice_program_set_get(set, i));
+                dice_clear_trace(ctx);
+                dice_arena_rewind(ctx, mark);
+            }
+            dice_program_set_close(set);
+        }
+        dice_clear_error(ctx);
+    }
+    TEST_ASSERT(rejected > 0, "Corrupted sets are rejected");
+    
+    memcpy(copy, buffer, size);
+    ((uint32_t*)copy)[0] = 0;
+    TEST_ASSERT(dice_program_set_view(ctx, copy, size) == NULL && dice_has_error(ctx), "Bad magic rejected");
+    dice_clear_error(ctx);
+    TEST_ASSERT(dice_program_set_view(ctx, (char*)buffer + 4, size - 4) == NULL, "Misaligned data rejected");
+    dice_clear_error(ctx);
+    
+    // A weight whose draw range wraps to zero must not reach the modulo
+    memcpy(copy, buffer, size);
+    uint64_t *weight = find_inline_die_weight(copy, size / 8);
+    TEST_ASSERT(weight != NULL, "Inline weighted die located");
+    *weight = (uint64_t)1 << 63;
+    TEST_ASSERT(dice_program_set_view(ctx, copy, size) == NULL && dice_has_error(ctx),
+                "Overflowing die weight rejected");
+    dice_clear_error(ctx);
+    *weight = 1;
+    TEST_ASSERT(dice_program_set_view(ctx, copy, size) == NULL && dice_has_error(ctx),
+                "Alias threshold above the die weight rejected");
+    dice_clear_error(ctx);
+    
+    // Duplicate keys cannot be encoded
+    const char *duplicate_keys[] = {"a", "b", "a", "c"};
+    TEST_ASSERT(dice_program_set_encode(ctx, (const dice_program_t *const *)programs, duplicate_keys,
+                                        SET_SIZE, buffer, size) == -1 && dice_has_error(ctx),
+                "Duplicate keys rejected");
+    dice_clear_error(ctx);
+    TEST_ASSERT(dice_program_set_encode(ctx, (const dice_program_t *const *)programs, keys,
+                                        SET_SIZE, buffer, size - 8) == -1, "Short buffer rejected");
+    dice_clear_error(ctx);
+    
+    free(copy);
+    free(buffer);
+    destroy_all(programs);
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_program_set_policy() {
+    // A set written under a permissive policy
+    dice_context_t *writer = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_policy_t loose = dice_default_policy();
+    loose.max_dice_count = 500;
+    loose.max_sides = 500;
+    dice_context_set_policy(writer, &loose);
+    dice_program_t *program = dice_compile(writer, dice_parse(writer, "200d300"));
+    TEST_ASSERT(program != NULL, "Wide program compiles under the loose policy");
+    const char *key[] = {"wide"};
+    size_t size = dice_program_set_encoded_size((const dice_program_t *const *)&program, key, 1);
+    uint64_t *buffer = calloc(size / 8, sizeof(uint64_t));
+    dice_program_set_encode(writer, (const dice_program_t *const *)&program, key, 1, buffer, size);
+    
+    dice_policy_t strict = dice_default_policy();
+    strict.max_dice_count = 100;
+    strict.max_sides = 100;
+    
+    // A stricter loading context refuses it
+    dice_context_t *reader = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_context_set_policy(reader, &strict);
+    TEST_ASSERT(dice_program_set_view(reader, buffer, size) == NULL && dice_has_error(reader),
+                "Set over the loading context's policy is rejected");
+    dice_clear_error(reader);
+    
+    // Loaded loosely, it is still held to whichever context evaluates it
+    dice_program_set_t *set = dice_program_set_view(writer, buffer, size);
+    TEST_ASSERT(set != NULL, "Set views under the policy it was built with");
+    const dice_program_t *loaded = dice_program_set_find(set, "wide");
+    TEST_ASSERT(!dice_program_evaluate(reader, loaded).success && dice_has_error(reader),
+                "Stricter evaluating context rejects the loaded program");
+    dice_clear_error(reader);
+    dice_context_set_policy(writer, &strict);
+    TEST_ASSERT(!dice_program_evaluate(writer, loaded).success && dice_has_error(writer),
+                "Tightening the loading context's policy applies to loaded programs");
+    dice_clear_error(writer);
+    dice_context_set_policy(writer, &loose);
+    TEST_ASSERT(dice_program_evaluate(writer, loaded).success, "Loaded program runs under the loose policy");
+    
+    dice_program_set_close(set);
+    free(buffer);
+    dice_program_destroy(program);
+    dice_context_destroy(reader);
+    dice_context_destroy(writer);
+    return 1;
+}
+
+int test_program_set_empty() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    
+    size_t size = dice_program_set_encoded_size(NULL, NULL, 0);
+    TEST_ASSERT(size > 0, "An empty set has a header");
+    uint64_t *buffer = calloc(size / 8, sizeof(uint64_t));
+    TEST_ASSERT(dice_program_set_encode(ctx, NULL, NULL, 0, buffer, size) == 0, "Empty set encodes");
+    
+    dice_program_set_t *set = dice_program_set_view(ctx, buffer, size);
+    TEST_ASSERT(set && dice_program_set_count(set) == 0, "Empty set views");
+    TEST_ASSERT(dice_program_set_find(set, "x") == NULL, "Nothing is found in an empty set");
+    dice_program_set_close(set);
+    
+    TEST_ASSERT(dice_program_set_count(NULL) == 0, "NULL set is empty");
+    dice_program_set_close(NULL);
+    
+    free(buffer);
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int main() {
+    printf("Running program set tests...\n\n");
+    
+    RUN_TEST(test_program_set_buffer_roundtrip);
+    RUN_TEST(test_program_set_file_roundtrip);
+    RUN_TEST(test_program_set_rejects_corruption);
+    RUN_TEST(test_program_set_policy);
+    RUN_TEST(test_program_set_empty);
+    
+    printf("All program set tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,227 @@
+#include "test_common.h"
+#include <stdint.h>
+
+// =============================================================================
+// Per-Die Results Tests (dice_evaluate_ex)
+// =============================================================================
+
+#define RESULT_DICE 2048
+
+typedef struct {
+    int64_t values[RESULT_DICE];
+    uint8_t kept[RESULT_DICE / 8];
+    uint32_t rerolls[RESULT_DICE];
+    dice_results_op_t ops[16];
+    dice_results_t results;
+} results_storage_t;
+
+static dice_results_t* results_init(results_storage_t *storage, size_t dice, size_t ops) {
+    memset(storage, 0, sizeof(*storage));
+    storage->results.values = storage->values;
+    storage->results.kept = storage->kept;
+    storage->results.rerolls = storage->rerolls;
+    storage->results.die_capacity = dice;
+    storage->results.ops = storage->ops;
+    storage->results.op_capacity = ops;
+    return &storage->results;
+}
+
+static bool die_kept(const dice_results_t *results, size_t die) {
+    return (results->kept[die / 8] >> (die % 8)) & 1;
+}
+
+static dice_context_t* seeded_context(uint64_t seed) {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(seed);
+    dice_context_set_rng(ctx, &rng);
+    return ctx;
+}
+
+int test_results_match_trace() {
+    const char *expressions[] = {"3d6+2", "4d6k3", "5d6l2", "10d10>8", "8d6s>=4", "4dF", "5d6!", "1d{1,2:\"two\"*3}"};
+    static results_storage_t storage;
+    
+    for (size_t e = 0; e < sizeof(expressions) / sizeof(expressions[0]); e++) {
+        dice_context_t *ctx = seeded_context(77);
+        dice_ast_node_t *ast = dice_parse(ctx, expressions[e]);
+        TEST_ASSERT(ast != NULL, "Expression parses");
+        
+        dice_results_t *results = results_init(&storage, RESULT_DICE, 16);
+        dice_eval_result_t result = dice_evaluate_ex(ctx, ast, results);
+        TEST_ASSERT(result.success, "Evaluation with results succeeds");
+        TEST_ASSERT(results->op_count == 1 && !results->truncated, "One dice operation recorded");
+        TEST_ASSERT(results->die_count == dice_get_trace(ctx)->count, "One result per traced die");
+        
+        // The fully traced roll lists the same dice in the same order
+        bool same = true;
+        size_t die = 0;
+        for (const dice_trace_entry_t *entry = dice_get_trace(ctx)->first; entry; entry = entry->next, die++) {
+            bool kept = entry->data.atomic_roll.selected || !dice_get_trace(ctx)->summary.dropped;
+            if (results->values[die] != entry->data.atomic_roll.result || die_kept(results, die) != kept ||
+                results->rerolls[die] != 0) {
+                same = false;
+            }
+        }
+        TEST_ASSERT(same, "Values and kept bits match the trace");
+        TEST_ASSERT(results->ops[0].first == 0 && results->ops[0].count == results->die_count,
+                    "Operation spans its dice");
+        
+        dice_context_destroy(ctx);
+    }
+    return 1;
+}
+
+int test_results_untraced() {
+    static results_storage_t storage;
+    dice_context_t *ctx = seeded_context(5);
+    dice_context_set_trace_level(ctx, DICE_TRACE_OFF);
+    
+    dice_ast_node_t *ast = dice_parse(ctx, "3d6+2d4+1dF");
+    dice_results_t *results = results_init(&storage, RESULT_DICE, 16);
+    size_t mark = dice_arena_mark(ctx);
+    dice_eval_result_t result = dice_evaluate_ex(ctx, ast, results);
+    TEST_ASSERT(result.success, "Untraced evaluation succeeds");
+    TEST_ASSERT(dice_get_trace(ctx)->count == 0 && dice_arena_mark(ctx) == mark,
+                "Results need no trace and no arena memory");
+    
+    TEST_ASSERT(results->op_count == 3 && results->die_count == 6, "Three operations, six dice");
+    TEST_ASSERT(results->ops[0].sides == 6 && results->ops[1].sides == 4 && results->ops[2].sides == 3,
+                "Operations keep their sides");
+    TEST_ASSERT(results->ops[1].first == 3 && results->ops[1].count == 2 && results->ops[2].first == 5,
+                "Operations index the die arrays");
+    int64_t total = 0;
+    for (size_t i = 0; i < results->die_count; i++) total += results->values[i];
+    TEST_ASSERT(total == result.value, "Dice add up to the total");
+    
+    // Pools and conditional selections roll every die instead of sampling a count
+    for (int i = 0; i < 20; i++) {
+        dice_arena_rewind(ctx, 0);
+        ast = dice_parse(ctx, i % 2 ? "30d6>4" : "30d6s>4");
+        result = dice_evaluate_ex(ctx, ast, results);
+        int64_t kept = 0, kept_sum = 0;
+        for (size_t d = 0; d < results->die_count; d++) {
+            if (die_kept(results, d)) {
+                kept++;
+                kept_sum += results->values[d];
+            }
+        }
+        TEST_ASSERT(result.success && results->die_count == 30, "Every die is recorded");
+        TEST_ASSERT(result.value == (i % 2 ? kept : kept_sum), "Kept dice explain the result");
+    }
+    
+    // Without a buffer it is a plain evaluation
+    TEST_ASSERT(dice_evaluate_ex(ctx, ast, NULL).success, "NULL results evaluates normally");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_results_rerolls() {
+    static results_storage_t storage;
+    dice_context_t *ctx = seeded_context(11);
+    
+    dice_ast_node_t *ast = dice_parse(ctx, "200d6r<3");
+    dice_results_t *results = results_init(&storage, RESULT_DICE, 16);
+    dice_eval_result_t result = dice_evaluate_ex(ctx, ast, results);
+    TEST_ASSERT(result.success && results->die_count == 200, "One result per rerolled die");
+    
+    uint64_t rerolls = 0;
+    int64_t total = 0;
+    bool final_ok = true;
+    for (size_t i = 0; i < results->die_count; i++) {
+        if (results->values[i] < 3 || !die_kept(results, i)) final_ok = false;
+        rerolls += results->rerolls[i];
+        total += results->values[i];
+    }
+    TEST_ASSERT(final_ok, "Final faces are kept and past the reroll condition");
+    TEST_ASSERT(rerolls == dice_get_trace(ctx)->summary.rerolls && rerolls > 0, "Reroll counts add up");
+    TEST_ASSERT(total == result.value, "Final faces add up to the total");
+    
+    // Compounding explosions keep one summed die
+    dice_arena_rewind(ctx, 0);
+    dice_clear_trace(ctx);
+    ast = dice_parse(ctx, "50d6!!");
+    result = dice_evaluate_ex(ctx, ast, results);
+    total = 0;
+    for (size_t i = 0; i < results->die_count; i++) total += results->values[i];
+    TEST_ASSERT(result.success && results->die_count == 50 && total == result.value,
+                "Compounding dice are recorded once each");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_results_capacity() {
+    static results_storage_t storage;
+    dice_context_t *ctx = seeded_context(3);
+    
+    dice_ast_node_t *ast = dice_parse(ctx, "10d6+2d8");
+    dice_results_t *results = results_init(&storage, 4, 16);
+    TEST_ASSERT(dice_evaluate_ex(ctx, ast, results).success, "Small buffer does not fail the roll");
+    TEST_ASSERT(results->die_count == 4 && results->truncated, "Dice past the capacity are dropped");
+    TEST_ASSERT(results->op_count == 2 && results->ops[0].count == 4 && results->ops[1].count == 0,
+                "Operations count only recorded dice");
+    
+    results_init(&storage, RESULT_DICE, 1);
+    TEST_ASSERT(dice_evaluate_ex(ctx, ast, results).success, "Too few operation slots");
+    TEST_ASSERT(results->op_count == 1 && results->die_count == 10 && results->truncated,
+                "Operations past the capacity are dropped with their dice");
+    
+    // Reroll counts are optional
+    results_init(&storage, RESULT_DICE, 16);
+    results->rerolls = NULL;
+    TEST_ASSERT(dice_evaluate_ex(ctx, dice_parse(ctx, "4d6r1"), results).success && results->die_count == 4,
+                "Results without reroll counts");
+    
+    results->values = NULL;
+    TEST_ASSERT(!dice_evaluate_ex(ctx, ast, results).success && dice_has_error(ctx), "Missing array rejected");
+    dice_clear_error(ctx);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_results_program() {
+    static results_storage_t tree_storage, program_storage;
+    dice_context_t *ctx = seeded_context(1);
+    dice_custom_side_t boon[] = {{0, "blank", 2}, {1, "boon", 1}};
+    dice_register_custom_die(ctx, "Boon", boon, 2);
+    
+    dice_ast_node_t *ast = dice_parse(ctx, "4d6k3+2dBoon+3d10>7+1d{5,6}");
+    dice_program_t *program = dice_compile(ctx, ast);
+    TEST_ASSERT(program != NULL, "Program compiles");
+    
+    dice_results_t *tree = results_init(&tree_storage, RESULT_DICE, 16);
+    dice_results_t *compiled = results_init(&program_storage, RESULT_DICE, 16);
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(9);
+    dice_context_set_rng(ctx, &rng);
+    dice_eval_result_t a = dice_evaluate_ex(ctx, ast, tree);
+    rng = dice_create_xoshiro_rng(9);
+    dice_context_set_rng(ctx, &rng);
+    dice_eval_result_t b = dice_program_evaluate_ex(ctx, program, compiled);
+    
+    TEST_ASSERT(a.success && b.success && a.value == b.value, "Program and tree agree");
+    TEST_ASSERT(tree->die_count == compiled->die_count && tree->op_count == compiled->op_count &&
+                tree->op_count == 4,
+                "Same dice and operations recorded");
+    TEST_ASSERT(memcmp(tree->values, compiled->values, tree->die_count * sizeof(int64_t)) == 0 &&
+                memcmp(tree->kept, compiled->kept, (tree->die_count + 7) / 8) == 0,
+                "Same values and kept bits");
+    
+    dice_program_destroy(program);
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int main() {
+    printf("Running dice results tests...\n\n");
+    
+    RUN_TEST(test_results_match_trace);
+    RUN_TEST(test_results_untraced);
+    RUN_TEST(test_results_rerolls);
+    RUN_TEST(test_results_capacity);
+    RUN_TEST(test_results_program);
+    
+    printf("All dice results tests passed!\n");
+    return 0;
+}
@@ -84,13 +84,14 @@ int test_rng_reproducibility() {
     
     int sequence1[10];
     for (int i = 0; i < 10; i++) {
-        sequence1[i] = dice_roll(6);
+        sequence1[i] = dice_roll_quick("3d6", 1000 + i);
     }
     
-    // Same seed
+    // Same seed; unseeded calls in between must not disturb seeded ones
     int sequence2[10];
     for (int i = 0; i < 10; i++) {
-        sequence2[i] = dice_roll(6);
+        dice_roll(6);
+        sequence2[i] = dice_roll_quick("3d6", 1000 + i);
     }
     
     // Sequences should be identical
@@ -293,6 +294,222 @@ int test_rng_state_isolation() {
     return 1;
 }
 
+// =============================================================================
+// xoshiro256++ Engine Tests
+// =============================================================================
+
+int test_xoshiro_known_sequence() {
+    // SplitMix64-expanded seed 12345; rand(2^63) is the raw output shifted right by one
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(12345);
+    const uint64_t expected[3] = {
+        0x46ca45416f7c52b4ULL, 0x1a3bfca9bcb38150ULL, 0x0ae5517e736dc6b4ULL
+    };
+    
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT(rng.rand(rng.state, (uint64_t)1 << 63) == expected[i],
+                    "xoshiro256++ matches reference output");
+    }
+    
+    rng.cleanup(rng.state);
+    return 1;
+}
+
+int test_xoshiro_independent_state() {
+    // Two engines with the same seed must not disturb each other
+    dice_rng_vtable_t a = dice_create_xoshiro_rng(2024);
+    dice_rng_vtable_t b = dice_create_xoshiro_rng(2024);
+    dice_rng_vtable_t other = dice_create_xoshiro_rng(7);
+    
+    int matches = 0;
+    for (int i = 0; i < 100; i++) {
+        int va = a.roll(a.state, 1000);
+        other.roll(other.state, 1000);
+        other.init(other.state, (uint64_t)i + 1); // reseeding must not leak into a/b
+        int vb = b.roll(b.state, 1000);
+        if (va == vb) matches++;
+    }
+    TEST_ASSERT(matches == 100, "Same seed gives same sequence regardless of other engines");
+    
+    a.cleanup(a.state);
+    b.cleanup(b.state);
+    other.cleanup(other.state);
+    return 1;
+}
+
+int test_xoshiro_range_and_uniformity() {
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(99);
+    
+    int frequencies[6] = {0};
+    for (int i = 0; i < 60000; i++) {
+        int roll = rng.roll(rng.state, 6);
+        if (roll < 1 || roll > 6) {
+            TEST_ASSERT(0, "xoshiro roll stays within [1, sides]");
+        }
+        frequencies[roll - 1]++;
+    }
+    double chi = chi_square_test(frequencies, 10000, 6);
+    TEST_ASSERT(chi < 20.515, "xoshiro d6 passes chi-square (5 dof, 99.9%)");
+    
+    bool in_range = true;
+    for (int i = 0; i < 10000; i++) {
+        uint64_t v = rng.rand(rng.state, 3);
+        if (v >= 3) in_range = false;
+    }
+    TEST_ASSERT(in_range, "xoshiro rand stays within [0, max-1]");
+    TEST_ASSERT(rng.rand(rng.state, 0) == 0, "xoshiro rand(0) returns 0");
+    TEST_ASSERT(rng.roll(rng.state, 0) == -1, "xoshiro roll(0) reports an error");
+    TEST_ASSERT(rng.roll(rng.state, 1) == 1, "xoshiro d1 always returns 1");
+    
+    rng.cleanup(rng.state);
+    return 1;
+}
+
+int test_xoshiro_jump_streams() {
+    dice_rng_vtable_t base = dice_create_xoshiro_rng(555);
+    dice_rng_vtable_t jumped = dice_create_xoshiro_rng(555);
+    dice_rng_vtable_t jumped_again = dice_create_xoshiro_rng(555);
+    
+    TEST_ASSERT(dice_xoshiro_jump(&jumped) == 0, "jump succeeds on xoshiro engine");
+    TEST_ASSERT(dice_xoshiro_jump(&jumped_again) == 0, "jump is repeatable");
+    
+    int same_as_base = 0;
+    int same_as_twin = 0;
+    for (int i = 0; i < 100; i++) {
+        uint64_t b = base.rand(base.state, 1000000);
+        uint64_t j = jumped.rand(jumped.state, 1000000);
+        uint64_t k = jumped_again.rand(jumped_again.state, 1000000);
+        if (b == j) same_as_base++;
+        if (j == k) same_as_twin++;
+    }
+    TEST_ASSERT(same_as_base < 5, "Jumped stream differs from base stream");
+    TEST_ASSERT(same_as_twin == 100, "Jump is deterministic");
+    
+    TEST_ASSERT(dice_xoshiro_long_jump(&jumped) == 0, "long jump succeeds on xoshiro engine");
+    
+    dice_rng_vtable_t system_rng = dice_create_system_rng(1);
+    TEST_ASSERT(dice_xoshiro_jump(&system_rng) == -1, "jump rejects non-xoshiro engines");
+    TEST_ASSERT(dice_xoshiro_long_jump(NULL) == -1, "long jump rejects NULL");
+    
+    base.cleanup(base.state);
+    jumped.cleanup(jumped.state);
+    jumped_again.cleanup(jumped_again.state);
+    system_rng.cleanup(system_rng.state);
+    return 1;
+}
+
+int test_xoshiro_bulk_matches_single() {
+    dice_rng_vtable_t bulk = dice_create_xoshiro_rng(2024);
+    dice_rng_vtable_t single = dice_create_xoshiro_rng(2024);
+    TEST_ASSERT(bulk.roll_n != NULL && bulk.rand_n != NULL, "xoshiro provides bulk entry points");
+    
+    int rolls[300];
+    TEST_ASSERT(bulk.roll_n(bulk.state, 6, rolls, 300) == 0, "roll_n succeeds");
+    bool same = true;
+    for (int i = 0; i < 300; i++) {
+        if (rolls[i] != single.roll(single.state, 6)) same = false;
+    }
+    TEST_ASSERT(same, "roll_n matches successive roll calls");
+    
+    // Non power-of-two bound exercises the rejection path
+    uint64_t values[300];
+    TEST_ASSERT(bulk.rand_n(bulk.state, 1000003, values, 300) == 0, "rand_n succeeds");
+    same = true;
+    for (int i = 0; i < 300; i++) {
+        if (values[i] != single.rand(single.state, 1000003)) same = false;
+    }
+    TEST_ASSERT(same, "rand_n matches successive rand calls");
+    TEST_ASSERT(bulk.roll(bulk.state, 20) == single.roll(single.state, 20), "Streams stay in step afterwards");
+    TEST_ASSERT(bulk.roll_n(bulk.state, 0, rolls, 4) == -1, "roll_n rejects invalid sides");
+    
+    bulk.cleanup(bulk.state);
+    single.cleanup(single.state);
+    return 1;
+}
+
+int test_bulk_fallback_without_roll_n() {
+    dice_context_t *bulk_ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_context_t *loop_ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_rng_vtable_t bulk = dice_create_xoshiro_rng(77);
+    dice_rng_vtable_t loop = dice_create_xoshiro_rng(77);
+    
+    // An engine that only implements the single-value entry points
+    loop.roll_n = NULL;
+    loop.rand_n = NULL;
+    dice_context_set_rng(bulk_ctx, &bulk);
+    dice_context_set_rng(loop_ctx, &loop);
+    
+    const char *expressions[] = {"300d6", "4d6k3", "10d10s>7", "600dF", "3d6r1"};
+    bool identical = true;
+    for (int i = 0; i < 5; i++) {
+        dice_eval_result_t a = dice_roll_expression(bulk_ctx, expressions[i]);
+        dice_eval_result_t b = dice_roll_expression(loop_ctx, expressions[i]);
+        if (!a.success || !b.success || a.value != b.value) identical = false;
+        if (dice_get_trace(bulk_ctx)->count != dice_get_trace(loop_ctx)->count) identical = false;
+        dice_clear_trace(bulk_ctx);
+        dice_clear_trace(loop_ctx);
+    }
+    TEST_ASSERT(identical, "Bulk and fallback paths produce the same rolls and traces");
+    
+    dice_context_destroy(bulk_ctx);
+    dice_context_destroy(loop_ctx);
+    return 1;
+}
+
+int test_xoshiro_x4_vector_matches_scalar() {
+    dice_rng_vtable_t bulk = dice_create_xoshiro_x4_rng(31337);
+    dice_rng_vtable_t single = dice_create_xoshiro_x4_rng(31337);
+    TEST_ASSERT(bulk.roll_n != NULL && bulk.state != NULL, "Four-lane engine created");
+    
+    // Odd block sizes leave buffered lane outputs between calls; the large die
+    // rejects about a quarter of its draws
+    static int rolls[10007];
+    const int sides[] = {10, 6, 1610612737, 20};
+    const size_t sizes[] = {10007, 3, 1001, 5};
+    bool same = true;
+    bool in_range = true;
+    for (int round = 0; round < 4; round++) {
+        TEST_ASSERT(bulk.roll_n(bulk.state, sides[round], rolls, sizes[round]) == 0, "Four-lane roll_n succeeds");
+        for (size_t i = 0; i < sizes[round]; i++) {
+            if (rolls[i] != single.roll(single.state, sides[round])) same = false;
+            if (rolls[i] < 1 || rolls[i] > sides[round]) in_range = false;
+        }
+    }
+    TEST_ASSERT(same, "Vector roll_n matches the scalar single-roll path");
+    TEST_ASSERT(in_range, "Four-lane rolls stay in range");
+    TEST_ASSERT(bulk.rand(bulk.state, 1000003) == single.rand(single.state, 1000003), "rand continues the shared stream");
+    
+    dice_rng_vtable_t other = dice_create_xoshiro_x4_rng(31338);
+    int differ = 0;
+    for (int i = 0; i < 100; i++) {
+        if (other.roll(other.state, 1000) != single.roll(single.state, 1000)) differ++;
+    }
+    TEST_ASSERT(differ > 90, "Different seeds give different streams");
+    TEST_ASSERT(dice_xoshiro_jump(&other) == -1, "jump rejects the four-lane engine");
+    
+    bulk.cleanup(bulk.state);
+    single.cleanup(single.state);
+    other.cleanup(other.state);
+    return 1;
+}
+
+int test_xoshiro_x4_uniformity() {
+    dice_rng_vtable_t rng = dice_create_xoshiro_x4_rng(8080);
+    static int rolls[60000];
+    int counts[10] = {0};
+    
+    TEST_ASSERT(rng.roll_n(rng.state, 10, rolls, 60000) == 0, "Bulk d10 pool rolled");
+    for (int i = 0; i < 60000; i++) counts[rolls[i] - 1]++;
+    
+    bool uniform = true;
+    for (int face = 0; face < 10; face++) {
+        if (counts[face] < 5600 || counts[face] > 6400) uniform = false;
+    }
+    TEST_ASSERT(uniform, "Four-lane d10 faces are roughly uniform");
+    
+    rng.cleanup(rng.state);
+    return 1;
+}
+
 int main() {
     printf("Running RNG tests...\n\n");
     
@@ -306,6 +523,14 @@ int main() {
     RUN_TEST(test_different_rng_implementations);
     RUN_TEST(test_rng_invalid_inputs);
     RUN_TEST(test_rng_state_isolation);
+    RUN_TEST(test_xoshiro_known_sequence);
+    RUN_TEST(test_xoshiro_independent_state);
+    RUN_TEST(test_xoshiro_range_and_uniformity);
+    RUN_TEST(test_xoshiro_jump_streams);
+    RUN_TEST(test_xoshiro_bulk_matches_single);
+    RUN_TEST(test_bulk_fallback_without_roll_n);
+    RUN_TEST(test_xoshiro_x4_vector_matches_scalar);
+    RUN_TEST(test_xoshiro_x4_uniformity);
     
     printf("All RNG tests passed!\n");
     return 0;
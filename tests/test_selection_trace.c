@@ -121,6 +121,90 @@ int test_selection_trace_no_selection() {
     return 1;
 }
 
+// Reference selection: the exchange sort the evaluator originally used
+static void reference_select(const int *rolls, int count, int keep, bool select_high, bool *selected) {
+    int values[256], indices[256];
+    for (int i = 0; i < count; i++) {
+        values[i] = rolls[i];
+        indices[i] = i;
+        selected[i] = false;
+    }
+    for (int i = 0; i < count - 1; i++) {
+        for (int j = i + 1; j < count; j++) {
+            bool beats = select_high ? values[j] > values[i] : values[j] < values[i];
+            if (beats) {
+                int tv = values[i]; values[i] = values[j]; values[j] = tv;
+                int ti = indices[i]; indices[i] = indices[j]; indices[j] = ti;
+            }
+        }
+    }
+    for (int i = 0; i < keep; i++) {
+        selected[indices[i]] = true;
+    }
+}
+
+// Roll an expression repeatedly and compare the traced selection flags with the reference
+static bool selection_matches_reference(const char *expression, int count, int keep, bool select_high) {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(2024);
+    dice_context_set_rng(ctx, &rng);
+    
+    dice_ast_node_t *ast = dice_parse(ctx, expression);
+    if (!ast || !ast->data.dice_op.selection) {
+        dice_context_destroy(ctx);
+        return false;
+    }
+    // The grammar only selects high; flip the parsed selection to cover low
+    ast->data.dice_op.selection->select_high = select_high;
+    
+    bool ok = true;
+    size_t mark = dice_arena_mark(ctx);
+    for (int round = 0; ok && round < 200; round++) {
+        dice_clear_trace(ctx);
+        dice_arena_rewind(ctx, mark);
+        if (!dice_evaluate(ctx, ast).success) {
+            ok = false;
+            break;
+        }
+        
+        int rolls[256];
+        bool traced[256], expected[256];
+        int n = 0;
+        for (const dice_trace_entry_t *e = dice_get_trace(ctx)->first; e && n < 256; e = e->next) {
+            rolls[n] = e->data.atomic_roll.result;
+            traced[n] = e->data.atomic_roll.selected;
+            n++;
+        }
+        if (n != count) {
+            ok = false;
+            break;
+        }
+        
+        reference_select(rolls, count, keep, select_high, expected);
+        for (int i = 0; i < count; i++) {
+            if (traced[i] != expected[i]) ok = false;
+        }
+    }
+    
+    dice_context_destroy(ctx);
+    return ok;
+}
+
+int test_selection_ties_match_exchange_sort() {
+    // Small dice: histogram path with many ties
+    TEST_ASSERT(selection_matches_reference("12d3k5", 12, 5, true), "Keep high ties match reference");
+    TEST_ASSERT(selection_matches_reference("12d3k5", 12, 5, false), "Keep low ties match reference");
+    TEST_ASSERT(selection_matches_reference("20d2l6", 20, 14, true), "Drop low ties match reference");
+    TEST_ASSERT(selection_matches_reference("20d2l6", 20, 14, false), "Drop high ties match reference");
+    TEST_ASSERT(selection_matches_reference("9d6k9", 9, 9, true), "Keeping every die matches reference");
+    
+    // Large dice: quickselect path (200 dice on d5000 still tie regularly)
+    TEST_ASSERT(selection_matches_reference("200d5000k50", 200, 50, true), "Quickselect keep high matches reference");
+    TEST_ASSERT(selection_matches_reference("200d5000l120", 200, 80, false), "Quickselect drop high matches reference");
+    
+    return 1;
+}
+
 int main() {
     printf("Running selection trace tests...\n\n");
     
@@ -128,6 +212,7 @@ int main() {
     RUN_TEST(test_selection_trace_conditional);
     RUN_TEST(test_selection_trace_drop_low);
     RUN_TEST(test_selection_trace_no_selection);
+    RUN_TEST(test_selection_ties_match_exchange_sort);
     
     printf("All selection trace tests passed!\n");
     return 0;
@@ -0,0 +1,97 @@
+#include "test_common.h"
+
+static dice_program_t* compile_expression(dice_context_t *ctx, const char *expr) {
+    dice_ast_node_t *ast = dice_parse(ctx, expr);
+    return ast ? dice_compile(ctx, ast) : NULL;
+}
+
+int test_simulate_deterministic_across_threads() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_program_t *program = compile_expression(ctx, "4d6k3+1d4");
+    TEST_ASSERT(program != NULL, "Program compiled");
+    
+    // Not a multiple of the chunk size, so the last chunk is partial
+    const size_t samples = 50000;
+    int64_t *single = malloc(samples * sizeof(int64_t));
+    int64_t *multi = malloc(samples * sizeof(int64_t));
+    dice_simulation_summary_t single_summary, multi_summary, again_summary;
+    
+    TEST_ASSERT(dice_simulate(ctx, program, samples, 1, 1234, single, &single_summary) == 0, "Single-threaded run succeeds");
+    TEST_ASSERT(dice_simulate(ctx, program, samples, 4, 1234, multi, &multi_summary) == 0, "Four-thread run succeeds");
+    TEST_ASSERT(memcmp(single, multi, samples * sizeof(int64_t)) == 0, "Samples do not depend on the thread count");
+    TEST_ASSERT(single_summary.mean == multi_summary.mean &&
+                single_summary.variance == multi_summary.variance, "Summary reduction is deterministic");
+    
+    TEST_ASSERT(dice_simulate(ctx, program, samples, 3, 1234, NULL, &again_summary) == 0, "Summary-only run succeeds");
+    TEST_ASSERT(again_summary.mean == single_summary.mean, "Same seed gives the same answer");
+    
+    dice_simulation_summary_t other;
+    dice_simulate(ctx, program, samples, 4, 4321, NULL, &other);
+    TEST_ASSERT(other.mean != single_summary.mean, "Different seeds give different runs");
+    
+    free(single);
+    free(multi);
+    dice_program_destroy(program);
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_simulate_summary_statistics() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_program_t *program = compile_expression(ctx, "2d6");
+    
+    const size_t samples = 200000;
+    int64_t *out = malloc(samples * sizeof(int64_t));
+    dice_simulation_summary_t summary;
+    TEST_ASSERT(dice_simulate(ctx, program, samples, 2, 99, out, &summary) == 0, "Simulation succeeds");
+    TEST_ASSERT(summary.samples == samples, "Every sample counted");
+    TEST_ASSERT(summary.min == 2 && summary.max == 12, "2d6 spans 2..12");
+    TEST_ASSERT(fabs(summary.mean - 7.0) < 0.05, "Mean close to 7");
+    TEST_ASSERT(fabs(summary.variance - 35.0 / 6.0) < 0.1, "Variance close to 35/6");
+    
+    double sum = 0.0;
+    for (size_t i = 0; i < samples; i++) sum += (double)out[i];
+    TEST_ASSERT(fabs(sum / samples - summary.mean) < 1e-9, "Summary agrees with the output buffer");
+    
+    free(out);
+    dice_program_destroy(program);
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_simulate_custom_dice_and_errors() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_custom_side_t sides[] = {{0, NULL, 1}, {0, NULL, 1}, {5, NULL, 1}};
+    TEST_ASSERT(dice_register_custom_die(ctx, "Skull", sides, 3) == 0, "Custom die registered");
+    
+    dice_program_t *program = compile_expression(ctx, "3dSkull+4dF");
+    TEST_ASSERT(program != NULL, "Custom dice program compiled");
+    dice_simulation_summary_t summary;
+    TEST_ASSERT(dice_simulate(ctx, program, 20000, 4, 7, NULL, &summary) == 0, "Workers see the parent registry");
+    TEST_ASSERT(summary.min >= -4 && summary.max <= 19, "Custom dice results in range");
+    dice_program_destroy(program);
+    
+    program = compile_expression(ctx, "10/(1d2-1)");
+    TEST_ASSERT(program != NULL, "Division program compiled");
+    TEST_ASSERT(dice_simulate(ctx, program, 20000, 4, 7, NULL, &summary) == -1, "Failing samples fail the run");
+    TEST_ASSERT(dice_has_error(ctx) && strstr(dice_get_error(ctx), "Division by zero"), "Worker error is reported on the context");
+    dice_clear_error(ctx);
+    dice_program_destroy(program);
+    
+    TEST_ASSERT(dice_simulate(ctx, NULL, 10, 1, 1, NULL, NULL) == -1 && dice_has_error(ctx), "NULL program rejected");
+    TEST_ASSERT(dice_simulate(NULL, NULL, 10, 1, 1, NULL, NULL) == -1, "NULL context rejected");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int main() {
+    printf("Running simulation tests...\n\n");
+    
+    RUN_TEST(test_simulate_deterministic_across_threads);
+    RUN_TEST(test_simulate_summary_statistics);
+    RUN_TEST(test_simulate_custom_dice_and_errors);
+    
+    printf("All simulation tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include "test_common.h"
+
+// =============================================================================
+// Streaming Statistics Tests
+// =============================================================================
+
+static dice_program_t* compile_expression(dice_context_t *ctx, const char *expr) {
+    dice_ast_node_t *ast = dice_parse(ctx, expr);
+    return ast ? dice_compile(ctx, ast) : NULL;
+}
+
+int test_stats_moments_and_histogram() {
+    dice_stats_t stats;
+    dice_stats_init(&stats);
+    uint64_t buckets[5];
+    TEST_ASSERT(dice_stats_set_histogram(&stats, 1, 2, buckets, 5) == 0, "Histogram attached");
+    TEST_ASSERT(dice_stats_set_histogram(&stats, 1, 0, buckets, 5) == -1, "Zero bucket width rejected");
+    
+    int64_t values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 0, 11};
+    dice_stats_add_n(&stats, values, 12);
+    
+    TEST_ASSERT(stats.count == 12, "Every sample counted");
+    TEST_ASSERT(fabs(stats.mean - 5.5) < 1e-12, "Mean is exact");
+    TEST_ASSERT(fabs(dice_stats_variance(&stats) - 143.0 / 12.0) < 1e-12, "Population variance is exact");
+    TEST_ASSERT(fabs(dice_stats_stddev(&stats) - sqrt(143.0 / 12.0)) < 1e-12, "Standard deviation matches");
+    TEST_ASSERT(stats.min == 0 && stats.max == 11, "Min and max tracked");
+    TEST_ASSERT(buckets[0] == 2 && buckets[2] == 2 && buckets[4] == 2, "Samples land in their buckets");
+    TEST_ASSERT(stats.underflow == 1 && stats.overflow == 1, "Out-of-range samples are counted separately");
+    TEST_ASSERT(dice_stats_set_histogram(&stats, 0, 1, buckets, 5) == -1, "Configuration is fixed once samples arrive");
+    
+    dice_stats_reset(&stats);
+    TEST_ASSERT(stats.count == 0 && buckets[0] == 0 && stats.buckets == buckets, "Reset keeps the histogram layout");
+    TEST_ASSERT(dice_stats_variance(&stats) == 0.0, "Empty variance is zero");
+    return 1;
+}
+
+int test_stats_quantiles() {
+    dice_stats_t stats;
+    dice_stats_init(&stats);
+    TEST_ASSERT(dice_stats_add_quantile(&stats, 0.5) == 0 && dice_stats_add_quantile(&stats, 0.9) == 0,
+                "Quantiles tracked");
+    TEST_ASSERT(dice_stats_add_quantile(&stats, 1.0) == -1, "Quantile outside (0, 1) rejected");
+    
+    double q;
+    TEST_ASSERT(dice_stats_quantile(&stats, 0.5, &q) == -1, "No estimate without samples");
+    dice_stats_add(&stats, 30);
+    dice_stats_add(&stats, 10);
+    dice_stats_add(&stats, 20);
+    TEST_ASSERT(dice_stats_quantile(&stats, 0.5, &q) == 0 && q == 20.0, "Small samples use the exact median");
+    
+    // Uniform 0..9999 shuffled deterministically
+    dice_stats_reset(&stats);
+    for (uint64_t i = 0; i < 100000; i++) {
+        dice_stats_add(&stats, (int64_t)((i * 7919) % 10000));
+    }
+    TEST_ASSERT(dice_stats_quantile(&stats, 0.5, &q) == 0 && fabs(q - 5000.0) < 100.0, "Median estimate close to 5000");
+    TEST_ASSERT(dice_stats_quantile(&stats, 0.9, &q) == 0 && fabs(q - 9000.0) < 100.0, "90th percentile close to 9000");
+    TEST_ASSERT(dice_stats_quantile(&stats, 0.25, &q) == -1, "Untracked quantile rejected");
+    return 1;
+}
+
+int test_stats_merge() {
+    dice_stats_t whole, left, right;
+    uint64_t whole_buckets[20], left_buckets[20], right_buckets[20];
+    dice_stats_t *all[] = {&whole, &left, &right};
+    uint64_t *bucket_sets[] = {whole_buckets, left_buckets, right_buckets};
+    for (int i = 0; i < 3; i++) {
+        dice_stats_init(all[i]);
+        dice_stats_set_histogram(all[i], 0, 1, bucket_sets[i], 20);
+        dice_stats_add_quantile(all[i], 0.5);
+    }
+    
+    for (int64_t i = 0; i < 40000; i++) {
+        int64_t value = (i * 13) % 19;
+        dice_stats_add(&whole, value);
+        dice_stats_add(i < 10000 ? &left : &right, value);
+    }
+    
+    TEST_ASSERT(dice_stats_merge(&left, &right) == 0, "Accumulators with the same layout merge");
+    TEST_ASSERT(left.count == whole.count && left.min == whole.min && left.max == whole.max, "Counts and extremes merge exactly");
+    TEST_ASSERT(fabs(left.mean - whole.mean) < 1e-9, "Merged mean matches");
+    TEST_ASSERT(fabs(dice_stats_variance(&left) - dice_stats_variance(&whole)) < 1e-9, "Merged variance matches");
+    TEST_ASSERT(memcmp(left_buckets, whole_buckets, sizeof(whole_buckets)) == 0, "Histograms merge exactly");
+    
+    double merged_median, whole_median;
+    dice_stats_quantile(&left, 0.5, &merged_median);
+    dice_stats_quantile(&whole, 0.5, &whole_median);
+    TEST_ASSERT(fabs(merged_median - whole_median) < 1.0, "Merged median is close");
+    
+    // A few raw samples are replayed into the other estimator
+    dice_stats_t tiny;
+    dice_stats_init(&tiny);
+    dice_stats_add_quantile(&tiny, 0.5);
+    dice_stats_add(&tiny, 7);
+    dice_stats_t big = tiny;
+    dice_stats_reset(&big);
+    for (int i = 0; i < 1000; i++) dice_stats_add(&big, i % 10);
+    TEST_ASSERT(dice_stats_merge(&tiny, &big) == 0 && tiny.count == 1001, "Tiny accumulator absorbs a large one");
+    
+    dice_stats_t plain;
+    dice_stats_init(&plain);
+    TEST_ASSERT(dice_stats_merge(&plain, &whole) == -1, "Different layouts do not merge");
+    TEST_ASSERT(plain.count == 0, "Failed merge changes nothing");
+    return 1;
+}
+
+int test_stats_batch_and_simulation() {
+    dice_context_t *ctx = dice_context_create(LARGE_ARENA_SIZE, DICE_FEATURE_ALL);
+    dice_program_t *program = compile_expression(ctx, "3d6");
+    TEST_ASSERT(program != NULL, "Program compiled");
+    
+    dice_stats_t stats;
+    uint64_t buckets[16];
+    dice_stats_init(&stats);
+    dice_stats_set_histogram(&stats, 3, 1, buckets, 16);
+    TEST_ASSERT(dice_program_evaluate_stats(ctx, program, 100000, &stats) == 0, "Batch evaluation feeds the accumulator");
+    TEST_ASSERT(stats.count == 100000 && stats.min >= 3 && stats.max <= 18, "Batch samples in range");
+    TEST_ASSERT(fabs(stats.mean - 10.5) < 0.05, "Batch mean close to 10.5");
+    TEST_ASSERT(stats.underflow == 0 && stats.overflow == 0, "Histogram holds every 3d6 outcome");
+    
+    // The runner's reduction must not depend on the thread count
+    const size_t samples = 50000;
+    dice_stats_t one, four;
+    uint64_t one_buckets[16], four_buckets[16];
+    dice_stats_init(&one);
+    dice_stats_init(&four);
+    dice_stats_set_histogram(&one, 3, 1, one_buckets, 16);
+    dice_stats_set_histogram(&four, 3, 1, four_buckets, 16);
+    dice_stats_add_quantile(&one, 0.5);
+    dice_stats_add_quantile(&four, 0.5);
+    TEST_ASSERT(dice_simulate_stats(ctx, program, samples, 1, 55, &one) == 0, "Single-threaded run succeeds");
+    TEST_ASSERT(dice_simulate_stats(ctx, program, samples, 4, 55, &four) == 0, "Four-thread run succeeds");
+    TEST_ASSERT(one.count == samples && one.mean == four.mean && one.m2 == four.m2, "Moments do not depend on the thread count");
+    TEST_ASSERT(memcmp(one_buckets, four_buckets, sizeof(one_buckets)) == 0, "Histograms do not depend on the thread count");
+    TEST_ASSERT(memcmp(one.quantiles, four.quantiles, sizeof(one.quantiles)) == 0, "Quantiles do not depend on the thread count");
+    
+    dice_simulation_summary_t summary;
+    dice_simulate(ctx, program, samples, 2, 55, NULL, &summary);
+    TEST_ASSERT(summary.min == one.min && summary.max == one.max &&
+                fabs(summary.mean - one.mean) < 1e-9, "Same samples as dice_simulate");
+    dice_program_destroy(program);
+    
+    program = compile_expression(ctx, "10/(1d2-1)");
+    dice_stats_reset(&one);
+    TEST_ASSERT(dice_simulate_stats(ctx, program, 20000, 4, 7, &one) == -1, "Failing samples fail the run");
+    TEST_ASSERT(one.count == 0 && dice_has_error(ctx), "Failed run leaves the accumulator untouched");
+    dice_clear_error(ctx);
+    TEST_ASSERT(dice_program_evaluate_stats(ctx, program, 20000, &one) == -1, "Failing batch is reported");
+    dice_clear_error(ctx);
+    dice_program_destroy(program);
+    
+    TEST_ASSERT(dice_simulate_stats(ctx, NULL, 10, 1, 1, &one) == -1 && dice_has_error(ctx), "NULL program rejected");
+    dice_clear_error(ctx);
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int main() {
+    printf("Running streaming statistics tests...\n\n");
+    
+    RUN_TEST(test_stats_moments_and_histogram);
+    RUN_TEST(test_stats_quantiles);
+    RUN_TEST(test_stats_merge);
+    RUN_TEST(test_stats_batch_and_simulation);
+    
+    printf("All streaming statistics tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,227 @@
+#include "test_common.h"
+#include <stdint.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// =============================================================================
+// Context Template Tests (frozen configuration and cheap clones)
+// =============================================================================
+
+static dice_context_t* create_source(void) {
+    dice_context_t *source = dice_context_create(16 * 1024, DICE_FEATURE_ALL);
+    dice_custom_side_t boon[] = {{0, "blank", 2}, {1, "boon", 1}, {2, "double", 1}};
+    dice_register_custom_die(source, "Boon", boon, 3);
+    
+    dice_policy_t policy = source->policy;
+    policy.max_dice_count = 50;
+    dice_context_set_policy(source, &policy);
+    dice_context_set_trace_level(source, DICE_TRACE_OFF);
+    return source;
+}
+
+int test_template_clone_configuration() {
+    dice_context_t *source = create_source();
+    dice_context_template_t *tmpl = dice_context_template_create(source, 42);
+    TEST_ASSERT(tmpl != NULL, "Template created");
+    
+    dice_context_t *a = dice_context_clone(tmpl);
+    dice_context_t *b = dice_context_clone(tmpl);
+    TEST_ASSERT(a && b, "Clones created");
+    TEST_ASSERT(a->policy.max_dice_count == 50 && a->trace_level == DICE_TRACE_OFF,
+                "Clone inherits policy and trace level");
+    TEST_ASSERT(a->arena_size == source->arena_size && a->features == source->features,
+                "Clone inherits arena size and features");
+    
+    // Both clones read the template's dice in place
+    const dice_custom_die_t *boon = dice_lookup_custom_die(a, "Boon");
+    TEST_ASSERT(boon && boon == dice_lookup_custom_die(b, "Boon"), "Custom dice are shared, not copied");
+    TEST_ASSERT(boon != dice_lookup_custom_die(source, "Boon"), "Template holds its own copy");
+    TEST_ASSERT(boon->total_weight == 4, "Weights survive the copy");
+    TEST_ASSERT(dice_lookup_custom_die(a, "F") != NULL, "FATE die is inherited");
+    
+    dice_eval_result_t result = dice_roll_expression(a, "4dF+2dBoon");
+    TEST_ASSERT(result.success && result.value >= -4 && result.value <= 8, "Clone rolls custom dice");
+    result = dice_roll_expression(a, "51d6");
+    TEST_ASSERT(!result.success, "Clone enforces the template policy");
+    dice_clear_error(a);
+    
+    // Later changes to the source do not reach the template
+    dice_custom_side_t late[] = {{9, NULL, 1}};
+    dice_register_custom_die(source, "Late", late, 1);
+    dice_clear_custom_dice(source);
+    dice_context_t *c = dice_context_clone(tmpl);
+    TEST_ASSERT(dice_lookup_custom_die(c, "Late") == NULL && dice_lookup_custom_die(c, "Boon") != NULL,
+                "Template is frozen at creation");
+    
+    // The template may be released while its clones live on
+    dice_context_template_release(tmpl);
+    TEST_ASSERT(dice_roll_expression(c, "1dBoon").success, "Clone outlives the template handle");
+    
+    dice_context_destroy(a);
+    dice_context_destroy(b);
+    dice_context_destroy(c);
+    dice_context_destroy(source);
+    return 1;
+}
+
+int test_template_copy_on_write() {
+    dice_context_t *source = create_source();
+    dice_context_template_t *tmpl = dice_context_template_create(source, 1);
+    dice_context_t *writer = dice_context_clone(tmpl);
+    dice_context_t *reader = dice_context_clone(tmpl);
+    
+    dice_custom_side_t coin[] = {{0, "tails", 1}, {1, "heads", 1}};
+    TEST_ASSERT(dice_register_custom_die(writer, "Coin", coin, 2) == 0, "Clone registers its own die");
+    TEST_ASSERT(dice_lookup_custom_die(writer, "Coin") && dice_lookup_custom_die(writer, "Boon"),
+                "Writer keeps the template's dice alongside its own");
+    TEST_ASSERT(dice_lookup_custom_die(writer, "Boon") != dice_lookup_custom_die(reader, "Boon"),
+                "Writer works on a private copy");
+    TEST_ASSERT(dice_lookup_custom_die(reader, "Coin") == NULL, "Other clones are unaffected");
+    
+    dice_context_t *later = dice_context_clone(tmpl);
+    TEST_ASSERT(dice_lookup_custom_die(later, "Coin") == NULL, "Template is unaffected");
+    
+    // Clearing detaches; a reset goes back to the template's dice
+    dice_clear_custom_dice(reader);
+    TEST_ASSERT(dice_lookup_custom_die(reader, "Boon") == NULL, "Clear empties a clone's dice");
+    TEST_ASSERT(dice_lookup_custom_die(later, "Boon") != NULL, "Clear leaves the template alone");
+    dice_context_reset(reader);
+    TEST_ASSERT(dice_lookup_custom_die(reader, "Boon") == dice_lookup_custom_die(later, "Boon"),
+                "Reset restores the shared dice");
+    dice_context_reset(writer);
+    TEST_ASSERT(dice_lookup_custom_die(writer, "Coin") == NULL, "Reset drops a clone's own dice");
+    
+    // A binding made in one clone stays valid in the others
+    dice_ast_node_t *ast = dice_parse(later, "3dBoon");
+    TEST_ASSERT(ast && ast->data.dice_op.bound_generation == reader->custom_dice.generation,
+                "Clones share the registry generation");
+    
+    dice_context_destroy(writer);
+    dice_context_destroy(reader);
+    dice_context_destroy(later);
+    dice_context_template_release(tmpl);
+    dice_context_destroy(source);
+    return 1;
+}
+
+int test_template_clone_into() {
+    dice_context_t *source = create_source();
+    dice_context_template_t *tmpl = dice_context_template_create(source, 7);
+    dice_context_destroy(source);
+    
+    // Caller-owned context and arena, reused for many requests
+    static uint64_t arena[1024];
+    dice_context_t ctx;
+    bool all_ok = true;
+    for (int i = 0; i < 100; i++) {
+        if (dice_context_clone_into(tmpl, &ctx, arena, sizeof(arena)) != 0) all_ok = false;
+        dice_eval_result_t result = dice_roll_expression(&ctx, "3d6+1dBoon");
+        if (!result.success || result.value < 3 || result.value > 20) all_ok = false;
+        dice_context_destroy(&ctx);
+    }
+    TEST_ASSERT(all_ok, "Clones into caller storage roll and release cleanly");
+    
+    TEST_ASSERT(dice_context_clone_into(tmpl, &ctx, NULL, 16) == -1, "Missing arena rejected");
+    TEST_ASSERT(dice_context_clone_into(NULL, &ctx, arena, sizeof(arena)) == -1, "Missing template rejected");
+    
+    // A clone without an arena still works once growth is enabled
+    TEST_ASSERT(dice_context_clone_into(tmpl, &ctx, NULL, 0) == 0, "Arena-less clone");
+    dice_context_set_arena_growth(&ctx, 4096);
+    TEST_ASSERT(dice_roll_expression(&ctx, "2d6").success, "Growth chunks serve the arena-less clone");
+    dice_context_destroy(&ctx);
+    
+    dice_context_template_release(tmpl);
+    dice_context_template_release(NULL);
+    return 1;
+}
+
+int test_template_rng_streams() {
+    dice_context_t *source = create_source();
+    dice_context_template_t *first = dice_context_template_create(source, 99);
+    dice_context_template_t *second = dice_context_template_create(source, 99);
+    
+    dice_context_t *a1 = dice_context_clone(first);
+    dice_context_t *a2 = dice_context_clone(first);
+    dice_context_t *b1 = dice_context_clone(second);
+    
+    bool same = true, differs = false;
+    for (int i = 0; i < 50; i++) {
+        int64_t x = dice_roll_expression(a1, "1d1000000").value;
+        int64_t y = dice_roll_expression(a2, "1d1000000").value;
+        int64_t z = dice_roll_expression(b1, "1d1000000").value;
+        if (x != z) same = false;
+        if (x != y) differs = true;
+    }
+    TEST_ASSERT(same, "Same seed and clone order give the same stream");
+    TEST_ASSERT(differs, "Clones of one template get different streams");
+    
+    dice_context_destroy(a1);
+    dice_context_destroy(a2);
+    dice_context_destroy(b1);
+    dice_context_template_release(first);
+    dice_context_template_release(second);
+    dice_context_destroy(source);
+    return 1;
+}
+
+#ifndef _WIN32
+typedef struct {
+    dice_context_template_t *tmpl;
+    int failures;
+} clone_worker_t;
+
+static void* clone_worker(void *arg) {
+    clone_worker_t *worker = arg;
+    uint64_t arena[512];
+    dice_context_t ctx;
+    
+    for (int i = 0; i < 2000; i++) {
+        dice_context_clone_into(worker->tmpl, &ctx, arena, sizeof(arena));
+        dice_eval_result_t result = dice_roll_expression(&ctx, "4dF+2dBoon");
+        if (!result.success || result.value < -4 || result.value > 8) worker->failures++;
+        dice_context_destroy(&ctx);
+    }
+    return NULL;
+}
+#endif
+
+int test_template_threads() {
+#ifndef _WIN32
+    dice_context_t *source = create_source();
+    dice_context_template_t *tmpl = dice_context_template_create(source, 5);
+    dice_context_destroy(source);
+    
+    enum { THREADS = 8 };
+    pthread_t threads[THREADS];
+    clone_worker_t workers[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        workers[i].tmpl = tmpl;
+        workers[i].failures = 0;
+        pthread_create(&threads[i], NULL, clone_worker, &workers[i]);
+    }
+    
+    int failures = 0;
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        failures += workers[i].failures;
+    }
+    TEST_ASSERT(failures == 0, "Threads clone and roll from one template without locks");
+    
+    dice_context_template_release(tmpl);
+#endif
+    return 1;
+}
+
+int main() {
+    printf("Running context template tests...\n\n");
+    
+    RUN_TEST(test_template_clone_configuration);
+    RUN_TEST(test_template_copy_on_write);
+    RUN_TEST(test_template_clone_into);
+    RUN_TEST(test_template_rng_streams);
+    RUN_TEST(test_template_threads);
+    
+    printf("All context template tests passed!\n");
+    return 0;
+}
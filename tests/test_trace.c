@@ -344,6 +344,52 @@ int test_trace_format_empty() {
     return 1;
 }
 
+int test_trace_levels() {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    TEST_ASSERT(ctx->trace_level == DICE_TRACE_FULL, "Contexts trace fully by default");
+    
+    dice_ast_node_t *ast = dice_parse(ctx, "100d6");
+    size_t mark = dice_arena_mark(ctx);
+    
+    // OFF: no entries, no counters, no arena use
+    TEST_ASSERT(dice_context_set_trace_level(ctx, DICE_TRACE_OFF) == 0, "Trace level set to OFF");
+    dice_eval_result_t result = dice_evaluate(ctx, ast);
+    TEST_ASSERT(result.success, "Evaluation succeeds with tracing off");
+    TEST_ASSERT(dice_get_trace(ctx)->count == 0, "OFF records no entries");
+    TEST_ASSERT(dice_get_trace(ctx)->summary.dice_rolled == 0, "OFF records no counters");
+    TEST_ASSERT(dice_arena_mark(ctx) == mark, "OFF uses no arena memory");
+    
+    // SUMMARY: counters only
+    dice_context_set_trace_level(ctx, DICE_TRACE_SUMMARY);
+    dice_evaluate(ctx, ast);
+    TEST_ASSERT(dice_get_trace(ctx)->count == 0, "SUMMARY records no entries");
+    TEST_ASSERT(dice_get_trace(ctx)->summary.dice_rolled == 100, "SUMMARY counts dice rolled");
+    TEST_ASSERT(dice_arena_mark(ctx) == mark, "SUMMARY uses no arena memory");
+    
+    dice_clear_trace(ctx);
+    dice_roll_expression(ctx, "4d6k3");
+    TEST_ASSERT(dice_get_trace(ctx)->summary.dice_rolled == 4, "Keep counts every die rolled");
+    TEST_ASSERT(dice_get_trace(ctx)->summary.dropped == 1, "Keep counts the dropped die");
+    
+    dice_clear_trace(ctx);
+    TEST_ASSERT(dice_get_trace(ctx)->summary.dice_rolled == 0, "Clearing resets counters");
+    
+    // FULL: entries and counters agree, rerolls included
+    dice_context_set_trace_level(ctx, DICE_TRACE_FULL);
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(5);
+    dice_context_set_rng(ctx, &rng);
+    dice_roll_expression(ctx, "20d6r<3");
+    const dice_trace_t *trace = dice_get_trace(ctx);
+    TEST_ASSERT(trace->count == trace->summary.dice_rolled, "FULL entries match dice rolled");
+    TEST_ASSERT(trace->summary.dice_rolled == 20 + trace->summary.rerolls, "Rerolls are counted as rolls");
+    
+    TEST_ASSERT(dice_context_set_trace_level(ctx, (dice_trace_level_t)7) == -1, "Invalid level rejected");
+    TEST_ASSERT(dice_context_set_trace_level(NULL, DICE_TRACE_OFF) == -1, "NULL context rejected");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
 int main() {
     printf("Running trace functionality tests...\n\n");
     
@@ -364,6 +410,7 @@ int main() {
     RUN_TEST(test_trace_format_string);
     RUN_TEST(test_trace_format_stream);
     RUN_TEST(test_trace_format_empty);
+    RUN_TEST(test_trace_levels);
     
     printf("All trace tests passed!\n");
     return 0;
@@ -0,0 +1,205 @@
+#include "test_common.h"
+#include <stdint.h>
+
+// =============================================================================
+// Packed Trace and Trace Sink Tests
+// =============================================================================
+
+// Sink that appends every batch to a growing buffer
+typedef struct {
+    uint8_t data[1 << 16];
+    size_t length;
+    int calls;
+    bool fail;
+} byte_sink_t;
+
+static int byte_sink(void *user_data, const uint8_t *data, size_t length) {
+    byte_sink_t *sink = user_data;
+    if (sink->fail || sink->length + length > sizeof(sink->data)) return -1;
+    
+    memcpy(sink->data + sink->length, data, length);
+    sink->length += length;
+    sink->calls++;
+    return 0;
+}
+
+static int file_sink(void *user_data, const uint8_t *data, size_t length) {
+    return fwrite(data, 1, length, (FILE*)user_data) == length ? 0 : -1;
+}
+
+// Roll expression with a fixed seed, in either trace representation
+static dice_context_t* roll_traced(const char *expression, bool packed) {
+    dice_context_t *ctx = dice_context_create(64 * 1024, DICE_FEATURE_ALL);
+    dice_rng_vtable_t rng = dice_create_xoshiro_rng(1234);
+    dice_context_set_rng(ctx, &rng);
+    dice_context_set_trace_packed(ctx, packed);
+    dice_roll_expression(ctx, expression);
+    return ctx;
+}
+
+int test_packed_matches_list() {
+    const char *expressions[] = {"3d6+2", "4d6k3", "10d10>8", "6d6r<2", "5d6!", "3d6!!", "4dF"};
+    
+    for (size_t i = 0; i < sizeof(expressions) / sizeof(expressions[0]); i++) {
+        dice_context_t *list = roll_traced(expressions[i], false);
+        dice_context_t *packed = roll_traced(expressions[i], true);
+        
+        const dice_trace_t *expected = dice_get_trace(list);
+        TEST_ASSERT(expected->count > 0, "Expression rolled and traced");
+        TEST_ASSERT(dice_get_trace(packed)->count == expected->count, "Same number of dice traced");
+        TEST_ASSERT(dice_get_trace(packed)->first == NULL, "Packed mode keeps no arena entries");
+        
+        size_t length, offset = 0;
+        const uint8_t *data = dice_trace_packed(packed, &length);
+        bool same = true;
+        dice_trace_roll_t roll;
+        for (const dice_trace_entry_t *entry = expected->first; entry; entry = entry->next) {
+            if (dice_trace_decode(data, length, &offset, &roll) != 1 ||
+                roll.sides != entry->data.atomic_roll.sides ||
+                roll.result != entry->data.atomic_roll.result ||
+                roll.selected != entry->data.atomic_roll.selected) {
+                same = false;
+            }
+        }
+        TEST_ASSERT(same, "Packed records decode to the listed entries");
+        TEST_ASSERT(dice_trace_decode(data, length, &offset, &roll) == 0, "Nothing follows the last record");
+        
+        char a[4096], b[4096];
+        TEST_ASSERT(dice_format_trace_string(list, a, sizeof(a)) >= 0 &&
+                    dice_format_trace_string(packed, b, sizeof(b)) >= 0 && strcmp(a, b) == 0,
+                    "Formatting reads either representation");
+        
+        dice_context_destroy(list);
+        dice_context_destroy(packed);
+    }
+    return 1;
+}
+
+int test_packed_is_compact() {
+    dice_context_t *ctx = dice_context_create(16 * 1024, DICE_FEATURE_ALL);
+    dice_context_set_trace_packed(ctx, true);
+    
+    // Far more dice than the arena could hold as entries
+    size_t mark = dice_arena_mark(ctx);
+    dice_eval_result_t result = dice_roll_expression(ctx, "500d6k10");
+    TEST_ASSERT(result.success, "Large audited roll fits a small arena");
+    TEST_ASSERT(dice_get_trace(ctx)->count == 500, "Every die is traced");
+    
+    size_t length;
+    dice_trace_packed(ctx, &length);
+    TEST_ASSERT(length == 1000, "A d6 takes two bytes");
+    TEST_ASSERT(dice_arena_mark(ctx) - mark < 1024, "Trace uses no arena memory");
+    
+    // Large and negative values round-trip
+    uint8_t bytes[] = {0xfc, 0xff, 0xff, 0xff, 0x1f, 0x01};
+    size_t offset = 0;
+    dice_trace_roll_t roll;
+    TEST_ASSERT(dice_trace_decode(bytes, sizeof(bytes), &offset, &roll) == 1 &&
+                roll.sides == INT32_MAX && roll.result == -1 && !roll.selected && offset == 6,
+                "Extreme values decode");
+    offset = 0;
+    TEST_ASSERT(dice_trace_decode(bytes, 3, &offset, &roll) == -1 && offset == 0, "Truncated record rejected");
+    uint8_t overlong[] = {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01, 0x02};
+    TEST_ASSERT(dice_trace_decode(overlong, sizeof(overlong), &offset, &roll) == -1, "Overlong varint rejected");
+    
+    dice_clear_trace(ctx);
+    TEST_ASSERT(dice_trace_packed(ctx, &length) == NULL && length == 0, "Clear empties the buffer");
+    
+    // Going back to the list representation
+    TEST_ASSERT(dice_context_set_trace_packed(ctx, false) == 0, "Packing switched off");
+    dice_roll_expression(ctx, "2d6");
+    TEST_ASSERT(dice_get_trace(ctx)->first != NULL, "Entries are listed again");
+    
+    dice_context_destroy(ctx);
+    return 1;
+}
+
+int test_trace_sink_batches() {
+    static byte_sink_t sink;
+    memset(&sink, 0, sizeof(sink));
+    
+    dice_context_t *ctx = dice_context_create(16 * 1024, DICE_FEATURE_ALL);
+    TEST_ASSERT(dice_context_set_trace_sink(ctx, byte_sink, &sink, 64) == 0, "Sink attached");
+    
+    // Batches are delivered while the roll is still running
+    TEST_ASSERT(dice_roll_expression(ctx, "1000d6").success, "Roll with sink succeeds");
+    TEST_ASSERT(sink.calls > 10, "Records streamed in batches");
+    
+    size_t pending;
+    dice_trace_packed(ctx, &pending);
+    TEST_ASSERT(pending < 64, "At most one partial batch pending");
+    TEST_ASSERT(dice_trace_flush(ctx) == 0 && sink.length == 2000, "Flush delivers the tail");
+    
+    size_t offset = 0;
+    int decoded = 0;
+    bool in_range = true;
+    dice_trace_roll_t roll;
+    while (dice_trace_decode(sink.data, sink.length, &offset, &roll) == 1) {
+        if (roll.sides != 6 || roll.result < 1 || roll.result > 6) in_range = false;
+        decoded++;
+    }
+    TEST_ASSERT(decoded == 1000 && in_range, "Batches concatenate to whole records");
+    
+    // A failing sink fails the evaluation and keeps the bytes
+    sink.fail = true;
+    dice_eval_result_t result = dice_roll_expression(ctx, "100d6");
+    TEST_ASSERT(!result.success && strstr(dice_get_error(ctx), "Trace sink failed") != NULL,
+                "Sink failure fails the roll");
+    dice_clear_error(ctx);
+    dice_trace_packed(ctx, &pending);
+    TEST_ASSERT(pending >= 64 && dice_trace_flush(ctx) == -1, "Undelivered bytes stay pending");
+    sink.fail = false;
+    TEST_ASSERT(dice_trace_flush(ctx) == 0 && dice_trace_packed(ctx, NULL) == NULL, "Retry delivers them");
+    
+    // The tail is delivered on clear and destroy
+    int calls = sink.calls;
+    dice_roll_expression(ctx, "2d6");
+    dice_clear_trace(ctx);
+    TEST_ASSERT(sink.calls == calls + 1, "Clear flushes to the sink");
+    dice_roll_expression(ctx, "2d6");
+    dice_context_destroy(ctx);
+    TEST_ASSERT(sink.calls == calls + 2, "Destroy flushes to the sink");
+    return 1;
+}
+
+int test_trace_sink_file() {
+    FILE *file = tmpfile();
+    TEST_ASSERT(file != NULL, "Temporary file opened");
+    
+    dice_context_t *ctx = dice_context_create(16 * 1024, DICE_FEATURE_ALL);
+    dice_context_set_trace_sink(ctx, file_sink, file, 0);
+    for (int i = 0; i < 200; i++) {
+        dice_roll_expression(ctx, "4d6k3");
+        dice_arena_rewind(ctx, 0);
+    }
+    dice_context_destroy(ctx);
+    
+    // Read the audit log back
+    static uint8_t data[1 << 14];
+    rewind(file);
+    size_t length = fread(data, 1, sizeof(data), file);
+    fclose(file);
+    
+    size_t offset = 0;
+    int decoded = 0, kept = 0;
+    dice_trace_roll_t roll;
+    while (dice_trace_decode(data, length, &offset, &roll) == 1) {
+        decoded++;
+        if (roll.selected) kept++;
+    }
+    TEST_ASSERT(offset == length, "File holds only whole records");
+    TEST_ASSERT(decoded == 800 && kept == 600, "Every die and its selection reach the file");
+    return 1;
+}
+
+int main() {
+    printf("Running packed trace tests...\n\n");
+    
+    RUN_TEST(test_packed_matches_list);
+    RUN_TEST(test_packed_is_compact);
+    RUN_TEST(test_trace_sink_batches);
+    RUN_TEST(test_trace_sink_file);
+    
+    printf("All packed trace tests passed!\n");
+    return 0;
+}